@@ -0,0 +1,107 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_BENCHMARKS_BENCHMARKS_H_
+#define NATRON_BENCHMARKS_BENCHMARKS_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <list>
+#include <string>
+#include <utility>
+#include <ostream>
+
+/**
+ * @brief Collects the results of the benchmarks and writes them as JSON, so that they can be compared
+ * between releases by a script.
+ **/
+class BenchmarkReport
+{
+public:
+
+    struct Result
+    {
+        std::string name;
+        int iterations;
+        double seconds; //< total wall-clock time of all iterations
+        std::list<std::pair<std::string,double> > params; //< e.g: the image size or the number of threads
+
+        Result()
+        : name()
+        , iterations(0)
+        , seconds(0)
+        , params()
+        {
+        }
+    };
+
+    BenchmarkReport(int nThreads);
+
+    /**
+     * @brief The number of threads the multi-threaded benchmarks should use.
+     **/
+    int getThreadsCount() const
+    {
+        return _nThreads;
+    }
+
+    void addResult(const Result& result);
+
+    /**
+     * @brief Adds a benchmark that could not run (e.g: a plug-in it needs is not installed)
+     **/
+    void addSkipped(const std::string& name,const std::string& reason);
+
+    void writeJSON(std::ostream& os) const;
+
+private:
+
+    int _nThreads;
+    std::list<Result> _results;
+    std::list<std::pair<std::string,std::string> > _skipped;
+};
+
+/**
+ * @brief Fits cubic Bezier curves on generated freehand-like point clouds of 1k to 100k points
+ * and reports the time spent in FitCurve::fit_cubic for each size.
+ **/
+void benchmarkFitCurve(BenchmarkReport* report);
+
+/**
+ * @brief Image::pasteFrom, Image::downscaleMipMap (halveRoI), Image::convertToFormat and Image::applyMaskMix
+ * on HD and 4K images.
+ **/
+void benchmarkImage(BenchmarkReport* report);
+
+/**
+ * @brief The sRGB Lut packed converters from and to 8-bit buffers.
+ **/
+void benchmarkLut(BenchmarkReport* report);
+
+/**
+ * @brief Curve::getValueAt on curves of 10 to 10k keyframes.
+ **/
+void benchmarkCurve(BenchmarkReport* report);
+
+/**
+ * @brief Hash64 of a node-like list of values.
+ **/
+void benchmarkHash64(BenchmarkReport* report);
+
+/**
+ * @brief Concurrent look-ups and insertions in the image cache from getThreadsCount() threads.
+ * The AppManager must have been loaded.
+ **/
+void benchmarkCache(BenchmarkReport* report);
+
+/**
+ * @brief renderRoI of a generator followed by a chain of Dot nodes, without the viewer nor a writer.
+ * The AppManager must have been loaded.
+ **/
+void benchmarkRenderRoI(BenchmarkReport* report);
+
+#endif // NATRON_BENCHMARKS_BENCHMARKS_H_
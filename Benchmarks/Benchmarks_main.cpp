@@ -0,0 +1,138 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Global/Macros.h"
+#include "Engine/AppManager.h"
+#include "Engine/AppInstance.h"
+#include "Engine/RenderBenchmark.h"
+
+BenchmarkReport::BenchmarkReport(int nThreads)
+: _nThreads(nThreads)
+, _results()
+, _skipped()
+{
+}
+
+void
+BenchmarkReport::addResult(const Result& result)
+{
+    _results.push_back(result);
+    ///Keep a human readable trace on stderr, stdout may be the JSON output
+    std::fprintf(stderr, "%-40s %8d iterations: %.6f s\n", result.name.c_str(), result.iterations, result.seconds);
+}
+
+void
+BenchmarkReport::addSkipped(const std::string& name,
+                            const std::string& reason)
+{
+    _skipped.push_back( std::make_pair(name, reason) );
+    std::fprintf(stderr, "%-40s skipped: %s\n", name.c_str(), reason.c_str());
+}
+
+void
+BenchmarkReport::writeJSON(std::ostream& os) const
+{
+    os.precision(9);
+    os << "{\n";
+    os << "  \"version\": \"" << NATRON_VERSION_STRING << "\",\n";
+    os << "  \"threads\": " << _nThreads << ",\n";
+    os << "  \"benchmarks\": [";
+    for (std::list<Result>::const_iterator it = _results.begin(); it != _results.end(); ++it) {
+        os << (it == _results.begin() ? "\n" : ",\n");
+        os << "    { \"name\": \"" << Natron::escapeJSON(it->name) << "\", \"iterations\": " << it->iterations
+           << ", \"seconds\": " << it->seconds
+           << ", \"secondsPerIteration\": " << (it->iterations > 0 ? it->seconds / it->iterations : 0.);
+        for (std::list<std::pair<std::string,double> >::const_iterator p = it->params.begin(); p != it->params.end(); ++p) {
+            os << ", \"" << Natron::escapeJSON(p->first) << "\": " << p->second;
+        }
+        os << " }";
+    }
+    os << "\n  ],\n";
+    os << "  \"skipped\": [";
+    for (std::list<std::pair<std::string,std::string> >::const_iterator it = _skipped.begin(); it != _skipped.end(); ++it) {
+        os << (it == _skipped.begin() ? "\n" : ",\n");
+        os << "    { \"name\": \"" << Natron::escapeJSON(it->first) << "\", \"reason\": \"" << Natron::escapeJSON(it->second) << "\" }";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+static void
+printUsage(const char* programName)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-o <file.json>] [-t <threads>]\n"
+                 "  -o, --output <file.json>  Write the results to the given file instead of the standard output.\n"
+                 "  -t, --threads <threads>   Number of threads used by the multi-threaded benchmarks. Defaults to\n"
+                 "                            the number of cores.\n",
+                 programName);
+}
+
+int
+main(int argc,
+     char* argv[])
+{
+    std::string outputPath;
+    int nThreads = 0;
+    for (int i = 1; i < argc; ++i) {
+        if ( (!std::strcmp(argv[i], "-o") || !std::strcmp(argv[i], "--output")) && i + 1 < argc ) {
+            outputPath = argv[++i];
+        } else if ( (!std::strcmp(argv[i], "-t") || !std::strcmp(argv[i], "--threads")) && i + 1 < argc ) {
+            nThreads = std::atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    ///The cache and the render benchmarks need the engine to be loaded, the same way the unit tests do it
+    AppManager* manager = new AppManager;
+    int appArgc = 0;
+    CLArgs cl;
+    manager->load(appArgc, 0, cl);
+    if (nThreads <= 0) {
+        nThreads = manager->getHardwareIdealThreadCount();
+    }
+
+    BenchmarkReport report(nThreads);
+    benchmarkImage(&report);
+    benchmarkLut(&report);
+    benchmarkCurve(&report);
+    benchmarkHash64(&report);
+    benchmarkFitCurve(&report);
+    benchmarkCache(&report);
+    benchmarkRenderRoI(&report);
+
+    if ( outputPath.empty() ) {
+        report.writeJSON(std::cout);
+    } else {
+        std::ofstream ofile(outputPath.c_str());
+        if ( !ofile.good() ) {
+            std::fprintf(stderr, "Cannot open %s for writing\n", outputPath.c_str());
+            manager->getTopLevelInstance()->quit();
+            manager->setNumberOfThreads(0);
+            delete manager;
+            return 1;
+        }
+        report.writeJSON(ofile);
+    }
+
+    manager->getTopLevelInstance()->quit();
+    manager->setNumberOfThreads(0);
+    delete manager;
+    return 0;
+}
@@ -0,0 +1,127 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <QThread>
+
+#include "Engine/AppManager.h"
+#include "Engine/Image.h"
+#include "Engine/ImageParams.h"
+#include "Engine/Timer.h"
+
+using namespace Natron;
+
+///A node hash that no node of the (empty) project can have
+#define CACHE_BENCHMARK_NODE_HASH 0xbe0c4a11be0c4a11ULL
+
+///Number of distinct images: at 128x128 RGBA 8-bit this is 32 MB, which fits in the default cache size
+#define CACHE_BENCHMARK_KEYS 512
+
+#define CACHE_BENCHMARK_OPERATIONS_PER_THREAD 20000
+
+namespace {
+
+/**
+ * @brief Looks-up CACHE_BENCHMARK_OPERATIONS_PER_THREAD images picked pseudo-randomly among CACHE_BENCHMARK_KEYS keys,
+ * creating and allocating those that are not in the cache yet.
+ **/
+class CacheBenchmarkThread : public QThread
+{
+    int _seed;
+    boost::shared_ptr<ImageParams> _params;
+
+public:
+
+    int nHits;
+
+    CacheBenchmarkThread(int seed,
+                         const boost::shared_ptr<ImageParams>& params)
+    : QThread()
+    , _seed(seed)
+    , _params(params)
+    , nHits(0)
+    {
+    }
+
+    virtual void run()
+    {
+        ///Linear congruential generator: std::rand is not thread-safe
+        unsigned int state = (unsigned int)_seed * 2654435761U + 1;
+        for (int i = 0; i < CACHE_BENCHMARK_OPERATIONS_PER_THREAD; ++i) {
+            state = state * 1664525U + 1013904223U;
+            int time = (int)( (state >> 8) % CACHE_BENCHMARK_KEYS );
+            ImageKey key = Image::makeKey(CACHE_BENCHMARK_NODE_HASH, true, time, 0);
+            boost::shared_ptr<Image> image;
+            if ( appPTR->getImageOrCreate(key, _params, &image) ) {
+                ++nHits;
+            } else if (image) {
+                image->allocateMemory();
+            }
+        }
+    }
+};
+
+}
+
+static void
+runCacheBenchmark(BenchmarkReport* report,
+                  const char* name,
+                  int nThreads,
+                  const boost::shared_ptr<ImageParams>& params)
+{
+    std::vector<CacheBenchmarkThread*> threads;
+    for (int i = 0; i < nThreads; ++i) {
+        threads.push_back( new CacheBenchmarkThread(i + 1, params) );
+    }
+    TimeLapse timer;
+    for (int i = 0; i < nThreads; ++i) {
+        threads[i]->start();
+    }
+    int nHits = 0;
+    for (int i = 0; i < nThreads; ++i) {
+        threads[i]->wait();
+        nHits += threads[i]->nHits;
+        delete threads[i];
+    }
+
+    BenchmarkReport::Result r;
+    r.name = name;
+    r.iterations = nThreads * CACHE_BENCHMARK_OPERATIONS_PER_THREAD;
+    r.seconds = timer.getTimeElapsedReset();
+    r.params.push_back( std::make_pair(std::string("threads"), (double)nThreads) );
+    r.params.push_back( std::make_pair(std::string("hitRate"), (double)nHits / r.iterations) );
+    report->addResult(r);
+}
+
+void
+benchmarkCache(BenchmarkReport* report)
+{
+    RectD rod(0, 0, 128, 128);
+    std::map<int, std::map<int,std::vector<RangeD> > > framesNeeded;
+    boost::shared_ptr<ImageParams> params = Image::makeParams(0, rod, 1., 0, false, ImageComponents::getRGBAComponents(),
+                                                              eImageBitDepthByte, framesNeeded);
+
+    const int maxThreads = report->getThreadsCount();
+    for (int nThreads = 1; ; nThreads = std::min(nThreads * 2, maxThreads)) {
+        appPTR->removeAllImagesFromCacheWithMatchingKey(CACHE_BENCHMARK_NODE_HASH);
+        ///Empty cache: the first look-ups of each key are insertions
+        runCacheBenchmark(report, "Cache::getOrCreate cold", nThreads, params);
+        ///All keys are in the cache: every look-up is a hit
+        runCacheBenchmark(report, "Cache::getOrCreate warm", nThreads, params);
+        if (nThreads == maxThreads) {
+            break;
+        }
+    }
+    appPTR->removeAllImagesFromCacheWithMatchingKey(CACHE_BENCHMARK_NODE_HASH);
+}
@@ -0,0 +1,49 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <cmath>
+
+#include "Engine/Curve.h"
+#include "Engine/Timer.h"
+
+#define CURVE_BENCHMARK_EVALUATIONS 1000000
+
+void
+benchmarkCurve(BenchmarkReport* report)
+{
+    const int nKeys[4] = { 10, 100, 1000, 10000 };
+    const Natron::KeyframeTypeEnum interps[2] = { Natron::eKeyframeTypeLinear, Natron::eKeyframeTypeSmooth };
+    const char* interpNames[2] = { "Curve::getValueAt linear", "Curve::getValueAt smooth" };
+
+    for (int k = 0; k < 2; ++k) {
+        for (int n = 0; n < 4; ++n) {
+            Curve c;
+            for (int i = 0; i < nKeys[n]; ++i) {
+                (void)c.addKeyFrame( KeyFrame(i * 10., std::sin(i * 0.1), 0., 0., interps[k]) );
+            }
+            
+            ///Evaluate at times spread over the whole curve, in between the keyframes
+            const double step = (nKeys[n] * 10.) / CURVE_BENCHMARK_EVALUATIONS;
+            double sum = 0.;
+            TimeLapse timer;
+            for (int i = 0; i < CURVE_BENCHMARK_EVALUATIONS; ++i) {
+                sum += c.getValueAt(i * step);
+            }
+            BenchmarkReport::Result r;
+            r.name = interpNames[k];
+            r.iterations = CURVE_BENCHMARK_EVALUATIONS;
+            r.seconds = timer.getTimeElapsedReset();
+            r.params.push_back( std::make_pair(std::string("keyframes"), (double)nKeys[n]) );
+            r.params.push_back( std::make_pair(std::string("checksum"), sum) );
+            report->addResult(r);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Engine/FitCurve.h"
+#include "Engine/Timer.h"
+
+using namespace Natron;
+
+#ifndef M_PI
+#define M_PI        3.14159265358979323846264338327950288   /* pi             */
+#endif
+
+/**
+ * @brief Generates a closed, wobbly stroke sampled with nPoints points plus some jitter, similar to what
+ * a tablet produces when drawing a freehand shape. The seed is fixed so that runs are comparable.
+ **/
+static void generateFreehandStroke(int nPoints, std::vector<Point>* points)
+{
+    std::srand(1);
+    points->resize(nPoints);
+    for (int i = 0; i < nPoints; ++i) {
+        double t = 2. * M_PI * (double)i / nPoints;
+        double radius = 500. + 100. * std::sin(5. * t) + 20. * std::cos(17. * t);
+        double jitterX = (std::rand() / (double)RAND_MAX - 0.5) * 0.5;
+        double jitterY = (std::rand() / (double)RAND_MAX - 0.5) * 0.5;
+        (*points)[i].x = radius * std::cos(t) + jitterX;
+        (*points)[i].y = radius * std::sin(t) + jitterY;
+    }
+}
+
+void
+benchmarkFitCurve(BenchmarkReport* report)
+{
+    const int sizes[3] = { 1000, 10000, 100000 };
+    const double error = 1.;
+    
+    for (int i = 0; i < 3; ++i) {
+        std::vector<Point> points;
+        generateFreehandStroke(sizes[i], &points);
+        
+        std::vector<FitCurve::SimpleBezierCP> curve;
+        TimeLapse timer;
+        FitCurve::fit_cubic(points, error, &curve);
+        
+        BenchmarkReport::Result r;
+        r.name = "FitCurve::fit_cubic";
+        r.iterations = 1;
+        r.seconds = timer.getTimeElapsedReset();
+        r.params.push_back( std::make_pair(std::string("points"), (double)sizes[i]) );
+        r.params.push_back( std::make_pair(std::string("controlPoints"), (double)curve.size()) );
+        report->addResult(r);
+    }
+}
@@ -0,0 +1,42 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include "Engine/Hash64.h"
+#include "Engine/Timer.h"
+
+#define HASH64_BENCHMARK_ITERATIONS 100000
+
+void
+benchmarkHash64(BenchmarkReport* report)
+{
+    ///From a node with a few parameters to a node with many parameters and inputs
+    const int nValues[3] = { 16, 128, 1024 };
+
+    for (int n = 0; n < 3; ++n) {
+        U64 checksum = 0;
+        TimeLapse timer;
+        for (int i = 0; i < HASH64_BENCHMARK_ITERATIONS; ++i) {
+            Hash64 hash;
+            for (int j = 0; j < nValues[n]; ++j) {
+                hash.append<double>(i + j * 0.5);
+            }
+            hash.computeHash();
+            checksum ^= hash.value();
+        }
+        BenchmarkReport::Result r;
+        r.name = "Hash64::computeHash";
+        r.iterations = HASH64_BENCHMARK_ITERATIONS;
+        r.seconds = timer.getTimeElapsedReset();
+        r.params.push_back( std::make_pair(std::string("values"), (double)nValues[n]) );
+        r.params.push_back( std::make_pair(std::string("checksum"), (double)(checksum & 0xffff)) );
+        report->addResult(r);
+    }
+}
@@ -0,0 +1,128 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <cstdlib>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Engine/Image.h"
+#include "Engine/Timer.h"
+
+using namespace Natron;
+
+#define IMAGE_BENCHMARK_ITERATIONS 10
+
+static boost::shared_ptr<Image>
+createImage(const RectI& bounds,
+            const ImageComponents& comps,
+            ImageBitDepthEnum depth,
+            unsigned int mipMapLevel = 0)
+{
+    RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    return boost::shared_ptr<Image>( new Image(comps, rod, bounds, mipMapLevel, 1., depth, false) );
+}
+
+/**
+ * @brief Fills a float image with noise, with a fixed seed so that runs are comparable.
+ **/
+static void
+fillNoise(Image* img)
+{
+    std::srand(1);
+    Image::WriteAccess acc = img->getWriteRights();
+    const RectI& bounds = img->getBounds();
+    int nComps = img->getComponentsCount();
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        float* pix = (float*)acc.pixelAt(bounds.x1, y);
+        for (int x = bounds.x1; x < bounds.x2; ++x) {
+            for (int k = 0; k < nComps; ++k, ++pix) {
+                *pix = std::rand() / (float)RAND_MAX;
+            }
+        }
+    }
+}
+
+static void
+addImageResult(BenchmarkReport* report,
+               const char* name,
+               const RectI& bounds,
+               double seconds)
+{
+    BenchmarkReport::Result r;
+    r.name = name;
+    r.iterations = IMAGE_BENCHMARK_ITERATIONS;
+    r.seconds = seconds;
+    r.params.push_back( std::make_pair(std::string("width"), (double)bounds.width()) );
+    r.params.push_back( std::make_pair(std::string("height"), (double)bounds.height()) );
+    report->addResult(r);
+}
+
+void
+benchmarkImage(BenchmarkReport* report)
+{
+    const RectI sizes[2] = { RectI(0, 0, 1920, 1080), RectI(0, 0, 3840, 2160) };
+
+    for (int s = 0; s < 2; ++s) {
+        const RectI& bounds = sizes[s];
+        RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+        boost::shared_ptr<Image> src = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+        fillNoise( src.get() );
+
+        {
+            boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+            TimeLapse timer;
+            for (int i = 0; i < IMAGE_BENCHMARK_ITERATIONS; ++i) {
+                dst->pasteFrom(*src, bounds, false);
+            }
+            addImageResult(report, "Image::pasteFrom", bounds, timer.getTimeElapsedReset());
+        }
+
+        {
+            ///downscaleMipMap by one level is a call to halveRoI followed by a paste
+            RectI halfBounds = bounds.downscalePowerOfTwoSmallestEnclosing(1);
+            boost::shared_ptr<Image> dst = createImage(halfBounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat, 1);
+            TimeLapse timer;
+            for (int i = 0; i < IMAGE_BENCHMARK_ITERATIONS; ++i) {
+                src->downscaleMipMap(rod, bounds, 0, 1, false, dst.get());
+            }
+            addImageResult(report, "Image::halveRoI", bounds, timer.getTimeElapsedReset());
+        }
+
+        {
+            boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthByte);
+            TimeLapse timer;
+            for (int i = 0; i < IMAGE_BENCHMARK_ITERATIONS; ++i) {
+                src->convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceSRGB, 3, false, false, dst.get());
+            }
+            addImageResult(report, "Image::convertToFormat float->byte sRGB", bounds, timer.getTimeElapsedReset());
+        }
+
+        {
+            boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getAlphaComponents(), eImageBitDepthFloat);
+            TimeLapse timer;
+            for (int i = 0; i < IMAGE_BENCHMARK_ITERATIONS; ++i) {
+                src->convertToFormat(bounds, eViewerColorSpaceLinear, eViewerColorSpaceLinear, 3, false, false, dst.get());
+            }
+            addImageResult(report, "Image::convertToFormat RGBA->Alpha", bounds, timer.getTimeElapsedReset());
+        }
+
+        {
+            boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+            boost::shared_ptr<Image> mask = createImage(bounds, ImageComponents::getAlphaComponents(), eImageBitDepthFloat);
+            fillNoise( mask.get() );
+            TimeLapse timer;
+            for (int i = 0; i < IMAGE_BENCHMARK_ITERATIONS; ++i) {
+                dst->applyMaskMix(bounds, mask.get(), src.get(), true, false, 0.5f);
+            }
+            addImageResult(report, "Image::applyMaskMix", bounds, timer.getTimeElapsedReset());
+        }
+    }
+}
@@ -0,0 +1,80 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "Engine/Lut.h"
+#include "Engine/Rect.h"
+#include "Engine/Timer.h"
+
+using namespace Natron::Color;
+
+#define LUT_BENCHMARK_ITERATIONS 10
+
+void
+benchmarkLut(BenchmarkReport* report)
+{
+    const Lut* lut = LutManager::sRGBLut();
+    lut->validate();
+
+    ///An HD RGBA frame, packed
+    const RectI bounds(0, 0, 1920, 1080);
+    const std::size_t nElements = (std::size_t)bounds.width() * bounds.height() * 4;
+    std::vector<float> floatBuf(nElements);
+    std::vector<unsigned char> byteBuf(nElements);
+    std::srand(1);
+    for (std::size_t i = 0; i < nElements; ++i) {
+        floatBuf[i] = std::rand() / (float)RAND_MAX;
+    }
+
+    {
+        TimeLapse timer;
+        for (int i = 0; i < LUT_BENCHMARK_ITERATIONS; ++i) {
+            lut->to_byte_packed(&byteBuf[0], &floatBuf[0], bounds, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false, false);
+        }
+        BenchmarkReport::Result r;
+        r.name = "Lut::to_byte_packed sRGB";
+        r.iterations = LUT_BENCHMARK_ITERATIONS;
+        r.seconds = timer.getTimeElapsedReset();
+        r.params.push_back( std::make_pair(std::string("pixels"), (double)bounds.area()) );
+        report->addResult(r);
+    }
+    {
+        TimeLapse timer;
+        for (int i = 0; i < LUT_BENCHMARK_ITERATIONS; ++i) {
+            lut->from_byte_packed(&floatBuf[0], &byteBuf[0], bounds, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false, false);
+        }
+        BenchmarkReport::Result r;
+        r.name = "Lut::from_byte_packed sRGB";
+        r.iterations = LUT_BENCHMARK_ITERATIONS;
+        r.seconds = timer.getTimeElapsedReset();
+        r.params.push_back( std::make_pair(std::string("pixels"), (double)bounds.area()) );
+        report->addResult(r);
+    }
+    {
+        ///The per-value float conversion used by the viewer and the OpenFX color-space suites
+        volatile float sink = 0.f;
+        TimeLapse timer;
+        for (int i = 0; i < LUT_BENCHMARK_ITERATIONS; ++i) {
+            for (std::size_t j = 0; j < nElements; ++j) {
+                sink = lut->toColorSpaceFloatFromLinearFloat(floatBuf[j]);
+            }
+        }
+        (void)sink;
+        BenchmarkReport::Result r;
+        r.name = "Lut::toColorSpaceFloatFromLinearFloat";
+        r.iterations = LUT_BENCHMARK_ITERATIONS;
+        r.seconds = timer.getTimeElapsedReset();
+        r.params.push_back( std::make_pair(std::string("values"), (double)nElements) );
+        report->addResult(r);
+    }
+}
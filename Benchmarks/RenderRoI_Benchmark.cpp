@@ -0,0 +1,155 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Benchmarks.h"
+
+#include <climits>
+#include <exception>
+#include <vector>
+
+#include "Engine/AppManager.h"
+#include "Engine/AppInstance.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/Image.h"
+#include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
+#include "Engine/Plugin.h"
+#include "Engine/Project.h"
+#include "Engine/TimeLine.h"
+#include "Engine/Timer.h"
+
+using namespace Natron;
+
+///Number of Dot nodes between the generator and the node rendered
+#define RENDERROI_BENCHMARK_DEPTH 8
+
+#define RENDERROI_BENCHMARK_FRAMES 20
+
+static boost::shared_ptr<Node>
+createBenchmarkNode(AppInstance* app,
+                    const QString& pluginID)
+{
+    return app->createNode( CreateNodeArgs(pluginID,
+                                           "",
+                                           -1,-1,false,INT_MIN,INT_MIN,false,true,false,
+                                           QString(),CreateNodeArgs::DefaultValuesList(),
+                                           app->getProject()) );
+}
+
+/**
+ * @brief Renders the frames [1, RENDERROI_BENCHMARK_FRAMES] of the output node, optionally clearing the image cache
+ * before each frame. Returns the time spent in renderRoI only, or -1 if a render failed.
+ **/
+static double
+renderFrames(AppInstance* app,
+             const boost::shared_ptr<Node>& output,
+             bool clearCache)
+{
+    EffectInstance* effect = output->getLiveInstance();
+    double elapsed = 0.;
+    for (int time = 1; time <= RENDERROI_BENCHMARK_FRAMES; ++time) {
+        if (clearCache) {
+            appPTR->clearNodeCache();
+        }
+        
+        TimeLapse timer;
+        ParallelRenderArgsSetter frameRenderArgs(app->getProject().get(),
+                                                 time,
+                                                 0, //< view
+                                                 false, //<isRenderUserInteraction
+                                                 false, //isSequential
+                                                 false, //can abort
+                                                 0, //render Age
+                                                 0, // requester
+                                                 0, //texture index
+                                                 app->getTimeLine().get(),
+                                                 NodePtr(),
+                                                 false);
+        RenderScale scale;
+        scale.x = scale.y = 1.;
+        RectD rod;
+        bool isProjectFormat;
+        StatusEnum stat = effect->getRegionOfDefinition_public(effect->getHash(), time, scale, 0, &rod, &isProjectFormat);
+        if (stat == eStatusFailed) {
+            return -1.;
+        }
+        RectI renderWindow;
+        rod.toPixelEnclosing(0, effect->getPreferredAspectRatio(), &renderWindow);
+        
+        std::list<ImageComponents> requestedComps;
+        requestedComps.push_back( ImageComponents::getRGBAComponents() );
+        ImageList planes;
+        EffectInstance::RenderRoIRetCode retCode =
+        effect->renderRoI(EffectInstance::RenderRoIArgs(time, scale, 0, 0, false, renderWindow, rod, requestedComps,
+                                                        eImageBitDepthFloat, effect), &planes);
+        if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
+            return -1.;
+        }
+        elapsed += timer.getTimeElapsedReset();
+    }
+    return elapsed;
+}
+
+void
+benchmarkRenderRoI(BenchmarkReport* report)
+{
+    const char* name = "EffectInstance::renderRoI";
+    AppInstance* app = appPTR->getTopLevelInstance();
+    
+    ///The generator is the example plug-in the unit tests use as well
+    Natron::Plugin* plugin = 0;
+    try {
+        plugin = appPTR->getPluginBinary(PLUGINID_OFX_DOTEXAMPLE, -1, -1, false);
+    } catch (const std::exception&) {
+        plugin = 0;
+    }
+    if (!plugin) {
+        report->addSkipped(name, "the plug-in " PLUGINID_OFX_DOTEXAMPLE " is not installed");
+        return;
+    }
+    
+    boost::shared_ptr<Node> generator = createBenchmarkNode(app, PLUGINID_OFX_DOTEXAMPLE);
+    if (!generator) {
+        report->addSkipped(name, "could not create the generator");
+        return;
+    }
+    boost::shared_ptr<Node> output = generator;
+    std::vector<boost::shared_ptr<Node> > nodes;
+    nodes.push_back(generator);
+    for (int i = 0; i < RENDERROI_BENCHMARK_DEPTH; ++i) {
+        boost::shared_ptr<Node> dot = createBenchmarkNode(app, PLUGINID_NATRON_DOT);
+        if ( !dot || !app->getProject()->connectNodes(0, output, dot.get()) ) {
+            report->addSkipped(name, "could not build the graph");
+            return;
+        }
+        nodes.push_back(dot);
+        output = dot;
+    }
+    
+    const bool clearCache[2] = { true, false };
+    const char* names[2] = { "EffectInstance::renderRoI cold cache", "EffectInstance::renderRoI warm cache" };
+    for (int i = 0; i < 2; ++i) {
+        double elapsed = renderFrames(app, output, clearCache[i]);
+        if (elapsed < 0) {
+            report->addSkipped(names[i], "the render failed");
+            continue;
+        }
+        BenchmarkReport::Result r;
+        r.name = names[i];
+        r.iterations = RENDERROI_BENCHMARK_FRAMES;
+        r.seconds = elapsed;
+        r.params.push_back( std::make_pair(std::string("depth"), (double)RENDERROI_BENCHMARK_DEPTH) );
+        report->addResult(r);
+    }
+    
+    for (std::vector<boost::shared_ptr<Node> >::reverse_iterator it = nodes.rbegin(); it != nodes.rend(); ++it) {
+        (*it)->destroyNode(false);
+    }
+    appPTR->clearNodeCache();
+}
@@ -22,9 +22,11 @@
 #include <QtConcurrentMap>
 #include <QThreadPool>
 #include <QUrl>
+#include <QFile>
 #include <QFileInfo>
 #include <QEventLoop>
 #include <QSettings>
+#include <QCoreApplication>
 
 #if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
 #include <boost/bind.hpp>
@@ -44,6 +46,7 @@
 #include "Engine/KnobTypes.h"
 #include "Engine/NoOp.h"
 #include "Engine/OfxHost.h"
+#include "Engine/ProcessHandler.h"
 
 using namespace Natron;
 
@@ -429,6 +432,11 @@ AppInstance::load(const CLArgs& cl)
                 throw std::invalid_argument(tr("Project file loading failed.").toStdString());
             }
             
+            if ( cl.isProjectConversion() ) {
+                _imp->_currentProject->exportProject(cl.getConvertedProjectFilename(), cl.isConversionToBinary());
+                return;
+            }
+            
             getWritersWorkForCL(cl, writersWork);
 
         } else if (info.suffix() == "py") {
@@ -440,7 +448,11 @@ AppInstance::load(const CLArgs& cl)
             throw std::invalid_argument(tr(NATRON_APPLICATION_NAME " only accepts python scripts or .ntp project files").toStdString());
         }
         
-        startWritersRendering(writersWork);
+        if (cl.getRenderProcessesCount() > 1) {
+            startWritersRenderingInProcesses(writersWork, cl.getRenderProcessesCount(), cl.isInterleavedFrameSplitting());
+        } else {
+            startWritersRendering(writersWork);
+        }
         
     } else if (appPTR->getAppType() == AppManager::eAppTypeInterpreter) {
         QFileInfo info(cl.getFilename());
@@ -1002,7 +1014,13 @@ void
 AppInstance::startWritersRendering(const std::list<RenderRequest>& writers)
 {
     std::list<RenderWork> renderers;
+    getRenderWork(writers, &renderers);
+    startWritersRendering(renderers);
+}
 
+void
+AppInstance::getRenderWork(const std::list<RenderRequest>& writers,std::list<RenderWork>* renderers)
+{
     if ( !writers.empty() ) {
         for (std::list<RenderRequest>::const_iterator it = writers.begin(); it != writers.end(); ++it) {
             
@@ -1030,7 +1048,7 @@ AppInstance::startWritersRendering(const std::list<RenderRequest>& writers)
                 assert(w.writer);
                 w.firstFrame = it->firstFrame;
                 w.lastFrame = it->lastFrame;
-                renderers.push_back(w);
+                renderers->push_back(w);
             }
         }
     } else {
@@ -1045,11 +1063,66 @@ AppInstance::startWritersRendering(const std::list<RenderRequest>& writers)
             if (w.writer) {
                 w.writer->getFrameRange_public(w.writer->getHash(), &w.firstFrame, &w.lastFrame);
             }
-            renderers.push_back(w);
+            renderers->push_back(w);
         }
     }
+}
+
+void
+AppInstance::startWritersRenderingInProcesses(const std::list<RenderRequest>& writers,
+                                              int nProcesses,
+                                              bool interleaved)
+{
+    std::list<RenderWork> renderers;
+    getRenderWork(writers, &renderers);
+    if (renderers.empty()) {
+        return;
+    }
+
+    MultiProcessRenderer renderer(nProcesses, interleaved ? MultiProcessRenderer::eFrameSplittingInterleaved :
+                                  MultiProcessRenderer::eFrameSplittingChunked);
+    for (std::list<RenderWork>::const_iterator it = renderers.begin(); it != renderers.end(); ++it) {
+        NodePtr node = it->writer->getNode();
+        std::string writerName = node->getFullyQualifiedName();
+        if ( writerName != Natron::makeNameScriptFriendly(writerName) ) {
+            ///The render processes can only be given writers at the top-level of the project
+            std::cout << tr("Warning: ").toStdString() << writerName
+                      << tr(" is inside a group and cannot be rendered by another process, rendering in this process instead.").toStdString()
+                      << std::endl;
+            startWritersRendering(renderers);
+            return;
+        }
+        int first,last;
+        getRenderWorkFrameRange(*it, &first, &last);
+        std::string sequentialNode;
+        renderer.addWriter( writerName.c_str(), first, last, !node->hasSequentialOnlyNodeUpstream(sequentialNode) );
+    }
+
+    ///The render processes load a snapshot of the project as it is now, since a script or the -o option may have created nodes
+    QString snapshotPath = QDir::tempPath() + QDir::separator() + NATRON_APPLICATION_NAME "_RENDER_"
+                           + QString::number( QCoreApplication::applicationPid() ) + "." NATRON_PROJECT_FILE_EXT;
+    getProject()->exportProject(snapshotPath, true);
+    try {
+        renderer.render(snapshotPath);
+    } catch (...) {
+        QFile::remove(snapshotPath);
+        throw;
+    }
+    QFile::remove(snapshotPath);
+}
+
+bool
+AppInstance::startWritersRenderingForCL(const CLArgs& cl)
+{
+    std::list<AppInstance::RenderRequest> writersWork;
+    getWritersWorkForCL(cl, writersWork);
+    std::list<RenderWork> renderers;
+    getRenderWork(writersWork, &renderers);
     
-    startWritersRendering(renderers);
+    ///Same as startWritersRendering in background mode, except that the result of each render is kept
+    QList<RenderWork> works = QList<RenderWork>::fromStdList(renderers);
+    QList<bool> results = QtConcurrent::blockingMapped<QList<bool> >( works, boost::bind(&AppInstance::renderFullSequenceBlocking,this,_1) );
+    return !results.contains(false);
 }
 
 void
@@ -1079,20 +1152,32 @@ AppInstance::startWritersRendering(const std::list<RenderWork>& writers)
 
 void
 AppInstance::startRenderingFullSequence(const RenderWork& writerWork,bool /*renderInSeparateProcess*/,const QString& /*savePath*/)
+{
+    renderFullSequenceBlocking(writerWork);
+}
+
+bool
+AppInstance::renderFullSequenceBlocking(const RenderWork& writerWork)
 {
     BlockingBackgroundRender backgroundRender(writerWork.writer);
     int first,last;
+    getRenderWorkFrameRange(writerWork, &first, &last);
+    
+    return backgroundRender.blockingRender(first,last); //< doesn't return before rendering is finished
+}
+
+void
+AppInstance::getRenderWorkFrameRange(const RenderWork& writerWork,int* first,int* last) const
+{
     if (writerWork.firstFrame == INT_MIN || writerWork.lastFrame == INT_MAX) {
-        writerWork.writer->getFrameRange_public(writerWork.writer->getHash(), &first, &last);
-        if (first == INT_MIN || last == INT_MAX) {
-            getFrameRange(&first, &last);
+        writerWork.writer->getFrameRange_public(writerWork.writer->getHash(), first, last);
+        if (*first == INT_MIN || *last == INT_MAX) {
+            getFrameRange(first, last);
         }
     } else {
-        first = writerWork.firstFrame;
-        last = writerWork.lastFrame;
+        *first = writerWork.firstFrame;
+        *last = writerWork.lastFrame;
     }
-    
-    backgroundRender.blockingRender(first,last); //< doesn't return before rendering is finished
 }
 
 void
@@ -326,8 +326,27 @@ public:
     void startWritersRendering(const std::list<RenderRequest>& writers);
     void startWritersRendering(const std::list<RenderWork>& writers);
 
+    /**
+     * @brief Renders the writers given on the command line with the project already loaded in this instance and blocks
+     * until they are rendered. Returns false if one of the renders was aborted or failed.
+     * This is used by the render daemon to run several render jobs with the same loaded project.
+     **/
+    bool startWritersRenderingForCL(const CLArgs& cl);
+
+    /**
+     * @brief Same as startWritersRendering but the frames are split across nProcesses render processes, see MultiProcessRenderer.
+     * If interleaved is true, each process renders one frame at a time, otherwise the frame range is split in contiguous chunks.
+     **/
+    void startWritersRenderingInProcesses(const std::list<RenderRequest>& writers,int nProcesses,bool interleaved);
+
     virtual void startRenderingFullSequence(const RenderWork& writerWork,bool renderInSeparateProcess,const QString& savePath);
 
+    /**
+     * @brief Renders the frame range of the writer in this process and blocks until it is rendered.
+     * Returns false if the render was aborted or failed.
+     **/
+    bool renderFullSequenceBlocking(const RenderWork& writerWork);
+
     virtual void clearViewersLastRenderedTexture() {}
 
     virtual void toggleAutoHideGraphInputs() {}
@@ -421,6 +440,10 @@ private:
     
     void getWritersWorkForCL(const CLArgs& cl,std::list<AppInstance::RenderRequest>& requests);
 
+    void getRenderWork(const std::list<RenderRequest>& writers,std::list<RenderWork>* renderers);
+
+    void getRenderWorkFrameRange(const RenderWork& writerWork,int* first,int* last) const;
+
 
     boost::shared_ptr<Natron::Node> createNodeInternal(const QString & pluginID,const std::string & multiInstanceParentName,
                                                        int majorVersion,int minorVersion,
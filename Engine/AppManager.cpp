@@ -21,7 +21,9 @@
 
 #include <clocale>
 #include <cstddef>
+#include <set>
 #include <QDebug>
+#include <QFile>
 #include <QTextCodec>
 #include <QProcess>
 #include <QAbstractSocket>
@@ -31,6 +33,7 @@
 #include <QThread>
 #include <QTemporaryFile>
 #include <QThreadPool>
+#include <QSystemSemaphore>
 #include <QtCore/QAtomicInt>
 
 #ifdef NATRON_USE_BREAKPAD
@@ -62,10 +65,12 @@
 #include "Engine/StandardPaths.h"
 #include "Engine/Format.h"
 #include "Engine/Log.h"
+#include "Engine/Timer.h"
 #include "Engine/Cache.h"
 #include "Engine/Variant.h"
 #include "Engine/Knob.h"
 #include "Engine/Rect.h"
+#include "Engine/RenderBenchmark.h"
 #include "Engine/DiskCacheNode.h"
 #include "Engine/NoOp.h"
 #include "Engine/Project.h"
@@ -106,6 +111,7 @@ struct AppManagerPrivate
     
     ProcessInputChannel* _backgroundIPC; //< object used to communicate with the main app
     //if this app is background, see the ProcessInputChannel def
+    RenderDaemon* _renderDaemon; //< the server rendering jobs if the process was launched with --daemon
     bool _loaded; //< true when the first instance is completly loaded.
     QString _binaryPath; //< the path to the application's binary
     mutable QMutex _wasAbortCalledMutex;
@@ -159,6 +165,8 @@ struct AppManagerPrivate
     
     QMutex natronPythonGIL;
     
+    std::list<std::pair<QString,double> > startupTimings; //< time spent in each phase of the startup, in seconds
+    
     AppManagerPrivate();
     
     ~AppManagerPrivate()
@@ -170,6 +178,12 @@ struct AppManagerPrivate
     }
 
     void initProcessInputChannel(const QString & mainProcessServerName);
+    
+    /**
+     * @brief Serves render jobs on the given local server until the daemon is asked to quit.
+     * Returns false if the server could not be created.
+     **/
+    bool runRenderDaemon(const QString & serverName);
 
     void loadBuiltinFormats();
 
@@ -186,6 +200,11 @@ struct AppManagerPrivate
      **/
     void setMaxCacheFiles();
     
+    /**
+     * @brief Writes the time spent in each phase of the startup to the log.
+     **/
+    void reportStartupTimings();
+    
     Natron::Plugin* findPluginById(const QString& oldId,int major, int minor) const;
     
     void declareSettingsToPython();
@@ -224,6 +243,7 @@ AppManagerPrivate::AppManagerPrivate()
 , diskCachesLocationMutex()
 , diskCachesLocation()
 ,_backgroundIPC(0)
+,_renderDaemon(0)
 ,_loaded(false)
 ,_binaryPath()
 ,_wasAbortAnyProcessingCalled(false)
@@ -346,6 +366,19 @@ struct CLArgsPrivate
     
     bool isEmpty;
     
+    QString convertedProjectFilename;
+    bool convertToBinary;
+    
+    QString daemonServerName;
+    
+    int renderProcessesCount;
+    bool interleavedFrameSplitting;
+    
+    bool isRenderBenchmark;
+    CLArgs::RenderBenchmarkArgs renderBenchmark;
+    
+    int nodeGraphBenchmarkNodesCount;
+    
     CLArgsPrivate()
     : args()
     , filename()
@@ -358,6 +391,14 @@ struct CLArgsPrivate
     , range()
     , rangeSet(false)
     , isEmpty(true)
+    , convertedProjectFilename()
+    , convertToBinary(false)
+    , daemonServerName()
+    , renderProcessesCount(1)
+    , interleavedFrameSplitting(true)
+    , isRenderBenchmark(false)
+    , renderBenchmark()
+    , nodeGraphBenchmarkNodesCount(0)
     {
         
     }
@@ -423,6 +464,14 @@ CLArgs::operator=(const CLArgs& other)
     _imp->range = other._imp->range;
     _imp->rangeSet = other._imp->rangeSet;
     _imp->isEmpty = other._imp->isEmpty;
+    _imp->convertedProjectFilename = other._imp->convertedProjectFilename;
+    _imp->convertToBinary = other._imp->convertToBinary;
+    _imp->daemonServerName = other._imp->daemonServerName;
+    _imp->renderProcessesCount = other._imp->renderProcessesCount;
+    _imp->interleavedFrameSplitting = other._imp->interleavedFrameSplitting;
+    _imp->isRenderBenchmark = other._imp->isRenderBenchmark;
+    _imp->renderBenchmark = other._imp->renderBenchmark;
+    _imp->nodeGraphBenchmarkNodesCount = other._imp->nodeGraphBenchmarkNodesCount;
 }
 
 bool
@@ -482,6 +531,52 @@ CLArgs::printUsage(const std::string& programName)
     W_LINE("./NatronRenderer -w MyWriter /FastDisk/Pictures/sequence###.exr 1-100 /Users/Me/MyNatronProjects/MyProject.ntp");
     W_LINE("./NatronRenderer -w MyWriter -w MySecondWriter 1-10 /Users/Me/MyNatronProjects/MyProject.ntp");
     W_LINE("\n");
+    W_TR_LINE("[--convert] <binary|xml> <output project file path> saves the project in the given format to the output file path "
+              "and exits without rendering.\n"
+              "Binary projects are much faster to load and save than XML projects but can only be read by the same kind of platform.");
+    W_TR_LINE("Some examples of usage of the tool:\n");
+    W_LINE("./NatronRenderer --convert binary /Users/Me/MyNatronProjects/MyProjectBinary.ntp /Users/Me/MyNatronProjects/MyProject.ntp");
+    W_LINE("\n");
+    W_TR_LINE("[--processes] <number of processes> [optional]<interleaved|chunked> splits the frame range of the writers across "
+              "several render processes instead of rendering in this process.\n"
+              "With interleaved (the default) each process is given one frame at a time, with chunked the frame range is split in "
+              "contiguous chunks, one per process. The frames of a process that fails are rendered again by the other processes. "
+              "Writers that must render sequentially (e.g. movie files) are rendered by a single process.");
+    W_TR_LINE("Some examples of usage of the tool:\n");
+    W_LINE("./NatronRenderer --processes 4 -w MyWriter 1-100 /Users/Me/MyNatronProjects/MyProject.ntp");
+    W_LINE("./NatronRenderer --processes 4 chunked -w MyWriter 1-100 /Users/Me/MyNatronProjects/MyProject.ntp");
+    W_LINE("\n");
+    W_TR_LINE("[--daemon] <server name> starts a render daemon that stays resident and listens to render jobs on the local socket "
+              "with the given name, instead of rendering a single project.\n"
+              "Plug-ins, caches and already loaded projects are kept between jobs. A job is a single line containing the same arguments "
+              "as a command-line render (project or script path, -w/-o options and frame range). Arguments containing spaces must be "
+              "enclosed in double quotes.\n"
+              "While a job renders, the daemon replies with one line per event: " kRenderingStartedShort " when a writer starts rendering, "
+              kFrameRenderedStringShort "<frame> for each frame rendered, " kRenderingFinishedStringShort " when the job succeeded or "
+              kRenderJobFailedStringShort "<reason> when it failed. "
+              "Sending " kAbortRenderingStringShort " aborts the job being rendered and " kQuitRenderDaemonStringShort " quits the daemon.");
+    W_TR_LINE("Some examples of usage of the tool:\n");
+    W_LINE("./NatronRenderer --daemon NatronRenderDaemon");
+    W_LINE("socat - UNIX-CONNECT:/tmp/NatronRenderDaemon");
+    W_LINE("-w MyWriter 1-10 /Users/Me/MyNatronProjects/MyProject.ntp");
+    W_LINE("\n");
+    W_TR_LINE("[--benchmark] <depth> <fan-in> <width>x<height> <animation density> [optional]<frameRange> builds a synthetic graph "
+              "and renders it over the frame range (1-50 by default) instead of rendering a project, then prints the results in JSON "
+              "on the standard output.\n"
+              "The graph chains <depth> Roto stages through Dot nodes, some of them inside a Group, each stage merging <fan-in> shapes "
+              "over the previous one, and ends with a DiskCache node. <animation density> is the fraction (between 0 and 1) of the shapes "
+              "that are animated. The results contain the frames per second, the peak memory usage, the hit rate of the image cache "
+              "and the render time of each node. No display nor GPU is needed.");
+    W_TR_LINE("Some examples of usage of the tool:\n");
+    W_LINE("./NatronRenderer --benchmark 8 4 1920x1080 0.5");
+    W_LINE("./NatronRenderer --benchmark 32 16 3840x2160 1 1-100");
+    W_LINE("\n");
+    W_TR_LINE("[--benchmark-nodegraph] <nodes> builds a synthetic graph of <nodes> connected nodes in the node-graph of the "
+              "graphical user interface, measures how fast it is drawn when zoomed out, panned across and when nodes are moved, "
+              "then prints the results in JSON on the standard output and quits. This option cannot be used in background mode.");
+    W_TR_LINE("Some examples of usage of the tool:\n");
+    W_LINE("./Natron --benchmark-nodegraph 5000");
+    W_LINE("\n");
     W_TR_LINE("- Options for the execution of Python scripts:\n");
     W_LINE(programName + " <Python script path>");
     W_TR_LINE("Note that the following does not apply if the -t option was given.");
@@ -573,6 +668,66 @@ CLArgs::getIPCPipeName() const
     return _imp->ipcPipe;
 }
 
+bool
+CLArgs::isProjectConversion() const
+{
+    return !_imp->convertedProjectFilename.isEmpty();
+}
+
+const QString&
+CLArgs::getConvertedProjectFilename() const
+{
+    return _imp->convertedProjectFilename;
+}
+
+bool
+CLArgs::isConversionToBinary() const
+{
+    return _imp->convertToBinary;
+}
+
+bool
+CLArgs::isRenderDaemon() const
+{
+    return !_imp->daemonServerName.isEmpty();
+}
+
+const QString&
+CLArgs::getRenderDaemonServerName() const
+{
+    return _imp->daemonServerName;
+}
+
+int
+CLArgs::getRenderProcessesCount() const
+{
+    return _imp->renderProcessesCount;
+}
+
+bool
+CLArgs::isInterleavedFrameSplitting() const
+{
+    return _imp->interleavedFrameSplitting;
+}
+
+bool
+CLArgs::isRenderBenchmark() const
+{
+    return _imp->isRenderBenchmark;
+}
+
+const CLArgs::RenderBenchmarkArgs&
+CLArgs::getRenderBenchmarkArgs() const
+{
+    return _imp->renderBenchmark;
+}
+
+int
+CLArgs::getNodeGraphBenchmarkNodesCount() const
+{
+    return _imp->nodeGraphBenchmarkNodesCount;
+}
+
 bool
 CLArgs::isPythonScript() const
 {
@@ -691,11 +846,177 @@ CLArgsPrivate::parse()
         }
     }
     
+    {
+        ///Parsed before the project file name since the output of the conversion also has the project file extension
+        QStringList::iterator it = hasToken("convert", "");
+        if (it != args.end()) {
+            if (!isBackground || isInterpreterMode) {
+                std::cout << QObject::tr("You cannot use the --convert option in interactive or interpreter mode").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            QStringList::iterator format = it;
+            ++format;
+            QStringList::iterator output = format;
+            if (output != args.end()) {
+                ++output;
+            }
+            if (format == args.end() || output == args.end() || (*format != "binary" && *format != "xml")) {
+                std::cout << QObject::tr("The --convert option must be followed by the format (binary or xml) and the output project file path").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            convertToBinary = *format == "binary";
+            convertedProjectFilename = *output;
+#if defined(Q_OS_UNIX)
+            convertedProjectFilename = AppManager::qt_tildeExpansion(convertedProjectFilename);
+#endif
+            ++output;
+            args.erase(it, output);
+        }
+    }
+    
+    {
+        QStringList::iterator it = hasToken("processes", "");
+        if (it != args.end()) {
+            if (!isBackground || isInterpreterMode) {
+                std::cout << QObject::tr("You cannot use the --processes option in interactive or interpreter mode").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            QStringList::iterator next = it;
+            ++next;
+            bool ok = false;
+            if (next != args.end()) {
+                renderProcessesCount = next->toInt(&ok);
+            }
+            if (!ok || renderProcessesCount < 1) {
+                std::cout << QObject::tr("The --processes option must be followed by the number of processes to render with").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            ++next;
+            if ( next != args.end() && (*next == "interleaved" || *next == "chunked") ) {
+                interleavedFrameSplitting = *next == "interleaved";
+                ++next;
+            }
+            args.erase(it, next);
+        }
+    }
+    
+    {
+        QStringList::iterator it = hasToken("daemon", "");
+        if (it != args.end()) {
+            if (!isBackground || isInterpreterMode) {
+                std::cout << QObject::tr("You cannot use the --daemon option in interactive or interpreter mode").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            QStringList::iterator next = it;
+            ++next;
+            if (next == args.end() || next->startsWith("-")) {
+                std::cout << QObject::tr("You must specify the name of the local server to listen to when using the --daemon option").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            daemonServerName = *next;
+            ++next;
+            args.erase(it, next);
+            if (args.size() > 1) {
+                std::cout << QObject::tr("The --daemon option cannot be combined with a project, a script or render options: "
+                                         "they must be sent to the daemon as render jobs").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+        }
+    }
+    
+    {
+        QStringList::iterator it = hasToken("benchmark", "");
+        if (it != args.end()) {
+            if (!isBackground || isInterpreterMode) {
+                std::cout << QObject::tr("You cannot use the --benchmark option in interactive or interpreter mode").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            QStringList::iterator next = it;
+            bool ok = true;
+            QStringList values;
+            for (int i = 0; i < 4; ++i) {
+                ++next;
+                if (next == args.end()) {
+                    ok = false;
+                    break;
+                }
+                values.push_back(*next);
+            }
+            if (ok) {
+                renderBenchmark.depth = values[0].toInt(&ok);
+            }
+            if (ok) {
+                renderBenchmark.fanIn = values[1].toInt(&ok);
+            }
+            if (ok) {
+                QStringList size = values[2].split('x');
+                ok = size.size() == 2;
+                if (ok) {
+                    renderBenchmark.width = size[0].toInt(&ok);
+                }
+                if (ok) {
+                    renderBenchmark.height = size[1].toInt(&ok);
+                }
+            }
+            if (ok) {
+                renderBenchmark.animationDensity = values[3].toDouble(&ok);
+            }
+            if (!ok || renderBenchmark.depth < 1 || renderBenchmark.fanIn < 1 || renderBenchmark.width < 1 || renderBenchmark.height < 1 ||
+                renderBenchmark.animationDensity < 0. || renderBenchmark.animationDensity > 1.) {
+                std::cout << QObject::tr("The --benchmark option must be followed by the depth, the fan-in, the size (e.g: 1920x1080) "
+                                         "and the animation density (between 0 and 1) of the graph").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            ++next;
+            args.erase(it, next);
+            if (hasFileNameWithExtension(NATRON_PROJECT_FILE_EXT) != args.end() || hasFileNameWithExtension("py") != args.end() ||
+                !daemonServerName.isEmpty()) {
+                std::cout << QObject::tr("The --benchmark option cannot be combined with a project, a script or the --daemon option").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            isRenderBenchmark = true;
+        }
+    }
+    
+    {
+        QStringList::iterator it = hasToken("benchmark-nodegraph", "");
+        if (it != args.end()) {
+            if (isBackground || isInterpreterMode) {
+                std::cout << QObject::tr("The --benchmark-nodegraph option needs the graphical user interface").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            QStringList::iterator next = it;
+            ++next;
+            bool ok = false;
+            if (next != args.end()) {
+                nodeGraphBenchmarkNodesCount = next->toInt(&ok);
+            }
+            if (!ok || nodeGraphBenchmarkNodesCount < 1) {
+                std::cout << QObject::tr("The --benchmark-nodegraph option must be followed by the number of nodes of the graph").toStdString() << std::endl;
+                error = 1;
+                return;
+            }
+            ++next;
+            args.erase(it, next);
+        }
+    }
+    
     {
         QStringList::iterator it = hasFileNameWithExtension(NATRON_PROJECT_FILE_EXT);
         if (it == args.end()) {
             it = hasFileNameWithExtension("py");
-            if (it == args.end() && !isInterpreterMode && isBackground) {
+            if (it == args.end() && !isInterpreterMode && isBackground && daemonServerName.isEmpty() && !isRenderBenchmark) {
                 std::cout << QObject::tr("You must specify the filename of a script or " NATRON_APPLICATION_NAME " project. (." NATRON_PROJECT_FILE_EXT
                                          ")").toStdString() << std::endl;
                 error = 1;
@@ -858,7 +1179,9 @@ AppManager::load(int &argc,
     }
     initializeQApp(argc, argv);
     
+    TimeLapse pythonTimer;
     initPython(argc, argv);
+    addStartupPhaseTiming(tr("Initializing Python"), pythonTimer.getTimeElapsedReset());
 
     _imp->idealThreadCount = QThread::idealThreadCount();
     QThreadPool::globalInstance()->setExpiryTimeout(-1); //< make threads never exit on their own
@@ -1070,12 +1393,16 @@ AppManager::loadInternal(const CLArgs& cl)
     _imp->initBreakpad();
 #endif
     
+    TimeLapse phaseTimer;
+    
     _imp->_settings->initializeKnobsPublic();
     ///Call restore after initializing knobs
     _imp->_settings->restoreSettings();
+    addStartupPhaseTiming(tr("Restoring user settings"), phaseTimer.getTimeElapsedReset());
 
     ///basically show a splashScreen
     initGui();
+    phaseTimer.getTimeElapsedReset();
 
 
     try {
@@ -1095,6 +1422,7 @@ AppManager::loadInternal(const CLArgs& cl)
 
     setLoadingStatus( tr("Restoring the image cache...") );
     _imp->restoreCaches();
+    addStartupPhaseTiming(tr("Restoring the image cache"), phaseTimer.getTimeElapsedReset());
 
     setLoadingStatus( tr("Restoring user settings...") );
 
@@ -1113,6 +1441,8 @@ AppManager::loadInternal(const CLArgs& cl)
     } catch (std::logic_error) {
         // ignore
     }
+    
+    _imp->reportStartupTimings();
 
     if ( isBackground() && !cl.getIPCPipeName().isEmpty() ) {
         _imp->initProcessInputChannel(cl.getIPCPipeName());
@@ -1152,6 +1482,34 @@ AppManager::loadInternal(const CLArgs& cl)
     } else {
         onLoadCompleted();
 
+        ///In render daemon mode, the main instance stays idle while the jobs are rendered in their own instances
+        if ( cl.isRenderDaemon() ) {
+            bool ok = _imp->runRenderDaemon( cl.getRenderDaemonServerName() );
+            try {
+                mainInstance->quit();
+            } catch (std::logic_error) {
+                // ignore
+            }
+
+            return ok;
+        }
+        
+        ///In benchmark mode the synthetic graph is built and rendered in the main instance, then the process exits
+        if ( cl.isRenderBenchmark() ) {
+            std::pair<int,int> range(1, 50);
+            if ( cl.hasFrameRange() ) {
+                range = cl.getFrameRange();
+            }
+            bool ok = Natron::runRenderBenchmark(mainInstance, cl.getRenderBenchmarkArgs(), range.first, range.second, std::cout);
+            try {
+                mainInstance->quit();
+            } catch (std::logic_error) {
+                // ignore
+            }
+
+            return ok;
+        }
+
         ///In background project auto-run the rendering is finished at this point, just exit the instance
         if ( (_imp->_appType == eAppTypeBackgroundAutoRun ||
               _imp->_appType == eAppTypeBackgroundAutoRunLaunchedFromGui ||
@@ -1316,6 +1674,23 @@ AppManagerPrivate::initProcessInputChannel(const QString & mainProcessServerName
     _backgroundIPC = new ProcessInputChannel(mainProcessServerName);
 }
 
+bool
+AppManagerPrivate::runRenderDaemon(const QString & serverName)
+{
+    RenderDaemon daemon(serverName);
+    if ( !daemon.isListening() ) {
+        std::cout << QObject::tr("Failed to create the render daemon server: ").toStdString() << serverName.toStdString() << std::endl;
+        return false;
+    }
+    std::cout << QObject::tr("Render daemon waiting for jobs on: ").toStdString() << daemon.getFullServerName().toStdString() << std::endl;
+
+    QObject::connect( &daemon, SIGNAL( quitRequested() ), qApp, SLOT( quit() ) );
+    qApp->exec();
+    daemon.closeLoadedProjects();
+
+    return true;
+}
+
 bool
 AppManager::hasAbortAnyProcessingBeenCalled() const
 {
@@ -1341,6 +1716,13 @@ bool
 AppManager::writeToOutputPipe(const QString & longMessage,
                               const QString & shortMessage)
 {
+    if (_imp->_renderDaemon) {
+        ///The daemon ends each job with a single line reporting the result of the whole job, see RenderDaemon::renderJob
+        if (shortMessage != kRenderingFinishedStringShort) {
+            _imp->_renderDaemon->writeToClient(shortMessage);
+        }
+        return true;
+    }
     if (!_imp->_backgroundIPC) {
         
         QMutexLocker k(&_imp->_ofxLogMutex);
@@ -1353,6 +1735,12 @@ AppManager::writeToOutputPipe(const QString & longMessage,
     return true;
 }
 
+void
+AppManager::setRenderDaemon(RenderDaemon* daemon)
+{
+    _imp->_renderDaemon = daemon;
+}
+
 void
 AppManager::registerAppInstance(AppInstance* app)
 {
@@ -1414,11 +1802,14 @@ AppManager::loadAllPlugins()
     std::map<std::string,std::vector< std::pair<std::string,double> > > writersMap;
 
     /*loading node plugins*/
+    TimeLapse phaseTimer;
 
     loadBuiltinNodePlugins(&readersMap, &writersMap);
+    addStartupPhaseTiming(tr("Loading built-in plug-ins"), phaseTimer.getTimeElapsedReset());
 
     /*loading ofx plugins*/
     _imp->ofxHost->loadOFXPlugins( &readersMap, &writersMap);
+    phaseTimer.getTimeElapsedReset();
     
     std::vector<Natron::Plugin*> ignoredPlugins;
     _imp->_settings->populatePluginsTab(ignoredPlugins);
@@ -1474,12 +1865,14 @@ AppManager::loadAllPlugins()
     
     _imp->_settings->populateReaderPluginsAndFormats(readersMap);
     _imp->_settings->populateWriterPluginsAndFormats(writersMap);
+    addStartupPhaseTiming(tr("Populating plug-ins preferences"), phaseTimer.getTimeElapsedReset());
 
     _imp->declareSettingsToPython();
     
     //Load python groups and init.py & initGui.py scripts
     //Should be done after settings are declared
     loadPythonGroups();
+    addStartupPhaseTiming(tr("Loading PyPlugs and start-up scripts"), phaseTimer.getTimeElapsedReset());
 
     onAllPluginsLoaded();
 }
@@ -2278,6 +2671,19 @@ AppManager::getCachesTotalMemorySize() const
     return _imp->_viewerCache->getMemoryCacheSize() + _imp->_nodeCache->getMemoryCacheSize();
 }
 
+void
+AppManager::getNodeCacheLookupStatistics(U64* nLookups,
+                                         U64* nHits) const
+{
+    _imp->_nodeCache->getLookupStatistics(nLookups, nHits);
+}
+
+void
+AppManager::resetNodeCacheLookupStatistics()
+{
+    _imp->_nodeCache->resetLookupStatistics();
+}
+
 Natron::CacheSignalEmitter*
 AppManager::getOrActivateViewerCacheSignalEmitter() const
 {
@@ -2322,12 +2728,65 @@ AppManager::registerEngineMetaTypes() const
 #endif
 }
 
+/**
+ * @brief Locks the table of contents of a disk cache against the other processes using the same cache location,
+ * e.g. the render processes of a MultiProcessRenderer. The semaphore is released by the system if the process crashes.
+ **/
+class CacheTOCLocker
+{
+    QSystemSemaphore _semaphore;
+
+public:
+
+    CacheTOCLocker(const QString & cachePath)
+        : _semaphore(QString(NATRON_APPLICATION_NAME "_CACHE_TOC_") + QString::number( qHash(cachePath) ), 1, QSystemSemaphore::Open)
+    {
+        _semaphore.acquire();
+    }
+
+    ~CacheTOCLocker()
+    {
+        _semaphore.release();
+    }
+};
+
 template <typename T>
 void saveCache(Natron::Cache<T>* cache)
 {
+    CacheTOCLocker locker( cache->getCachePath() );
+    std::string cacheRestoreFilePath = cache->getRestoreFilePath();
+    typename Natron::Cache<T>::CacheTOC toc;
+    cache->save(&toc);
+
+    ///Another process sharing the cache may have saved its entries since this process started: keep them
+    {
+        std::ifstream ifile(cacheRestoreFilePath.c_str(),std::ifstream::in);
+        if ( ifile.good() ) {
+            typename Natron::Cache<T>::CacheTOC otherToc;
+            try {
+                boost::archive::binary_iarchive iArchive(ifile);
+                unsigned int otherVersion = 0;
+                iArchive >> otherVersion;
+                if (otherVersion == cache->cacheVersion()) {
+                    iArchive >> otherToc;
+                }
+            } catch (const std::exception &) {
+                otherToc.clear();
+            }
+            std::set<std::string> ownFiles;
+            for (typename Natron::Cache<T>::CacheTOC::const_iterator it = toc.begin(); it != toc.end(); ++it) {
+                ownFiles.insert(it->filePath);
+            }
+            for (typename Natron::Cache<T>::CacheTOC::const_iterator it = otherToc.begin(); it != otherToc.end(); ++it) {
+                if ( (ownFiles.find(it->filePath) == ownFiles.end()) && QFile::exists( it->filePath.c_str() ) ) {
+                    toc.push_back(*it);
+                }
+            }
+        }
+    }
+
     std::ofstream ofile;
     ofile.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-    std::string cacheRestoreFilePath = cache->getRestoreFilePath();
     try {
         ofile.open(cacheRestoreFilePath.c_str(),std::ofstream::out);
     } catch (const std::ios_base::failure & e) {
@@ -2346,8 +2805,6 @@ void saveCache(Natron::Cache<T>* cache)
         return;
     }
     
-    typename Natron::Cache<T>::CacheTOC toc;
-    cache->save(&toc);
     unsigned int version = cache->cacheVersion();
     try {
         boost::archive::binary_oarchive oArchive(ofile);
@@ -2392,6 +2849,7 @@ AppManagerPrivate::saveCaches()
 template <typename T>
 void restoreCache(AppManagerPrivate* p,Natron::Cache<T>* cache)
 {
+    CacheTOCLocker locker( cache->getCachePath() );
     if ( p->checkForCacheDiskStructure( cache->getCachePath() ) ) {
         std::ifstream ifile;
         std::string settingsFilePath = cache->getRestoreFilePath();
@@ -2748,6 +3206,32 @@ AppManager::writeToOfxLog_mt_safe(const QString & str)
     _imp->_ofxLog.append(str + '\n' + '\n');
 }
 
+void
+AppManager::addStartupPhaseTiming(const QString& phase,
+                                  double seconds)
+{
+    _imp->startupTimings.push_back( std::make_pair(phase, seconds) );
+}
+
+void
+AppManagerPrivate::reportStartupTimings()
+{
+    if ( startupTimings.empty() ) {
+        return;
+    }
+    double total = 0.;
+    QString report = QObject::tr("Startup timings:") + '\n';
+    for (std::list<std::pair<QString,double> >::iterator it = startupTimings.begin(); it != startupTimings.end(); ++it) {
+        report.append( QString("    %1: %2 s\n").arg(it->first).arg(it->second, 0, 'f', 3) );
+        total += it->second;
+    }
+    report.append( QObject::tr("    Total: %1 s").arg(total, 0, 'f', 3) );
+    startupTimings.clear();
+    
+    ///Only to the log: the standard output of background processes is parsed by benchmarks and render daemons
+    appPTR->writeToOfxLog_mt_safe(report);
+}
+
 void
 AppManager::clearOfxLog_mt_safe()
 {
@@ -42,6 +42,7 @@ CLANG_DIAG_ON(deprecated)
 class QMutex;
 
 class AppInstance;
+class RenderDaemon;
 class Format;
 class Settings;
 class KnobHolder;
@@ -93,6 +94,23 @@ public:
         }
     };
     
+    /**
+     * @brief The parameters of the synthetic graph rendered by the --benchmark option, see RenderBenchmark.
+     **/
+    struct RenderBenchmarkArgs
+    {
+        int depth; //< number of stages chained from the first to the last node
+        int fanIn; //< number of shapes merged by each stage
+        int width,height;
+        double animationDensity; //< fraction in [0,1] of the shapes that are animated
+        
+        RenderBenchmarkArgs()
+        : depth(0), fanIn(0), width(0), height(0), animationDensity(0.)
+        {
+            
+        }
+    };
+    
     CLArgs();
     
     CLArgs(int& argc,char* argv[],bool forceBackground);
@@ -127,6 +145,49 @@ public:
     
     bool isPythonScript() const;
     
+    /**
+     * @brief Returns true if the --convert option was given: the project must be saved to getConvertedProjectFilename()
+     * in the binary format if isConversionToBinary() returns true, in the XML format otherwise, instead of being rendered.
+     **/
+    bool isProjectConversion() const;
+    
+    const QString& getConvertedProjectFilename() const;
+    
+    bool isConversionToBinary() const;
+    
+    /**
+     * @brief Returns true if the --daemon option was given: instead of rendering a project the process stays resident
+     * and serves render jobs sent to the local server named getRenderDaemonServerName(), see RenderDaemon.
+     **/
+    bool isRenderDaemon() const;
+    
+    const QString& getRenderDaemonServerName() const;
+    
+    /**
+     * @brief Returns the number of processes the frame range of the writers must be split across, as given by the
+     * --processes option, or 1 if the frames must be rendered by this process.
+     **/
+    int getRenderProcessesCount() const;
+    
+    /**
+     * @brief If true, each render process is given one frame at a time, otherwise the frame range is split in contiguous chunks.
+     **/
+    bool isInterleavedFrameSplitting() const;
+    
+    /**
+     * @brief Returns true if the --benchmark option was given: instead of rendering a project a synthetic graph
+     * described by getRenderBenchmarkArgs() is built and rendered over the frame range, see RenderBenchmark.
+     **/
+    bool isRenderBenchmark() const;
+    
+    const CLArgs::RenderBenchmarkArgs& getRenderBenchmarkArgs() const;
+    
+    /**
+     * @brief Returns the number of nodes of the synthetic graph built in the node-graph when the --benchmark-nodegraph
+     * option was given, or 0 otherwise, see NodeGraphBenchmark.
+     **/
+    int getNodeGraphBenchmarkNodesCount() const;
+    
 private:
     
     boost::scoped_ptr<CLArgsPrivate> _imp;
@@ -243,6 +304,13 @@ public:
                             boost::shared_ptr<Natron::FrameEntry>* returnValue) const;
 
     U64 getCachesTotalMemorySize() const;
+    
+    /**
+     * @brief Returns the number of look-ups in the node cache and how many of them found an image
+     * since the last call to resetNodeCacheLookupStatistics().
+     **/
+    void getNodeCacheLookupStatistics(U64* nLookups,U64* nHits) const;
+    void resetNodeCacheLookupStatistics();
 
     Natron::CacheSignalEmitter* getOrActivateViewerCacheSignalEmitter() const;
 
@@ -276,6 +344,12 @@ public:
      **/
     bool writeToOutputPipe(const QString & longMessage,const QString & shortMessage);
 
+    /**
+     * @brief While a render daemon exists, the messages written to the output pipe are sent to the client of the job
+     * being rendered instead, see RenderDaemon.
+     **/
+    void setRenderDaemon(RenderDaemon* daemon);
+
     void abortAnyProcessing();
 
     bool hasAbortAnyProcessingBeenCalled() const;
@@ -311,6 +385,12 @@ public:
 
     void writeToOfxLog_mt_safe(const QString & str);
     
+    /**
+     * @brief Records the time (in seconds) spent in a phase of the application startup. All the phases are reported
+     * in the log (and on the standard output in background mode) once the plug-ins are loaded.
+     **/
+    void addStartupPhaseTiming(const QString& phase,double seconds);
+    
     void clearOfxLog_mt_safe();
     
     virtual void showOfxLog() {}
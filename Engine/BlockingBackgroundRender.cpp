@@ -24,29 +24,32 @@ CLANG_DIAG_ON(deprecated-register)
 
 BlockingBackgroundRender::BlockingBackgroundRender(Natron::OutputEffectInstance* writer)
     : _running(false)
+      ,_aborted(false)
       ,_writer(writer)
 {
 }
 
-void
+bool
 BlockingBackgroundRender::blockingRender(int first,int last)
 {
     _writer->renderFullSequence(this,first,last);
+    QMutexLocker locker(&_runningMutex);
     if (appPTR->getCurrentSettings()->getNumberOfThreads() != -1) {
-        QMutexLocker locker(&_runningMutex);
         _running = true;
         while (_running) {
             _runningCond.wait(&_runningMutex);
         }
     }
+    return !_aborted;
 }
 
 void
-BlockingBackgroundRender::notifyFinished()
+BlockingBackgroundRender::notifyFinished(bool aborted)
 {
     qDebug() << "Blocking render finished.";
     appPTR->writeToOutputPipe(kRenderingFinishedStringLong,kRenderingFinishedStringShort);
     QMutexLocker locker(&_runningMutex);
+    _aborted = aborted;
     _running = false;
     _runningCond.wakeOne();
 }
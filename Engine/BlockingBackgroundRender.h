@@ -25,6 +25,7 @@ class OutputEffectInstance;
 class BlockingBackgroundRender
 {
     bool _running;
+    bool _aborted;
     QWaitCondition _runningCond;
     QMutex _runningMutex;
     Natron::OutputEffectInstance* _writer;
@@ -42,9 +43,15 @@ public:
         return _writer;
     }
 
-    void notifyFinished();
+    /**
+     * @brief Called when the render is over, aborted is true if it was aborted or failed.
+     **/
+    void notifyFinished(bool aborted);
 
-    void blockingRender(int first,int last);
+    /**
+     * @brief Renders the frame range and returns once it is rendered. Returns false if the render was aborted or failed.
+     **/
+    bool blockingRender(int first,int last);
 };
 
 #endif // BLOCKINGBACKGROUNDRENDER_H
@@ -389,6 +389,10 @@ private:
 
     mutable QMutex _getLock;  //prevents get() and getOrCreate() to be called simultaneously
 
+    ///Statistics about the look-ups, protected by _getLock
+    mutable U64 _nLookups;
+    mutable U64 _nHits;
+
     /*These 2 are mutable because we need to modify the LRU list even
          when we call get() and we want this function to be const.*/
     mutable CacheContainer _memoryCache;
@@ -426,6 +430,8 @@ public:
           ,_sizeLock()
           ,_lock()
           , _getLock()
+          , _nLookups(0)
+          , _nHits(0)
           ,_memoryCache()
           ,_diskCache()
           ,_cacheName(cacheName)
@@ -473,10 +479,33 @@ public:
 
         ///lock the cache before reading it.
         QMutexLocker locker(&_lock);
-        return getInternal(key,returnValue);
+        bool found = getInternal(key,returnValue);
+        ++_nLookups;
+        if (found) {
+            ++_nHits;
+        }
+        return found;
         
     } // get
     
+    /**
+     * @brief Returns the number of calls to get() and getOrCreate() and how many of them found an entry
+     * since the last call to resetLookupStatistics().
+     **/
+    void getLookupStatistics(U64* nLookups,U64* nHits) const
+    {
+        QMutexLocker getlocker(&_getLock);
+        *nLookups = _nLookups;
+        *nHits = _nHits;
+    }
+    
+    void resetLookupStatistics()
+    {
+        QMutexLocker getlocker(&_getLock);
+        _nLookups = 0;
+        _nHits = 0;
+    }
+    
 
 private:
     
@@ -638,10 +667,12 @@ public:
                 QMutexLocker locker(&_lock);
                 didGetSucceed = getInternal(key,&entries);
             }
+            ++_nLookups;
             if (didGetSucceed) {
                 for (typename std::list<EntryTypePtr>::iterator it = entries.begin(); it != entries.end(); ++it) {
                     if (*(*it)->getParams() == *params) {
                         *returnValue = *it;
+                        ++_nHits;
                         return true;
                     }
                 }
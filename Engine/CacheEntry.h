@@ -159,7 +159,9 @@ public:
             _storageMode = eStorageModeDisk;
             _path = path;
             try {
-                _backingFile.reset( new MemoryFile(_path,MemoryFile::eFileOpenModeEnumIfExistsKeepElseCreate) );
+                ///The file name was chosen so that it does not exist: fail rather than sharing the file if another process
+                ///using the same cache location created it in the meantime
+                _backingFile.reset( new MemoryFile(_path,MemoryFile::eFileOpenModeEnumIfExistsFailElseCreate) );
             } catch (const std::runtime_error & r) {
                 std::cout << r.what() << std::endl;
 
@@ -43,6 +43,7 @@
 
 #include <limits>
 #include <cfloat>
+#include <vector>
 #include "Engine/RotoContext.h"
 #include "Engine/RotoContextPrivate.h"
 #include "Engine/Interpolation.h"
@@ -54,8 +55,23 @@ using namespace Natron;
 #define M_PI_2      1.57079632679489661923132169163975144   /* pi/2           */
 #endif
 
+typedef std::vector<BezierCPValue> BezierCPValues;
 
-static Point getPointAt(const BezierCPs& cps, int time, double t)
+/**
+ * @brief Evaluates all the control points of the patch once at the given time, so that the routines below
+ * access them by index instead of walking the list and evaluating the animation curves on each access.
+ **/
+static void evaluatePatch(const BezierCPs& cps, int time, BezierCPValues* values)
+{
+    values->resize(cps.size());
+    int i = 0;
+    for (BezierCPs::const_iterator it = cps.begin(); it != cps.end(); ++it, ++i) {
+        (*it)->evaluateAtTime(time, &(*values)[i]);
+    }
+}
+
+
+static Point getPointAt(const BezierCPValues& cps, double t)
 {
     int ncps = (int)cps.size();
     assert(ncps);
@@ -66,37 +82,19 @@ static Point getPointAt(const BezierCPs& cps, int time, double t)
     int t_i_plus_1 = t_i % ncps;
     assert(t_i >= 0 && t_i < ncps && t_i_plus_1 >= 0 && t_i_plus_1 < ncps);
     if (t == t_i) {
-        BezierCPs::const_iterator it = cps.begin();
-        std::advance(it, t_i);
-        Point ret;
-        (*it)->getPositionAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cps[t_i].p;
     } else if (t == t_i_plus_1) {
-        BezierCPs::const_iterator it = cps.begin();
-        std::advance(it, t_i_plus_1);
-        Point ret;
-        (*it)->getPositionAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cps[t_i_plus_1].p;
     }
     
-    BezierCPs::const_iterator it = cps.begin();
-    std::advance(it, t_i);
-    BezierCPs::const_iterator next = it;
-    ++next;
-    if (next == cps.end()) {
-        next = cps.begin();
-    }
-    Point p0,p1,p2,p3;
-    (*it)->getPositionAtTime(time, &p0.x, &p0.y);
-    (*it)->getRightBezierPointAtTime(time, &p1.x, &p1.y);
-    (*next)->getLeftBezierPointAtTime(time, &p2.x, &p2.y);
-    (*next)->getPositionAtTime(time, &p3.x, &p3.y);
+    const BezierCPValue& cur = cps[t_i];
+    const BezierCPValue& next = cps[(t_i + 1) % ncps];
     Point ret;
-    Bezier::bezierPoint(p0, p1, p2, p3, t - t_i, &ret);
+    Bezier::bezierPoint(cur.p, cur.right, next.left, next.p, t - t_i, &ret);
     return ret;
 }
 
-static Point getLeftPointAt(const BezierCPs& cps, int time, double t)
+static Point getLeftPointAt(const BezierCPValues& cps, double t)
 {
     int ncps = (int)cps.size();
     assert(ncps);
@@ -107,34 +105,20 @@ static Point getLeftPointAt(const BezierCPs& cps, int time, double t)
     int t_i_plus_1 = t_i % ncps;
     assert(t_i >= 0 && t_i < ncps && t_i_plus_1 >= 0 && t_i_plus_1 < ncps);
     if (t == t_i) {
-        BezierCPs::const_iterator it = cps.begin();
-        std::advance(it, t_i);
-        Point ret;
-        (*it)->getLeftBezierPointAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cps[t_i].left;
     } else if (t == t_i_plus_1) {
-        BezierCPs::const_iterator it = cps.begin();
-        std::advance(it, t_i_plus_1);
-        Point ret;
-        (*it)->getLeftBezierPointAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cps[t_i_plus_1].left;
     }
     
-    BezierCPs::const_iterator it = cps.begin();
-    std::advance(it, t_i);
-    BezierCPs::const_iterator next = it;
-    ++next;
-    if (next == cps.end()) {
-        next = cps.begin();
-    }
+    const BezierCPValue& cur = cps[t_i];
+    const BezierCPValue& next = cps[(t_i + 1) % ncps];
     
     t = t - t_i;
     
-    Point a,b,c,ab,bc,abc;
-    Point ret;
-    (*it)->getPositionAtTime(time, &a.x, &a.y);
-    (*it)->getRightBezierPointAtTime(time, &b.x, &b.y);
-    (*next)->getLeftBezierPointAtTime(time, &c.x, &c.y);
+    Point ab,bc,abc;
+    const Point& a = cur.p;
+    const Point& b = cur.right;
+    const Point& c = next.left;
     ab.x = (1. - t) * a.x + t * b.x;
     ab.y = (1. - t) * a.y + t * b.y;
     
@@ -144,14 +128,13 @@ static Point getLeftPointAt(const BezierCPs& cps, int time, double t)
     abc.x = (1. - t) * ab.x + t * bc.x;
     abc.y = (1. - t) * ab.y + t * bc.y;
     if (abc.x == a.x && abc.y == a.y) {
-        (*it)->getLeftBezierPointAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cur.left;
     } else {
         return abc;
     }
 }
 
-static Point getRightPointAt(const BezierCPs& cps, int time, double t)
+static Point getRightPointAt(const BezierCPValues& cps, double t)
 {
     int ncps = cps.size();
     assert(ncps);
@@ -162,34 +145,20 @@ static Point getRightPointAt(const BezierCPs& cps, int time, double t)
     int t_i_plus_1 = t_i % ncps;
     assert(t_i >= 0 && t_i < ncps && t_i_plus_1 >= 0 && t_i_plus_1 < ncps);
     if (t == t_i) {
-        BezierCPs::const_iterator it = cps.begin();
-        std::advance(it, t_i);
-        Point ret;
-        (*it)->getRightBezierPointAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cps[t_i].right;
     } else if (t == t_i_plus_1) {
-        BezierCPs::const_iterator it = cps.begin();
-        std::advance(it, t_i_plus_1);
-        Point ret;
-        (*it)->getRightBezierPointAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return cps[t_i_plus_1].right;
     }
     
-    BezierCPs::const_iterator it = cps.begin();
-    std::advance(it, t_i);
-    BezierCPs::const_iterator next = it;
-    ++next;
-    if (next == cps.end()) {
-        next = cps.begin();
-    }
+    const BezierCPValue& cur = cps[t_i];
+    const BezierCPValue& next = cps[(t_i + 1) % ncps];
     
     t = t - t_i;
     
-    Point a,b,c,ab,bc,abc;
-    Point ret;
-    (*it)->getRightBezierPointAtTime(time, &a.x, &a.y);
-    (*next)->getLeftBezierPointAtTime(time, &b.x, &b.y);
-    (*next)->getPositionAtTime(time, &c.x, &c.y);
+    Point ab,bc,abc;
+    const Point& a = cur.right;
+    const Point& b = next.left;
+    const Point& c = next.p;
     ab.x = (1. - t) * a.x + t * b.x;
     ab.y = (1. - t) * a.y + t * b.y;
     
@@ -199,8 +168,7 @@ static Point getRightPointAt(const BezierCPs& cps, int time, double t)
     abc.x = (1. - t) * ab.x + t * bc.x;
     abc.y = (1. - t) * ab.y + t * bc.y;
     if (abc.x == c.x && abc.y == c.y) {
-        (*next)->getRightBezierPointAtTime(time, &ret.x, &ret.y);
-        return ret;
+        return next.right;
     } else {
         return abc;
     }
@@ -215,15 +183,15 @@ static double norm(const Point& z0, const Point& c0, const Point& c1, const Poin
     return fuzz2 * std::max(p1_p1p2Norm,std::max(p1_p2p1Norm,p1_p2Norm));
 }
 
-static Point predir(const BezierCPs& cps, int time, double t)
+static Point predir(const BezierCPValues& cps, double t)
 {
     //Compute the unit vector in the direction of the bysector angle
     Point dir;
     Point p1,p2,p2p1,p1p2;
-    p2 = getPointAt(cps, time, t);
-    p2p1 = getLeftPointAt(cps, time, t);
-    p1p2 = getRightPointAt(cps, time, t - 1);
-    p1 = getPointAt(cps, time, t - 1);
+    p2 = getPointAt(cps, t);
+    p2p1 = getLeftPointAt(cps, t);
+    p1p2 = getRightPointAt(cps, t - 1);
+    p1 = getPointAt(cps, t - 1);
     dir.x =  3. * (p2.x - p2p1.x);
     dir.y =  3. * (p2.y - p2p1.y);
     
@@ -261,14 +229,14 @@ static Point predir(const BezierCPs& cps, int time, double t)
     return ret;
 }
 
-static Point postdir(const BezierCPs& cps, int time, double t)
+static Point postdir(const BezierCPValues& cps, double t)
 {
     Point dir;
     Point p2,p3,p2p3,p3p2;
-    p2 = getPointAt(cps, time, t);
-    p2p3 = getRightPointAt(cps, time, t);
-    p3 = getPointAt(cps, time, t+1);
-    p3p2 = getLeftPointAt(cps, time, t+1);
+    p2 = getPointAt(cps, t);
+    p2p3 = getRightPointAt(cps, t);
+    p3 = getPointAt(cps, t+1);
+    p3p2 = getLeftPointAt(cps, t+1);
     dir.x = 3. * (p2p3.x - p2.x);
     dir.y = 3. * (p2p3.y - p2.y);
     double epsilon = norm(p2, p2p3, p3p2, p3);
@@ -305,18 +273,18 @@ static Point postdir(const BezierCPs& cps, int time, double t)
     return ret;
 }
 
-static Point dirVect(const BezierCPs& cps, int time, double t, int sign)
+static Point dirVect(const BezierCPValues& cps, double t, int sign)
 {
     Point ret;
     if (sign == 0) {
-        Point pre = predir(cps, time, t);
-        Point post = postdir(cps, time, t);
+        Point pre = predir(cps, t);
+        Point post = postdir(cps, t);
         ret.x = pre.x + post.x;
         ret.y = pre.y + post.y;
     } else if (sign < 0) {
-        ret = predir(cps, time, t);
+        ret = predir(cps, t);
     } else if (sign > 0) {
-        ret = postdir(cps, time, t);
+        ret = postdir(cps, t);
     }
     
     double norm = std::sqrt(ret.x * ret.x + ret.y * ret.y);
@@ -327,14 +295,14 @@ static Point dirVect(const BezierCPs& cps, int time, double t, int sign)
     return ret;
 }
 
-static Point dirVect(const BezierCPs& cps, int time, double t)
+static Point dirVect(const BezierCPValues& cps, double t)
 {
     int t_i = std::floor(t);
     t -= t_i;
     if (t == 0) {
-        Point pre = predir(cps,time ,t);
+        Point pre = predir(cps, t);
         
-        Point post = postdir(cps, time ,t);
+        Point post = postdir(cps, t);
         
         Point ret;
         ret.x = pre.x + post.x;
@@ -348,10 +316,10 @@ static Point dirVect(const BezierCPs& cps, int time, double t)
         ret.y /= norm;
         return ret;
     }
-    Point z0 = getPointAt(cps, time, t_i);
-    Point c0 = getRightPointAt(cps, time, t_i);
-    Point c1 = getLeftPointAt(cps, time, t_i + 1);
-    Point z1 = getPointAt(cps, time, t_i + 1);
+    Point z0 = getPointAt(cps, t_i);
+    Point c0 = getRightPointAt(cps, t_i);
+    Point c1 = getLeftPointAt(cps, t_i + 1);
+    Point z1 = getPointAt(cps, t_i + 1);
     Point a,b,c;
     a.x = 3. * (z1.x - z0.x) + 9. * (c0.x - c1.x);
     a.y = 3. * (z1.y - z0.y) + 9. * (c0.y - c1.y);
@@ -401,8 +369,11 @@ static boost::shared_ptr<BezierCP> makeBezierCPFromPoint(const Point& p, const P
     return ret;
 }
 
-static void findIntersection(const BezierCPs& cps,
-                             int time,
+/**
+ * @brief Finds the first intersection along the path of the line (p,q) with the patch, other than p itself.
+ * Returns false if there is none.
+ **/
+static bool findIntersection(const BezierCPValues& cps,
                              const Point& p,
                              const Point& q,
                              boost::shared_ptr<BezierCP>* newPoint,
@@ -410,28 +381,18 @@ static void findIntersection(const BezierCPs& cps,
 {
     double fuzz = 1000. * std::numeric_limits<double>::epsilon();
     double fuzz2 = fuzz * fuzz;
-
-    
     double dx = q.x - p.x;
     double dy = q.y - p.y;
     double det = p.y * q.x - p.x * q.y;
-    std::vector<std::pair<boost::shared_ptr<BezierCP>,std::pair<BezierCPs::const_iterator,BezierCPs::const_iterator> > > intersections;
-    
-    BezierCPs::const_iterator s1 = cps.begin();
-    BezierCPs::const_iterator s2 = cps.begin();
-    ++s2;
-    int index = 0;
-    for (; s1 != cps.end(); ++s1,++s2, ++index) {
-        if (s2 == cps.end()) {
-            s2 = cps.begin();
-        }
-      
-        Point z0,z1,c0,c1;
-        (*s1)->getPositionAtTime(time, &z0.x, &z0.y);
-        (*s1)->getRightBezierPointAtTime(time, &c0.x, &c0.y);
-        (*s2)->getPositionAtTime(time, &z1.x, &z1.y);
-        (*s2)->getLeftBezierPointAtTime(time, &c1.x, &c1.y);
-        
+    
+    int ncps = (int)cps.size();
+    for (int index = 0; index < ncps; ++index) {
+        const BezierCPValue& s1 = cps[index];
+        const BezierCPValue& s2 = cps[(index + 1) % ncps];
+        const Point& z0 = s1.p;
+        const Point& c0 = s1.right;
+        const Point& z1 = s2.p;
+        const Point& c1 = s2.left;
         
         Point t3,t2,t1;
         t3.x = z1.x - z0.x + 3. * (c0.x - c1.x);
@@ -448,75 +409,77 @@ static void findIntersection(const BezierCPs& cps,
         double c = dy * t1.x - dx * t1.y;
         double d = dy * z0.x - dx * z0.y + det;
         
-        std::vector<double> roots;
-        if (std::max(std::max(std::max(a * a, b * b), c * c), d * d) >
-            fuzz2 * std::max(std::max(std::max(z0.x * z0.x + z0.y * z0.y, z1.x * z1.x + z1.y * z1.y),
-                                      c0.x * c0.x + c0.y * c0.y),
-                             c1.x * c1.x + c1.y * c1.y)) {
-                double r[3];
-                int order[3];
-                int nsols = Natron::solveCubic(d, c, b, a, r, order);
-                for (int i = 0; i < nsols; ++i) {
-                    roots.push_back(r[i]);
-                }
-            } else {
-                roots.push_back(0);
+        double maxNorm2 = std::max(std::max(std::max(z0.x * z0.x + z0.y * z0.y, z1.x * z1.x + z1.y * z1.y),
+                                            c0.x * c0.x + c0.y * c0.y),
+                                   c1.x * c1.x + c1.y * c1.y);
+        double roots[3];
+        int nRoots = 0;
+        if (std::max(std::max(std::max(a * a, b * b), c * c), d * d) > fuzz2 * maxNorm2) {
+            
+            /*
+             By the convex hull property the segment cannot cross the line (p,q) if all its control points lie
+             strictly on the same side of the line: skip it before solving the cubic. The margin covers the roots
+             slightly outside of [0,1] that are accepted below, as well as the segments that lie on the line up to
+             the tolerance of the degenerate case above.
+             */
+            double side0 = d;
+            double side1 = dy * c0.x - dx * c0.y + det;
+            double side2 = dy * c1.x - dx * c1.y + det;
+            double side3 = dy * z1.x - dx * z1.y + det;
+            double minSide = std::min(std::min(side0, side1), std::min(side2, side3));
+            double maxSide = std::max(std::max(side0, side1), std::max(side2, side3));
+            double margin = std::max(8. * fuzz * std::max(std::abs(minSide), std::abs(maxSide)), fuzz * std::sqrt(maxNorm2));
+            if (minSide > margin || maxSide < -margin) {
+                continue;
             }
+            
+            int order[3];
+            nRoots = Natron::solveCubic(d, c, b, a, roots, order);
+        } else {
+            roots[0] = 0;
+            nRoots = 1;
+        }
         
-        for (std::size_t i = 0; i < roots.size(); ++i) {
+        for (int i = 0; i < nRoots; ++i) {
             if (roots[i] >= -fuzz && roots[i] <= 1. + fuzz) {
-                if (i + roots[i] >= roots.size() - fuzz) {
+                if (i + roots[i] >= nRoots - fuzz) {
                     roots[i] = 0;
                 }
-                Point interP = getPointAt(cps, time, roots[i] + index);
-                Point interLeft = getLeftPointAt(cps, time, roots[i] + index);
-                Point interRight = getRightPointAt(cps, time, roots[i] + index);
-                boost::shared_ptr<BezierCP> intersection = makeBezierCPFromPoint(interP,interLeft,interRight);
-            
+                
+                Point interP = getPointAt(cps, roots[i] + index);
+                
                 double distToP = std::sqrt((p.x - interP.x) * (p.x - interP.x) + (p.y - interP.y) * (p.y - interP.y));
                 if (std::abs(distToP) < 1e-4) {
                     continue;
                 }
                 
-                bool found = false;
-                for (std::vector<std::pair<boost::shared_ptr<BezierCP>,std::pair<BezierCPs::const_iterator,BezierCPs::const_iterator> > >::iterator it = intersections.begin(); it!=intersections.end(); ++it) {
-                    Point other;
-                    it->first->getPositionAtTime(time, &other.x, &other.y);
-                    double distSquared = (interP.x - other.x) * (interP.x - other.x) + (interP.y - other.y) * (interP.y - other.y);
-                    if (distSquared <= fuzz2) {
-                        found = true;
-                        break;
-                    }
-                }
-                
-                if (!found) {
-                    intersections.push_back(std::make_pair(intersection, std::make_pair(s1, s2)));
-                }
+                //Only the first intersection along the path is used: stop there instead of collecting the others
+                Point interLeft = getLeftPointAt(cps, roots[i] + index);
+                Point interRight = getRightPointAt(cps, roots[i] + index);
+                *newPoint = makeBezierCPFromPoint(interP,interLeft,interRight);
+                *before = index;
+                return true;
             }
         }
     }
-    
-    
-    
-    assert(intersections.size() >= 1);
-    const std::pair<boost::shared_ptr<BezierCP>,std::pair<BezierCPs::const_iterator,BezierCPs::const_iterator> > & inter = intersections.front();
-    *newPoint = inter.first;
-    *before = std::distance(cps.begin(), inter.second.first);
+    return false;
 }
 
-static bool splitAt(const BezierCPs &cps, int time, double t, std::list<BezierCPs>* ret)
+static bool splitAt(const BezierCPs &cps, const BezierCPValues& values, int time, double t, std::list<BezierCPs>* ret)
 {
-    Point dir = dirVect(cps, time, t);
+    Point dir = dirVect(values, t);
     if (dir.x != 0. || dir.y != 0.) {
-        Point z = getPointAt(cps, time, t);
-        Point zLeft = getLeftPointAt(cps, time, t);
-        Point zRight = getRightPointAt(cps, time, t);
+        Point z = getPointAt(values, t);
+        Point zLeft = getLeftPointAt(values, t);
+        Point zRight = getRightPointAt(values, t);
         Point q;
         q.x = z.x;
         q.y = z.y + dir.y;
         boost::shared_ptr<BezierCP> newPoint;
         int pointIdx = -1;
-        findIntersection(cps, time, z, q, &newPoint, &pointIdx);
+        if ( !findIntersection(values, z, q, &newPoint, &pointIdx) ) {
+            return false;
+        }
         assert(pointIdx >= 0 && pointIdx < (int)cps.size());
         
         //Separate the original patch in 2 parts and call regularize again on each of them
@@ -585,7 +548,7 @@ static bool splitAt(const BezierCPs &cps, int time, double t, std::list<BezierCP
         std::list<BezierCPs> regularizedSecond;
         Natron::regularize(firstPart, time, &regularizedFirst);
         Natron::regularize(secondPart, time, &regularizedSecond);
-        ret->insert(ret->begin(),regularizedFirst.begin(),regularizedSecond.end());
+        ret->insert(ret->begin(),regularizedFirst.begin(),regularizedFirst.end());
         ret->insert(ret->end(), regularizedSecond.begin(), regularizedSecond.end());
         return true;
     }
@@ -596,20 +559,20 @@ static bool splitAt(const BezierCPs &cps, int time, double t, std::list<BezierCP
  * @brief Given the original coon's patch, check if all interior angles are inferior to 180°. If not then we split
  * along the bysector angle and separate the patch.
  **/
-static bool checkAnglesAndSplitIfNeeded(const BezierCPs &cps, int time, int sign, std::list<BezierCPs>* ret)
+static bool checkAnglesAndSplitIfNeeded(const BezierCPs &cps, const BezierCPValues& values, int time, int sign, std::list<BezierCPs>* ret)
 {
     int ncps = (int)cps.size();
     assert(ncps >= 3);
     
     
     for (int i = 0; i < ncps; ++i) {
-        Point negativeDir = dirVect(cps, time, i, -1);
+        Point negativeDir = dirVect(values, i, -1);
         negativeDir.y = -negativeDir.y;
-        Point positiveDir = dirVect(cps, time, i, 1);
+        Point positiveDir = dirVect(values, i, 1);
         
         double py = negativeDir.x * positiveDir.y + negativeDir.y * positiveDir.x;
         if (py * sign < -1e-4) {
-            if (splitAt(cps, time, i, ret)) {
+            if (splitAt(cps, values, time, i, ret)) {
                 return true;
             }
             return false;
@@ -619,84 +582,55 @@ static bool checkAnglesAndSplitIfNeeded(const BezierCPs &cps, int time, int sign
     
 }
 
-static void tensor(const BezierCPs& p, int time, const Point* internal, Point ret[4][4])
+static void tensor(const BezierCPValues& p, const Point* internal, Point ret[4][4])
 {
-    ret[0][0] = getPointAt(p, time, 0);
-    ret[0][1] = getLeftPointAt(p, time, 0);
-    ret[0][2] = getRightPointAt(p, time, 3);
-    ret[0][3] = getPointAt(p, time, 3);
+    ret[0][0] = getPointAt(p, 0);
+    ret[0][1] = getLeftPointAt(p, 0);
+    ret[0][2] = getRightPointAt(p, 3);
+    ret[0][3] = getPointAt(p, 3);
     
-    ret[1][0] = getRightPointAt(p, time, 0);
+    ret[1][0] = getRightPointAt(p, 0);
     ret[1][1] = internal[0];
     ret[1][2] = internal[3];
-    ret[1][3] = getLeftPointAt(p, time, 3);
+    ret[1][3] = getLeftPointAt(p, 3);
     
-    ret[2][0] = getLeftPointAt(p, time, 1);
+    ret[2][0] = getLeftPointAt(p, 1);
     ret[2][1] = internal[1];
     ret[2][2] = internal[2];
-    ret[2][3] = getRightPointAt(p, time, 2);
+    ret[2][3] = getRightPointAt(p, 2);
     
-    ret[3][0] = getPointAt(p, time, 1);
-    ret[3][1] = getRightPointAt(p, time, 1);
-    ret[3][2] = getLeftPointAt(p, time, 2);
-    ret[3][3] = getPointAt(p, time, 2);
+    ret[3][0] = getPointAt(p, 1);
+    ret[3][1] = getRightPointAt(p, 1);
+    ret[3][2] = getLeftPointAt(p, 2);
+    ret[3][3] = getPointAt(p, 2);
 }
 
-static void coonsPatch(const BezierCPs& p, int time, Point ret[4][4])
+static void coonsPatch(const BezierCPValues& p, Point ret[4][4])
 {
     assert(p.size() >= 3);
     Point internal[4];
-    BezierCPs::const_iterator cur = p.begin();
-    BezierCPs::const_iterator prev = p.end();
-    --prev;
-    BezierCPs::const_iterator next = cur;
-    ++next;
-    BezierCPs::const_iterator nextNext = next;
-    ++nextNext;
-    
-    for (int j = 0; j < 4; ++j,
-         ++prev,++cur,++next,++nextNext) {
-        if (cur == p.end()) {
-            cur = p.begin();
-        }
-        if (prev == p.end()) {
-            prev = p.begin();
-        }
-        if (next == p.end()) {
-            next = p.begin();
-        }
-        if (nextNext == p.end()) {
-            nextNext = p.begin();
-        }
-        
-        Point p1;
-        (*cur)->getPositionAtTime(time, &p1.x, &p1.y);
-        
-        Point p1left;
-        (*cur)->getLeftBezierPointAtTime(time, &p1left.x, &p1left.y);
-        
-        Point p1right;
-        (*cur)->getRightBezierPointAtTime(time, &p1right.x, &p1right.y);
-        
-        Point p0;
-        (*prev)->getPositionAtTime(time, &p0.x, &p0.y);
-        
-        Point p2;
-        (*next)->getPositionAtTime(time, &p2.x, &p2.y);
-        
-        Point p0left;
-        (*prev)->getLeftBezierPointAtTime(time, &p0left.x, &p0left.y);
+    int ncps = (int)p.size();
+    
+    for (int j = 0; j < 4; ++j) {
         
-        Point p2right;
-        (*next)->getRightBezierPointAtTime(time, &p2right.x, &p2right.y);
+        const BezierCPValue& prev = p[(j + ncps - 1) % ncps];
+        const BezierCPValue& cur = p[j % ncps];
+        const BezierCPValue& next = p[(j + 1) % ncps];
+        const BezierCPValue& nextNext = p[(j + 2) % ncps];
         
-        Point p3;
-        (*nextNext)->getPositionAtTime(time, &p3.x, &p3.y);
+        const Point& p1 = cur.p;
+        const Point& p1left = cur.left;
+        const Point& p1right = cur.right;
+        const Point& p0 = prev.p;
+        const Point& p2 = next.p;
+        const Point& p0left = prev.left;
+        const Point& p2right = next.right;
+        const Point& p3 = nextNext.p;
         
         internal[j].x = 1. / 9. * (-4. * p1.x + 6. * (p1left.x + p1right.x) - 2. * (p0.x + p2.x) + 3. * (p0left.x + p2right.x) - p3.x);
         internal[j].y = 1. / 9. * (-4. * p1.y + 6. * (p1left.y + p1right.y) - 2. * (p0.y + p2.y) + 3. * (p0left.y + p2right.y) - p3.y);
     }
-    return tensor(p, time, internal, ret);
+    return tensor(p, internal, ret);
 }
 
 
@@ -749,7 +683,7 @@ double normal(const Point P[4][4], double u, double v) {
     return a.x * b.y - a.y * b.x;
 }
 
-Point findPointInside(const BezierCPs& cps, int time)
+Point findPointInside(const BezierCPValues& cps)
 {
     /*
      Given a simple polygon, find some point inside it. Here is a method based on the proof that
@@ -757,23 +691,21 @@ Point findPointInside(const BezierCPs& cps, int time)
      a diagonal is interior to the polygon.
      */
     assert(!cps.empty());
-    int i = 0;
-    for (BezierCPs::const_iterator it = cps.begin(); it != cps.end(); ++it, ++i) {
-        Point dir = dirVect(cps, time, i);
+    for (int i = 0; i < (int)cps.size(); ++i) {
+        Point dir = dirVect(cps, i);
         if (dir.x == 0. && dir.y == 0.) {
             continue;
         }
-        Point p;
-        (*it)->getPositionAtTime(time, &p.x, &p.y);
+        const Point& p = cps[i].p;
         Point q;
         q.x = p.x;
         q.y = p.y + dir.y;
         boost::shared_ptr<BezierCP> newPoint;
         int beforeIndex = -1;
-        findIntersection(cps, time, p, q, &newPoint, &beforeIndex);
-        if (newPoint && beforeIndex != -1) {
+        if ( findIntersection(cps, p, q, &newPoint, &beforeIndex) ) {
             Point np;
-            newPoint->getPositionAtTime(time, &np.x, &np.y);
+            //The intersection point only has a static position
+            newPoint->getPositionAtTime(0, &np.x, &np.y);
             if (np.x != p.x || np.y != p.y) {
                 Point m;
                 m.x = 0.5 * (p.x + np.x);
@@ -782,9 +714,7 @@ Point findPointInside(const BezierCPs& cps, int time)
             }
         }
     }
-    Point ret;
-    cps.front()->getPositionAtTime(time, &ret.x, &ret.y);
-    return ret;
+    return cps.front().p;
 }
 
 
@@ -1161,7 +1091,7 @@ static bool checkCurve(const Point& z0, const Point& c0, const Point& z1, const
 // Return the winding number of the region bounded by the (cyclic) path
 // relative to the point z, or the largest odd integer if the point lies on
 // the path.
-static int computeWindingNumber(const BezierCPs& patch, int time, const Point& z) {
+static int computeWindingNumber(const BezierCPValues& patch, const Point& z) {
     
     assert(patch.size() >= 3);
     
@@ -1170,21 +1100,12 @@ static int computeWindingNumber(const BezierCPs& patch, int time, const Point& z
     
     int count = 0;
     
-    BezierCPs::const_iterator it = patch.begin();
-    BezierCPs::const_iterator next = it;
-    ++next;
-    for (; it != patch.end(); ++it, ++next) {
-        if (next == patch.end()) {
-            next = patch.begin();
-        }
-        
-        Point p0,p1,p2,p3;
-        (*it)->getPositionAtTime(time, &p0.x, &p0.y);
-        (*it)->getRightBezierPointAtTime(time, &p1.x, &p1.y);
-        (*next)->getLeftBezierPointAtTime(time, &p2.x, &p2.y);
-        (*next)->getPositionAtTime(time, &p3.x, &p3.y);
+    int ncps = (int)patch.size();
+    for (int i = 0; i < ncps; ++i) {
+        const BezierCPValue& cur = patch[i];
+        const BezierCPValue& next = patch[(i + 1) % ncps];
         
-        if (checkCurve(p0, p1, p2, p3, z, &count, maxdepth)) {
+        if (checkCurve(cur.p, cur.right, next.left, next.p, z, &count, maxdepth)) {
             return undefined;
         }
     }
@@ -1198,7 +1119,10 @@ void Natron::regularize(const BezierCPs &patch, int time, std::list<BezierCPs> *
         return;
     }
     
-    Point pointInside = findPointInside(patch, time);
+    BezierCPValues values;
+    evaluatePatch(patch, time, &values);
+    
+    Point pointInside = findPointInside(values);
     int sign;
     {
         RectD bbox;
@@ -1210,20 +1134,20 @@ void Natron::regularize(const BezierCPs &patch, int time, std::list<BezierCPs> *
         if (!bbox.contains(pointInside.x, pointInside.y)) {
             sign = 0;
         } else {
-            int winding_number = computeWindingNumber(patch, time, pointInside);
+            int winding_number = computeWindingNumber(values, pointInside);
             sign = (winding_number < 0) ? -1 : ((winding_number > 0) ? 1 : 0);
         }
         
     }
     
     std::list<BezierCPs> splits;
-    if (checkAnglesAndSplitIfNeeded(patch, time, sign, &splits)) {
+    if (checkAnglesAndSplitIfNeeded(patch, values, time, sign, &splits)) {
         *fixedPatch = splits;
         return;
     }
     
     Point P[4][4];
-    coonsPatch(patch, time, P);
+    coonsPatch(values, P);
     
     //Check for degeneracy
     Point U[3][4];
@@ -1366,11 +1290,11 @@ void Natron::regularize(const BezierCPs &patch, int time, std::list<BezierCPs> *
     }
     
     // Split at the worst boundary degeneracy.
-    if (M < 0 && splitAt(patch, time, cut, fixedPatch)) {
+    if (M < 0 && splitAt(patch, values, time, cut, fixedPatch)) {
         return;
     }
     
     
     // Split arbitrarily to resolve any remaining (internal) degeneracy.
-    splitAt(patch, time, 0.5, fixedPatch);
+    splitAt(patch, values, time, 0.5, fixedPatch);
 }
\ No newline at end of file
@@ -289,6 +289,7 @@ Curve::clearKeyFrames()
     QMutexLocker l(&_imp->_lock);
 
     _imp->keyFrames.clear();
+    onCurveChanged();
 }
 
 bool
@@ -1512,6 +1513,7 @@ Curve::onCurveChanged()
     // PRIVATE - should not lock
     if (_imp->owner) {
         _imp->owner->clearExpressionsResults(_imp->dimensionInOwner);
+        _imp->owner->onCurveKeyframesChanged(this, _imp->dimensionInOwner);
     }
     _imp->resultCache.clear();
 }
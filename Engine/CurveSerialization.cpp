@@ -10,6 +10,77 @@
 
 #include "CurveSerialization.h"
 
+#include <cstring>
+#include <vector>
+
+namespace {
+///Size of a keyframe in the binary archive: its fields are packed so that no padding byte is written
+const std::size_t kKeyFrameRecordSize = 4 * sizeof(double) + sizeof(int);
+
+template <typename T>
+char* writeRecordField(char* dst, T value)
+{
+    std::memcpy(dst, &value, sizeof(T));
+    return dst + sizeof(T);
+}
+
+template <typename T>
+const char* readRecordField(const char* src, T* value)
+{
+    std::memcpy(value, src, sizeof(T));
+    return src + sizeof(T);
+}
+}
+
+void
+serializeKeyFrameSet(boost::archive::binary_oarchive & ar,
+                     KeyFrameSet & keyFrames)
+{
+    unsigned int count = (unsigned int)keyFrames.size();
+    ar << count;
+    if (count == 0) {
+        return;
+    }
+    std::vector<char> records(count * kKeyFrameRecordSize);
+    char* dst = &records[0];
+    for (KeyFrameSet::const_iterator it = keyFrames.begin(); it != keyFrames.end(); ++it) {
+        dst = writeRecordField(dst, it->getTime());
+        dst = writeRecordField(dst, it->getValue());
+        dst = writeRecordField(dst, it->getLeftDerivative());
+        dst = writeRecordField(dst, it->getRightDerivative());
+        dst = writeRecordField(dst, (int)it->getInterpolation());
+    }
+    ar.save_binary(&records[0], records.size());
+}
+
+void
+serializeKeyFrameSet(boost::archive::binary_iarchive & ar,
+                     KeyFrameSet & keyFrames)
+{
+    unsigned int count;
+    ar >> count;
+    keyFrames.clear();
+    if (count == 0) {
+        return;
+    }
+    std::vector<char> records(count * kKeyFrameRecordSize);
+    ar.load_binary(&records[0], records.size());
+    
+    ///The records were written in increasing time order: inserting at the end is amortized constant time
+    const char* src = &records[0];
+    for (unsigned int i = 0; i < count; ++i) {
+        double time,value,leftDerivative,rightDerivative;
+        int interpolation;
+        src = readRecordField(src, &time);
+        src = readRecordField(src, &value);
+        src = readRecordField(src, &leftDerivative);
+        src = readRecordField(src, &rightDerivative);
+        src = readRecordField(src, &interpolation);
+        keyFrames.insert(keyFrames.end(), KeyFrame(time, value, leftDerivative, rightDerivative,
+                                                   (Natron::KeyframeTypeEnum)interpolation));
+    }
+}
+
 // explicit template instantiations
 
 
@@ -17,3 +88,7 @@ template void Curve::serialize<boost::archive::xml_iarchive>(boost::archive::xml
                                                              const unsigned int file_version);
 template void Curve::serialize<boost::archive::xml_oarchive>(boost::archive::xml_oarchive & ar,
                                                              const unsigned int file_version);
+template void Curve::serialize<boost::archive::binary_iarchive>(boost::archive::binary_iarchive & ar,
+                                                                const unsigned int file_version);
+template void Curve::serialize<boost::archive::binary_oarchive>(boost::archive::binary_oarchive & ar,
+                                                                const unsigned int file_version);
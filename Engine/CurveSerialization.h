@@ -24,6 +24,8 @@ GCC_DIAG_OFF(unused-parameter)
 #include <boost/archive/xml_iarchive.hpp>
 GCC_DIAG_ON(unused-parameter)
 #include <boost/archive/xml_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/set.hpp>
 #include <boost/serialization/scoped_ptr.hpp>
@@ -32,13 +34,28 @@ GCC_DIAG_ON(unused-parameter)
 #include "Engine/CurvePrivate.h"
 
 
+template<class Archive>
+void
+serializeKeyFrameSet(Archive & ar,
+                     KeyFrameSet & keyFrames)
+{
+    ar & boost::serialization::make_nvp("KeyFrameSet",keyFrames);
+}
+
+/**
+ * @brief Binary projects store the keyframes of a curve as a single array of plain records
+ * instead of going through the per-keyframe serialization of std::set.
+ **/
+void serializeKeyFrameSet(boost::archive::binary_oarchive & ar,KeyFrameSet & keyFrames);
+void serializeKeyFrameSet(boost::archive::binary_iarchive & ar,KeyFrameSet & keyFrames);
+
 template<class Archive>
 void
 Curve::serialize(Archive & ar,
                  const unsigned int /*version*/)
 {
     QMutexLocker l(&_imp->_lock);
-    ar & boost::serialization::make_nvp("KeyFrameSet",_imp->keyFrames);
+    serializeKeyFrameSet(ar, _imp->keyFrames);
 }
 
 #endif // NATRON_ENGINE_CURVESERIALIZATION_H_
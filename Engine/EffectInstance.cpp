@@ -17,10 +17,14 @@
 
 #include <map>
 #include <sstream>
+#include <algorithm>
+#include <vector>
 #include <QtConcurrentMap>
 #include <QReadWriteLock>
 #include <QCoreApplication>
 #include <QtConcurrentRun>
+#include <QThreadStorage>
+#include <QtCore/QAtomicInt>
 #if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
 #include <boost/bind.hpp>
 #endif
@@ -33,11 +37,14 @@
 #include "Engine/ViewerInstance.h"
 #include "Engine/Log.h"
 #include "Engine/Image.h"
+#include "Engine/ImageTransform.h"
 #include "Engine/ImageParams.h"
 #include "Engine/KnobFile.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/OfxImageEffectInstance.h"
 #include "Engine/KnobTypes.h"
+#include "Engine/KnobValuesSnapshot.h"
+#include "Engine/Timer.h"
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
 #include "Engine/BlockingBackgroundRender.h"
@@ -58,6 +65,166 @@
 
 using namespace Natron;
 
+namespace {
+
+class RenderSafetyLocker;
+
+struct RenderSafetyThreadState
+{
+    RenderSafetyLocker* current; //< the innermost locker of the current thread
+    int nLocked; //< the number of thread-safety locks held by the current thread
+    
+    RenderSafetyThreadState()
+    : current(0)
+    , nLocked(0)
+    {
+    }
+};
+
+static QThreadStorage<RenderSafetyThreadState> tlsRenderSafety;
+
+/**
+ * @brief Holds the thread-safety lock of an effect (see renderRoI) for the duration of a renderRoI call,
+ * except while the thread renders the inputs of the effect (see RenderSafetyUnlocker_RAII).
+ **/
+class RenderSafetyLocker
+{
+    QMutex* _mutex;
+    bool _locked;
+    RenderSafetyLocker* _previous;
+    double _lockWaitTime;
+    
+public:
+    
+    RenderSafetyLocker(QMutex* mutex)
+    : _mutex(mutex)
+    , _locked(false)
+    , _previous(tlsRenderSafety.localData().current)
+    , _lockWaitTime(0)
+    {
+        tlsRenderSafety.localData().current = this;
+        relock();
+    }
+    
+    ~RenderSafetyLocker()
+    {
+        unlock();
+        tlsRenderSafety.localData().current = _previous;
+    }
+    
+    void relock()
+    {
+        if (!_mutex || _locked) {
+            return;
+        }
+        TimeLapse timer;
+        _mutex->lock();
+        _lockWaitTime += timer.getTimeSinceCreation();
+        _locked = true;
+        ++tlsRenderSafety.localData().nLocked;
+    }
+    
+    void unlock()
+    {
+        if (!_locked) {
+            return;
+        }
+        _mutex->unlock();
+        _locked = false;
+        --tlsRenderSafety.localData().nLocked;
+    }
+    
+    bool isLocked() const
+    {
+        return _locked;
+    }
+    
+    RenderSafetyLocker* getPrevious() const
+    {
+        return _previous;
+    }
+    
+    ///Time spent waiting for the lock, in seconds
+    double getLockWaitTime() const
+    {
+        return _lockWaitTime;
+    }
+};
+
+/**
+ * @brief Releases all the thread-safety locks held by the current thread while it renders the inputs of an effect:
+ * the actions of the effect are not called meanwhile, and other threads may render the effect.
+ * The locks are taken again in the order they were first taken.
+ **/
+class RenderSafetyUnlocker_RAII
+{
+    std::vector<RenderSafetyLocker*> _unlocked; //< innermost first
+    
+public:
+    
+    RenderSafetyUnlocker_RAII()
+    : _unlocked()
+    {
+        if ( !tlsRenderSafety.hasLocalData() ) {
+            return;
+        }
+        for (RenderSafetyLocker* it = tlsRenderSafety.localData().current; it; it = it->getPrevious()) {
+            if ( it->isLocked() ) {
+                it->unlock();
+                _unlocked.push_back(it);
+            }
+        }
+    }
+    
+    ~RenderSafetyUnlocker_RAII()
+    {
+        for (std::vector<RenderSafetyLocker*>::reverse_iterator it = _unlocked.rbegin(); it != _unlocked.rend(); ++it) {
+            (*it)->relock();
+        }
+    }
+};
+
+///Accumulates durations from several threads without locking
+class AtomicDuration
+{
+    mutable QAtomicInt _seconds;
+    mutable QAtomicInt _microseconds; //< normalized below one second by add(), up to concurrent additions
+    
+public:
+    
+    AtomicDuration()
+    : _seconds(0)
+    , _microseconds(0)
+    {
+    }
+    
+    void add(double seconds)
+    {
+        int whole = (int)seconds;
+        int micro = (int)( (seconds - whole) * 1e6 );
+        if (whole) {
+            _seconds.fetchAndAddRelaxed(whole);
+        }
+        if (micro && _microseconds.fetchAndAddRelaxed(micro) + micro >= 1000000) {
+            _microseconds.fetchAndAddRelaxed(-1000000);
+            _seconds.fetchAndAddRelaxed(1);
+        }
+    }
+    
+    double get() const
+    {
+        return _seconds.fetchAndAddRelaxed(0) + _microseconds.fetchAndAddRelaxed(0) * 1e-6;
+    }
+    
+    void reset()
+    {
+        _seconds.fetchAndStoreRelaxed(0);
+        _microseconds.fetchAndStoreRelaxed(0);
+    }
+};
+    
+}
+
 
 class File_Knob;
 class OutputFile_Knob;
@@ -386,6 +553,21 @@ struct EffectInstance::Implementation
     , componentsAvailableMutex()
     , componentsAvailableDirty(true)
     , outputComponentsAvailable()
+    , renderStatsClock()
+    , nRenders(0)
+    , activeRenders(0)
+    , busyStartTimeMS(0)
+    , renderTime()
+    , busyTime()
+    , lockWaitTime()
+    , inFlightRendersMutex()
+    , inFlightRenders()
+    , timeInvarianceMutex()
+    , timeInvarianceHash(0)
+    , timeInvarianceValid(false)
+    , upstreamFrameVaryingOrAnimated(true)
+    , invariantRenderTimeSet(false)
+    , invariantRenderTime(0)
     {
     }
 
@@ -446,6 +628,128 @@ struct EffectInstance::Implementation
     bool componentsAvailableDirty; /// Set to true when getClipPreferences is called to indicate it must be set again
     EffectInstance::ComponentsAvailableMap outputComponentsAvailable;
     
+    ///Statistics about the calls to the render action. They are updated without locking since they are on the render path,
+    ///hence busyTime is approximate when a render starts while the last active one finishes.
+    TimeLapse renderStatsClock;
+    QAtomicInt nRenders;
+    QAtomicInt activeRenders; //< number of threads currently in the render action
+    QAtomicInt busyStartTimeMS; //< when activeRenders became positive, in milliseconds since renderStatsClock was created
+    AtomicDuration renderTime,busyTime,lockWaitTime;
+    
+    ///A render of this effect being computed by a thread, that other threads requesting the same image wait for
+    struct InFlightRender
+    {
+        U64 nodeHash;
+        SequenceTime time;
+        int view;
+        unsigned int mipMapLevel;
+        RectI roi;
+        std::list<Natron::ImageComponents> components;
+        Natron::ImageBitDepthEnum bitdepth;
+        
+        QMutex lock; //< protects all fields below
+        QWaitCondition cond;
+        bool done;
+        EffectInstance::RenderRoIRetCode retCode;
+        ImageList planes;
+        
+        InFlightRender(U64 hash,const RenderRoIArgs& args)
+        : nodeHash(hash)
+        , time(args.time)
+        , view(args.view)
+        , mipMapLevel(args.mipMapLevel)
+        , roi(args.roi)
+        , components(args.components)
+        , bitdepth(args.bitdepth)
+        , lock()
+        , cond()
+        , done(false)
+        , retCode(EffectInstance::eRenderRoIRetCodeFailed)
+        , planes()
+        {
+        }
+        
+        bool matches(U64 hash,const RenderRoIArgs& args) const
+        {
+            return nodeHash == hash && time == args.time && view == args.view && mipMapLevel == args.mipMapLevel &&
+            roi == args.roi && bitdepth == args.bitdepth && components == args.components;
+        }
+    };
+    
+    QMutex inFlightRendersMutex; //< protects inFlightRenders
+    std::list<boost::shared_ptr<InFlightRender> > inFlightRenders;
+    
+    /**
+     * @brief Publishes the results of an in-flight render to the threads waiting for it and forgets about it
+     **/
+    void finishInFlightRender(const boost::shared_ptr<InFlightRender>& render,
+                              EffectInstance::RenderRoIRetCode retCode,
+                              const ImageList& planes)
+    {
+        {
+            QMutexLocker k(&inFlightRendersMutex);
+            std::list<boost::shared_ptr<InFlightRender> >::iterator found = std::find(inFlightRenders.begin(), inFlightRenders.end(), render);
+            if (found != inFlightRenders.end()) {
+                inFlightRenders.erase(found);
+            }
+        }
+        QMutexLocker k(&render->lock);
+        render->retCode = retCode;
+        render->planes = planes;
+        render->done = true;
+        render->cond.wakeAll();
+    }
+    
+    ///Time-invariance analysis of the tree upstream, valid as long as the node hash does not change
+    mutable QMutex timeInvarianceMutex; //< protects all fields below
+    U64 timeInvarianceHash; //< the hash for which the fields below were computed
+    bool timeInvarianceValid;
+    bool upstreamFrameVaryingOrAnimated; //< true if at least one input tree is frame varying or animated
+    bool invariantRenderTimeSet;
+    SequenceTime invariantRenderTime; //< the time at which all renders of a time-invariant node are issued
+    
+    /**
+     * @brief Called when entering the render action, returns the time to pass to notifyRenderActionFinished()
+     **/
+    double notifyRenderActionStarted(double lockWaitTime_)
+    {
+        double now = renderStatsClock.getTimeSinceCreation();
+        if (activeRenders.fetchAndAddRelaxed(1) == 0) {
+            busyStartTimeMS.fetchAndStoreRelaxed( (int)(now * 1000.) );
+        }
+        nRenders.fetchAndAddRelaxed(1);
+        if (lockWaitTime_ > 0) {
+            lockWaitTime.add(lockWaitTime_);
+        }
+        return now;
+    }
+    
+    void notifyRenderActionFinished(double startTime)
+    {
+        double now = renderStatsClock.getTimeSinceCreation();
+        renderTime.add(now - startTime);
+        if (activeRenders.fetchAndAddRelaxed(-1) == 1) {
+            busyTime.add( std::max(0., now - busyStartTimeMS.fetchAndAddRelaxed(0) / 1000.) );
+        }
+    }
+    
+    struct RenderActionStats_RAII
+    {
+        Implementation* _imp;
+        double _startTime;
+        
+        RenderActionStats_RAII(Implementation* imp,double lockWaitTime)
+        : _imp(imp)
+        , _startTime( imp->notifyRenderActionStarted(lockWaitTime) )
+        {
+        }
+        
+        ~RenderActionStats_RAII()
+        {
+            _imp->notifyRenderActionFinished(_startTime);
+        }
+    };
+    
     void runChangedParamCallback(KnobI* k,bool userEdited,const std::string& callback);
     
     
@@ -827,6 +1131,17 @@ EffectInstance::setParallelRenderArgsTLS(int time,
     args.isDuringPaintStrokeCreation = isDuringPaintStrokeCreation;
     args.currentThreadSafety = currentThreadSafety;
     args.rotoPaintNodes = rotoPaintNodes;
+    
+    ///Nested calls for the same frame keep the values already frozen. The values are frozen right away so that
+    ///edits made once the render started are not seen by it. The main thread and analysis renders never read
+    ///the snapshot (see getRenderKnobValuesSnapshot).
+    if (!args.validArgs || !args.knobValues || args.knobValues->getTime() != time) {
+        ///Reset first: knobs of this node read while freezing (e.g by expressions) must use the live values
+        args.knobValues.reset();
+        if ( !isAnalysis && (QThread::currentThread() != qApp->thread()) ) {
+            args.knobValues.reset( new KnobValuesSnapshot(this, time) );
+        }
+    }
     ++args.validArgs;
     
 }
@@ -869,8 +1184,9 @@ EffectInstance::invalidateParallelRenderArgsTLS()
     if (_imp->frameRenderArgs.hasLocalData()) {
         ParallelRenderArgs& args = _imp->frameRenderArgs.localData();
         --args.validArgs;
-        if (args.validArgs < 0) {
+        if (args.validArgs <= 0) {
             args.validArgs = 0;
+            args.knobValues.reset();
         }
         
         for (NodeList::iterator it = args.rotoPaintNodes.begin(); it!=args.rotoPaintNodes.end(); ++it) {
@@ -1943,9 +2259,73 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool useCache,
 
 }
 
+///Names of the resampling parameters of the transform plug-ins (see ofxsTransform3x3.h in openfx-misc)
+#define kTransformParamFilter "filter"
+#define kTransformParamClamp "clamp"
+#define kTransformParamBlackOutside "black_outside"
+#define kTransformParamMotionBlur "motionBlur"
+#define kTransformParamDirectionalBlur "directionalBlur"
+
+/**
+ * @brief Returns true if resampling with the given host filter gives the same result as the render action of the
+ * transform effect, according to its resampling parameters: same filter, no clamping, black outside of the source
+ * and no motion blur. Effects without these parameters are left to render themselves.
+ **/
+static bool
+canHostReproduceTransformRender(const Natron::EffectInstance* effect,
+                                Natron::TransformFilterEnum filter)
+{
+    Choice_Knob* filterKnob = dynamic_cast<Choice_Knob*>( effect->getKnobByName(kTransformParamFilter).get() );
+    if (!filterKnob) {
+        return false;
+    }
+    std::string pluginFilter = filterKnob->getActiveEntryText_mt_safe();
+    switch (filter) {
+    case Natron::eTransformFilterBilinear:
+        if (pluginFilter != "Bilinear") {
+            return false;
+        }
+        break;
+    case Natron::eTransformFilterCubic:
+        if (pluginFilter != "Cubic") {
+            return false;
+        }
+        break;
+    case Natron::eTransformFilterKeys:
+        if (pluginFilter != "Keys") {
+            return false;
+        }
+        break;
+    case Natron::eTransformFilterLanczos:
+        ///No transform plug-in filters with Lanczos
+        return false;
+    }
+    
+    Bool_Knob* clampKnob = dynamic_cast<Bool_Knob*>( effect->getKnobByName(kTransformParamClamp).get() );
+    if ( clampKnob && clampKnob->getValue() && (filter == Natron::eTransformFilterKeys) ) {
+        ///Bilinear and Cubic never overshoot, clamping does not change their result
+        return false;
+    }
+    Bool_Knob* blackOutsideKnob = dynamic_cast<Bool_Knob*>( effect->getKnobByName(kTransformParamBlackOutside).get() );
+    if ( !blackOutsideKnob || !blackOutsideKnob->getValue() ) {
+        ///The host reads black outside of the source image
+        return false;
+    }
+    Double_Knob* motionBlurKnob = dynamic_cast<Double_Knob*>( effect->getKnobByName(kTransformParamMotionBlur).get() );
+    if ( motionBlurKnob && (motionBlurKnob->getValue() != 0.) ) {
+        return false;
+    }
+    Bool_Knob* directionalBlurKnob = dynamic_cast<Bool_Knob*>( effect->getKnobByName(kTransformParamDirectionalBlur).get() );
+    if ( directionalBlurKnob && directionalBlurKnob->getValue() ) {
+        return false;
+    }
+    return true;
+}
+
 void
 EffectInstance::tryConcatenateTransforms(const RenderRoIArgs& args,
-                                         std::list<InputMatrix>* inputTransforms)
+                                         std::list<InputMatrix>* inputTransforms,
+                                         boost::shared_ptr<HostTransform>* hostTransform)
 {
     
     bool canTransform = getCanTransform();
@@ -1969,6 +2349,7 @@ EffectInstance::tryConcatenateTransforms(const RenderRoIArgs& args,
             getTransformSucceeded = true;
         }
     }
+    Natron::EffectInstance* thisNodeInputToTransform = inputToTransform;
 
     
     if ((canTransform && getTransformSucceeded) || (!canTransform && canApplyTransform && !inputHoldingTransforms.empty())) {
@@ -2058,6 +2439,25 @@ EffectInstance::tryConcatenateTransforms(const RenderRoIArgs& args,
         } //  for (std::list<int>::iterator it = inputHoldingTransforms.begin(); it != inputHoldingTransforms.end(); ++it)
 
     } // if ((canTransform && getTransformSucceeded) || (canApplyTransform && !inputHoldingTransforms.empty()))
+    
+    ///If this effect is itself the last transform of the chain, the host can apply the whole chain in a single pass
+    ///instead of letting the plug-in resample with the concatenated matrix, as long as it renders the same image
+    Natron::TransformFilterEnum hostFilter;
+    if (canTransform && getTransformSucceeded && inputTransforms->size() == 1 &&
+        appPTR->getCurrentSettings()->getHostTransformFilter(&hostFilter) &&
+        canHostReproduceTransformRender(this, hostFilter)) {
+        const InputMatrix& im = inputTransforms->front();
+        Natron::EffectInstance* chainInput = im.newInputEffect->getInput(im.newInputNbToFetchFrom);
+        if (chainInput && getInput(im.inputNb) == thisNodeInputToTransform) {
+            boost::shared_ptr<Transform::Matrix3x3> mat(new Transform::Matrix3x3(Transform::matMul(thisNodeTransform, *im.cat)));
+            if (Transform::matDeterminant(*mat) != 0.) {
+                hostTransform->reset(new HostTransform);
+                (*hostTransform)->input = chainInput;
+                (*hostTransform)->matrix = mat;
+                (*hostTransform)->filter = hostFilter;
+            }
+        }
+    }
 
 }
 
@@ -2275,6 +2675,88 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
     ///The args must have been set calling setParallelRenderArgs
     assert(frameRenderArgs.validArgs);
     
+    ///If nothing in the tree upstream depends on the time, render it once at the first time it was asked for and share
+    ///the actions results, the cached images and the renders of the inputs across the whole sequence.
+    {
+        SequenceTime invariantTime;
+        if (getTimeInvariantRenderTime(frameRenderArgs.nodeHash, args.time, &invariantTime) && invariantTime != args.time) {
+            RenderRoIArgs argCpy = args;
+            argCpy.time = invariantTime;
+            return renderRoI(argCpy,outputPlanes);
+        }
+    }
+    
+    ///All views of a view invariant effect are the same image, evaluate the main view only
+    if (args.view != 0 && isViewInvariant()) {
+        RenderRoIArgs argCpy = args;
+        argCpy.view = 0;
+        return renderRoI(argCpy,outputPlanes);
+    }
+    
+    ///Writers must write every request they are given and paint strokes must see the latest points: don't share those
+    if (args.byPassCache || frameRenderArgs.isDuringPaintStrokeCreation || isWriter()) {
+        return renderRoIUnshared(args, outputPlanes);
+    }
+    
+    ///Concurrent requests for the same image (e.g: the 2 views of a stereo project or the 2 inputs of the viewer wipe
+    ///sharing a part of their tree) wait for a single computation instead of rendering it each.
+    ///A thread holding the thread-safety lock of an effect must not wait: the computation it would wait for might need
+    ///that same lock.
+    bool canWait = !tlsRenderSafety.hasLocalData() || tlsRenderSafety.localData().nLocked == 0;
+    boost::shared_ptr<Implementation::InFlightRender> inFlight;
+    bool isOwner = false;
+    {
+        QMutexLocker k(&_imp->inFlightRendersMutex);
+        for (std::list<boost::shared_ptr<Implementation::InFlightRender> >::iterator it = _imp->inFlightRenders.begin();
+             it != _imp->inFlightRenders.end(); ++it) {
+            if ((*it)->matches(frameRenderArgs.nodeHash, args)) {
+                inFlight = *it;
+                break;
+            }
+        }
+        if (!inFlight) {
+            inFlight.reset(new Implementation::InFlightRender(frameRenderArgs.nodeHash, args));
+            _imp->inFlightRenders.push_back(inFlight);
+            isOwner = true;
+        } else if (!canWait) {
+            inFlight.reset();
+        }
+    }
+    
+    if (!inFlight) {
+        return renderRoIUnshared(args, outputPlanes);
+    }
+    
+    if (!isOwner) {
+        QMutexLocker k(&inFlight->lock);
+        while (!inFlight->done) {
+            inFlight->cond.wait(&inFlight->lock);
+        }
+        if (inFlight->retCode == eRenderRoIRetCodeOk) {
+            *outputPlanes = inFlight->planes;
+            return eRenderRoIRetCodeOk;
+        }
+        ///The render we waited for was aborted or failed, it might not be the case of ours
+        k.unlock();
+        return renderRoIUnshared(args, outputPlanes);
+    }
+    
+    RenderRoIRetCode ret = eRenderRoIRetCodeFailed;
+    try {
+        ret = renderRoIUnshared(args, outputPlanes);
+    } catch (...) {
+        _imp->finishInFlightRender(inFlight, ret, *outputPlanes);
+        throw;
+    }
+    _imp->finishInFlightRender(inFlight, ret, *outputPlanes);
+    return ret;
+}
+
+EffectInstance::RenderRoIRetCode
+EffectInstance::renderRoIUnshared(const RenderRoIArgs & args,ImageList* outputPlanes)
+{
+    ParallelRenderArgs& frameRenderArgs = _imp->frameRenderArgs.localData();
+    assert(frameRenderArgs.validArgs);
     
     ///For writer we never want to cache otherwise the next time we want to render it will skip writing the image on disk!
     bool byPassCache = args.byPassCache;
@@ -2327,16 +2809,20 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
     // eRenderSafetyFullySafe means that there is only one render per FRAME : the lock is by image and handled in Node.cpp
     ///locks belongs to an instance)
     
-    boost::shared_ptr<QMutexLocker> locker;
+    ///The lock is held for the whole call so that the actions of the effect are never called concurrently, but it is
+    ///released while the inputs are rendered (see RenderSafetyUnlocker_RAII), otherwise one thread-unsafe node would
+    ///serialize its whole upstream tree.
+    QMutex* renderSafetyMutex = 0;
     Natron::RenderSafetyEnum safety = getCurrentThreadSafetyThreadLocal();
     if (safety == eRenderSafetyInstanceSafe) {
-        locker.reset(new QMutexLocker( &getNode()->getRenderInstancesSharedMutex()));
+        renderSafetyMutex = &getNode()->getRenderInstancesSharedMutex();
     } else if (safety == eRenderSafetyUnsafe) {
         const Natron::Plugin* p = getNode()->getPlugin();
         assert(p);
-        locker.reset(new QMutexLocker(p->getPluginLock()));
+        renderSafetyMutex = p->getPluginLock();
     }
     ///For eRenderSafetyFullySafe, don't take any lock, the image already has a lock on itself so we're sure it can't be written to by 2 different threads.
+    RenderSafetyLocker renderSafetyLocker(renderSafetyMutex);
 
     
  
@@ -2473,6 +2959,7 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
                 inputArgs.time = inputTimeIdentity;
                 inputArgs.preComputedRoD.clear();
                 
+                RenderSafetyUnlocker_RAII unlocker;
                 return inputEffectIdentity->renderRoI(inputArgs, outputPlanes);
                 
             } else {
@@ -2579,7 +3066,11 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
             inArgs.components.clear();
             inArgs.components.push_back(it->first);
             ImageList inputPlanes;
-            RenderRoIRetCode inputRetCode = node->getLiveInstance()->renderRoI(inArgs,&inputPlanes);
+            RenderRoIRetCode inputRetCode;
+            {
+                RenderSafetyUnlocker_RAII unlocker;
+                inputRetCode = node->getLiveInstance()->renderRoI(inArgs,&inputPlanes);
+            }
             assert(inputPlanes.size() == 1 || inputPlanes.empty());
             if (inputRetCode == eRenderRoIRetCodeAborted || inputRetCode == eRenderRoIRetCodeFailed || inputPlanes.empty()) {
                 return inputRetCode;
@@ -2601,8 +3092,9 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
     ////////////////////////////// Transform concatenations ///////////////////////////////////////////////////////////////
     ///Try to concatenate transform effects
     std::list<InputMatrix> inputsToTransform;
+    boost::shared_ptr<HostTransform> hostTransform;
     if (appPTR->getCurrentSettings()->isTransformConcatenationEnabled()) {
-        tryConcatenateTransforms(args, &inputsToTransform);
+        tryConcatenateTransforms(args, &inputsToTransform, &hostTransform);
     }
     
     ///Ok now we have the concatenation of all matrices, set it on the associated clip and reroute the tree
@@ -2691,6 +3183,7 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
 
     
     ImagePlanesToRender planesToRender;
+    planesToRender.hostTransform = hostTransform;
     FramesNeededMap framesNeeded;
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3332,6 +3825,7 @@ EffectInstance::RenderRoIRetCode EffectInstance::renderRoI(const RenderRoIArgs &
                 
             }
 # endif
+            Implementation::RenderActionStats_RAII renderStats( _imp.get(), renderSafetyLocker.getLockWaitTime() );
             renderRetCode = renderRoIInternal(args.time,
                                               safety,
                                               args.mipMapLevel,
@@ -3680,7 +4174,11 @@ EffectInstance::renderInputImagesForRoI(SequenceTime time,
                             
                            
                             ImageList inputImgs;
-                            RenderRoIRetCode ret = inputEffect->renderRoI(inArgs, &inputImgs); //< requested bitdepth
+                            RenderRoIRetCode ret;
+                            {
+                                RenderSafetyUnlocker_RAII unlocker;
+                                ret = inputEffect->renderRoI(inArgs, &inputImgs); //< requested bitdepth
+                            }
                             if (ret != eRenderRoIRetCodeOk) {
                                 return ret;
                             }
@@ -4526,7 +5024,12 @@ EffectInstance::renderHandler(RenderArgs & args,
         
         Natron::StatusEnum st = eStatusOK;
         if (!identityProcessed) {
-            st = render_public(actionArgs);
+            ///The concatenated matrix is expressed at the requested scale: let the plug-in render if it needs full scale images
+            if (planes.hostTransform && actionArgs.mappedScale.x == actionArgs.originalScale.x) {
+                st = renderHostTransform(*planes.hostTransform, actionArgs);
+            } else {
+                st = render_public(actionArgs);
+            }
         }
         
         renderAborted = aborted();
@@ -5312,6 +5815,75 @@ EffectInstance::isDoingInteractAction() const
     return _imp->duringInteractAction;
 }
 
+Natron::StatusEnum
+EffectInstance::renderHostTransform(const HostTransform& transform,
+                                    const RenderActionArgs& args)
+{
+    assert(transform.input && transform.matrix);
+    
+    ///The region of the chain input read by the filter
+    double det = Transform::matDeterminant(*transform.matrix);
+    if (det == 0.) {
+        return eStatusFailed;
+    }
+    Transform::Matrix3x3 inverse = Transform::matInverse(*transform.matrix, det);
+    RectD inputRegion;
+    Transform::transformRegionFromRoD(RectD(args.roi.x1, args.roi.y1, args.roi.x2, args.roi.y2), inverse, inputRegion);
+    int radius = getTransformFilterRadius(transform.filter) + 1;
+    RectI inputRoI((int)std::floor(inputRegion.x1) - radius, (int)std::floor(inputRegion.y1) - radius,
+                   (int)std::ceil(inputRegion.x2) + radius, (int)std::ceil(inputRegion.y2) + radius);
+    
+    unsigned int mipMapLevel = Image::getLevelFromScale(args.originalScale.x);
+    
+    for (std::list<std::pair<ImageComponents,ImagePtr> >::const_iterator it = args.outputPlanes.begin(); it != args.outputPlanes.end(); ++it) {
+        const ImagePtr& dstImg = it->second;
+        
+        std::list<Natron::ImageComponents> comps;
+        comps.push_back(dstImg->getComponents());
+        RenderRoIArgs inArgs(args.time,
+                             args.originalScale,
+                             mipMapLevel,
+                             args.view,
+                             args.byPassCache,
+                             inputRoI,
+                             RectD(),
+                             comps,
+                             dstImg->getBitDepth(),
+                             this);
+        ImageList inputPlanes;
+        RenderRoIRetCode ret;
+        {
+            RenderSafetyUnlocker_RAII unlocker;
+            ret = transform.input->renderRoI(inArgs, &inputPlanes);
+        }
+        if (ret == eRenderRoIRetCodeFailed) {
+            return eStatusFailed;
+        } else if (ret == eRenderRoIRetCodeAborted) {
+            ///The caller checks for abortion
+            return eStatusOK;
+        }
+        if (inputPlanes.empty()) {
+            dstImg->fillZero(args.roi);
+            continue;
+        }
+        
+        ImagePtr srcImg = inputPlanes.front();
+        if (srcImg->getComponents() != dstImg->getComponents() || srcImg->getBitDepth() != dstImg->getBitDepth()) {
+            ImagePtr converted(new Image(dstImg->getComponents(), srcImg->getRoD(), srcImg->getBounds(), srcImg->getMipMapLevel(),
+                                         srcImg->getPixelAspectRatio(), dstImg->getBitDepth(), false));
+            srcImg->convertToFormat(srcImg->getBounds(),
+                                    getApp()->getDefaultColorSpaceForBitDepth(srcImg->getBitDepth()),
+                                    getApp()->getDefaultColorSpaceForBitDepth(dstImg->getBitDepth()),
+                                    3, false, false, converted.get());
+            srcImg = converted;
+        }
+        if (!Natron::transformImage(*srcImg, *transform.matrix, transform.filter, args.roi, dstImg.get())) {
+            return eStatusFailed;
+        }
+    }
+    return eStatusOK;
+}
+
 Natron::StatusEnum
 EffectInstance::render_public(const RenderActionArgs& args)
 {
@@ -6610,6 +7182,46 @@ EffectInstance::getCurrentView() const
     return 0;
 }
 
+EffectInstance::RenderStatistics
+EffectInstance::getRenderStatistics() const
+{
+    RenderStatistics ret;
+    ret.nRenders = _imp->nRenders.fetchAndAddRelaxed(0);
+    ret.renderTime = _imp->renderTime.get();
+    ret.busyTime = _imp->busyTime.get();
+    ret.lockWaitTime = _imp->lockWaitTime.get();
+    if (_imp->activeRenders.fetchAndAddRelaxed(0) > 0) {
+        ret.busyTime += std::max(0., _imp->renderStatsClock.getTimeSinceCreation() - _imp->busyStartTimeMS.fetchAndAddRelaxed(0) / 1000.);
+    }
+    return ret;
+}
+
+void
+EffectInstance::resetRenderStatistics()
+{
+    ///Called before a render starts, when the render action is not running
+    _imp->nRenders.fetchAndStoreRelaxed(0);
+    _imp->renderTime.reset();
+    _imp->busyTime.reset();
+    _imp->lockWaitTime.reset();
+    _imp->busyStartTimeMS.fetchAndStoreRelaxed( (int)(_imp->renderStatsClock.getTimeSinceCreation() * 1000.) );
+}
+
+const KnobValuesSnapshot*
+EffectInstance::getRenderKnobValuesSnapshot() const
+{
+    ///Values set in the main-thread (e.g: by knobChanged) must be seen right away and analysis renders
+    ///may set values themselves, so only the other render threads use the snapshot.
+    if ( QThread::currentThread() == qApp->thread() || !_imp->frameRenderArgs.hasLocalData() ) {
+        return 0;
+    }
+    const ParallelRenderArgs& args = _imp->frameRenderArgs.localData();
+    if (!args.validArgs || args.isAnalysis) {
+        return 0;
+    }
+    return args.knobValues.get();
+}
+
 SequenceTime
 EffectInstance::getFrameRenderArgsCurrentTime() const
 {
@@ -6645,31 +7257,63 @@ EffectInstance::checkCanSetValueAndWarn() const
 }
 #endif
 
-static
-void isFrameVaryingOrAnimated_impl(const Natron::EffectInstance* node,bool *ret)
+bool
+EffectInstance::isFrameVaryingOrAnimated_Recursive() const
 {
-    if (node->isFrameVarying() || node->getHasAnimation() || node->getNode()->getRotoContext()) {
-        *ret = true;
-    } else {
-        int maxInputs = node->getMaxInputCount();
-        for (int i = 0; i < maxInputs; ++i) {
-            Natron::EffectInstance* input = node->getInput(i);
-            if (input) {
-                isFrameVaryingOrAnimated_impl(input,ret);
-                if (*ret) {
-                    return;
-                }
-            }
+    if (isFrameVarying() || getHasAnimation() || getNode()->getRotoContext()) {
+        return true;
+    }
+    
+    ///The hash of the node changes whenever a parameter or the hash of an input changes, hence the result of the
+    ///analysis of the tree upstream remains valid as long as the hash is the same.
+    U64 hash = getHash();
+    {
+        QMutexLocker k(&_imp->timeInvarianceMutex);
+        if (_imp->timeInvarianceValid && _imp->timeInvarianceHash == hash) {
+            return _imp->upstreamFrameVaryingOrAnimated;
+        }
+    }
+    
+    bool ret = false;
+    int maxInputs = getMaxInputCount();
+    for (int i = 0; i < maxInputs; ++i) {
+        Natron::EffectInstance* input = getInput(i);
+        if (input && input->isFrameVaryingOrAnimated_Recursive()) {
+            ret = true;
+            break;
         }
     }
+    
+    QMutexLocker k(&_imp->timeInvarianceMutex);
+    if (!_imp->timeInvarianceValid || _imp->timeInvarianceHash != hash) {
+        _imp->timeInvarianceValid = true;
+        _imp->timeInvarianceHash = hash;
+        _imp->invariantRenderTimeSet = false;
+    }
+    _imp->upstreamFrameVaryingOrAnimated = ret;
+    return ret;
 }
 
 bool
-EffectInstance::isFrameVaryingOrAnimated_Recursive() const
+EffectInstance::getTimeInvariantRenderTime(U64 nodeHash,
+                                           SequenceTime time,
+                                           SequenceTime* invariantTime) const
 {
-    bool ret = false;
-    isFrameVaryingOrAnimated_impl(this,&ret);
-    return ret;
+    ///Outputs must be rendered at every time they are asked for (e.g: writers write a file per frame)
+    if (isOutput() || isWriter() || isFrameVaryingOrAnimated_Recursive()) {
+        return false;
+    }
+    QMutexLocker k(&_imp->timeInvarianceMutex);
+    if (!_imp->timeInvarianceValid || _imp->timeInvarianceHash != nodeHash) {
+        ///The hash of the render is not the current hash of the node, don't share anything
+        return false;
+    }
+    if (!_imp->invariantRenderTimeSet) {
+        _imp->invariantRenderTimeSet = true;
+        _imp->invariantRenderTime = time;
+    }
+    *invariantTime = _imp->invariantRenderTime;
+    return true;
 }
 
 bool
@@ -6762,10 +7406,10 @@ OutputEffectInstance::renderFullSequence(BlockingBackgroundRender* renderControl
 }
 
 void
-OutputEffectInstance::notifyRenderFinished()
+OutputEffectInstance::notifyRenderFinished(bool aborted)
 {
     if (_renderController) {
-        _renderController->notifyFinished();
+        _renderController->notifyFinished(aborted);
         _renderController = 0;
     }
 }
@@ -75,6 +75,7 @@ class NodeSerialization;
 class ViewerInstance;
 class RenderEngine;
 class BufferableObject;
+class KnobValuesSnapshot;
 namespace Natron {
 class OutputEffectInstance;
 }
@@ -145,6 +146,9 @@ struct ParallelRenderArgs
     ///whereas afterwards we revert back to the plug-in thread safety
     Natron::RenderSafetyEnum currentThreadSafety;
     
+    ///The values of the knobs of the node at the time of the frame, shared by all threads rendering the frame
+    boost::shared_ptr<KnobValuesSnapshot> knobValues;
+    
     ParallelRenderArgs()
     : time(0)
     , timeline(0)
@@ -162,6 +166,7 @@ struct ParallelRenderArgs
     , isDuringPaintStrokeCreation(false)
     , rotoPaintNodes()
     , currentThreadSafety(Natron::eRenderSafetyInstanceSafe)
+    , knobValues()
     {
         
     }
@@ -565,6 +570,8 @@ public:
      * @param args See the definition of the class for comments on each argument.
      * The return code indicates whether the render succeeded or failed. Note that this function may succeed
      * and return 0 plane if the RoI does not intersect the RoD of the effect.
+     * Concurrent calls for the same image (same hash, time, view, mipmap level, render window, planes and bit depth)
+     * share a single computation. A view invariant effect renders the main view for all views.
      **/
     RenderRoIRetCode renderRoI(const RenderRoIArgs & args,std::list<boost::shared_ptr<Image> >* outputPlanes) WARN_UNUSED_RETURN;
 
@@ -719,6 +726,8 @@ public:
     virtual SequenceTime getCurrentTime() const OVERRIDE WARN_UNUSED_RETURN;
 
     virtual int getCurrentView() const OVERRIDE WARN_UNUSED_RETURN;
+    
+    virtual const KnobValuesSnapshot* getRenderKnobValuesSnapshot() const OVERRIDE FINAL WARN_UNUSED_RETURN;
 
     virtual bool getCanTransform() const { return false; }
 
@@ -736,6 +745,18 @@ public:
         boost::shared_ptr<Transform::Matrix3x3> cat;
     };
 
+    /**
+     * @brief Set when this effect is the last transform of a concatenated chain and the host resamples the chain
+     * instead of the plug-in: the render action is replaced by a single resampling of the image of input,
+     * the effect at the top of the chain, by matrix.
+     **/
+    struct HostTransform
+    {
+        Natron::EffectInstance* input;
+        boost::shared_ptr<Transform::Matrix3x3> matrix; //< the chain and this effect's transform, in pixel coordinates
+        Natron::TransformFilterEnum filter;
+    };
+
     virtual void rerouteInputAndSetTransform(const std::list<InputMatrix>& /*inputTransforms*/) {}
 
     virtual void clearTransform(int /*inputNb*/) {}
@@ -760,6 +781,13 @@ public:
      **/
     bool isFrameVaryingOrAnimated_Recursive() const;
 
+    /**
+     * @brief If neither this node nor its tree upstream is frame varying or animated, returns true and sets invariantTime
+     * to the time at which the renders of this node for the given hash are issued, so that they are shared across the sequence.
+     * Writers and other output nodes are never time-invariant.
+     **/
+    bool getTimeInvariantRenderTime(U64 nodeHash, SequenceTime time, SequenceTime* invariantTime) const WARN_UNUSED_RETURN;
+
 
     virtual bool isMultiPlanar() const { return false; }
 
@@ -1178,6 +1206,30 @@ public:
 
     bool isDuringPaintStrokeCreationThreadLocal() const;
     Natron::RenderSafetyEnum getCurrentThreadSafetyThreadLocal() const;
+    
+    /**
+     * @brief Statistics about the calls to the render action since resetRenderStatistics() was last called.
+     * The effective parallelism of the effect is renderTime / busyTime: it is 1 when all renders were serialized.
+     **/
+    struct RenderStatistics
+    {
+        int nRenders;
+        double renderTime; //< time spent in the render action by all threads, in seconds
+        double busyTime; //< wall-clock time during which at least one thread was in the render action, in seconds
+        double lockWaitTime; //< time spent by all threads waiting for the thread-safety lock of the effect, in seconds
+        
+        RenderStatistics()
+        : nRenders(0)
+        , renderTime(0)
+        , busyTime(0)
+        , lockWaitTime(0)
+        {
+        }
+    };
+    
+    RenderStatistics getRenderStatistics() const;
+    
+    void resetRenderStatistics();
 
     struct PlaneToRender
     {
@@ -1228,12 +1280,15 @@ public:
         bool isBeingRenderedElsewhere;
         Natron::ImagePremultiplicationEnum outputPremult;
         std::map<int,Natron::ImagePremultiplicationEnum> inputPremult;
+        boost::shared_ptr<HostTransform> hostTransform;
         
         ImagePlanesToRender()
         : rectsToRender()
         , planes()
         , isBeingRenderedElsewhere(false)
         , outputPremult(eImagePremultiplicationPremultiplied)
+        , inputPremult()
+        , hostTransform()
         {
         
         }
@@ -1536,6 +1591,11 @@ private:
 
 
 
+    /**
+     * @brief Same as renderRoI but does not share the computation with other threads requesting the same image.
+     **/
+    RenderRoIRetCode renderRoIUnshared(const RenderRoIArgs & args,std::list<boost::shared_ptr<Image> >* outputPlanes) WARN_UNUSED_RETURN;
+
     /**
      * @brief The internal of renderRoI, mainly it calls render and handles the thread safety of the effect.
      * @param time The time at which to render
@@ -1600,9 +1660,17 @@ private:
 
     /**
      * @brief Check if Transform effects concatenation is possible on the current node and node upstream.
+     * If the host resamples concatenated transforms (see Settings::getHostTransformFilter) and this effect is itself
+     * the last transform of a chain, hostTransform is set.
      **/
     void tryConcatenateTransforms(const RenderRoIArgs& args,
-                                  std::list<InputMatrix>* inputTransforms);
+                                  std::list<InputMatrix>* inputTransforms,
+                                  boost::shared_ptr<HostTransform>* hostTransform);
+    
+    /**
+     * @brief Replaces the render action when the host resamples a chain of transforms ending with this effect.
+     **/
+    Natron::StatusEnum renderHostTransform(const HostTransform& transform,const RenderActionArgs& args);
 
     /**
      * @brief Called by getImage when the thread-storage was not set by the caller thread (mostly because this is a thread that is not
@@ -1820,7 +1888,10 @@ public:
      **/
     void renderFullSequence(BlockingBackgroundRender* renderController,int first,int last);
 
-    void notifyRenderFinished();
+    /**
+     * @brief Called when the render started by renderFullSequence is over, aborted is true if it was aborted or failed.
+     **/
+    void notifyRenderFinished(bool aborted);
 
     void renderCurrentFrame(bool canAbort);
 
@@ -83,12 +83,15 @@ SOURCES += \
     ImageKey.cpp \
     ImageMaskMix.cpp \
     ImageParamsSerialization.cpp \
+    ImagePlaneWrapper.cpp \
+    ImageTransform.cpp \
     Interpolation.cpp \
     Knob.cpp \
     KnobSerialization.cpp \
     KnobFactory.cpp \
     KnobFile.cpp \
     KnobTypes.cpp \
+    KnobValuesSnapshot.cpp \
     LibraryBinary.cpp \
     Log.cpp \
     Lut.cpp \
@@ -117,6 +120,7 @@ SOURCES += \
     Project.cpp \
     ProjectPrivate.cpp \
     ProjectSerialization.cpp \
+    RenderBenchmark.cpp \
     PySideCompat.cpp \
     Rect.cpp \
     RotoContext.cpp \
@@ -208,6 +212,8 @@ HEADERS += \
     ImageSerialization.h \
     ImageParams.h \
     ImageParamsSerialization.h \
+    ImagePlaneWrapper.h \
+    ImageTransform.h \
     Interpolation.h \
     KeyHelper.h \
     Knob.h \
@@ -217,6 +223,7 @@ HEADERS += \
     KnobFactory.h \
     KnobFile.h \
     KnobTypes.h \
+    KnobValuesSnapshot.h \
     LibraryBinary.h \
     Log.h \
     LRUHashTable.h \
@@ -250,6 +257,7 @@ HEADERS += \
     Project.h \
     ProjectPrivate.h \
     ProjectSerialization.h \
+    RenderBenchmark.h \
     Pyside_Engine_Python.h \
     Rect.h \
     RotoContext.h \
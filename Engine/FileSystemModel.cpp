@@ -12,6 +12,7 @@
 
 #include "FileSystemModel.h"
 
+#include <algorithm>
 #include <vector>
 
 CLANG_DIAG_OFF(deprecated)
@@ -25,11 +26,16 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QDebug>
 #include <QtCore/QUrl>
 #include <QtCore/QMimeData>
+#include <QtCore/QDirIterator>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
 #include <SequenceParsing.h>
 
+#include "Engine/Timer.h"
+
 
 
 static QStringList getSplitPath(const QString& path)
@@ -238,17 +244,49 @@ void
 FileSystemItem::addChild(const boost::shared_ptr<SequenceParsing::SequenceFromFiles>& sequence,
               const QFileInfo& info)
 {
+    ///Create the child before locking since it may query the file system
+    boost::shared_ptr<FileSystemItem> child = createChild(sequence, info);
+    
     QMutexLocker l(&_imp->childrenMutex);
     ///Does the child exist already ?
-    QString filename = sequence ? sequence->generateUserFriendlySequencePattern().c_str() : info.fileName();
-    
     for (std::vector<boost::shared_ptr<FileSystemItem> >::iterator it = _imp->children.begin(); it!=_imp->children.end();++it) {
-        if ((*it)->fileName() == filename) {
+        if ((*it)->fileName() == child->fileName()) {
             _imp->children.erase(it);
             break;
         }
     }
     
+    _imp->children.push_back(child);
+    
+}
+
+void
+FileSystemItem::addChildren(const std::vector<boost::shared_ptr<FileSystemItem> >& children,
+                            const std::set<boost::shared_ptr<FileSystemItem> >& replacedChildren)
+{
+    QSet<QString> names;
+    for (std::vector<boost::shared_ptr<FileSystemItem> >::const_iterator it = children.begin(); it != children.end(); ++it) {
+        names.insert( (*it)->fileName() );
+    }
+    
+    QMutexLocker l(&_imp->childrenMutex);
+    std::vector<boost::shared_ptr<FileSystemItem> > merged;
+    merged.reserve( _imp->children.size() + children.size() );
+    for (std::vector<boost::shared_ptr<FileSystemItem> >::iterator it = _imp->children.begin(); it != _imp->children.end(); ++it) {
+        ///The name of a sequence changes as files are added to it: earlier items are removed by identity
+        if ( !names.contains( (*it)->fileName() ) && ( replacedChildren.find(*it) == replacedChildren.end() ) ) {
+            merged.push_back(*it);
+        }
+    }
+    merged.insert( merged.end(), children.begin(), children.end() );
+    _imp->children.swap(merged);
+}
+
+boost::shared_ptr<FileSystemItem>
+FileSystemItem::createChild(const boost::shared_ptr<SequenceParsing::SequenceFromFiles>& sequence,
+                            const QFileInfo& info)
+{
+    QString filename = sequence ? sequence->generateUserFriendlySequencePattern().c_str() : info.fileName();
     
     bool isDir = sequence ? false : info.isDir();
     qint64 size;
@@ -258,16 +296,23 @@ FileSystemItem::addChild(const boost::shared_ptr<SequenceParsing::SequenceFromFi
         size = isDir ? 0 : info.size();
     }
     
-    
-    ///Create the child
-    boost::shared_ptr<FileSystemItem> child( new FileSystemItem(isDir,
-                                                                filename,
-                                                                sequence,
-                                                                info.lastModified(),
-                                                                size,
-                                                                this) );
-    _imp->children.push_back(child);
-    
+    return boost::shared_ptr<FileSystemItem>( new FileSystemItem(isDir,
+                                                                 filename,
+                                                                 sequence,
+                                                                 info.lastModified(),
+                                                                 size,
+                                                                 this) );
+}
+
+bool
+FileSystemItem::replaceChildren(const std::vector<boost::shared_ptr<FileSystemItem> >& children)
+{
+    QMutexLocker l(&_imp->childrenMutex);
+    if ( children.size() < _imp->children.size() ) {
+        return false;
+    }
+    _imp->children = children;
+    return true;
 }
 
 void
@@ -370,6 +415,7 @@ FileSystemModel::FileSystemModel(SortableViewI* view)
 , _imp(new FileSystemModelPrivate(this,view))
 {
     QObject::connect(&_imp->gatherer, SIGNAL(directoryLoaded(QString)), this, SLOT(onDirectoryLoadedByGatherer(QString)));
+    QObject::connect(&_imp->gatherer, SIGNAL(directoryPartiallyLoaded(QString)), this, SLOT(onDirectoryPartiallyLoadedByGatherer(QString)));
     
     
     _imp->headers << tr("Name") << tr("Size") << tr("Type") << tr("Date Modified");
@@ -996,6 +1042,17 @@ FileSystemModel::onDirectoryLoadedByGatherer(const QString& directory)
     Q_EMIT directoryLoaded(directory);
 }
 
+void
+FileSystemModel::onDirectoryPartiallyLoadedByGatherer(const QString& directory)
+{
+    if ( directory != _imp->currentRootPath || !_imp->getItemFromPath(directory) ) {
+        return;
+    }
+    
+    ///The files found so far can be shown, the directory will be watched once it is completely loaded
+    Q_EMIT directoryLoaded(directory);
+}
+
 void
 FileSystemModel::onWatchedDirectoryChanged(const QString& directory)
 {
@@ -1266,7 +1323,114 @@ static bool isVideoFileExtension(const std::string& ext)
     return false;
 }
 
-typedef std::list< std::pair< boost::shared_ptr<SequenceParsing::SequenceFromFiles> ,QFileInfo > > FileSequences;
+///Number of entries of a directory processed between 2 checks of the time elapsed since partial results were last shown
+#define GATHERER_PARTIAL_RESULTS_CHECK_PERIOD 1000
+
+///Minimum time in seconds between 2 updates of the partial results of a directory being gathered
+#define GATHERER_PARTIAL_RESULTS_INTERVAL 0.5
+
+namespace {
+    
+/**
+ * @brief An entry of a directory being gathered: a directory, a file or a file sequence.
+ **/
+struct GatheredEntry
+{
+    boost::shared_ptr<SequenceParsing::SequenceFromFiles> sequence;
+    QFileInfo info;
+    
+    ///The item last shown in the view for this entry, or NULL if it was not shown yet or has changed since then
+    boost::shared_ptr<FileSystemItem> published;
+    
+    GatheredEntry(const boost::shared_ptr<SequenceParsing::SequenceFromFiles>& sequence,
+                  const QFileInfo& info)
+    : sequence(sequence)
+    , info(info)
+    , published()
+    {
+    }
+};
+
+struct FileInfoNameLess
+{
+    bool operator()(const QFileInfo& lhs,const QFileInfo& rhs) const
+    {
+        return lhs.fileName().compare(rhs.fileName(), Qt::CaseInsensitive) < 0;
+    }
+};
+
+struct FileInfoTypeLess
+{
+    bool operator()(const QFileInfo& lhs,const QFileInfo& rhs) const
+    {
+        int r = lhs.suffix().compare(rhs.suffix(), Qt::CaseInsensitive);
+        if (r == 0) {
+            r = lhs.fileName().compare(rhs.fileName(), Qt::CaseInsensitive);
+        }
+        return r < 0;
+    }
+};
+
+}
+
+/**
+ * @brief Returns a key shared by all the files that may belong to the same sequence as filename: files of a sequence
+ * only differ by their numbers, so each number is replaced by a single '#'. Files with different keys never
+ * belong to the same sequence, files with the same key still have to be checked with SequenceFromFiles::tryInsertFile.
+ **/
+static QString
+makeSequenceGroupingKey(const QString& filename)
+{
+    QString key;
+    key.reserve( filename.size() );
+    bool inNumber = false;
+    for (int i = 0; i < filename.size(); ++i) {
+        const QChar& c = filename[i];
+        bool isNumber = c.isDigit() || ( c == QChar('-') && i + 1 < filename.size() && filename[i + 1].isDigit() );
+        if (isNumber) {
+            if (!inNumber) {
+                key.push_back( QChar('#') );
+            }
+        } else {
+            key.push_back( c.toLower() );
+        }
+        inNumber = isNumber;
+    }
+    return key;
+}
+
+/**
+ * @brief Lists the entries of dir sorted according to sort. When sorting by name or type the entries are listed
+ * with a QDirIterator which does not query the file system for each file (the file type is known from the directory
+ * listing on most systems): the size and the modification date are only read later for the items shown.
+ **/
+static QFileInfoList
+listDirectoryEntries(const QDir& dir,
+                     QDir::Filters filters,
+                     FileSystemModel::Sections sortSection)
+{
+    switch (sortSection) {
+        case FileSystemModel::Size:
+            return dir.entryInfoList(filters, QDir::Size | QDir::IgnoreCase);
+        case FileSystemModel::DateModified:
+            return dir.entryInfoList(filters, QDir::Time | QDir::IgnoreCase);
+        default:
+            break;
+    }
+    
+    QFileInfoList all;
+    QDirIterator it(dir.absolutePath(), filters);
+    while ( it.hasNext() ) {
+        it.next();
+        all.push_back( it.fileInfo() );
+    }
+    if (sortSection == FileSystemModel::Type) {
+        std::sort( all.begin(), all.end(), FileInfoTypeLess() );
+    } else {
+        std::sort( all.begin(), all.end(), FileInfoNameLess() );
+    }
+    return all;
+}
 
 #define KERNEL_INCR() \
     switch (viewOrder) \
@@ -1287,30 +1451,23 @@ FileGathererThread::gatheringKernel(const boost::shared_ptr<FileSystemItem>& ite
     
     Qt::SortOrder viewOrder = _imp->model->sortIndicatorOrder();
     FileSystemModel::Sections sortSection = (FileSystemModel::Sections)_imp->model->sortIndicatorSection();
-    QDir::SortFlags sort;
-    switch (sortSection) {
-        case FileSystemModel::Name:
-            sort = QDir::Name;
-            break;
-        case FileSystemModel::Size:
-            sort = QDir::Size;
-            break;
-        case FileSystemModel::Type:
-            sort = QDir::Type;
-            break;
-        case FileSystemModel::DateModified:
-            sort = QDir::Time;
-            break;
-        default:
-            break;
-    }
-    sort |= QDir::IgnoreCase;
     
     ///All entries in the directory
-    QFileInfoList all = dir.entryInfoList(_imp->model->filter(), sort);
+    QFileInfoList all = listDirectoryEntries(dir, _imp->model->filter(), sortSection);
     
-    ///List of all possible file sequences in the directory or directories
-    FileSequences sequences;
+    ///List of all possible file sequences in the directory or directories, in the order they must appear
+    std::vector<GatheredEntry> sequences;
+    
+    ///Indexes in sequences of the file sequences, by grouping key (see makeSequenceGroupingKey)
+    QHash<QString,std::vector<std::size_t> > sequencesByKey;
+    
+    const bool sequenceModeEnabled = _imp->model->isSequenceModeEnabled();
+    TimeLapse gatheringTimer;
+    double partialResultsTime = 0.;
+    
+    ///All the items shown while gathering, they are replaced by the final children
+    std::set<boost::shared_ptr<FileSystemItem> > publishedItems;
+    int nProcessed = 0;
     
     int start = 0;
     int end = 0;
@@ -1332,10 +1489,33 @@ FileGathererThread::gatheringKernel(const boost::shared_ptr<FileSystemItem>& ite
         if ( _imp->checkForAbort() ) {
             return;
         }
-                
+        
+        ///Show what was found so far in large directories
+        if ( ++nProcessed % GATHERER_PARTIAL_RESULTS_CHECK_PERIOD == 0 &&
+             gatheringTimer.getTimeSinceCreation() - partialResultsTime >= GATHERER_PARTIAL_RESULTS_INTERVAL ) {
+            partialResultsTime = gatheringTimer.getTimeSinceCreation();
+            std::vector<boost::shared_ptr<FileSystemItem> > children;
+            children.reserve( sequences.size() );
+            for (std::vector<GatheredEntry>::iterator it = sequences.begin(); it != sequences.end(); ++it) {
+                if (!it->published) {
+                    ///The sequence keeps being filled by this thread: the view is given a copy
+                    boost::shared_ptr<SequenceParsing::SequenceFromFiles> snapshot;
+                    if (it->sequence) {
+                        snapshot.reset( new SequenceParsing::SequenceFromFiles(*it->sequence) );
+                    }
+                    it->published = item->createChild(snapshot, it->info);
+                    publishedItems.insert(it->published);
+                }
+                children.push_back(it->published);
+            }
+            if ( item->replaceChildren(children) ) {
+                Q_EMIT directoryPartiallyLoaded( item->absoluteFilePath() );
+            }
+        }
+        
         if ( all[i].isDir() ) {
             ///This is a directory
-            sequences.push_back(std::make_pair(boost::shared_ptr<SequenceParsing::SequenceFromFiles>(), all[i]));
+            sequences.push_back( GatheredEntry(boost::shared_ptr<SequenceParsing::SequenceFromFiles>(), all[i]) );
         } else {
             
 
@@ -1348,8 +1528,8 @@ FileGathererThread::gatheringKernel(const boost::shared_ptr<FileSystemItem>& ite
             }
             
             /// If file sequence fetching is disabled, accept it
-            if ( !_imp->model->isSequenceModeEnabled() ) {
-                sequences.push_back(std::make_pair(boost::shared_ptr<SequenceParsing::SequenceFromFiles>(), all[i]));
+            if (!sequenceModeEnabled) {
+                sequences.push_back( GatheredEntry(boost::shared_ptr<SequenceParsing::SequenceFromFiles>(), all[i]) );
                 KERNEL_INCR();
                 continue;
             }
@@ -1363,12 +1543,17 @@ FileGathererThread::gatheringKernel(const boost::shared_ptr<FileSystemItem>& ite
             /// to create a new one
             SequenceParsing::FileNameContent fileContent(absoluteFilePath);
             
-            if (!isVideoFileExtension(fileContent.getExtension())) {
+            bool isVideo = isVideoFileExtension( fileContent.getExtension() );
+            std::vector<std::size_t>* candidates = 0;
+            if (!isVideo) {
+                candidates = &sequencesByKey[makeSequenceGroupingKey(filename)];
                 ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
-                for (FileSequences::reverse_iterator it = sequences.rbegin(); it != sequences.rend(); ++it) {
+                for (std::vector<std::size_t>::reverse_iterator it = candidates->rbegin(); it != candidates->rend(); ++it) {
                     
-                    if ( it->first && it->first->tryInsertFile(fileContent,false) ) {
+                    GatheredEntry& entry = sequences[*it];
+                    if ( entry.sequence->tryInsertFile(fileContent,false) ) {
                         
+                        entry.published.reset();
                         foundMatchingSequence = true;
                         break;
                     }
@@ -1378,7 +1563,10 @@ FileGathererThread::gatheringKernel(const boost::shared_ptr<FileSystemItem>& ite
             
             if (!foundMatchingSequence) {
                 boost::shared_ptr<SequenceParsing::SequenceFromFiles> newSequence( new SequenceParsing::SequenceFromFiles(fileContent,true) );
-                sequences.push_back(std::make_pair(newSequence, all[i]));
+                if (candidates) {
+                    candidates->push_back( sequences.size() );
+                }
+                sequences.push_back( GatheredEntry(newSequence, all[i]) );
 
             }
             
@@ -1387,9 +1575,12 @@ FileGathererThread::gatheringKernel(const boost::shared_ptr<FileSystemItem>& ite
     }
     
     ///Now iterate through the sequences and create the children as necessary
-    for (FileSequences::iterator it = sequences.begin(); it != sequences.end(); ++it) {
-        item->addChild(it->first, it->second);
+    std::vector<boost::shared_ptr<FileSystemItem> > children;
+    children.reserve( sequences.size() );
+    for (std::vector<GatheredEntry>::iterator it = sequences.begin(); it != sequences.end(); ++it) {
+        children.push_back( it->published ? it->published : item->createChild(it->sequence, it->info) );
     }
+    item->addChildren(children, publishedItems);
     
     Q_EMIT directoryLoaded( item->absoluteFilePath() );
 }
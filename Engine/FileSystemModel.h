@@ -15,6 +15,9 @@
 // "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
 #include <Python.h>
 
+#include <set>
+#include <vector>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -87,6 +90,27 @@ public:
     void addChild(const boost::shared_ptr<SequenceParsing::SequenceFromFiles>& sequence,
                   const QFileInfo& info);
     
+    /**
+     * @brief Same as calling addChild(child) for each of the given children but in linear time, MT-safe.
+     * The children in replacedChildren (e.g: items shown while the directory was being gathered) are removed as well.
+     **/
+    void addChildren(const std::vector<boost::shared_ptr<FileSystemItem> >& children,
+                     const std::set<boost::shared_ptr<FileSystemItem> >& replacedChildren);
+    
+    /**
+     * @brief Creates a child item of this item for the given sequence (or the file/directory described by info if sequence
+     * is NULL) without adding it to the children.
+     **/
+    boost::shared_ptr<FileSystemItem> createChild(const boost::shared_ptr<SequenceParsing::SequenceFromFiles>& sequence,
+                                                  const QFileInfo& info);
+    
+    /**
+     * @brief Replaces all children by the given ones, MT-safe. This is used to show the content of a directory
+     * while it is still being gathered: since the views are not notified of the rows being removed, this does nothing
+     * and returns false if there are less items in children than there are children currently.
+     **/
+    bool replaceChildren(const std::vector<boost::shared_ptr<FileSystemItem> >& children);
+    
     /**
      * @brief Remove all children, MT-safe
      **/
@@ -129,6 +153,8 @@ Q_SIGNALS:
     
     void directoryLoaded(QString);
     
+    ///Emitted while a large directory is gathered, each time the children of its item were updated with the files found so far
+    void directoryPartiallyLoaded(QString);
 
 private:
     
@@ -287,6 +313,8 @@ public Q_SLOTS:
     
     void onDirectoryLoadedByGatherer(const QString& directory);
     
+    void onDirectoryPartiallyLoadedByGatherer(const QString& directory);
+    
     void onWatchedDirectoryChanged(const QString& directory);
     
     void onWatchedFileChanged(const QString& file);
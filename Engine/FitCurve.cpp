@@ -6,6 +6,8 @@
 #include "FitCurve.h"
 
 #include <cmath>
+#include <list>
+#include <map>
 
 #ifndef M_PI_2
 #define M_PI_2      1.57079632679489661923132169163975144   /* pi/2           */
@@ -76,10 +78,10 @@ static Point computeCenterTangent(const Point& prev,const Point& center,const Po
   *  @brief Evaluate a Bezier curve at a particular parameter value
   *
  **/
-static Point bezierEval(int degree, const std::vector<Point>& v, double t)
+static Point bezierEval(int degree, const Point* v, double t)
 {
-    std::vector<Point> 	vtemp(v.size());		/* Local copy of control points		*/
-    assert((int)v.size() == degree + 1);
+    Point vtemp[4]; /* Local copy of control points, the degree is at most 3 */
+    assert(degree >= 0 && degree <= 3);
     
     for (int i = 0; i <= degree; ++i) {
         vtemp[i] = v[i];
@@ -96,32 +98,47 @@ static Point bezierEval(int degree, const std::vector<Point>& v, double t)
 }
     
 /**
- * @brief Use Newton-Raphson iteration to find better root.
+ * @brief The control vertices of a cubic segment and of its first and second derivatives.
+ * They only depend on the segment so they are computed once for all the points being reparameterized.
  **/
-static double newtonRaphsonRootFind(const std::vector<Point>& Q, const Point& P, double u)
+struct BezierSegmentDerivatives
 {
-    std::vector<Point> Q1(3); // Q'
-    std::vector<Point> Q2(2); // Q''
-    Point Q_u, Q1_u, Q2_u; /*u evaluated at Q, Q', & Q''	*/
-    
-    // Compute Q(u)
-    Q_u = bezierEval(3, Q, u);
-    
-    // Generate control vertices for Q'
-    for (int i = 0; i < 3; ++i) {
-        Q1[i].x = (Q[i+1].x - Q[i].x) * 3.0;
-        Q1[i].y = (Q[i+1].y - Q[i].y) * 3.0;
+    Point Q[4]; // Q
+    Point Q1[3]; // Q'
+    Point Q2[2]; // Q''
+    
+    BezierSegmentDerivatives(const std::vector<SimpleBezierCP>& bezCurve)
+    {
+        Q[0] = bezCurve[0].p;
+        Q[1] = bezCurve[0].rightTan;
+        Q[2] = bezCurve[1].leftTan;
+        Q[3] = bezCurve[1].p;
+        
+        // Generate control vertices for Q'
+        for (int i = 0; i < 3; ++i) {
+            Q1[i].x = (Q[i+1].x - Q[i].x) * 3.0;
+            Q1[i].y = (Q[i+1].y - Q[i].y) * 3.0;
+        }
+        
+        // Generate control vertices for Q''
+        for (int i = 0; i < 2; ++i) {
+            Q2[i].x = (Q1[i+1].x - Q1[i].x) * 2.0;
+            Q2[i].y = (Q1[i+1].y - Q1[i].y) * 2.0;
+        }
     }
+};
     
-    // Generate control vertices for Q''
-    for (int i = 0; i < 2; ++i) {
-        Q2[i].x = (Q1[i+1].x - Q1[i].x) * 2.0;
-        Q2[i].y = (Q1[i+1].y - Q1[i].y) * 2.0;
-    }
+/**
+ * @brief Use Newton-Raphson iteration to find better root.
+ **/
+static double newtonRaphsonRootFind(const BezierSegmentDerivatives& seg, const Point& P, double u)
+{
+    Point Q_u, Q1_u, Q2_u; /*u evaluated at Q, Q', & Q''	*/
     
-    // Compute Q'(u) and Q''(u)
-    Q1_u = bezierEval(2, Q1, u);
-    Q2_u = bezierEval(1, Q2, u);
+    // Compute Q(u), Q'(u) and Q''(u)
+    Q_u = bezierEval(3, seg.Q, u);
+    Q1_u = bezierEval(2, seg.Q1, u);
+    Q2_u = bezierEval(1, seg.Q2, u);
     
     // Compute f(u)/f'(u)
     double numerator = (Q_u.x - P.x) * (Q1_u.x) + (Q_u.y - P.y) * (Q1_u.y);
@@ -140,16 +157,11 @@ static double newtonRaphsonRootFind(const std::vector<Point>& Q, const Point& P,
  * a better parameterization.
  *
  **/
-static void reparameterize(const std::vector<Point> &points, const std::vector<SimpleBezierCP>& bezCurve,  std::vector<double>& u)
+static void reparameterize(const Point* points, int nPoints, const std::vector<SimpleBezierCP>& bezCurve, std::vector<double>& u)
 {
-    std::vector<Point> bezSeg;
-    bezSeg.push_back(bezCurve[0].p);
-    bezSeg.push_back(bezCurve[0].rightTan);
-    bezSeg.push_back(bezCurve[1].leftTan);
-    bezSeg.push_back(bezCurve[1].p);
-
-    for (std::size_t i = 0; i < u.size(); ++i) {
-        u[i] = newtonRaphsonRootFind(bezSeg, points[i], u[i]);
+    BezierSegmentDerivatives seg(bezCurve);
+    for (int i = 0; i < nPoints; ++i) {
+        u[i] = newtonRaphsonRootFind(seg, points[i], u[i]);
     }
 }
     
@@ -157,17 +169,17 @@ static void reparameterize(const std::vector<Point> &points, const std::vector<S
   *	Find the maximum squared distance of digitized points
   *	to fitted curve.
  **/
-static double computeMaxError(const std::vector<Point>& points,const std::vector<SimpleBezierCP>& bezierCurve,
-                                  const std::vector<double>& u, int* splitPoint)
+static double computeMaxError(const Point* points, int nPoints, const std::vector<SimpleBezierCP>& bezierCurve,
+                              const std::vector<double>& u, int* splitPoint)
 {
-    *splitPoint = points.size() / 2;
+    *splitPoint = nPoints / 2;
     double maxDist = 0.0;
-    std::vector<Point> bezierSegment;
-    bezierSegment.push_back(bezierCurve[0].p);
-    bezierSegment.push_back(bezierCurve[0].rightTan);
-    bezierSegment.push_back(bezierCurve[1].leftTan);
-    bezierSegment.push_back(bezierCurve[1].p);
-    for (std::size_t i = 1; i < points.size() - 1; ++i) {
+    Point bezierSegment[4];
+    bezierSegment[0] = bezierCurve[0].p;
+    bezierSegment[1] = bezierCurve[0].rightTan;
+    bezierSegment[2] = bezierCurve[1].leftTan;
+    bezierSegment[3] = bezierCurve[1].p;
+    for (int i = 1; i < nPoints - 1; ++i) {
         Point p = bezierEval(3, bezierSegment, u[i]);
         Point v;
         v.x = p.x - points[i].x;
@@ -186,27 +198,21 @@ static double computeMaxError(const std::vector<Point>& points,const std::vector
  *	Assign parameter values to digitized points
  *	using relative distances between points.
 **/
-static void chordLengthParametrize(const std::vector<Point>& points,std::vector<double>* u)
+static void chordLengthParametrize(const Point* points, int nPoints, std::vector<double>* u)
 {
-    assert(points.size() > 1);
-    u->push_back(0.);
-    std::vector<Point>::const_iterator prev = points.begin();
-    std::vector<Point>::const_iterator cur = points.begin();
-    ++cur;
-    
-    for (; cur != points.end(); ++prev, ++cur) {
-        double last = u->back();
-        double dist = euclideanDistance(*cur, *prev);
-        u->push_back(last + dist);
+    assert(nPoints > 1);
+    if ((int)u->size() < nPoints) {
+        u->resize(nPoints);
     }
-    assert(u->size() == points.size());
-    double last = u->back();
+    (*u)[0] = 0.;
+    for (int i = 1; i < nPoints; ++i) {
+        (*u)[i] = (*u)[i - 1] + euclideanDistance(points[i], points[i - 1]);
+    }
+    double last = (*u)[nPoints - 1];
     assert(last != 0.);
     
-    std::vector<double>::iterator it = u->begin();
-    ++it;
-    for (; it != u->end(); ++it) {
-        *it /= last;
+    for (int i = 1; i < nPoints; ++i) {
+        (*u)[i] /= last;
     }
 }
     
@@ -238,61 +244,43 @@ static double Bezier3(double u)
 }
     
     
-static void generateBezier(const std::vector<Point>& points, const std::vector<double>& u, const Point& tHat1, const Point& tHat2,
+static void generateBezier(const Point* points, int nPoints, const std::vector<double>& u, const Point& tHat1, const Point& tHat2,
                            std::vector<SimpleBezierCP>* generatedBezier)
 {
-    assert(points.size() == u.size());
-    
-    std::vector<std::pair<Point,Point> > a(points.size()); // Precomputed rhs for eqn
-    for (std::size_t i = 0; i < points.size(); ++i) {
-        Point v1,v2;
-        v1 = tHat1;
-        v2 = tHat2;
-        v1.x *= Bezier1(u[i]);
-        v1.y *= Bezier1(u[i]);
-        
-        v2.x *= Bezier2(u[i]);
-        v2.y *= Bezier2(u[i]);
-        a[i].first = v1;
-        a[i].second = v2;
-    }
-    
-    assert(a.size() == points.size());
+    assert(nPoints <= (int)u.size());
     
     double c[2][2]; // Matrix C
     c[0][0] = c[0][1] = c[1][0] = c[1][1] = 0.0;
     double x[2]; // Matrix X
     x[0] = x[1] = 0.;
     
+    const Point& first = points[0];
+    const Point& last = points[nPoints - 1];
+    
     Point tmp;
-    for (std::size_t i = 0; i < points.size(); ++i) {
-        c[0][0] += dotProduct(a[i].first, a[i].first);
-        c[0][1] += dotProduct(a[i].first, a[i].second);
-        c[1][0] += c[0][1];
-        c[1][1] += dotProduct(a[i].second, a[i].second);
-        tmp = points[i];
-        
-        Point firstBezier0 = points[0];
-        firstBezier0.x *= Bezier0(u[i]);
-        firstBezier0.y *= Bezier0(u[i]);
+    for (int i = 0; i < nPoints; ++i) {
+        double b0 = Bezier0(u[i]);
+        double b1 = Bezier1(u[i]);
+        double b2 = Bezier2(u[i]);
+        double b3 = Bezier3(u[i]);
         
-        Point firstBezier1 = points[0];
-        firstBezier1.x *= Bezier1(u[i]);
-        firstBezier1.y *= Bezier1(u[i]);
+        // Rhs for eqn
+        Point a1,a2;
+        a1.x = tHat1.x * b1;
+        a1.y = tHat1.y * b1;
+        a2.x = tHat2.x * b2;
+        a2.y = tHat2.y * b2;
         
-        Point lastBezier3 = points[points.size() - 1];
-        lastBezier3.x *= Bezier3(u[i]);
-        lastBezier3.y *= Bezier3(u[i]);
-        
-        Point lastBezier2 = points[points.size() - 1];
-        lastBezier2.x *= Bezier2(u[i]);
-        lastBezier2.y *= Bezier2(u[i]);
+        c[0][0] += dotProduct(a1, a1);
+        c[0][1] += dotProduct(a1, a2);
+        c[1][0] += c[0][1];
+        c[1][1] += dotProduct(a2, a2);
         
-        tmp.x -= (firstBezier0.x + firstBezier1.x +  lastBezier2.x + lastBezier3.x);
-        tmp.y -= (firstBezier0.y + firstBezier1.y +  lastBezier2.y + lastBezier3.y);
+        tmp.x = points[i].x - (first.x * b0 + first.x * b1 + last.x * b2 + last.x * b3);
+        tmp.y = points[i].y - (first.y * b0 + first.y * b1 + last.y * b2 + last.y * b3);
         
-        x[0] += dotProduct(a[i].first, tmp);
-        x[1] += dotProduct(a[i].second, tmp);
+        x[0] += dotProduct(a1, tmp);
+        x[1] += dotProduct(a2, tmp);
     }
     
     //Compute the determinants of C and X
@@ -307,7 +295,7 @@ static void generateBezier(const std::vector<Point>& points, const std::vector<d
     // If alpha negative, use the Wu/Barsky heuristic (see text)
     // (if alpha is 0, you get coincident control points that lead to
     // divide by zero in any subsequent NewtonRaphsonRootFind() call.
-    double segLength = euclideanDistance(points[points.size() - 1], points[0]);
+    double segLength = euclideanDistance(last, first);
     double epsilon = 1.0e-6 * segLength;
     if (alpha_l < epsilon || alpha_r < epsilon) {
         // fall back on standard (probably inaccurate) formula, and subdivide further if needed.
@@ -320,9 +308,9 @@ static void generateBezier(const std::vector<Point>& points, const std::vector<d
     //  Control points 1 and 2 are positioned an alpha distance out
     //  on the tangent vectors, left and right, respectively
     SimpleBezierCP firstCp,lastCp;
-    firstCp.p = points[0];
+    firstCp.p = first;
     firstCp.leftTan = firstCp.p;
-    lastCp.p = points[points.size() - 1];
+    lastCp.p = last;
     lastCp.rightTan = lastCp.p;
     firstCp.rightTan.x = firstCp.p.x + tHat1.x * alpha_l;
     firstCp.rightTan.y = firstCp.p.y + tHat1.y * alpha_l;
@@ -333,7 +321,22 @@ static void generateBezier(const std::vector<Point>& points, const std::vector<d
     
 }
     
-static void fit_cubic_internal(const std::vector<Point>& points, const Point&  tHat1, const Point& tHat2, double error,
+/**
+ * @brief Buffers shared by all the recursion levels of fit_cubic_internal. The parameterization of a range
+ * is no longer needed once it has been split, so the same storage is reused by the sub-ranges.
+ **/
+struct FitCubicWorkspace
+{
+    std::vector<double> u;
+    
+    FitCubicWorkspace(std::size_t nPoints)
+    : u(nPoints)
+    {
+    }
+};
+    
+static void fit_cubic_internal(const Point* points, int nPoints, const Point&  tHat1, const Point& tHat2, double error,
+                               FitCubicWorkspace* workspace,
                                std::vector<SimpleBezierCP>* generatedBezier)
 {
     //Error below which you try iterating
@@ -342,9 +345,9 @@ static void fit_cubic_internal(const std::vector<Point>& points, const Point&  t
     int maxIterations = 4;
     
     //Use heuristic if the region only has 2 points
-    if (points.size() == 2) {
-        const Point& first = points.front();
-        const Point& last = points.back();
+    if (nPoints == 2) {
+        const Point& first = points[0];
+        const Point& last = points[1];
         double dist =  euclideanDistance(first, last);
         SimpleBezierCP firstCp,lastCp;
         firstCp.p = first;
@@ -361,43 +364,36 @@ static void fit_cubic_internal(const std::vector<Point>& points, const Point&  t
     }
     
     // Parameterize points, and attempt to fit curve
-    std::vector<double> u;
-    chordLengthParametrize(points, &u);
-    generateBezier(points, u, tHat1, tHat2, generatedBezier);
+    std::vector<double>& u = workspace->u;
+    chordLengthParametrize(points, nPoints, &u);
+    generateBezier(points, nPoints, u, tHat1, tHat2, generatedBezier);
     
     int splitPoint;
-    double maxError = computeMaxError(points, *generatedBezier, u, &splitPoint);
+    double maxError = computeMaxError(points, nPoints, *generatedBezier, u, &splitPoint);
     
     //  If error not too large, try some reparameterization and iteration
     if (maxError < iterationError) {
         for (int i = 0; i < maxIterations; ++i) {
-            reparameterize(points, *generatedBezier, u);
+            reparameterize(points, nPoints, *generatedBezier, u);
             generatedBezier->clear();
-            generateBezier(points, u, tHat1, tHat2, generatedBezier);
-            maxError = computeMaxError(points, *generatedBezier, u, &splitPoint);
+            generateBezier(points, nPoints, u, tHat1, tHat2, generatedBezier);
+            maxError = computeMaxError(points, nPoints, *generatedBezier, u, &splitPoint);
             if (maxError < error) {
                 return;
             }
         }
     }
 
-    assert(splitPoint >= 1 && splitPoint < (int)points.size() - 1);
+    assert(splitPoint >= 1 && splitPoint < nPoints - 1);
     // Fitting failed -- split at max error point and fit recursively
     Point tHatCenter = computeCenterTangent(points[splitPoint - 1], points[splitPoint], points[splitPoint + 1]);
     
-    std::vector<Point> firstSplit,secondSplit;
-    for (std::size_t i = 0; i <= (std::size_t)splitPoint; ++i) {
-        firstSplit.push_back(points[i]);
-    }
-    for (std::size_t i = (std::size_t)splitPoint; i < points.size(); ++i) {
-        secondSplit.push_back(points[i]);
-    }
-    
+    //Both halves share the split point, they are fitted in place without copying the points
     std::vector<SimpleBezierCP> first,second;
-    fit_cubic_internal(firstSplit, tHat1, tHatCenter, error, &first);
+    fit_cubic_internal(points, splitPoint + 1, tHat1, tHatCenter, error, workspace, &first);
     tHatCenter.x = -tHatCenter.x;
     tHatCenter.y = -tHatCenter.y;
-    fit_cubic_internal(secondSplit, tHatCenter, tHat2, error, &second);
+    fit_cubic_internal(points + splitPoint, nPoints - splitPoint, tHatCenter, tHat2, error, workspace, &second);
     generatedBezier->clear();
     if (!first.empty()) {
         generatedBezier->insert(generatedBezier->end(), first.begin(), first.end());
@@ -432,84 +428,99 @@ static void fit_cubic_for_sub_set(const std::vector<Point>& points,double error,
     }
     Point tHat1 = computeEndTangent(points[0], points[1]);
     Point tHat2 = computeEndTangent(points[points.size() - 1], points[points.size() - 2]);
-    fit_cubic_internal(points, tHat1, tHat2, error, generatedBezier);
+    FitCubicWorkspace workspace(points.size());
+    fit_cubic_internal(&points[0], (int)points.size(), tHat1, tHat2, error, &workspace, generatedBezier);
 }
     
-} // anon namespace
-
-void FitCurve::fit_cubic(const std::vector<Point>& points, double error,std::vector<SimpleBezierCP>* generatedBezier)
+/**
+ * @brief Removes the points that are closer than the given tolerance (on both axes) to a point that was already kept.
+ * Kept points are indexed in a grid whose cells are as large as the tolerance so that only the 9 neighbouring
+ * cells have to be looked up for each point.
+ **/
+static void removeDuplicatePoints(const std::vector<Point>& points, double tolerance, std::vector<Point>* newPoints)
 {
-    if (points.size() < 2) {
-        return;
-    }
+    typedef std::pair<long long,long long> GridCell;
+    typedef std::map<GridCell, std::vector<std::size_t> > PointsGrid;
+    PointsGrid grid;
     
-    //First remove (almost) duplicate points
-    std::list<Point> newPoints;
+    newPoints->reserve(points.size());
     for (std::vector<Point>::const_iterator it = points.begin(); it!=points.end(); ++it) {
+        long long cellX = (long long)std::floor(it->x / tolerance);
+        long long cellY = (long long)std::floor(it->y / tolerance);
         
         bool foundDuplicate = false;
-        for (std::list<Point>::const_iterator it2 = newPoints.begin(); it2!=newPoints.end(); ++it2) {
-            if (std::abs(it2->x - it->x) < 1e-4 && std::abs(it2->y - it->y) < 1e-4) {
-                foundDuplicate = true;
-                break;
+        for (long long i = cellX - 1; i <= cellX + 1 && !foundDuplicate; ++i) {
+            for (long long j = cellY - 1; j <= cellY + 1 && !foundDuplicate; ++j) {
+                PointsGrid::const_iterator found = grid.find(std::make_pair(i, j));
+                if (found == grid.end()) {
+                    continue;
+                }
+                for (std::vector<std::size_t>::const_iterator it2 = found->second.begin(); it2!=found->second.end(); ++it2) {
+                    const Point& other = (*newPoints)[*it2];
+                    if (std::abs(other.x - it->x) < tolerance && std::abs(other.y - it->y) < tolerance) {
+                        foundDuplicate = true;
+                        break;
+                    }
+                }
             }
         }
         if (!foundDuplicate) {
-            newPoints.push_back(*it);
+            grid[std::make_pair(cellX, cellY)].push_back(newPoints->size());
+            newPoints->push_back(*it);
         }
     }
+}
+    
+} // anon namespace
+
+void FitCurve::fit_cubic(const std::vector<Point>& points, double error,std::vector<SimpleBezierCP>* generatedBezier)
+{
+    if (points.size() < 2) {
+        return;
+    }
+    
+    //First remove (almost) duplicate points
+    std::vector<Point> newPoints;
+    removeDuplicatePoints(points, 1e-4, &newPoints);
     
     //Divide the original points by identifying "corners": points where the angle between the previous, current and next point
     //creates a discontinuity
     std::list<std::vector<Point> > pointSets;
     
-    
+    //Index of the first point that does not belong to a subset yet
+    std::size_t start = 0;
+    std::size_t nPoints = newPoints.size();
     bool foundCorner;
     
     do {
         foundCorner = false;
-        if (newPoints.size() <= 2) {
+        if (nPoints - start <= 2) {
             break;
         }
-        std::list<Point>::iterator prev = newPoints.begin();
-        std::list<Point>::iterator it = newPoints.begin();
-        ++it;
-        std::list<Point>::iterator next = it;
-        if (next != newPoints.end()) {
-            ++next;
-        }
-        for (; it != newPoints.end(); ++prev, ++it, ++next) {
-            if (it == newPoints.end()) {
-                it = newPoints.begin();
-            }
-            if (next == newPoints.end()) {
-                break;
-                //next = newPoints.begin();
-            }
+        for (std::size_t i = start + 1; i + 1 < nPoints; ++i) {
+            const Point& prev = newPoints[i - 1];
+            const Point& cur = newPoints[i];
+            const Point& next = newPoints[i + 1];
             
             Point u,v;
-            u.x = it->x - prev->x;
-            u.y = it->y - prev->y;
+            u.x = cur.x - prev.x;
+            u.y = cur.y - prev.y;
             
-            v.x = next->x - it->x;
-            v.y = next->y - it->y;
+            v.x = next.x - cur.x;
+            v.y = next.y - cur.y;
             
             double distU = std::sqrt(u.x * u.x + u.y * u.y);
             double distV = std::sqrt(v.x * v.x + v.y * v.y);
             assert(distV != 0);
             double alpha = std::acos(distU / distV);
             if (alpha > M_PI_2) {
-                std::vector<Point> subset;
-                
-                for (std::list<Point>::iterator it2 = newPoints.begin(); it2!=next; ++it2) {
-                    subset.push_back(*it2);
-                }
-                newPoints.erase(newPoints.begin(), next);
+                std::vector<Point> subset(newPoints.begin() + start, newPoints.begin() + i + 1);
+                start = i + 1;
                 
                 //If only a single point remains, just add it to this bezier curve
-                if (newPoints.size() == 1) {
-                    subset.push_back(newPoints.front());
-                    newPoints.clear();
+                if (nPoints - start == 1) {
+                    subset.push_back(newPoints[start]);
+                    start = nPoints;
                 }
                 pointSets.push_back(subset);
                 foundCorner = true;
@@ -517,12 +528,8 @@ void FitCurve::fit_cubic(const std::vector<Point>& points, double error,std::vec
             }
         }
     } while (foundCorner);
-    if (!newPoints.empty()) {
-        std::vector<Point> subset;
-        for (std::list<Point>::iterator it2 = newPoints.begin(); it2!=newPoints.end(); ++it2) {
-            subset.push_back(*it2);
-        }
-        pointSets.push_back(subset);
+    if (start < nPoints) {
+        pointSets.push_back(std::vector<Point>(newPoints.begin() + start, newPoints.end()));
     }
     
     
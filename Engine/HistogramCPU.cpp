@@ -10,10 +10,24 @@
 #include "HistogramCPU.h"
 
 #include <algorithm>
+#include <map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NATRON_HISTOGRAM_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include <QMutex>
 #include <QWaitCondition>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
 
+#include "Engine/AppManager.h"
 #include "Engine/Image.h"
+#include "Engine/Settings.h"
 
 
 struct HistogramRequest
@@ -25,6 +39,7 @@ struct HistogramRequest
     double vmin;
     double vmax;
     int smoothingKernelSize;
+    int tileSize; //< size of the tiles of the viewer, in pixels
 
     HistogramRequest()
         : binsCount(0)
@@ -34,6 +49,7 @@ struct HistogramRequest
           , vmin(0)
           , vmax(0)
           , smoothingKernelSize(0)
+          , tileSize(0)
     {
     }
 
@@ -43,7 +59,8 @@ struct HistogramRequest
                      const RectI & rect,
                      double vmin,
                      double vmax,
-                     int smoothingKernelSize)
+                     int smoothingKernelSize,
+                     int tileSize)
         : binsCount(binsCount)
           , mode(mode)
           , image(image)
@@ -51,6 +68,56 @@ struct HistogramRequest
           , vmin(vmin)
           , vmax(vmax)
           , smoothingKernelSize(smoothingKernelSize)
+          , tileSize(tileSize)
+    {
+    }
+};
+
+///The counts of the pixels of a tile of the image in each bin
+struct HistogramTile
+{
+    RectI rect; //< the portion of the tile that is counted
+    int x,y; //< coordinates of the tile in the grid of tiles
+    bool cacheable; //< true if rect is the whole tile and it was fully rendered
+    std::vector<unsigned int> bins;
+};
+
+struct HistogramTileKey
+{
+    int mode;
+    int x,y;
+
+    bool operator<(const HistogramTileKey& other) const
+    {
+        if (mode != other.mode) {
+            return mode < other.mode;
+        }
+        if (y != other.y) {
+            return y < other.y;
+        }
+
+        return x < other.x;
+    }
+};
+
+typedef std::map<HistogramTileKey,std::vector<unsigned int> > HistogramTilesCache;
+
+///Partial histograms of the tiles of the last image, so that only the tiles the viewer re-rendered are counted again
+struct HistogramTilesCacheState
+{
+    boost::weak_ptr<Natron::Image> image;
+    int binsCount;
+    double vmin,vmax;
+    int tileSize;
+    HistogramTilesCache tiles;
+
+    HistogramTilesCacheState()
+        : image()
+          , binsCount(0)
+          , vmin(0)
+          , vmax(0)
+          , tileSize(0)
+          , tiles()
     {
     }
 };
@@ -90,6 +157,7 @@ struct HistogramCPUPrivate
     QWaitCondition mustQuitCond;
     QMutex mustQuitMutex;
     bool mustQuit;
+    HistogramTilesCacheState tilesCache; //< only accessed by the histogram thread
 
     HistogramCPUPrivate()
         : requestCond()
@@ -100,6 +168,7 @@ struct HistogramCPUPrivate
           , mustQuitCond()
           , mustQuitMutex()
           , mustQuit(false)
+          , tilesCache()
     {
     }
 };
@@ -128,7 +197,8 @@ HistogramCPU::computeHistogram(int mode,      //< corresponds to the enum Histog
     QMutexLocker quitLocker(&_imp->mustQuitMutex);
     QMutexLocker locker(&_imp->requestMutex);
 
-    _imp->requests.push_back( HistogramRequest(binsCount,mode,image,rect,vmin,vmax,smoothingKernelSize) );
+    int tileSize = 1 << appPTR->getCurrentSettings()->getViewerTilesPowerOf2();
+    _imp->requests.push_back( HistogramRequest(binsCount,mode,image,rect,vmin,vmax,smoothingKernelSize,tileSize) );
     if (!isRunning() && !_imp->mustQuit) {
         quitLocker.unlock();
         start(HighestPriority);
@@ -199,12 +269,20 @@ HistogramCPU::getMostRecentlyProducedHistogram(std::vector<float>* histogram1,
 
 ///putting these in an anonymous namespace will yield this error on gcc 4.2:
 ///"function has not external linkage"
+///val4 computes the value of 4 pixels at once given their channels
 struct pix_red
 {
     static float val(const float *pix)
     {
         return pix[0];
     }
+
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+    static __m128 val4(__m128 r, __m128 /*g*/, __m128 /*b*/, __m128 /*a*/)
+    {
+        return r;
+    }
+#endif
 };
 
 struct pix_green
@@ -213,6 +291,13 @@ struct pix_green
     {
         return pix[1];
     }
+
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+    static __m128 val4(__m128 /*r*/, __m128 g, __m128 /*b*/, __m128 /*a*/)
+    {
+        return g;
+    }
+#endif
 };
 
 struct pix_blue
@@ -221,6 +306,13 @@ struct pix_blue
     {
         return pix[2];
     }
+
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+    static __m128 val4(__m128 /*r*/, __m128 /*g*/, __m128 b, __m128 /*a*/)
+    {
+        return b;
+    }
+#endif
 };
 
 struct pix_alpha
@@ -229,6 +321,13 @@ struct pix_alpha
     {
         return pix[3];
     }
+
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+    static __m128 val4(__m128 /*r*/, __m128 /*g*/, __m128 /*b*/, __m128 a)
+    {
+        return a;
+    }
+#endif
 };
 
 struct pix_lum
@@ -237,37 +336,182 @@ struct pix_lum
     {
         return 0.299 * pix[0] + 0.587 * pix[1] + 0.114 * pix[2];
     }
+
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+    static __m128 val4(__m128 r, __m128 g, __m128 b, __m128 /*a*/)
+    {
+        return _mm_add_ps( _mm_add_ps( _mm_mul_ps( r, _mm_set1_ps(0.299f) ), _mm_mul_ps( g, _mm_set1_ps(0.587f) ) ),
+                           _mm_mul_ps( b, _mm_set1_ps(0.114f) ) );
+    }
+#endif
 };
 
+///Counts the pixels of tile.rect in nBins bins spanning [vmin,vmax)
+template <typename PIX>
+void
+countTile(const Natron::Image* image,
+          double vmin,
+          double vmax,
+          int nBins,
+          HistogramTile & tile)
+{
+    tile.bins.assign(nBins, 0);
+    unsigned int* bins = &tile.bins[0];
+    const double binsPerValue = nBins / (vmax - vmin);
+    const int nComps = (int)image->getComponentsCount();
+
+    Natron::Image::ReadAccess acc = image->getReadRights();
+
+    for (int y = tile.rect.y1; y < tile.rect.y2; ++y) {
+        const float *pix = (const float*)acc.pixelAt(tile.rect.x1, y);
+        int x = tile.rect.x1;
+#ifdef NATRON_HISTOGRAM_USE_SSE2
+        if (nComps == 4) {
+            const __m128 vminv = _mm_set1_ps(vmin);
+            const __m128 vmaxv = _mm_set1_ps(vmax);
+            const __m128 scalev = _mm_set1_ps(binsPerValue);
+            int indices[4];
+            for (; x + 4 <= tile.rect.x2; x += 4, pix += 16) {
+                __m128 p0 = _mm_loadu_ps(pix);
+                __m128 p1 = _mm_loadu_ps(pix + 4);
+                __m128 p2 = _mm_loadu_ps(pix + 8);
+                __m128 p3 = _mm_loadu_ps(pix + 12);
+                ///p0..p3 now hold the red, green, blue and alpha of the 4 pixels
+                _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+                __m128 v = PIX::val4(p0, p1, p2, p3);
+                ///NaNs fail both comparisons
+                int inRange = _mm_movemask_ps( _mm_and_ps( _mm_cmpge_ps(v, vminv), _mm_cmplt_ps(v, vmaxv) ) );
+                if (!inRange) {
+                    continue;
+                }
+                _mm_storeu_si128( (__m128i*)indices, _mm_cvttps_epi32( _mm_mul_ps( _mm_sub_ps(v, vminv), scalev ) ) );
+                for (int k = 0; k < 4; ++k) {
+                    if ( inRange & (1 << k) ) {
+                        ///v < vmax may still round to nBins in single precision
+                        ++bins[std::min(indices[k], nBins - 1)];
+                    }
+                }
+            }
+        }
+#endif
+        for (; x < tile.rect.x2; ++x, pix += nComps) {
+            float v = PIX::val(pix);
+            if ( (vmin <= v) && (v < vmax) ) {
+                int index = std::min( (int)( (v - vmin) * binsPerValue ), nBins - 1 );
+                assert(index >= 0);
+                ++bins[index];
+            }
+        }
+    }
+}
+
+static int
+floorDiv(int a,
+         int b)
+{
+    return a >= 0 ? a / b : -( (-a + b - 1) / b );
+}
 
-template <float pix_func(const float*)>
+/**
+ * @brief Computes the histogram of request.rect by tiles of request.tileSize pixels aligned on the origin, in parallel.
+ * Tiles that are entirely in the rectangle and fully rendered are kept in cache so that they are not counted again
+ * for the next request on the same image.
+ **/
+template <typename PIX>
 void
 computeHisto(const HistogramRequest & request,
              int upscale,
+             int mode,
+             HistogramTilesCache* cache,
              std::vector<float> *histo)
 {
     assert(histo);
-    histo->resize(request.binsCount * upscale);
+    const int nBins = request.binsCount * upscale;
+    histo->resize(nBins);
     std::fill(histo->begin(), histo->end(), 0.f);
-    double binSize = (request.vmax - request.vmin) / histo->size();
 
     ///Images come from the viewer which is in float.
     assert(request.image->getBitDepth() == Natron::eImageBitDepthFloat);
 
-    Natron::Image::ReadAccess acc = request.image->getReadRights();
-    
-    for (int y = request.rect.bottom(); y < request.rect.top(); ++y) {
-        for (int x = request.rect.left(); x < request.rect.right(); ++x) {
-            const float *pix = (const float*)acc.pixelAt(x, y);
-            float v = pix_func(pix);
-            if ( (request.vmin <= v) && (v < request.vmax) ) {
-                int index = (int)( (v - request.vmin) / binSize );
-                assert( 0 <= index && index < (int)histo->size() );
-                (*histo)[index] += 1.f;
+    const RectI & bounds = request.image->getBounds();
+    RectI area;
+    if ( (nBins == 0) || !request.rect.intersect(bounds, &area) || area.isNull() ) {
+        return;
+    }
+
+    std::vector<unsigned int> total(nBins, 0);
+    std::vector<HistogramTile> toCount;
+    const int tileSize = request.tileSize;
+    assert(tileSize > 0);
+    const int tx1 = floorDiv(area.x1, tileSize);
+    const int tx2 = floorDiv(area.x2 - 1, tileSize);
+    const int ty1 = floorDiv(area.y1, tileSize);
+    const int ty2 = floorDiv(area.y2 - 1, tileSize);
+    for (int ty = ty1; ty <= ty2; ++ty) {
+        for (int tx = tx1; tx <= tx2; ++tx) {
+            RectI tileRect(tx * tileSize, ty * tileSize, (tx + 1) * tileSize, (ty + 1) * tileSize);
+            RectI wholeTile;
+            tileRect.intersect(bounds, &wholeTile);
+            HistogramTile tile;
+            tileRect.intersect(area, &tile.rect);
+            tile.x = tx;
+            tile.y = ty;
+            tile.cacheable = false;
+            if (tile.rect == wholeTile) {
+                std::list<RectI> restToRender;
+                request.image->getRestToRender(tile.rect, restToRender);
+                tile.cacheable = restToRender.empty();
+            }
+            if (tile.cacheable) {
+                HistogramTileKey key;
+                key.mode = mode;
+                key.x = tx;
+                key.y = ty;
+                HistogramTilesCache::const_iterator found = cache->find(key);
+                if ( found != cache->end() ) {
+                    for (int i = 0; i < nBins; ++i) {
+                        total[i] += found->second[i];
+                    }
+                    continue;
+                }
             }
+            toCount.push_back(tile);
         }
     }
-}
+
+    bool runInCurrentThread = toCount.size() <= 1 ||
+                              QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount();
+    if (runInCurrentThread) {
+        for (std::vector<HistogramTile>::iterator it = toCount.begin(); it != toCount.end(); ++it) {
+            countTile<PIX>(request.image.get(), request.vmin, request.vmax, nBins, *it);
+        }
+    } else {
+        QtConcurrent::map( toCount,
+                           boost::bind(&countTile<PIX>,
+                                       request.image.get(),
+                                       request.vmin,
+                                       request.vmax,
+                                       nBins,
+                                       _1) ).waitForFinished();
+    }
+
+    for (std::vector<HistogramTile>::iterator it = toCount.begin(); it != toCount.end(); ++it) {
+        for (int i = 0; i < nBins; ++i) {
+            total[i] += it->bins[i];
+        }
+        if (it->cacheable) {
+            HistogramTileKey key;
+            key.mode = mode;
+            key.x = it->x;
+            key.y = it->y;
+            (*cache)[key].swap(it->bins);
+        }
+    }
+
+    for (int i = 0; i < nBins; ++i) {
+        (*histo)[i] = (float)total[i];
+    }
+} // computeHisto
 
 /// IIR Gaussian filter: recursive implementation.
 
@@ -407,6 +651,7 @@ iir_1d_filter(SrcIterator src,
 
 static void
 computeHistogramStatic(const HistogramRequest & request,
+                       HistogramTilesCache* cache,
                        boost::shared_ptr<FinishedHistogram> ret,
                        int histogramIndex)
 {
@@ -442,19 +687,19 @@ computeHistogramStatic(const HistogramRequest & request,
     std::vector<float> histo_upscaled;
     switch (mode) {
     case 1:     //< A
-        computeHisto<&pix_alpha::val>(request, upscale, &histo_upscaled);
+        computeHisto<pix_alpha>(request, upscale, mode, cache, &histo_upscaled);
         break;
     case 2:     //<Y
-        computeHisto<&pix_lum::val>(request, upscale, &histo_upscaled);
+        computeHisto<pix_lum>(request, upscale, mode, cache, &histo_upscaled);
         break;
     case 3:     //< R
-        computeHisto<&pix_red::val>(request, upscale, &histo_upscaled);
+        computeHisto<pix_red>(request, upscale, mode, cache, &histo_upscaled);
         break;
     case 4:     //< G
-        computeHisto<&pix_green::val>(request, upscale, &histo_upscaled);
+        computeHisto<pix_green>(request, upscale, mode, cache, &histo_upscaled);
         break;
     case 5:     //< B
-        computeHisto<&pix_blue::val>(request, upscale, &histo_upscaled);
+        computeHisto<pix_blue>(request, upscale, mode, cache, &histo_upscaled);
         break;
 
     default:
@@ -522,19 +767,30 @@ HistogramCPU::run()
         ret->vmax = request.vmax;
         ret->mipMapLevel = request.image->getMipMapLevel();
 
+        ///The partial histograms of the tiles are only valid for the same image and the same bins
+        HistogramTilesCacheState & tilesCache = _imp->tilesCache;
+        if ( (tilesCache.image.lock() != request.image) || (tilesCache.binsCount != request.binsCount) ||
+             (tilesCache.vmin != request.vmin) || (tilesCache.vmax != request.vmax) || (tilesCache.tileSize != request.tileSize) ) {
+            tilesCache.tiles.clear();
+            tilesCache.image = request.image;
+            tilesCache.binsCount = request.binsCount;
+            tilesCache.vmin = request.vmin;
+            tilesCache.vmax = request.vmax;
+            tilesCache.tileSize = request.tileSize;
+        }
 
         switch (request.mode) {
         case 0:     //< RGB
-            computeHistogramStatic(request, ret, 1);
-            computeHistogramStatic(request, ret, 2);
-            computeHistogramStatic(request, ret, 3);
+            computeHistogramStatic(request, &tilesCache.tiles, ret, 1);
+            computeHistogramStatic(request, &tilesCache.tiles, ret, 2);
+            computeHistogramStatic(request, &tilesCache.tiles, ret, 3);
             break;
         case 1:
         case 2:
         case 3:
         case 4:
         case 5:
-            computeHistogramStatic(request, ret, 1);
+            computeHistogramStatic(request, &tilesCache.tiles, ret, 1);
             break;
         default:
             assert(false);     //< unknown case.
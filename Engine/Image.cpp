@@ -1307,6 +1307,19 @@ Image::getRowElements() const
     return getComponentsCount() * _bounds.width();
 }
 
+Image::ReadAccess*
+Image::tryGetReadRights() const
+{
+    if ( !_entryLock.tryLockForRead() ) {
+        return NULL;
+    }
+    ///The lock is recursive: taking it again for the returned object does not wait
+    ReadAccess* ret = new ReadAccess(this);
+    _entryLock.unlock();
+
+    return ret;
+}
+
 // code proofread and fixed by @devernay on 4/12/2014
 template <typename PIX, int maxValue>
 void
@@ -407,6 +407,12 @@ namespace Natron {
             return WriteAccess(this);
         }
         
+        /**
+         * @brief Same as getReadRights() but returns NULL instead of waiting if the image is being written to.
+         * The caller owns the returned object.
+         **/
+        ReadAccess* tryGetReadRights() const;
+        
     private:
         
         friend class ReadAccess;
@@ -0,0 +1,343 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "ImagePlaneWrapper.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/Image.h"
+#include "Engine/ImageParams.h"
+
+namespace {
+
+struct ImagePlaneData
+{
+    boost::shared_ptr<Natron::Image> image; //< NULL once released
+    boost::scoped_ptr<Natron::Image::ReadAccess> access;
+    const char* format;
+    Py_ssize_t itemSize;
+    Py_ssize_t shape[3];
+    Py_ssize_t strides[3];
+    int exports; //< number of buffers currently exported to Python
+
+    ///Kept so that the plane can still be described once released
+    std::string layer;
+    std::vector<std::string> channels;
+    RectI bounds;
+    unsigned int mipMapLevel;
+
+    ImagePlaneData()
+    : image()
+    , access()
+    , format(0)
+    , itemSize(0)
+    , exports(0)
+    , layer()
+    , channels()
+    , bounds()
+    , mipMapLevel(0)
+    {
+    }
+};
+
+struct ImagePlaneObject
+{
+    PyObject_HEAD
+    ImagePlaneData* data;
+};
+
+ImagePlaneData*
+getData(PyObject* self)
+{
+    return ( (ImagePlaneObject*)self )->data;
+}
+
+void
+ImagePlane_dealloc(PyObject* self)
+{
+    ///No buffer can be exported anymore: they hold a reference to self
+    delete getData(self);
+    Py_TYPE(self)->tp_free(self);
+}
+
+int
+ImagePlane_getbuffer(PyObject* self,
+                     Py_buffer* view,
+                     int flags)
+{
+    ImagePlaneData* data = getData(self);
+
+    view->obj = NULL;
+    if (!data->image) {
+        PyErr_SetString(PyExc_BufferError, "The image plane was released.");
+
+        return -1;
+    }
+    if ( (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE ) {
+        PyErr_SetString(PyExc_BufferError, "The image plane is read-only.");
+
+        return -1;
+    }
+    ///Rows are contiguous, only a Fortran-ordered request cannot be served
+    if ( (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS ) {
+        PyErr_SetString(PyExc_BufferError, "The image plane is not Fortran contiguous.");
+
+        return -1;
+    }
+
+    Py_INCREF(self);
+    view->obj = self;
+    view->buf = (void*)data->access->pixelAt(data->bounds.x1, data->bounds.y1);
+    view->len = data->shape[0] * data->strides[0];
+    view->readonly = 1;
+    view->itemsize = data->itemSize;
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? (char*)data->format : NULL;
+    if ( (flags & PyBUF_ND) == PyBUF_ND ) {
+        view->ndim = 3;
+        view->shape = data->shape;
+    } else {
+        view->ndim = 1;
+        view->shape = NULL;
+    }
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? data->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    ++data->exports;
+
+    return 0;
+}
+
+void
+ImagePlane_releasebuffer(PyObject* self,
+                         Py_buffer* /*view*/)
+{
+    ImagePlaneData* data = getData(self);
+
+    assert(data->exports > 0);
+    --data->exports;
+}
+
+PyObject*
+ImagePlane_release(PyObject* self,
+                   PyObject* /*args*/)
+{
+    ImagePlaneData* data = getData(self);
+
+    if (data->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "The image plane cannot be released while memoryviews or arrays still use it.");
+
+        return NULL;
+    }
+    data->access.reset();
+    data->image.reset();
+    Py_RETURN_NONE;
+}
+
+PyObject*
+ImagePlane_enter(PyObject* self,
+                 PyObject* /*args*/)
+{
+    Py_INCREF(self);
+
+    return self;
+}
+
+PyObject*
+ImagePlane_exit(PyObject* self,
+                PyObject* /*args*/)
+{
+    PyObject* ret = ImagePlane_release(self, NULL);
+
+    if (!ret) {
+        return NULL;
+    }
+    Py_DECREF(ret);
+    Py_RETURN_FALSE;
+}
+
+PyObject*
+ImagePlane_getLayer(PyObject* self,
+                    void* /*closure*/)
+{
+    return PyUnicode_FromString( getData(self)->layer.c_str() );
+}
+
+PyObject*
+ImagePlane_getChannels(PyObject* self,
+                       void* /*closure*/)
+{
+    const std::vector<std::string>& channels = getData(self)->channels;
+    PyObject* ret = PyTuple_New( (Py_ssize_t)channels.size() );
+
+    if (!ret) {
+        return NULL;
+    }
+    for (std::size_t i = 0; i < channels.size(); ++i) {
+        PyObject* item = PyUnicode_FromString( channels[i].c_str() );
+        if (!item) {
+            Py_DECREF(ret);
+
+            return NULL;
+        }
+        PyTuple_SET_ITEM(ret, (Py_ssize_t)i, item);
+    }
+
+    return ret;
+}
+
+PyObject*
+ImagePlane_getBounds(PyObject* self,
+                     void* /*closure*/)
+{
+    const RectI& bounds = getData(self)->bounds;
+
+    return Py_BuildValue("(iiii)", bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+}
+
+PyObject*
+ImagePlane_getMipMapLevel(PyObject* self,
+                          void* /*closure*/)
+{
+    return PyLong_FromUnsignedLong( getData(self)->mipMapLevel );
+}
+
+PyObject*
+ImagePlane_isReleased(PyObject* self,
+                      void* /*closure*/)
+{
+    return PyBool_FromLong( !getData(self)->image );
+}
+
+PyBufferProcs ImagePlane_bufferProcs = {
+    ImagePlane_getbuffer,
+    ImagePlane_releasebuffer
+};
+
+PyMethodDef ImagePlane_methods[] = {
+    {"release", (PyCFunction)ImagePlane_release, METH_NOARGS,
+     "Releases the image: the plane can no longer be read afterwards. Fails if memoryviews or arrays still use it."},
+    {"__enter__", (PyCFunction)ImagePlane_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)ImagePlane_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+PyGetSetDef ImagePlane_getset[] = {
+    {(char*)"layer", ImagePlane_getLayer, NULL, (char*)"The name of the layer of the plane.", NULL},
+    {(char*)"channels", ImagePlane_getChannels, NULL, (char*)"The names of the channels, in the order of the last axis of the buffer.", NULL},
+    {(char*)"bounds", ImagePlane_getBounds, NULL, (char*)"The pixel bounds (x1, y1, x2, y2) of the plane, x2 and y2 excluded.", NULL},
+    {(char*)"mipMapLevel", ImagePlane_getMipMapLevel, NULL, (char*)"The mip-map level of the plane.", NULL},
+    {(char*)"released", ImagePlane_isReleased, NULL, (char*)"True once the plane was released.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+PyTypeObject ImagePlaneType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "NatronEngine.ImagePlane",        /* tp_name */
+    sizeof(ImagePlaneObject),         /* tp_basicsize */
+    0,                                /* tp_itemsize */
+    ImagePlane_dealloc,               /* tp_dealloc */
+    0,                                /* tp_print */
+    0,                                /* tp_getattr */
+    0,                                /* tp_setattr */
+    0,                                /* tp_reserved */
+    0,                                /* tp_repr */
+    0,                                /* tp_as_number */
+    0,                                /* tp_as_sequence */
+    0,                                /* tp_as_mapping */
+    0,                                /* tp_hash */
+    0,                                /* tp_call */
+    0,                                /* tp_str */
+    0,                                /* tp_getattro */
+    0,                                /* tp_setattro */
+    &ImagePlane_bufferProcs,          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,               /* tp_flags */
+    "Read-only view on the pixels of an image plane held by the cache, through the buffer protocol.", /* tp_doc */
+    0,                                /* tp_traverse */
+    0,                                /* tp_clear */
+    0,                                /* tp_richcompare */
+    0,                                /* tp_weaklistoffset */
+    0,                                /* tp_iter */
+    0,                                /* tp_iternext */
+    ImagePlane_methods,               /* tp_methods */
+    0,                                /* tp_members */
+    ImagePlane_getset,                /* tp_getset */
+};
+
+} // anon namespace
+
+PyObject*
+createImagePlaneForPython(const boost::shared_ptr<Natron::Image>& image)
+{
+    assert(image);
+
+    static bool typeReady = false;
+    if (!typeReady) {
+        if (PyType_Ready(&ImagePlaneType) < 0) {
+            return NULL;
+        }
+        typeReady = true;
+    }
+
+    RectI bounds = image->getBounds();
+    if ( bounds.isNull() ) {
+        return NULL;
+    }
+    Natron::Image::ReadAccess* access = image->tryGetReadRights();
+    if (!access) {
+        return NULL;
+    }
+    ImagePlaneObject* ret = PyObject_New(ImagePlaneObject, &ImagePlaneType);
+    if (!ret) {
+        delete access;
+
+        return NULL;
+    }
+
+    ImagePlaneData* data = new ImagePlaneData;
+    data->image = image;
+    data->access.reset(access);
+    const Natron::ImageComponents& comps = image->getComponents();
+    data->layer = comps.getLayerName();
+    data->channels = comps.getComponentsNames();
+    data->bounds = bounds;
+    data->mipMapLevel = image->getMipMapLevel();
+
+    Natron::ImageBitDepthEnum depth = image->getBitDepth();
+    switch (depth) {
+    case Natron::eImageBitDepthShort:
+        data->format = "H";
+        break;
+    case Natron::eImageBitDepthFloat:
+        data->format = "f";
+        break;
+    case Natron::eImageBitDepthByte:
+    case Natron::eImageBitDepthNone:
+        data->format = "B";
+        break;
+    }
+    data->itemSize = Natron::getSizeOfForBitDepth(depth);
+
+    Py_ssize_t nComps = comps.getNumComponents();
+    data->shape[0] = bounds.height();
+    data->shape[1] = bounds.width();
+    data->shape[2] = nComps;
+    data->strides[2] = data->itemSize;
+    data->strides[1] = nComps * data->itemSize;
+    data->strides[0] = bounds.width() * data->strides[1];
+
+    ret->data = data;
+
+    return (PyObject*)ret;
+}
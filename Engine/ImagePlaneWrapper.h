@@ -0,0 +1,38 @@
+//  Natron
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * @brief Exposes the pixels of the images held by the cache to Python, without copying them.
+ * This is written directly against the Python C API: Shiboken cannot generate types implementing the buffer protocol,
+ * hence this header is not parsed when generating the bindings.
+ **/
+
+#ifndef IMAGEPLANEWRAPPER_H
+#define IMAGEPLANEWRAPPER_H
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#endif
+
+namespace Natron {
+class Image;
+}
+
+/**
+ * @brief Returns a new reference to a NatronEngine.ImagePlane object exposing the pixels of image through the buffer protocol,
+ * e.g: numpy.asarray(plane) or memoryview(plane). The buffer is read-only, of shape (height, width, components)
+ * where the first row is the bottom of the image, and of format 'B', 'H' or 'f' depending on the bit depth.
+ * The object holds a reference and a read lock on the image until it is released, either with its release() function,
+ * when leaving a with-statement or when it is destroyed: meanwhile the cache cannot free the image and renders cannot write to it.
+ * Returns NULL without setting a Python error if the image is empty or being written to, and NULL with a Python error set
+ * upon failure.
+ **/
+PyObject* createImagePlaneForPython(const boost::shared_ptr<Natron::Image>& image);
+
+#endif // IMAGEPLANEWRAPPER_H
@@ -0,0 +1,282 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "ImageTransform.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NATRON_IMAGETRANSFORM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "Engine/Image.h"
+#include "Engine/Rect.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+///The widest filter (Lanczos) reads 3 pixels on each side of the sample
+#define NATRON_TRANSFORM_FILTER_MAX_RADIUS 3
+
+using namespace Natron;
+
+int
+Natron::getTransformFilterRadius(Natron::TransformFilterEnum filter)
+{
+    switch (filter) {
+        case eTransformFilterBilinear:
+            return 1;
+        case eTransformFilterCubic:
+            return 1;
+        case eTransformFilterKeys:
+            return 2;
+        case eTransformFilterLanczos:
+            return 3;
+    }
+    return 1;
+}
+
+namespace {
+
+static double
+evaluateFilter(Natron::TransformFilterEnum filter,
+               double t)
+{
+    t = std::fabs(t);
+    switch (filter) {
+        case eTransformFilterBilinear:
+            return t < 1. ? 1. - t : 0.;
+        case eTransformFilterCubic:
+            //Hermite cubic with zero derivatives at the samples: only the 2 nearest samples contribute
+            return t < 1. ? (2. * t - 3.) * t * t + 1. : 0.;
+        case eTransformFilterKeys:
+            //Catmull-Rom (Keys with a = -0.5)
+            if (t < 1.) {
+                return (1.5 * t - 2.5) * t * t + 1.;
+            } else if (t < 2.) {
+                return ((-0.5 * t + 2.5) * t - 4.) * t + 2.;
+            }
+            return 0.;
+        case eTransformFilterLanczos: {
+            if (t < 1e-8) {
+                return 1.;
+            } else if (t >= 3.) {
+                return 0.;
+            }
+            double x = M_PI * t;
+            return 3. * std::sin(x) * std::sin(x / 3.) / (x * x);
+        }
+    }
+    return 0.;
+}
+
+/**
+ * @brief Computes the 2*radius weights of the taps surrounding a sample whose fractional position
+ * relative to the tap at index radius-1 is frac. The weights are normalized so that flat areas are preserved.
+ **/
+static void
+computeFilterWeights(Natron::TransformFilterEnum filter,
+                     int radius,
+                     double frac,
+                     float* weights)
+{
+    double sum = 0.;
+    double w[2 * NATRON_TRANSFORM_FILTER_MAX_RADIUS];
+    for (int i = 0; i < 2 * radius; ++i) {
+        w[i] = evaluateFilter(filter, frac + radius - 1 - i);
+        sum += w[i];
+    }
+    double norm = sum != 0. ? 1. / sum : 0.;
+    for (int i = 0; i < 2 * radius; ++i) {
+        weights[i] = (float)(w[i] * norm);
+    }
+}
+
+/**
+ * @brief Accumulates sum(weights[i] * src[i]) for nTaps consecutive pixels of a row
+ **/
+template <typename PIX, int nComps>
+void
+accumulateRow(const PIX* src,
+              const float* weights,
+              int nTaps,
+              float* acc)
+{
+    for (int k = 0; k < nComps; ++k) {
+        acc[k] = 0.f;
+    }
+    for (int i = 0; i < nTaps; ++i, src += nComps) {
+        for (int k = 0; k < nComps; ++k) {
+            acc[k] += weights[i] * (float)src[k];
+        }
+    }
+}
+
+#ifdef NATRON_IMAGETRANSFORM_USE_SSE
+template <>
+void
+accumulateRow<float, 4>(const float* src,
+                        const float* weights,
+                        int nTaps,
+                        float* acc)
+{
+    __m128 sum = _mm_setzero_ps();
+    for (int i = 0; i < nTaps; ++i, src += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(src)));
+    }
+    _mm_storeu_ps(acc, sum);
+}
+#endif
+
+template <typename PIX, int maxValue, int nComps>
+void
+transformImageForDepthAndComps(const Image& srcImg,
+                               const Transform::Matrix3x3& inverse,
+                               Natron::TransformFilterEnum filter,
+                               const RectI& roi,
+                               Image* dstImg)
+{
+    Image::ReadAccess racc = srcImg.getReadRights();
+    Image::WriteAccess wacc = dstImg->getWriteRights();
+
+    const RectI srcBounds = srcImg.getBounds();
+    const int srcRowElements = srcBounds.width() * nComps;
+    const PIX* srcPixels = (const PIX*)racc.pixelAt(srcBounds.x1, srcBounds.y1);
+    const int radius = getTransformFilterRadius(filter);
+
+    float wx[2 * NATRON_TRANSFORM_FILTER_MAX_RADIUS];
+    float wy[2 * NATRON_TRANSFORM_FILTER_MAX_RADIUS];
+
+    for (int y = roi.y1; y < roi.y2; ++y) {
+        PIX* dstPix = (PIX*)wacc.pixelAt(roi.x1, y);
+        assert(dstPix);
+
+        for (int x = roi.x1; x < roi.x2; ++x, dstPix += nComps) {
+
+            ///Map the destination pixel center back to the source
+            double X = inverse.a * (x + 0.5) + inverse.b * (y + 0.5) + inverse.c;
+            double Y = inverse.d * (x + 0.5) + inverse.e * (y + 0.5) + inverse.f;
+            double Z = inverse.g * (x + 0.5) + inverse.h * (y + 0.5) + inverse.i;
+
+            float pix[4] = { 0.f, 0.f, 0.f, 0.f };
+
+            if (Z > 0. && srcPixels) {
+                double sx = X / Z - 0.5;
+                double sy = Y / Z - 0.5;
+
+                ///Taps [x0, x0 + 2 * radius) x [y0, y0 + 2 * radius), clipped to the source bounds
+                double fx = std::floor(sx);
+                double fy = std::floor(sy);
+                if (fx > -(1 << 30) && fx < (1 << 30) && fy > -(1 << 30) && fy < (1 << 30)) {
+                    int x0 = (int)fx - radius + 1;
+                    int y0 = (int)fy - radius + 1;
+                    int iBegin = std::max(0, srcBounds.x1 - x0);
+                    int iEnd = std::min(2 * radius, srcBounds.x2 - x0);
+                    int jBegin = std::max(0, srcBounds.y1 - y0);
+                    int jEnd = std::min(2 * radius, srcBounds.y2 - y0);
+
+                    if (iBegin < iEnd && jBegin < jEnd) {
+                        computeFilterWeights(filter, radius, sx - fx, wx);
+                        computeFilterWeights(filter, radius, sy - fy, wy);
+
+                        const PIX* srcRow = srcPixels + (y0 + jBegin - srcBounds.y1) * srcRowElements + (x0 + iBegin - srcBounds.x1) * nComps;
+                        for (int j = jBegin; j < jEnd; ++j, srcRow += srcRowElements) {
+                            float rowAcc[4];
+                            accumulateRow<PIX, nComps>(srcRow, wx + iBegin, iEnd - iBegin, rowAcc);
+                            for (int k = 0; k < nComps; ++k) {
+                                pix[k] += wy[j] * rowAcc[k];
+                            }
+                        }
+                    }
+                }
+            }
+
+            for (int k = 0; k < nComps; ++k) {
+                if (maxValue == 1) {
+                    dstPix[k] = (PIX)pix[k];
+                } else {
+                    ///Keys and Lanczos overshoot around edges
+                    dstPix[k] = (PIX)std::max(0.f, std::min(pix[k] + 0.5f, (float)maxValue));
+                }
+            }
+        }
+    }
+}
+
+template <typename PIX, int maxValue>
+void
+transformImageForDepth(const Image& srcImg,
+                       const Transform::Matrix3x3& inverse,
+                       Natron::TransformFilterEnum filter,
+                       const RectI& roi,
+                       Image* dstImg)
+{
+    switch (srcImg.getComponentsCount()) {
+        case 1:
+            transformImageForDepthAndComps<PIX, maxValue, 1>(srcImg, inverse, filter, roi, dstImg);
+            break;
+        case 2:
+            transformImageForDepthAndComps<PIX, maxValue, 2>(srcImg, inverse, filter, roi, dstImg);
+            break;
+        case 3:
+            transformImageForDepthAndComps<PIX, maxValue, 3>(srcImg, inverse, filter, roi, dstImg);
+            break;
+        case 4:
+            transformImageForDepthAndComps<PIX, maxValue, 4>(srcImg, inverse, filter, roi, dstImg);
+            break;
+        default:
+            break;
+    }
+}
+
+} // anon namespace
+
+bool
+Natron::transformImage(const Image& srcImg,
+                       const Transform::Matrix3x3& transform,
+                       Natron::TransformFilterEnum filter,
+                       const RectI& roi,
+                       Image* dstImg)
+{
+    assert(srcImg.getComponentsCount() == dstImg->getComponentsCount() && srcImg.getBitDepth() == dstImg->getBitDepth());
+    if (srcImg.getComponentsCount() != dstImg->getComponentsCount() || srcImg.getBitDepth() != dstImg->getBitDepth()) {
+        return false;
+    }
+
+    double det = Transform::matDeterminant(transform);
+    if (det == 0.) {
+        return false;
+    }
+    Transform::Matrix3x3 inverse = Transform::matInverse(transform, det);
+
+    RectI dstRoI;
+    if (!roi.intersect(dstImg->getBounds(), &dstRoI)) {
+        return true;
+    }
+
+    switch (srcImg.getBitDepth()) {
+        case eImageBitDepthByte:
+            transformImageForDepth<unsigned char, 255>(srcImg, inverse, filter, dstRoI, dstImg);
+            break;
+        case eImageBitDepthShort:
+            transformImageForDepth<unsigned short, 65535>(srcImg, inverse, filter, dstRoI, dstImg);
+            break;
+        case eImageBitDepthFloat:
+            transformImageForDepth<float, 1>(srcImg, inverse, filter, dstRoI, dstImg);
+            break;
+        case eImageBitDepthNone:
+            break;
+    }
+    return true;
+}
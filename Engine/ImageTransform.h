@@ -0,0 +1,45 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_ENGINE_IMAGETRANSFORM_H_
+#define NATRON_ENGINE_IMAGETRANSFORM_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Global/Enums.h"
+#include "Engine/Transform.h"
+
+class RectI;
+
+namespace Natron {
+
+class Image;
+
+/**
+ * @brief Returns the number of source pixels on each side of the sample position read by the given filter.
+ **/
+int getTransformFilterRadius(Natron::TransformFilterEnum filter);
+
+/**
+ * @brief Resamples srcImg into dstImg over the window roi (in dstImg pixel coordinates).
+ * The transform maps srcImg pixel coordinates to dstImg pixel coordinates (e.g the concatenation of a chain of
+ * transform effects): each destination pixel center is mapped back into srcImg and filtered once with the given filter.
+ * Samples falling outside of srcImg bounds are black and transparent.
+ * Both images must have the same components and bit depth. Float RGBA images are filtered with SSE when the
+ * compiler supports it.
+ * Returns false if the transform is not invertible, in which case dstImg is untouched.
+ **/
+bool transformImage(const Image& srcImg,
+                    const Transform::Matrix3x3& transform,
+                    Natron::TransformFilterEnum filter,
+                    const RectI& roi,
+                    Image* dstImg);
+
+}
+
+#endif // NATRON_ENGINE_IMAGETRANSFORM_H_
@@ -453,6 +453,7 @@ KnobHelper::deleteKnob()
                 effect->getNode()->removeDefaultOverlay(this);
             }
             effect->getNode()->removeParameterFromPython(getName());
+            effect->getNode()->removeKnobFromKeyframesIndex(this);
         }
     }
     _signalSlotHandler.reset();
@@ -1342,6 +1343,9 @@ void
 KnobHelper::setEnabled(int dimension,
                        bool b)
 {
+    if (_imp->holder) {
+        _imp->holder->onKnobModified();
+    }
     _imp->enabled[dimension] = b;
     if (_signalSlotHandler) {
         _signalSlotHandler->s_enabledChanged();
@@ -1351,6 +1355,9 @@ KnobHelper::setEnabled(int dimension,
 void
 KnobHelper::setAllDimensionsEnabled(bool b)
 {
+    if (_imp->holder) {
+        _imp->holder->onKnobModified();
+    }
     for (U32 i = 0; i < _imp->enabled.size(); ++i) {
         _imp->enabled[i] = b;
     }
@@ -1362,7 +1369,18 @@ KnobHelper::setAllDimensionsEnabled(bool b)
 void
 KnobHelper::setSecret(bool b)
 {
+    if (_imp->holder) {
+        _imp->holder->onKnobModified();
+    }
+    bool changed = _imp->IsSecret != b;
     _imp->IsSecret = b;
+
+    ///the keyframes of secret knobs are not indexed
+    if (changed) {
+        for (int i = 0; i < (int)_imp->curves.size(); ++i) {
+            refreshKeyframesIndex(i);
+        }
+    }
     
     ///the knob was revealed , refresh its gui to the current time
     if ( !b && _imp->holder && _imp->holder->getApp() ) {
@@ -1396,6 +1414,9 @@ KnobHelper::getDescription() const
 void
 KnobHelper::setDescription(const std::string& description)
 {
+    if (_imp->holder) {
+        _imp->holder->onKnobModified();
+    }
     _imp->description = description;
     if (_signalSlotHandler) {
         _signalSlotHandler->s_descriptionChanged();
@@ -1870,6 +1891,9 @@ KnobHelper::getExpressionDependencies(int dimension, std::list<KnobI*>& dependen
 void
 KnobHelper::clearExpression(int dimension,bool clearResults)
 {
+    if (_imp->holder) {
+        _imp->holder->onKnobModified();
+    }
     Natron::PythonGILLocker pgl;
     {
         QMutexLocker k(&_imp->expressionMutex);
@@ -1941,6 +1965,39 @@ KnobHelper::expressionChanged(int dimension)
     
 }
 
+void
+KnobHelper::onCurveKeyframesChanged(const Curve* curve,
+                                    int dimension)
+{
+    ///Only the internal curve is indexed, not the gui curve
+    if ( (dimension < 0) || ( dimension >= (int)_imp->curves.size() ) || (_imp->curves[dimension].get() != curve) ) {
+        return;
+    }
+    refreshKeyframesIndex(dimension);
+}
+
+void
+KnobHelper::refreshKeyframesIndex(int dimension)
+{
+    Natron::EffectInstance* effect = dynamic_cast<Natron::EffectInstance*>(_imp->holder);
+    if (!effect) {
+        return;
+    }
+    boost::shared_ptr<Natron::Node> node = effect->getNode();
+    if (!node) {
+        return;
+    }
+    std::list<SequenceTime> times;
+    ///Same knobs as the ones whose keyframes are displayed on the timeline
+    if ( !getIsSecret() && getIsPersistant() && canAnimate() && !dynamic_cast<File_Knob*>(this) && _imp->curves[dimension] ) {
+        KeyFrameSet kfs = _imp->curves[dimension]->getKeyFrames_mt_safe();
+        for (KeyFrameSet::iterator it = kfs.begin(); it != kfs.end(); ++it) {
+            times.push_back( it->getTime() );
+        }
+    }
+    node->setKnobKeyframesInIndex(this, dimension, times);
+}
+
 PyObject*
 KnobHelper::executeExpression(double time, int dimension) const
 {
@@ -2907,6 +2964,9 @@ struct KnobHolder::KnobHolderPrivate
     int evaluationBlocked;
     ChangesList knobChanged;
     
+    mutable QMutex modificationCountMutex;
+    U64 modificationCount;
+    
     bool changeSignificant;
 
     QMutex knobsFrozenMutex;
@@ -2931,6 +2991,8 @@ struct KnobHolder::KnobHolderPrivate
     , evaluationBlockedMutex(QMutex::Recursive)
     , evaluationBlocked(0)
     , knobChanged()
+    , modificationCountMutex()
+    , modificationCount(0)
     , changeSignificant(false)
     , knobsFrozenMutex()
     , knobsFrozen(false)
@@ -2973,6 +3035,7 @@ void
 KnobHolder::addKnob(boost::shared_ptr<KnobI> k)
 {
     assert(QThread::currentThread() == qApp->thread());
+    onKnobModified();
     QMutexLocker kk(&_imp->knobsMutex);
     _imp->knobs.push_back(k);
 }
@@ -2983,6 +3046,7 @@ KnobHolder::insertKnob(int index, const boost::shared_ptr<KnobI>& k)
     if (index < 0) {
         return;
     }
+    onKnobModified();
     QMutexLocker kk(&_imp->knobsMutex);
     
     if (index >= (int)_imp->knobs.size()) {
@@ -3022,6 +3086,7 @@ KnobHolder::refreshKnobs()
 void
 KnobHolder::removeDynamicKnob(KnobI* knob)
 {
+    onKnobModified();
     std::vector<boost::shared_ptr<KnobI> > knobs;
     {
         QMutexLocker k(&_imp->knobsMutex);
@@ -3052,6 +3117,7 @@ KnobHolder::moveKnobOneStepUp(KnobI* knob)
     if (!knob->isUserKnob()) {
         return;
     }
+    onKnobModified();
     boost::shared_ptr<KnobI> parent = knob->getParentKnob();
     Group_Knob* parentIsGrp = dynamic_cast<Group_Knob*>(parent.get());
     Page_Knob* parentIsPage = dynamic_cast<Page_Knob*>(parent.get());
@@ -3088,6 +3154,7 @@ KnobHolder::moveKnobOneStepDown(KnobI* knob)
     if (!knob->isUserKnob()) {
         return;
     }
+    onKnobModified();
     boost::shared_ptr<KnobI> parent = knob->getParentKnob();
     Group_Knob* parentIsGrp = dynamic_cast<Group_Knob*>(parent.get());
     Page_Knob* parentIsPage = dynamic_cast<Page_Knob*>(parent.get());
@@ -3395,9 +3462,24 @@ KnobHolder::onDoValueChangeOnMainThread(KnobI* knob, int reason, int time, bool
     onKnobValueChanged_public(knob, (Natron::ValueChangedReasonEnum)reason, time, originatedFromMT);
 }
 
+U64
+KnobHolder::getKnobsModificationCount() const
+{
+    QMutexLocker l(&_imp->modificationCountMutex);
+    return _imp->modificationCount;
+}
+
+void
+KnobHolder::onKnobModified()
+{
+    QMutexLocker l(&_imp->modificationCountMutex);
+    ++_imp->modificationCount;
+}
+
 void
 KnobHolder::appendValueChange(KnobI* knob,Natron::ValueChangedReasonEnum reason)
 {
+    onKnobModified();
     {
         QMutexLocker l(&_imp->evaluationBlockedMutex);
 
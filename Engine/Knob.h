@@ -42,6 +42,7 @@ class KnobHolder;
 class AppInstance;
 class KnobSerialization;
 class StringAnimationManager;
+class KnobValuesSnapshot;
 namespace Transform {
 struct Matrix3x3;
 }
@@ -570,6 +571,12 @@ public:
     }
     
     virtual void clearExpressionsResults(int dimension) = 0;
+
+    /**
+     * @brief Called by a curve held by this knob whenever its keyframes changed so that the keyframes index of the
+     * node holding the knob is kept up to date.
+     **/
+    virtual void onCurveKeyframesChanged(const Curve* curve,int dimension) = 0;
     
     virtual void clearExpression(int dimension,bool clearResults) = 0;
     virtual std::string getExpression(int dimension) const = 0;
@@ -1241,6 +1248,8 @@ public:
     virtual void getListeners(std::list<boost::shared_ptr<KnobI> >& listeners) const OVERRIDE FINAL;
     
     virtual void clearExpressionsResults(int /*dimension*/) {}
+
+    virtual void onCurveKeyframesChanged(const Curve* curve,int dimension) OVERRIDE FINAL;
     
     void incrementExpressionRecursionLevel() const;
     
@@ -1338,6 +1347,11 @@ protected:
 private:
     
     void expressionChanged(int dimension);
+
+    /**
+     * @brief Sets the keyframes of the given dimension in the keyframes index of the node holding this knob, if any.
+     **/
+    void refreshKeyframesIndex(int dimension);
         
     boost::scoped_ptr<KnobHelperPrivate> _imp;
 };
@@ -1612,6 +1626,13 @@ public:
     
     bool getValueFromCurve(double time,int dimension, bool byPassMaster, bool clamp, T* ret) const;
     
+    /**
+     * @brief If called from a render thread, returns the value frozen when the render started.
+     * Returns false if the value must be read from the knob instead.
+     * @param time The time of the value or NULL for the current time of the holder.
+     **/
+    bool getValueFromRenderSnapshot(const double* time,int dimension,T* ret) const;
+    
 protected:
     
     virtual void resetExtraToDefaultValue(int /*dimension*/) {}
@@ -1945,6 +1966,14 @@ public:
 
     void appendValueChange(KnobI* knob,Natron::ValueChangedReasonEnum reason);
     
+    /**
+     * @brief Returns a number incremented every time a knob of this holder is changed, added or removed, including
+     * the changes that do not modify the hash of the node, e.g: non significant knobs, visibility or expressions.
+     **/
+    U64 getKnobsModificationCount() const;
+    
+    void onKnobModified();
+    
 protected:
     
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -2088,6 +2117,15 @@ public:
      * @brief Returns the local current time of the timeline
      **/
     virtual SequenceTime getCurrentTime() const;
+    
+    /**
+     * @brief Returns the values of the knobs frozen for the frame being rendered by the current thread, or NULL
+     * if the current thread is not rendering, in which case the knobs must be read directly.
+     **/
+    virtual const KnobValuesSnapshot* getRenderKnobValuesSnapshot() const
+    {
+        return 0;
+    }
 
     /**
      * @brief Returns the local current view being rendered or 0
@@ -15,11 +15,15 @@
 
 #include "KnobFile.h"
 
+#include <cassert>
+#include <set>
 #include <utility>
 #include <QtCore/QStringList>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QDir>
 #include <QDebug>
 
+#include "Engine/AppInstance.h"
 #include "Engine/Transform.h"
 #include "Engine/StringAnimationManager.h"
 #include "Engine/KnobTypes.h"
@@ -31,6 +35,78 @@ using namespace Natron;
 using std::make_pair;
 using std::pair;
 
+/***********************************FILE_NAME_PATTERN*****************************************/
+
+FileNamePattern::FileNamePattern()
+: _pattern()
+, _type(ePatternTypeConstant)
+, _prefix()
+, _suffix()
+, _padding(0)
+{
+}
+
+FileNamePattern::FileNamePattern(const std::string& pattern)
+: _pattern(pattern)
+, _type(ePatternTypeGeneric)
+, _prefix()
+, _suffix()
+, _padding(0)
+{
+    ///Variables are only expanded in the file name, not in the path
+    std::size_t fileNameStart = pattern.find_last_of('/');
+    fileNameStart = fileNameStart == std::string::npos ? 0 : fileNameStart + 1;
+    if (pattern.find('%', fileNameStart) != std::string::npos) {
+        return;
+    }
+    std::size_t hashStart = pattern.find('#', fileNameStart);
+    if (hashStart == std::string::npos) {
+        _type = ePatternTypeConstant;
+        return;
+    }
+    std::size_t hashEnd = pattern.find_first_not_of('#', hashStart);
+    if (hashEnd == std::string::npos) {
+        hashEnd = pattern.size();
+    }
+    if (pattern.find('#', hashEnd) != std::string::npos) {
+        return;
+    }
+    _type = ePatternTypeFrameNumber;
+    _prefix = pattern.substr(0, hashStart);
+    _suffix = pattern.substr(hashEnd);
+    _padding = (int)(hashEnd - hashStart);
+}
+
+std::string
+FileNamePattern::generateFileName(int time,
+                                  int view) const
+{
+    switch (_type) {
+        case ePatternTypeConstant:
+            return _pattern;
+        case ePatternTypeFrameNumber:
+            ///Negative frame numbers are left to SequenceParsing
+            if (time >= 0) {
+                std::string frameNumber;
+                for (int t = time; t > 0 || frameNumber.empty(); t /= 10) {
+                    frameNumber.push_back( (char)('0' + t % 10) );
+                }
+                if ( (int)frameNumber.size() < _padding ) {
+                    frameNumber.append(_padding - frameNumber.size(), '0');
+                }
+                std::string ret = _prefix;
+                ret.append( frameNumber.rbegin(), frameNumber.rend() );
+                ret.append(_suffix);
+                assert(ret == SequenceParsing::generateFileNameFromPattern(_pattern, time, view));
+                return ret;
+            }
+            break;
+        case ePatternTypeGeneric:
+            break;
+    }
+    return SequenceParsing::generateFileNameFromPattern(_pattern, time, view);
+}
+
 /***********************************FILE_KNOB*****************************************/
 
 File_Knob::File_Knob(KnobHolder* holder,
@@ -39,6 +115,8 @@ File_Knob::File_Knob(KnobHolder* holder,
                      bool declaredByPlugin)
     : AnimatingString_KnobHelper(holder, description, dimension,declaredByPlugin)
       , _isInputImage(false)
+      , _patternMutex()
+      , _pattern()
 {
 }
 
@@ -98,7 +176,65 @@ File_Knob::getFileName(int time) const
         return getValue();
     } else {
         ///try to interpret the pattern and generate a filename if indexes are found
-        return SequenceParsing::generateFileNameFromPattern(getValue(), time, view);
+        std::string pattern = getValue();
+        QMutexLocker l(&_patternMutex);
+        if (_pattern.getPattern() != pattern) {
+            _pattern = FileNamePattern(pattern);
+        }
+        return _pattern.generateFileName(time, view);
+    }
+}
+
+void
+File_Knob::getFileNamesInRange(int first,
+                               int last,
+                               std::vector<std::string>* fileNames,
+                               std::vector<bool>* exists) const
+{
+    int view = getHolder() ? getHolder()->getCurrentView() : 0;
+    std::string value = getValue();
+    FileNamePattern pattern(value);
+    
+    fileNames->clear();
+    if (last < first) {
+        if (exists) {
+            exists->clear();
+        }
+        return;
+    }
+    fileNames->reserve(last - first + 1);
+    for (int i = first; i <= last; ++i) {
+        fileNames->push_back( _isInputImage ? pattern.generateFileName(i, view) : value );
+    }
+    
+    if (!exists) {
+        return;
+    }
+    exists->resize(fileNames->size());
+    
+    ///The names of the files of each directory
+    std::map<std::string,std::set<std::string> > directories;
+    Natron::Project* project = getHolder() && getHolder()->getApp() ? getHolder()->getApp()->getProject().get() : 0;
+    for (std::size_t i = 0; i < fileNames->size(); ++i) {
+        std::string filePath = (*fileNames)[i];
+        if (project) {
+            project->canonicalizePath(filePath);
+        }
+        std::size_t foundSlash = filePath.find_last_of('/');
+        std::string dirPath = foundSlash == std::string::npos ? std::string() : filePath.substr(0, foundSlash + 1);
+        std::string fileName = foundSlash == std::string::npos ? filePath : filePath.substr(foundSlash + 1);
+        
+        std::map<std::string,std::set<std::string> >::iterator found = directories.find(dirPath);
+        if ( found == directories.end() ) {
+            std::set<std::string>& files = directories[dirPath];
+            QStringList entries = QDir( dirPath.empty() ? QString(".") : QString( dirPath.c_str() ) )
+                                  .entryList(QDir::Files | QDir::Hidden | QDir::System, QDir::Unsorted);
+            for (QStringList::iterator it = entries.begin(); it != entries.end(); ++it) {
+                files.insert( it->toStdString() );
+            }
+            found = directories.find(dirPath);
+        }
+        (*exists)[i] = found->second.find(fileName) != found->second.end();
     }
 }
 
@@ -33,6 +33,43 @@ CLANG_DIAG_ON(deprecated)
 namespace SequenceParsing {
 class SequenceFromFiles;
 }
+
+/**
+ * @brief A file name pattern (e.g: /path/to/sequence.####.exr) parsed once so that the file name of each frame
+ * can be generated without parsing the pattern again.
+ * Patterns whose file name has no variable or a single run of '#' are expanded directly, the other ones
+ * (printf-like frame numbers, views...) are given to SequenceParsing::generateFileNameFromPattern.
+ **/
+class FileNamePattern
+{
+public:
+
+    FileNamePattern();
+
+    explicit FileNamePattern(const std::string& pattern);
+
+    const std::string& getPattern() const
+    {
+        return _pattern;
+    }
+
+    std::string generateFileName(int time,int view) const;
+
+private:
+
+    enum PatternTypeEnum
+    {
+        ePatternTypeConstant = 0, //< the file name does not depend on the frame nor the view
+        ePatternTypeFrameNumber, //< _prefix + the frame number padded to _padding digits + _suffix
+        ePatternTypeGeneric
+    };
+
+    std::string _pattern;
+    PatternTypeEnum _type;
+    std::string _prefix,_suffix;
+    int _padding;
+};
+
 /******************************FILE_KNOB**************************************/
 
 class File_Knob
@@ -92,6 +129,13 @@ public:
      */
     std::string getFileName(int time) const;
 
+    /**
+     * @brief Same as calling getFileName for each frame in [first,last]. If exists is not NULL it is set to whether the file
+     * of each frame exists on disk: each directory the files are in is listed once instead of querying
+     * the file system for each frame, which is much faster to find the missing frames of long sequences.
+     **/
+    void getFileNamesInRange(int first,int last,std::vector<std::string>* fileNames,std::vector<bool>* exists = 0) const;
+
 Q_SIGNALS:
 
     void openFile();
@@ -106,6 +150,10 @@ private:
 
     static const std::string _typeNameStr;
     int _isInputImage;
+
+    ///The pattern last used by getFileName, parsed again when the value of the knob changes
+    mutable QMutex _patternMutex;
+    mutable FileNamePattern _pattern;
 };
 
 /******************************OUTPUT_FILE_KNOB**************************************/
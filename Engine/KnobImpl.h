@@ -37,6 +37,7 @@ CLANG_DIAG_ON(mismatched-tags)
 GCC_DIAG_ON(unused-parameter)
 
 #include "Engine/Curve.h"
+#include "Engine/KnobValuesSnapshot.h"
 #include "Engine/AppInstance.h"
 #include "Engine/Project.h"
 #include "Engine/TimeLine.h"
@@ -570,11 +571,61 @@ Knob<T>::getValueFromMaster(int dimension, KnobI* master,bool clamp) const
 
 
 
+template <typename T>
+bool
+Knob<T>::getValueFromRenderSnapshot(const double* time,
+                                    int dimension,
+                                    T* ret) const
+{
+    KnobHolder* holder = getHolder();
+    const KnobValuesSnapshot* snapshot = holder ? holder->getRenderKnobValuesSnapshot() : 0;
+    double value;
+    if ( !snapshot || !snapshot->getValue(this, time ? *time : holder->getCurrentTime(), dimension, &value) ) {
+        return false;
+    }
+    *ret = (T)value;
+    return true;
+}
+
+template <>
+bool
+Knob<bool>::getValueFromRenderSnapshot(const double* time,
+                                       int dimension,
+                                       bool* ret) const
+{
+    KnobHolder* holder = getHolder();
+    const KnobValuesSnapshot* snapshot = holder ? holder->getRenderKnobValuesSnapshot() : 0;
+    double value;
+    if ( !snapshot || !snapshot->getValue(this, time ? *time : holder->getCurrentTime(), dimension, &value) ) {
+        return false;
+    }
+    *ret = value != 0.;
+    return true;
+}
+
+template <>
+bool
+Knob<std::string>::getValueFromRenderSnapshot(const double* time,
+                                              int dimension,
+                                              std::string* ret) const
+{
+    KnobHolder* holder = getHolder();
+    const KnobValuesSnapshot* snapshot = holder ? holder->getRenderKnobValuesSnapshot() : 0;
+    return snapshot && snapshot->getStringValue(this, time ? *time : holder->getCurrentTime(), dimension, ret);
+}
+
 template <typename T>
 T
 Knob<T>::getValue(int dimension,bool clamp) const
 {
     assert(dimension < (int)_values.size() && dimension >= 0);
+    if (clamp) {
+        ///Render threads read the values frozen when the render started, without any locking
+        T ret;
+        if ( getValueFromRenderSnapshot(0, dimension, &ret) ) {
+            return ret;
+        }
+    }
     std::string hasExpr = getExpression(dimension);
     if (!hasExpr.empty()) {
         T ret;
@@ -644,6 +695,14 @@ Knob<T>::getValueAtTime(double time, int dimension,bool clamp ,bool byPassMaster
 {
     assert(dimension < (int)_values.size() && dimension >= 0);
     
+    if (clamp && !byPassMaster) {
+        ///Render threads read the values frozen when the render started, without any locking
+        T ret;
+        if ( getValueFromRenderSnapshot(&time, dimension, &ret) ) {
+            return ret;
+        }
+    }
+    
     std::string hasExpr = getExpression(dimension);
     if (!hasExpr.empty()) {
         T ret;
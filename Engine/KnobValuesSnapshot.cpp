@@ -0,0 +1,119 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "KnobValuesSnapshot.h"
+
+#include <algorithm>
+
+#include "Engine/Knob.h"
+
+KnobValuesSnapshot::KnobValuesSnapshot(const KnobHolder* holder,
+                                       int time)
+    : _time(time)
+    , _knobs()
+    , _values()
+    , _strings()
+{
+    freeze(holder);
+}
+
+KnobValuesSnapshot::~KnobValuesSnapshot()
+{
+}
+
+void
+KnobValuesSnapshot::freeze(const KnobHolder* holder)
+{
+    std::vector< boost::shared_ptr<KnobI> > knobs = holder->getKnobs_mt_safe();
+
+    _knobs.reserve( knobs.size() );
+    for (std::vector< boost::shared_ptr<KnobI> >::iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        Knob<int>* isInt = dynamic_cast<Knob<int>*>( it->get() );
+        Knob<bool>* isBool = dynamic_cast<Knob<bool>*>( it->get() );
+        Knob<double>* isDouble = dynamic_cast<Knob<double>*>( it->get() );
+        Knob<std::string>* isString = dynamic_cast<Knob<std::string>*>( it->get() );
+
+        KnobEntry entry;
+        entry.knob = it->get();
+        entry.dimension = (*it)->getDimension();
+        entry.isString = isString != 0;
+        if (isString) {
+            entry.index = _strings.size();
+            for (int i = 0; i < entry.dimension; ++i) {
+                _strings.push_back( isString->getValueAtTime(_time, i) );
+            }
+        } else if (isInt || isBool || isDouble) {
+            entry.index = _values.size();
+            for (int i = 0; i < entry.dimension; ++i) {
+                if (isInt) {
+                    _values.push_back( isInt->getValueAtTime(_time, i) );
+                } else if (isBool) {
+                    _values.push_back( isBool->getValueAtTime(_time, i) );
+                } else {
+                    _values.push_back( isDouble->getValueAtTime(_time, i) );
+                }
+            }
+        } else {
+            continue;
+        }
+        _knobs.push_back(entry);
+    }
+    std::sort( _knobs.begin(), _knobs.end() );
+}
+
+const KnobValuesSnapshot::KnobEntry*
+KnobValuesSnapshot::findKnob(const KnobI* knob,
+                             int dimension) const
+{
+    KnobEntry key;
+    key.knob = knob;
+    std::vector<KnobEntry>::const_iterator found = std::lower_bound(_knobs.begin(), _knobs.end(), key);
+    if ( found == _knobs.end() || found->knob != knob || dimension < 0 || dimension >= found->dimension ) {
+        return 0;
+    }
+
+    return &(*found);
+}
+
+bool
+KnobValuesSnapshot::getValue(const KnobI* knob,
+                             double time,
+                             int dimension,
+                             double* value) const
+{
+    if (time != _time) {
+        return false;
+    }
+    const KnobEntry* entry = findKnob(knob, dimension);
+    if (!entry || entry->isString) {
+        return false;
+    }
+    *value = _values[entry->index + dimension];
+
+    return true;
+}
+
+bool
+KnobValuesSnapshot::getStringValue(const KnobI* knob,
+                                   double time,
+                                   int dimension,
+                                   std::string* value) const
+{
+    if (time != _time) {
+        return false;
+    }
+    const KnobEntry* entry = findKnob(knob, dimension);
+    if (!entry || !entry->isString) {
+        return false;
+    }
+    *value = _strings[entry->index + dimension];
+
+    return true;
+}
@@ -0,0 +1,75 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_ENGINE_KNOBVALUESSNAPSHOT_H_
+#define NATRON_ENGINE_KNOBVALUESSNAPSHOT_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <vector>
+#include <string>
+
+class KnobI;
+class KnobHolder;
+
+/**
+ * @brief The values of all the parameters of a KnobHolder at the time of a frame render.
+ * The values are evaluated by the constructor, when the render args of the frame are set on the nodes,
+ * and the snapshot is then shared by all the threads rendering the frame through the ParallelRenderArgs.
+ * It is immutable and read without any locking: edits made during the render are not seen by it.
+ **/
+class KnobValuesSnapshot
+{
+public:
+
+    KnobValuesSnapshot(const KnobHolder* holder,int time);
+
+    ~KnobValuesSnapshot();
+
+    int getTime() const
+    {
+        return _time;
+    }
+
+    /**
+     * @brief Returns the value of the given dimension of a int, bool or double knob at the given time.
+     * Returns false if the value is not part of the snapshot, in which case the live value must be used instead.
+     **/
+    bool getValue(const KnobI* knob,double time,int dimension,double* value) const;
+
+    /**
+     * @brief Same as getValue() for string knobs.
+     **/
+    bool getStringValue(const KnobI* knob,double time,int dimension,std::string* value) const;
+
+private:
+
+    struct KnobEntry
+    {
+        const KnobI* knob;
+        int dimension;
+        std::size_t index; //< index of the first dimension in _values or _strings
+        bool isString;
+
+        bool operator<(const KnobEntry& other) const
+        {
+            return knob < other.knob;
+        }
+    };
+
+    const KnobEntry* findKnob(const KnobI* knob,int dimension) const;
+
+    void freeze(const KnobHolder* holder);
+
+    int _time;
+    std::vector<KnobEntry> _knobs; //< sorted by knob
+    std::vector<double> _values;
+    std::vector<std::string> _strings;
+};
+
+#endif // NATRON_ENGINE_KNOBVALUESSNAPSHOT_H_
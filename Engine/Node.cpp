@@ -17,6 +17,7 @@
 
 #include <limits>
 #include <locale>
+#include <set>
 
 #include <QtCore/QDebug>
 #include <QtCore/QReadWriteLock>
@@ -234,6 +235,9 @@ struct Node::Implementation
     , multiInstanceParentName()
     , duringInputChangedAction(false)
     , keyframesDisplayedOnTimeline(false)
+    , keyframesIndexMutex()
+    , knobsKeyframes()
+    , keyframesIndex()
     , timersMutex()
     , lastRenderStartedSlotCallTime()
     , lastInputNRenderStartedSlotCallTime()
@@ -422,6 +426,10 @@ struct Node::Implementation
     std::string multiInstanceParentName;
     bool duringInputChangedAction; //< true if we're during onInputChanged(...). MT-safe since only modified by the main thread
     bool keyframesDisplayedOnTimeline;
+
+    mutable QMutex keyframesIndexMutex; //< protects knobsKeyframes and keyframesIndex
+    std::map<std::pair<const KnobI*,int>,std::list<SequenceTime> > knobsKeyframes; //< the keyframes in the index of each knob dimension
+    std::multiset<SequenceTime> keyframesIndex; //< the keyframes of all the knobs, a time appears once per keyframe at that time
     
     ///This is to avoid the slots connected to the main-thread to be called too much
     QMutex timersMutex; //< protects lastRenderStartedSlotCallTime & lastInputNRenderStartedSlotCallTime
@@ -5562,29 +5570,50 @@ void
 Node::getAllKnobsKeyframes(std::list<SequenceTime>* keyframes)
 {
     assert(keyframes);
-    const std::vector<boost::shared_ptr<KnobI> > & knobs = getKnobs();
-    
-    for (U32 i = 0; i < knobs.size(); ++i) {
-        if ( knobs[i]->getIsSecret() || !knobs[i]->getIsPersistant()) {
-            continue;
-        }
-        if (!knobs[i]->canAnimate()) {
-            continue;
+    QMutexLocker l(&_imp->keyframesIndexMutex);
+    keyframes->insert( keyframes->end(), _imp->keyframesIndex.begin(), _imp->keyframesIndex.end() );
+}
+
+void
+Node::setKnobKeyframesInIndex(const KnobI* knob,
+                              int dimension,
+                              const std::list<SequenceTime>& times)
+{
+    QMutexLocker l(&_imp->keyframesIndexMutex);
+    std::pair<const KnobI*,int> key = std::make_pair(knob, dimension);
+    std::map<std::pair<const KnobI*,int>,std::list<SequenceTime> >::iterator found = _imp->knobsKeyframes.find(key);
+    if ( found != _imp->knobsKeyframes.end() ) {
+        for (std::list<SequenceTime>::iterator it = found->second.begin(); it != found->second.end(); ++it) {
+            std::multiset<SequenceTime>::iterator indexed = _imp->keyframesIndex.find(*it);
+            assert( indexed != _imp->keyframesIndex.end() );
+            if ( indexed != _imp->keyframesIndex.end() ) {
+                _imp->keyframesIndex.erase(indexed);
+            }
         }
-        int dim = knobs[i]->getDimension();
-        File_Knob* isFile = dynamic_cast<File_Knob*>( knobs[i].get() );
-        if (isFile) {
-            ///skip file knobs
-            continue;
+        if ( times.empty() ) {
+            _imp->knobsKeyframes.erase(found);
+        } else {
+            found->second = times;
         }
-        for (int j = 0; j < dim; ++j) {
-            if (knobs[i]->canAnimate() && knobs[i]->isAnimated(j)) {
-                KeyFrameSet kfs = knobs[i]->getCurve(j)->getKeyFrames_mt_safe();
-                for (KeyFrameSet::iterator it = kfs.begin(); it != kfs.end(); ++it) {
-                    keyframes->push_back( it->getTime() );
-                }
+    } else if ( !times.empty() ) {
+        _imp->knobsKeyframes.insert( std::make_pair(key, times) );
+    }
+    _imp->keyframesIndex.insert( times.begin(), times.end() );
+}
+
+void
+Node::removeKnobFromKeyframesIndex(const KnobI* knob)
+{
+    QMutexLocker l(&_imp->keyframesIndexMutex);
+    std::map<std::pair<const KnobI*,int>,std::list<SequenceTime> >::iterator it = _imp->knobsKeyframes.lower_bound( std::make_pair(knob, INT_MIN) );
+    while ( it != _imp->knobsKeyframes.end() && it->first.first == knob ) {
+        for (std::list<SequenceTime>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            std::multiset<SequenceTime>::iterator indexed = _imp->keyframesIndex.find(*it2);
+            if ( indexed != _imp->keyframesIndex.end() ) {
+                _imp->keyframesIndex.erase(indexed);
             }
         }
+        _imp->knobsKeyframes.erase(it++);
     }
 }
 
@@ -841,9 +841,18 @@ public:
     
     /**
      * @brief Fills keyframes with all different keyframes time that all parameters of this
-     * node have. Some keyframes might appear several times.
+     * node have, in increasing order. Some keyframes might appear several times.
+     * This is read from the keyframes index of the node and does not go through the curves of the knobs.
      **/
     void getAllKnobsKeyframes(std::list<SequenceTime>* keyframes);
+
+    /**
+     * @brief Replaces the keyframes of the given dimension of knob in the keyframes index of the node by times.
+     * This is called by the knobs of this node whenever the keyframes of one of their curves change.
+     **/
+    void setKnobKeyframesInIndex(const KnobI* knob,int dimension,const std::list<SequenceTime>& times);
+
+    void removeKnobFromKeyframesIndex(const KnobI* knob);
     
     
     void setNodeIsRendering();
@@ -39,6 +39,29 @@ NodeCollectionSerialization::initialize(const NodeCollection& group)
     }
 }
 
+void
+NodeCollectionSerialization::replaceNodeSerialization(const boost::shared_ptr<NodeSerialization>& s)
+{
+    for (std::list< boost::shared_ptr<NodeSerialization> >::iterator it = _serializedNodes.begin(); it != _serializedNodes.end(); ++it) {
+        if ((*it)->getNodeScriptName() == s->getNodeScriptName()) {
+            *it = s;
+            return;
+        }
+    }
+    _serializedNodes.push_back(s);
+}
+
+void
+NodeCollectionSerialization::removeNodeSerialization(const std::string& scriptName)
+{
+    for (std::list< boost::shared_ptr<NodeSerialization> >::iterator it = _serializedNodes.begin(); it != _serializedNodes.end(); ++it) {
+        if ((*it)->getNodeScriptName() == scriptName) {
+            _serializedNodes.erase(it);
+            return;
+        }
+    }
+}
+
 bool
 NodeCollectionSerialization::restoreFromSerialization(const std::list< boost::shared_ptr<NodeSerialization> > & serializedNodes,
                                                       const boost::shared_ptr<NodeCollection>& group,
@@ -65,6 +65,16 @@ public:
         _serializedNodes.push_back(s);
     }
     
+    /**
+     * @brief Replaces the serialization of the node with the same script name, or appends it if there is none.
+     **/
+    void replaceNodeSerialization(const boost::shared_ptr<NodeSerialization>& s);
+    
+    /**
+     * @brief Removes the serialization of the node with the given script name, if any.
+     **/
+    void removeNodeSerialization(const std::string& scriptName);
+    
     static bool restoreFromSerialization(const std::list< boost::shared_ptr<NodeSerialization> > & serializedNodes,
                                          const boost::shared_ptr<NodeCollection>& group,
                                          bool createNodes,
@@ -18,9 +18,13 @@
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
 #include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/NodeGroup.h"
 #include "Engine/RotoWrapper.h"
+#include "Engine/Image.h"
+#include "Engine/ImagePlaneWrapper.h"
+#include "Engine/DiskCacheNode.h"
 
 Effect::Effect(const boost::shared_ptr<Natron::Node>& node)
 : Group()
@@ -558,4 +562,55 @@ Effect::getRegionOfDefinition(int time,int view) const
         return RectD();
     }
     return rod;
-}
\ No newline at end of file
+}
+
+PyObject*
+Effect::getCachedImagePlanes(int time,int view,unsigned int mipMapLevel) const
+{
+    PyObject* ret = PyList_New(0);
+    if (!ret || !_node || !_node->getLiveInstance()) {
+        return ret;
+    }
+    Natron::EffectInstance* effect = _node->getLiveInstance();
+    
+    ///Look-up the cache the way renderRoI() does
+    U64 hash = effect->getHash();
+    SequenceTime invariantTime;
+    if ( effect->getTimeInvariantRenderTime(hash, time, &invariantTime) ) {
+        time = invariantTime;
+    }
+    if ( (view != 0) && effect->isViewInvariant() ) {
+        view = 0;
+    }
+    Natron::ImageKey key = Natron::Image::makeKey(hash, effect->isFrameVaryingOrAnimated_Recursive(), time, view);
+    std::list<boost::shared_ptr<Natron::Image> > images;
+    if ( dynamic_cast<DiskCacheNode*>(effect) ) {
+        Natron::getImageFromDiskCache(key, &images);
+    } else {
+        Natron::getImageFromCache(key, &images);
+    }
+    
+    for (std::list<boost::shared_ptr<Natron::Image> >::iterator it = images.begin(); it != images.end(); ++it) {
+        if ( (*it)->getMipMapLevel() != mipMapLevel ) {
+            continue;
+        }
+        PyObject* plane = createImagePlaneForPython(*it);
+        if (!plane) {
+            if ( PyErr_Occurred() ) {
+                Py_DECREF(ret);
+                
+                return NULL;
+            }
+            continue;
+        }
+        int stat = PyList_Append(ret, plane);
+        Py_DECREF(plane);
+        if (stat < 0) {
+            Py_DECREF(ret);
+            
+            return NULL;
+        }
+    }
+    
+    return ret;
+}
@@ -321,6 +321,16 @@ public:
     
     RectD getRegionOfDefinition(int time,int view) const;
     
+#if !defined(SBK_RUN)
+    /**
+     * @brief Returns a new list of NatronEngine.ImagePlane objects giving access without copies to the planes of the images
+     * of this node held by the cache at the given time, view and mip-map level, or an empty list if nothing was rendered there.
+     * Planes being rendered are not returned. See createImagePlaneForPython() for the lifetime of the planes.
+     * This is bound to Python by an add-function of typesystem_engine.xml since Shiboken does not handle the returned objects.
+     **/
+    PyObject* getCachedImagePlanes(int time,int view,unsigned int mipMapLevel) const;
+#endif
+    
     static Param* createParamWrapperForKnob(const boost::shared_ptr<KnobI>& knob);
 };
 
@@ -23,6 +23,8 @@
 #include <string>
 CLANG_DIAG_OFF(deprecated-register) //'register' storage class specifier is deprecated
 #include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QDataStream>
 #include <QtCore/QMutex>
 #include <QtCore/QThreadPool>
 #include <QtCore/QCoreApplication>
@@ -75,6 +77,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/Node.h"
 #include "Engine/AppInstance.h"
 #include "Engine/Project.h"
+#include "Engine/Timer.h"
 
 using namespace Natron;
 
@@ -486,6 +489,113 @@ Natron::OfxHost::addPathToLoadOFXPlugins(const std::string path)
 const TCHAR * getStdOFXPluginPath(const std::string &hostId);
 #endif
 
+namespace {
+
+///Identifies the content of the OFX plug-ins cache manifest file
+#define NATRON_OFX_CACHE_MANIFEST_MAGIC 0x4E4F4658
+#define NATRON_OFX_CACHE_MANIFEST_VERSION 1
+
+///A plug-in binary found on disk: the OpenFX plug-ins cache is valid as long as none of them changed
+struct OfxBinaryFileInfo
+{
+    QString filePath;
+    qint64 modificationTime;
+    qint64 size;
+    
+    bool operator==(const OfxBinaryFileInfo& other) const
+    {
+        return filePath == other.filePath && modificationTime == other.modificationTime && size == other.size;
+    }
+    
+    bool operator<(const OfxBinaryFileInfo& other) const
+    {
+        return filePath < other.filePath;
+    }
+};
+
+typedef std::vector<OfxBinaryFileInfo> OfxBinaryFileInfoList;
+
+/**
+ * @brief Lists the binaries of the plug-ins known to the OpenFX plug-ins cache. After PluginCache::scanPluginFiles()
+ * the modification time and size of each binary are the ones found on disk by the scan, so that no other pass
+ * over the plug-in directories is needed to know whether the cache changed.
+ **/
+static void
+getPluginBinaries(OfxBinaryFileInfoList* binaries)
+{
+    const std::list<OFX::Host::Plugin*>& plugins = OFX::Host::PluginCache::getPluginCache()->getPlugins();
+    for (std::list<OFX::Host::Plugin*>::const_iterator it = plugins.begin(); it != plugins.end(); ++it) {
+        OFX::Host::PluginBinary* binary = (*it)->getBinary();
+        if (!binary) {
+            continue;
+        }
+        OfxBinaryFileInfo info;
+        info.filePath = QString::fromUtf8( binary->getFilePath().c_str() );
+        info.modificationTime = (qint64)binary->getFileModificationTime();
+        info.size = (qint64)binary->getFileSize();
+        binaries->push_back(info);
+    }
+    ///A binary may contain several plug-ins
+    std::sort( binaries->begin(), binaries->end() );
+    binaries->erase( std::unique( binaries->begin(), binaries->end() ), binaries->end() );
+}
+
+static QString
+getOFXCacheFilePath(const QString& fileName)
+{
+    return Natron::StandardPaths::writableLocation(Natron::StandardPaths::eStandardLocationCache) + QDir::separator() + fileName;
+}
+
+/**
+ * @brief Reads the list of binaries that were on disk when OFXCache.xml was last written. Returns false if the file
+ * does not exist or was written by another version.
+ **/
+static bool
+readOFXCacheManifest(const QString& cacheVersion,
+                     OfxBinaryFileInfoList* binaries)
+{
+    QFile file( getOFXCacheFilePath("OFXCache.manifest") );
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic,count;
+    qint32 version;
+    QString fileCacheVersion;
+    stream >> magic >> version;
+    if (magic != NATRON_OFX_CACHE_MANIFEST_MAGIC || version != NATRON_OFX_CACHE_MANIFEST_VERSION) {
+        return false;
+    }
+    stream >> fileCacheVersion >> count;
+    if (fileCacheVersion != cacheVersion || stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        OfxBinaryFileInfo info;
+        stream >> info.filePath >> info.modificationTime >> info.size;
+        binaries->push_back(info);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+static void
+writeOFXCacheManifest(const QString& cacheVersion,
+                      const OfxBinaryFileInfoList& binaries)
+{
+    QFile file( getOFXCacheFilePath("OFXCache.manifest") );
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << (quint32)NATRON_OFX_CACHE_MANIFEST_MAGIC << (qint32)NATRON_OFX_CACHE_MANIFEST_VERSION;
+    stream << cacheVersion << (quint32)binaries.size();
+    for (OfxBinaryFileInfoList::const_iterator it = binaries.begin(); it != binaries.end(); ++it) {
+        stream << it->filePath << it->modificationTime << it->size;
+    }
+}
+
+} // anon namespace
+
 void
 Natron::OfxHost::loadOFXPlugins(std::map<std::string,std::vector< std::pair<std::string,double> > >* readersMap,
                                 std::map<std::string,std::vector< std::pair<std::string,double> > >* writersMap)
@@ -532,22 +642,44 @@ Natron::OfxHost::loadOFXPlugins(std::map<std::string,std::vector< std::pair<std:
         // ignore
     }
 
+    TimeLapse phaseTimer;
+    const QString cacheVersion(NATRON_APPLICATION_NAME "OFXCachev1");
+    
     /// now read an old cache
     // The cache location depends on the OS.
     // On OSX, it will be ~/Library/Caches/<organization>/<application>/OFXCache.xml
     //on Linux ~/.cache/<organization>/<application>/OFXCache.xml
     //on windows:
-    QString ofxcachename = Natron::StandardPaths::writableLocation(Natron::StandardPaths::eStandardLocationCache) + QDir::separator() + "OFXCache.xml";
+    QString ofxcachename = getOFXCacheFilePath("OFXCache.xml");
+    bool cacheUpToDate = false;
     std::ifstream ifs( ofxcachename.toStdString().c_str() );
-    if ( ifs.is_open() ) {
+    bool ifsOpened = ifs.is_open();
+    if (ifsOpened) {
         OFX::Host::PluginCache::getPluginCache()->readCache(ifs);
         ifs.close();
     }
+    appPTR->addStartupPhaseTiming( QObject::tr("OpenFX: reading plug-ins cache"), phaseTimer.getTimeElapsedReset() );
+    
+    ///Binaries that are not in the cache (or changed) are loaded and described here. Describing plug-ins in a context
+    ///is done lazily when the first node of the plug-in is created, see AppInstance::createNodeInternal
     OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
+    
+    ///The cache was written for exactly the same binaries: it does not need to be written again
+    OfxBinaryFileInfoList binaries;
+    getPluginBinaries(&binaries);
+    if (ifsOpened) {
+        OfxBinaryFileInfoList cachedBinaries;
+        cacheUpToDate = readOFXCacheManifest(cacheVersion, &cachedBinaries) && cachedBinaries == binaries;
+    }
+    appPTR->addStartupPhaseTiming( QObject::tr("OpenFX: scanning %1 plug-in binaries").arg( binaries.size() ), phaseTimer.getTimeElapsedReset() );
 
     // write the cache NOW (it won't change anyway)
-    /// flush out the current cache
-    writeOFXCache();
+    /// flush out the current cache, unless it is known to be identical
+    if (!cacheUpToDate) {
+        writeOFXCache();
+        writeOFXCacheManifest(cacheVersion, binaries);
+        appPTR->addStartupPhaseTiming( QObject::tr("OpenFX: writing plug-ins cache"), phaseTimer.getTimeElapsedReset() );
+    }
 
     /*Filling node name list and plugin grouping*/
     typedef std::map<OFX::Host::ImageEffect::MajorPlugin,OFX::Host::ImageEffect::ImageEffectPlugin *> PMap;
@@ -664,6 +796,7 @@ Natron::OfxHost::loadOFXPlugins(std::map<std::string,std::vector< std::pair<std:
             }
         }
     }
+    appPTR->addStartupPhaseTiming( QObject::tr("OpenFX: registering %1 plug-ins").arg( ofxPlugins.size() ), phaseTimer.getTimeElapsedReset() );
 } // loadOFXPlugins
 
 void
@@ -694,6 +827,10 @@ Natron::OfxHost::clearPluginsLoadedCache()
     if ( QFile::exists(ofxcachename) ) {
         QFile::remove(ofxcachename);
     }
+    QString manifestName = getOFXCacheFilePath("OFXCache.manifest");
+    if ( QFile::exists(manifestName) ) {
+        QFile::remove(manifestName);
+    }
 }
 
 void
@@ -2159,6 +2159,55 @@ DefaultScheduler::getSchedulingPolicy() const
 }
 
 
+static void
+resetNodesRenderStatistics(Natron::OutputEffectInstance* effect)
+{
+    NodeList nodes;
+    effect->getApp()->getProject()->getNodes_recursive(nodes);
+    for (NodeList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        Natron::EffectInstance* liveInstance = (*it)->getLiveInstance();
+        if (liveInstance) {
+            liveInstance->resetRenderStatistics();
+        }
+    }
+}
+
+/**
+ * @brief Logs how concurrently each node rendered, to spot the nodes whose thread-safety serializes the render.
+ **/
+static void
+reportNodesRenderStatistics(Natron::OutputEffectInstance* effect)
+{
+    NodeList nodes;
+    effect->getApp()->getProject()->getNodes_recursive(nodes);
+    QString report;
+    for (NodeList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        Natron::EffectInstance* liveInstance = (*it)->getLiveInstance();
+        if (!liveInstance) {
+            continue;
+        }
+        Natron::EffectInstance::RenderStatistics stats = liveInstance->getRenderStatistics();
+        if (stats.nRenders == 0 || stats.busyTime <= 0.) {
+            continue;
+        }
+        report.append( QString("%1: %2 renders, effective parallelism %3 (%4 s rendering in %5 s, %6 s waiting for the thread-safety lock)\n")
+                       .arg( (*it)->getFullyQualifiedName().c_str() )
+                       .arg(stats.nRenders)
+                       .arg(stats.renderTime / stats.busyTime, 0, 'f', 2)
+                       .arg(stats.renderTime, 0, 'f', 2)
+                       .arg(stats.busyTime, 0, 'f', 2)
+                       .arg(stats.lockWaitTime, 0, 'f', 2) );
+    }
+    if ( report.isEmpty() ) {
+        return;
+    }
+    report.prepend( QString("Render statistics of %1:\n").arg( effect->getNode()->getFullyQualifiedName().c_str() ) );
+    appPTR->writeToOfxLog_mt_safe(report);
+    if ( appPTR->isBackground() ) {
+        std::cout << report.toStdString() << std::flush;
+    }
+}
+
 void
 DefaultScheduler::aboutToStartRender()
 {
@@ -2182,6 +2231,8 @@ DefaultScheduler::aboutToStartRender()
         appPTR->writeToOutputPipe(kRenderingStartedLong, kRenderingStartedShort);
     }
     
+    resetNodesRenderStatistics(_effect);
+    
     std::string cb = _effect->getNode()->getBeforeRenderCallback();
     if (!cb.empty()) {
         std::vector<std::string> args;
@@ -2214,11 +2265,13 @@ DefaultScheduler::aboutToStartRender()
 void
 DefaultScheduler::onRenderStopped(bool aborted)
 {
+    reportNodesRenderStatistics(_effect);
+    
     bool isBackGround = appPTR->isBackground();
     if (!isBackGround) {
         _effect->setKnobsFrozen(false);
     } else {
-        _effect->notifyRenderFinished();
+        _effect->notifyRenderFinished(aborted);
     }
     
     std::string cb = _effect->getNode()->getAfterRenderCallback();
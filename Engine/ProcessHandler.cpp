@@ -14,6 +14,9 @@
 
 #include "ProcessHandler.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <QProcess>
 #include <QLocalServer>
 #include <QLocalSocket>
@@ -22,12 +25,20 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <QDir>
+#include <QFileInfo>
 #include <QDebug>
 
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
 #include "Engine/Node.h"
 #include "Engine/EffectInstance.h"
+#include "Engine/Project.h"
+
+///The number of projects a render daemon keeps loaded between jobs
+#define NATRON_RENDER_DAEMON_MAX_LOADED_PROJECTS 4
+
+///The number of render processes that may fail to render the same frames before giving up
+#define NATRON_MULTI_PROCESS_RENDER_MAX_ATTEMPTS 2
 
 ProcessHandler::ProcessHandler(AppInstance* app,
                                const QString & projectPath,
@@ -349,3 +360,714 @@ ProcessInputChannel::onOutputPipeConnectionMade()
     qDebug() << "The output channel was successfully created and connected.";
 }
 
+
+RenderDaemon::RenderDaemon(const QString & serverName)
+    : QThread()
+      , _server(new QLocalServer)
+      , _outputMutex(new QMutex)
+      , _pendingOutput()
+      , _connectedClient(0)
+      , _jobClient(0)
+      , _jobs()
+      , _renderingJobs(false)
+      , _jobMutex(new QMutex)
+      , _jobRunning(false)
+      , _jobAborted(false)
+      , _jobApp(0)
+      , _loadedProjects()
+      , _mustQuit(false)
+      , _mustQuitMutex(new QMutex)
+{
+    if ( !_server->listen(serverName) && (_server->serverError() == QAbstractSocket::AddressInUseError) ) {
+        ///A previous daemon crashed without removing its socket
+        QLocalServer::removeServer(serverName);
+        _server->listen(serverName);
+    }
+
+    QObject::connect( this, SIGNAL( jobReceived(QString,int) ), this, SLOT( onJobReceived(QString,int) ) );
+    _server->moveToThread(this);
+    if ( _server->isListening() ) {
+        appPTR->setRenderDaemon(this);
+        start();
+    }
+}
+
+RenderDaemon::~RenderDaemon()
+{
+    if ( isRunning() ) {
+        {
+            QMutexLocker l(_mustQuitMutex);
+            _mustQuit = true;
+        }
+        wait();
+    }
+    closeLoadedProjects();
+    if ( _server->isListening() ) {
+        appPTR->setRenderDaemon(0);
+    }
+
+    delete _server;
+    delete _outputMutex;
+    delete _jobMutex;
+    delete _mustQuitMutex;
+}
+
+bool
+RenderDaemon::isListening() const
+{
+    return _server->isListening();
+}
+
+QString
+RenderDaemon::getFullServerName() const
+{
+    return _server->fullServerName();
+}
+
+void
+RenderDaemon::writeToClient(const QString & message)
+{
+    QMutexLocker l(_outputMutex);
+
+    ///The client of the job disconnected: its messages must not be sent to the next client
+    if ( (_jobClient == 0) || (_jobClient != _connectedClient) ) {
+        return;
+    }
+    _pendingOutput.push_back(message);
+}
+
+void
+RenderDaemon::run()
+{
+    QLocalSocket* client = 0;
+    int nClients = 0;
+
+    for (;; ) {
+        {
+            QMutexLocker l(_mustQuitMutex);
+            if (_mustQuit) {
+                break;
+            }
+        }
+
+        if (!client) {
+            if ( _server->waitForNewConnection(100) ) {
+                client = _server->nextPendingConnection();
+                qDebug() << "Render daemon: a client connected.";
+                QMutexLocker l(_outputMutex);
+                _connectedClient = ++nClients;
+                _pendingOutput.clear();
+            }
+            continue;
+        }
+
+        ///Send what was written by the renders since the last iteration
+        QStringList messages;
+        {
+            QMutexLocker l(_outputMutex);
+            messages = _pendingOutput;
+            _pendingOutput.clear();
+        }
+        for (QStringList::iterator it = messages.begin(); it != messages.end(); ++it) {
+            client->write( (*it + '\n').toUtf8() );
+        }
+        if ( !messages.isEmpty() ) {
+            client->flush();
+        }
+
+        if ( client->canReadLine() || client->waitForReadyRead(100) ) {
+            while ( client->canReadLine() ) {
+                QString str( client->readLine() );
+                while ( str.endsWith('\n') || str.endsWith('\r') ) {
+                    str.chop(1);
+                }
+                if ( !str.isEmpty() ) {
+                    onClientMessageReceived(str, nClients);
+                }
+            }
+        } else if (client->state() != QLocalSocket::ConnectedState) {
+            qDebug() << "Render daemon: the client disconnected.";
+            {
+                QMutexLocker l(_outputMutex);
+                _connectedClient = 0;
+                _pendingOutput.clear();
+            }
+            ///Nobody waits for the result of the job anymore
+            abortCurrentJob();
+            delete client;
+            client = 0;
+        }
+    }
+
+    delete client;
+}
+
+void
+RenderDaemon::onClientMessageReceived(const QString & message,
+                                      int client)
+{
+    if (message == kAbortRenderingStringShort) {
+        qDebug() << "Render daemon: aborting render!";
+        abortCurrentJob();
+    } else if (message == kQuitRenderDaemonStringShort) {
+        {
+            QMutexLocker l(_mustQuitMutex);
+            _mustQuit = true;
+        }
+        abortCurrentJob();
+        Q_EMIT quitRequested();
+    } else {
+        Q_EMIT jobReceived(message, client);
+    }
+}
+
+void
+RenderDaemon::abortCurrentJob()
+{
+    ///The main thread is blocked while the job renders, so the abort cannot be posted to it. Instead only the instance
+    ///of the job is aborted: the main thread cannot create or close it while we hold the lock.
+    QMutexLocker l(_jobMutex);
+
+    if (!_jobRunning) {
+        return;
+    }
+    _jobAborted = true;
+    if (_jobApp) {
+        _jobApp->getProject()->quitAnyProcessingForAllNodes();
+    }
+}
+
+void
+RenderDaemon::onJobReceived(const QString & job,
+                            int client)
+{
+    ///always running in the main thread
+    assert( QThread::currentThread() == qApp->thread() );
+
+    _jobs.push_back( std::make_pair(job, client) );
+
+    ///A render may process events, in which case the job will be picked by the loop below
+    if (_renderingJobs) {
+        return;
+    }
+    _renderingJobs = true;
+    while ( !_jobs.empty() ) {
+        {
+            QMutexLocker l(_mustQuitMutex);
+            if (_mustQuit) {
+                _jobs.clear();
+                break;
+            }
+        }
+        std::pair<QString,int> next = _jobs.front();
+        _jobs.pop_front();
+        bool clientConnected;
+        {
+            QMutexLocker l(_outputMutex);
+            clientConnected = next.second == _connectedClient;
+        }
+        if (!clientConnected) {
+            qDebug() << "Render daemon: dropping job" << next.first << "because its client disconnected.";
+            continue;
+        }
+        renderJob(next.first, next.second);
+    }
+    _renderingJobs = false;
+}
+
+/**
+ * @brief Splits a job line into arguments, arguments enclosed in double quotes may contain spaces.
+ **/
+static QStringList
+splitJobArguments(const QString & job)
+{
+    QStringList ret;
+    QString arg;
+    bool inQuotes = false;
+    bool hasArg = false;
+
+    for (int i = 0; i < job.size(); ++i) {
+        const QChar c = job.at(i);
+        if ( c == QChar('"') ) {
+            inQuotes = !inQuotes;
+            hasArg = true;
+        } else if ( !inQuotes && c.isSpace() ) {
+            if (hasArg) {
+                ret.push_back(arg);
+                arg.clear();
+                hasArg = false;
+            }
+        } else {
+            arg.append(c);
+            hasArg = true;
+        }
+    }
+    if (hasArg) {
+        ret.push_back(arg);
+    }
+
+    return ret;
+}
+
+void
+RenderDaemon::renderJob(const QString & job,
+                        int client)
+{
+    qDebug() << "Render daemon: starting job" << job;
+
+    {
+        QMutexLocker l(_outputMutex);
+        _jobClient = client;
+    }
+    {
+        QMutexLocker l(_jobMutex);
+        _jobRunning = true;
+        ///An abort only applies to the job being rendered when it is received
+        _jobAborted = false;
+        _jobApp = 0;
+    }
+
+    QString error;
+    bool ok = renderJobInternal(job, &error);
+
+    {
+        QMutexLocker l(_jobMutex);
+        _jobRunning = false;
+        assert(!_jobApp);
+    }
+
+    ///The only line reporting the result of the job, the writers do not report the end of their render to the client
+    if (ok) {
+        writeToClient(kRenderingFinishedStringShort);
+    } else {
+        writeToClient(QString(kRenderJobFailedStringShort) + error);
+    }
+    {
+        QMutexLocker l(_outputMutex);
+        _jobClient = 0;
+    }
+}
+
+bool
+RenderDaemon::renderJobInternal(const QString & job,
+                                QString* error)
+{
+    QStringList args = splitJobArguments(job);
+    args.push_front( QCoreApplication::applicationFilePath() );
+
+    CLArgs cl(args, true);
+    if ( (cl.getError() > 0) || cl.isInterpreterMode() || cl.isRenderDaemon() || cl.getFilename().isEmpty() ) {
+        *error = tr("Invalid render job: ") + job;
+
+        return false;
+    }
+
+    QFileInfo info( cl.getFilename() );
+    if ( !info.exists() ) {
+        *error = tr("Specified file does not exist");
+
+        return false;
+    }
+    bool isProject = info.suffix() == NATRON_PROJECT_FILE_EXT;
+    if ( !isProject && (info.suffix() != "py") ) {
+        *error = tr(NATRON_APPLICATION_NAME " only accepts python scripts or .ntp project files");
+
+        return false;
+    }
+
+    ///Scripts and -o options create nodes, the project cannot be re-used by the next jobs
+    bool keepLoaded = isProject;
+    const std::list<CLArgs::WriterArg> & writers = cl.getWriterArgs();
+    for (std::list<CLArgs::WriterArg>::const_iterator it = writers.begin(); it != writers.end(); ++it) {
+        if (it->mustCreate) {
+            keepLoaded = false;
+        }
+    }
+
+    AppInstance* app = keepLoaded ? getLoadedProject( info.absoluteFilePath(), info.lastModified() ) : 0;
+    bool mustLoad = !app;
+    if (mustLoad) {
+        app = appPTR->newAppInstance( CLArgs() );
+        if (!app) {
+            *error = tr("Cannot create a new application instance");
+
+            return false;
+        }
+    }
+
+    bool ok = true;
+    try {
+        if (mustLoad) {
+            if (isProject) {
+                if ( !app->getProject()->loadProject( info.path(), info.fileName() ) ) {
+                    throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
+                }
+            } else if ( !app->loadPythonScript(info) ) {
+                throw std::invalid_argument( tr("Python script loading failed.").toStdString() );
+            }
+        }
+        ///From now on the daemon thread may abort the instance
+        {
+            QMutexLocker l(_jobMutex);
+            if (_jobAborted) {
+                throw std::runtime_error( tr("Render aborted").toStdString() );
+            }
+            _jobApp = app;
+        }
+        if ( cl.isProjectConversion() ) {
+            app->getProject()->exportProject( cl.getConvertedProjectFilename(), cl.isConversionToBinary() );
+        } else {
+            ok = app->startWritersRenderingForCL(cl);
+        }
+    } catch (const std::exception & e) {
+        ok = false;
+        *error = e.what();
+    }
+
+    bool aborted;
+    {
+        QMutexLocker l(_jobMutex);
+        _jobApp = 0;
+        aborted = _jobAborted;
+    }
+    if (aborted) {
+        ok = false;
+        *error = tr("Render aborted");
+    } else if ( !ok && error->isEmpty() ) {
+        *error = tr("Render failed");
+    }
+
+    if (keepLoaded && ok) {
+        if (mustLoad) {
+            LoadedProject p;
+            p.filePath = info.absoluteFilePath();
+            p.lastModified = info.lastModified();
+            p.app = app;
+            _loadedProjects.push_front(p);
+            while (_loadedProjects.size() > NATRON_RENDER_DAEMON_MAX_LOADED_PROJECTS) {
+                closeProject(_loadedProjects.back().app);
+                _loadedProjects.pop_back();
+            }
+        }
+    } else {
+        ///The state of a project that failed to render is unknown, do not re-use it
+        if (!mustLoad) {
+            assert(!_loadedProjects.empty() && _loadedProjects.front().app == app);
+            _loadedProjects.pop_front();
+        }
+        closeProject(app);
+    }
+
+    return ok;
+}
+
+AppInstance*
+RenderDaemon::getLoadedProject(const QString & filePath,
+                               const QDateTime & lastModified)
+{
+    for (std::list<LoadedProject>::iterator it = _loadedProjects.begin(); it != _loadedProjects.end(); ++it) {
+        if (it->filePath != filePath) {
+            continue;
+        }
+        if (it->lastModified != lastModified) {
+            ///The project was modified since it was loaded
+            closeProject(it->app);
+            _loadedProjects.erase(it);
+
+            return 0;
+        }
+        ///Move it to the front so the least recently used project is evicted first
+        LoadedProject p = *it;
+        _loadedProjects.erase(it);
+        _loadedProjects.push_front(p);
+
+        return p.app;
+    }
+
+    return 0;
+}
+
+void
+RenderDaemon::closeProject(AppInstance* app)
+{
+    try {
+        app->getProject()->closeProject(true);
+    } catch (std::logic_error) {
+        // ignore
+    }
+    try {
+        app->quit();
+    } catch (std::logic_error) {
+        // ignore
+    }
+}
+
+void
+RenderDaemon::closeLoadedProjects()
+{
+    for (std::list<LoadedProject>::iterator it = _loadedProjects.begin(); it != _loadedProjects.end(); ++it) {
+        closeProject(it->app);
+    }
+    _loadedProjects.clear();
+}
+
+MultiProcessRenderer::MultiProcessRenderer(int nProcesses,
+                                           FrameSplittingEnum splitting)
+    : _nProcesses(nProcesses)
+      , _splitting(splitting)
+      , _queue()
+      , _processes()
+      , _nFramesTotal(0)
+      , _nFramesRendered(0)
+      , _renderingStartedReported(false)
+{
+}
+
+MultiProcessRenderer::~MultiProcessRenderer()
+{
+    stopProcesses();
+}
+
+void
+MultiProcessRenderer::queueContiguousChunks(const QString & writerName,
+                                            const std::set<int> & frames,
+                                            int attempts,
+                                            int maxChunkSize,
+                                            std::list<RenderChunk>* queue)
+{
+    RenderChunk chunk;
+
+    chunk.writerName = writerName;
+    chunk.attempts = attempts;
+    for (std::set<int>::const_iterator it = frames.begin(); it != frames.end(); ++it) {
+        if ( !chunk.frames.empty() && ( (*chunk.frames.rbegin() != *it - 1) || ( (int)chunk.frames.size() >= maxChunkSize ) ) ) {
+            queue->push_back(chunk);
+            chunk.frames.clear();
+        }
+        chunk.frames.insert(*it);
+    }
+    if ( !chunk.frames.empty() ) {
+        queue->push_back(chunk);
+    }
+}
+
+void
+MultiProcessRenderer::addWriter(const QString & writerName,
+                                int firstFrame,
+                                int lastFrame,
+                                bool canSplit)
+{
+    if (lastFrame < firstFrame) {
+        return;
+    }
+    std::set<int> frames;
+    for (int i = firstFrame; i <= lastFrame; ++i) {
+        frames.insert(i);
+    }
+    _nFramesTotal += (int)frames.size();
+
+    int nFrames = lastFrame - firstFrame + 1;
+    int maxChunkSize;
+    if (!canSplit) {
+        maxChunkSize = nFrames;
+    } else if (_splitting == eFrameSplittingInterleaved) {
+        maxChunkSize = 1;
+    } else {
+        maxChunkSize = (nFrames + _nProcesses - 1) / _nProcesses;
+    }
+    queueContiguousChunks(writerName, frames, 0, maxChunkSize, &_queue);
+}
+
+void
+MultiProcessRenderer::startProcesses()
+{
+    ///Do not start more processes than there are chunks to render
+    int nProcesses = std::min( _nProcesses, (int)_queue.size() );
+
+    _processes.resize(nProcesses);
+    for (int i = 0; i < nProcesses; ++i) {
+        RenderProcess & p = _processes[i];
+        {
+            QTemporaryFile tmpf( QDir::tempPath() + QDir::separator() + NATRON_APPLICATION_NAME "_RENDER_PROCESS_"
+                                 + QString::number( QCoreApplication::applicationPid() ) + "_" + QString::number(i) );
+            tmpf.open();
+            p.serverName = tmpf.fileName();
+            tmpf.remove();
+        }
+        p.process = new QProcess;
+        ///Let the render processes print to our own output, otherwise they would block once the pipes are full
+        p.process->setProcessChannelMode(QProcess::ForwardedChannels);
+        p.socket = new QLocalSocket;
+        p.connected = false;
+        p.dead = false;
+        p.busy = false;
+        p.chunk.attempts = 0;
+
+        QStringList args;
+        args << "-b" << "--daemon" << p.serverName;
+        p.process->start(QCoreApplication::applicationFilePath(), args);
+    }
+}
+
+void
+MultiProcessRenderer::sendNextChunk(RenderProcess* p,
+                                    const QString & projectFilePath)
+{
+    assert( !p->busy && !_queue.empty() );
+    p->chunk = _queue.front();
+    _queue.pop_front();
+    p->busy = true;
+
+    QString job = QString("-w %1 %2-%3 \"%4\"").arg(p->chunk.writerName).arg( *p->chunk.frames.begin() )
+                  .arg( *p->chunk.frames.rbegin() ).arg(projectFilePath);
+    p->socket->write( (job + '\n').toUtf8() );
+    p->socket->flush();
+}
+
+void
+MultiProcessRenderer::requeueChunk(RenderProcess* p,
+                                   const std::string & reason)
+{
+    if (!p->busy) {
+        return;
+    }
+    p->busy = false;
+    if ( p->chunk.frames.empty() ) {
+        return;
+    }
+    int attempts = p->chunk.attempts + 1;
+    if (attempts >= NATRON_MULTI_PROCESS_RENDER_MAX_ATTEMPTS) {
+        throw std::runtime_error( QObject::tr("Frames of %1 could not be rendered: ").arg(p->chunk.writerName).toStdString() + reason );
+    }
+    std::cout << QObject::tr("A render process failed to render frames of %1, rendering them again with another process: ")
+        .arg(p->chunk.writerName).toStdString() << reason << std::endl;
+
+    std::list<RenderChunk> chunks;
+    queueContiguousChunks(p->chunk.writerName, p->chunk.frames, attempts,
+                          _splitting == eFrameSplittingInterleaved ? 1 : (int)p->chunk.frames.size(), &chunks);
+    ///Render them first
+    _queue.splice(_queue.begin(), chunks);
+}
+
+void
+MultiProcessRenderer::onProcessMessageReceived(RenderProcess* p,
+                                               const QString & message)
+{
+    if ( message.startsWith(kRenderingStartedShort) ) {
+        if (!_renderingStartedReported) {
+            _renderingStartedReported = true;
+            appPTR->writeToOutputPipe(kRenderingStartedLong, kRenderingStartedShort);
+        }
+    } else if ( message.startsWith(kFrameRenderedStringShort) ) {
+        QString frameStr = message.mid( QString(kFrameRenderedStringShort).size() );
+        bool ok;
+        int frame = frameStr.toInt(&ok);
+        if ( ok && p->busy && (p->chunk.frames.erase(frame) > 0) ) {
+            ++_nFramesRendered;
+            QString pStr = QString::number(_nFramesRendered * 100. / _nFramesTotal);
+            appPTR->writeToOutputPipe(kFrameRenderedStringLong + frameStr + " (" + pStr + "%)", kFrameRenderedStringShort + frameStr);
+        }
+    } else if ( message.startsWith(kRenderingFinishedStringShort) ) {
+        ///This is the only line ending a job, see RenderDaemon. Frames the job did not report are rendered again
+        if ( p->chunk.frames.empty() ) {
+            p->busy = false;
+        } else {
+            requeueChunk( p, QObject::tr("the render process did not render all the frames it was given").toStdString() );
+        }
+    } else if ( message.startsWith(kRenderJobFailedStringShort) ) {
+        requeueChunk( p, message.mid( QString(kRenderJobFailedStringShort).size() ).toStdString() );
+    }
+}
+
+void
+MultiProcessRenderer::render(const QString & projectFilePath)
+{
+    if ( _queue.empty() ) {
+        return;
+    }
+    startProcesses();
+
+    for (;; ) {
+        if ( appPTR->hasAbortAnyProcessingBeenCalled() ) {
+            stopProcesses();
+            throw std::runtime_error( QObject::tr("Render aborted").toStdString() );
+        }
+
+        int nAlive = 0;
+        int nBusy = 0;
+        for (std::size_t i = 0; i < _processes.size(); ++i) {
+            RenderProcess & p = _processes[i];
+            if (p.dead) {
+                continue;
+            }
+            if (!p.connected) {
+                if (p.process->state() == QProcess::NotRunning) {
+                    std::cout << QObject::tr("A render process failed to start").toStdString() << std::endl;
+                    p.dead = true;
+                    continue;
+                }
+                ///The process listens only once it has finished loading
+                p.socket->connectToServer(p.serverName, QLocalSocket::ReadWrite);
+                if ( !p.socket->waitForConnected(50) ) {
+                    p.socket->abort();
+                    ++nAlive;
+                    continue;
+                }
+                p.connected = true;
+            }
+
+            if ( !p.busy && !_queue.empty() ) {
+                sendNextChunk(&p, projectFilePath);
+            }
+
+            if ( p.socket->canReadLine() || p.socket->waitForReadyRead(10) ) {
+                while ( p.socket->canReadLine() ) {
+                    QString str( p.socket->readLine() );
+                    while ( str.endsWith('\n') ) {
+                        str.chop(1);
+                    }
+                    onProcessMessageReceived(&p, str);
+                }
+            } else if (p.socket->state() != QLocalSocket::ConnectedState) {
+                p.dead = true;
+                requeueChunk(&p, QObject::tr("the render process exited unexpectedly").toStdString());
+                continue;
+            }
+            ++nAlive;
+            if (p.busy) {
+                ++nBusy;
+            }
+        }
+
+        if ( (nBusy == 0) && _queue.empty() ) {
+            break;
+        }
+        if (nAlive == 0) {
+            throw std::runtime_error( QObject::tr("All render processes failed").toStdString() );
+        }
+    }
+
+    stopProcesses();
+}
+
+void
+MultiProcessRenderer::stopProcesses()
+{
+    for (std::size_t i = 0; i < _processes.size(); ++i) {
+        RenderProcess & p = _processes[i];
+        if (p.connected && !p.dead) {
+            if (p.busy) {
+                p.socket->write( (QString(kAbortRenderingStringShort) + '\n').toUtf8() );
+            }
+            p.socket->write( (QString(kQuitRenderDaemonStringShort) + '\n').toUtf8() );
+            p.socket->waitForBytesWritten(1000);
+        }
+        if ( !p.process->waitForFinished(10000) ) {
+            p.process->kill();
+            p.process->waitForFinished(1000);
+        }
+        delete p.socket;
+        delete p.process;
+    }
+    _processes.clear();
+}
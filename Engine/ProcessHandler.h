@@ -16,16 +16,21 @@
 #include <Python.h>
 
 #include "Global/Macros.h"
+#include <list>
+#include <set>
+#include <vector>
 CLANG_DIAG_OFF(deprecated)
 #include <QProcess>
 #include <QThread>
 #include <QStringList>
 #include <QString>
+#include <QDateTime>
 CLANG_DIAG_ON(deprecated)
 #include "Global/GlobalDefines.h"
 
 //natron
 class AppInstance;
+class CLArgs;
 namespace Natron {
 class OutputEffectInstance;
 }
@@ -250,4 +255,212 @@ private:
     QMutex* _mustQuitMutex;
 };
 
+/**
+ * @brief A render daemon keeps a background process resident and renders the jobs sent by clients on a local server,
+ * so that the cost of loading plug-ins, restoring caches and loading projects is paid once for many renders.
+ *
+ * - A job is exactly 1 line containing the arguments a command-line render would take (project or script path,
+ * -w/-o options and frame range). Arguments containing spaces must be enclosed in double quotes.
+ * - While a job renders, the messages written by the render to the output pipe (kRenderingStartedShort,
+ * kFrameRenderedStringShort...) are streamed back to the client. The job ends with either kRenderingFinishedStringShort
+ * or kRenderJobFailedStringShort followed by the reason.
+ * Each job ends with exactly one of them, reporting whether the whole job was rendered.
+ * - kAbortRenderingStringShort aborts the job being rendered and kQuitRenderDaemonStringShort quits the daemon.
+ *
+ * The sockets are only ever used by the thread of the daemon (run()) so that aborting is possible while a job renders,
+ * whereas jobs are executed in the main thread, one after another, in the order they were received.
+ * Only one client is served at a time, others wait for it to disconnect. When a client disconnects, its job is aborted,
+ * the jobs it queued are dropped and nothing it was meant to receive is sent to the next client.
+ * Projects (.ntp) are kept loaded between jobs and reloaded only if the file was modified in the meantime.
+ **/
+class RenderDaemon
+    : public QThread
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Creates the local server and starts the thread listening to it.
+     **/
+    RenderDaemon(const QString & serverName);
+
+    virtual ~RenderDaemon();
+
+    bool isListening() const;
+
+    QString getFullServerName() const;
+
+    /**
+     * @brief Sends a message to the client of the job being rendered. Can be called from any thread.
+     * The message is dropped if that client disconnected.
+     **/
+    void writeToClient(const QString & message);
+
+    /**
+     * @brief Closes all the projects kept loaded between jobs. Must be called in the main thread.
+     **/
+    void closeLoadedProjects();
+
+public Q_SLOTS:
+
+    /**
+     * @brief Called in the main thread when a job was received by the daemon thread from the given client.
+     **/
+    void onJobReceived(const QString & job,int client);
+
+Q_SIGNALS:
+
+    void jobReceived(QString,int);
+
+    void quitRequested();
+
+private:
+
+    /**
+     * @brief Serves the clients until the daemon is destroyed.
+     **/
+    virtual void run();
+
+    /**
+     * @brief Interprets a message received from the client.
+     **/
+    void onClientMessageReceived(const QString & message,int client);
+
+    /**
+     * @brief Aborts the job being rendered, if any. Called by the daemon thread.
+     **/
+    void abortCurrentJob();
+
+    /**
+     * @brief Renders the job and sends its result to the client. Must be called in the main thread.
+     **/
+    void renderJob(const QString & job,int client);
+
+    /**
+     * @brief Loads (or re-uses) the project of the job and renders it. Returns false and the reason in error if the
+     * job could not be rendered entirely.
+     **/
+    bool renderJobInternal(const QString & job,QString* error);
+
+    /**
+     * @brief Returns the instance which already loaded the given project if it is still up to date, or NULL.
+     **/
+    AppInstance* getLoadedProject(const QString & filePath,const QDateTime & lastModified);
+
+    void closeProject(AppInstance* app);
+
+    struct LoadedProject
+    {
+        QString filePath;
+        QDateTime lastModified;
+        AppInstance* app;
+    };
+
+    QLocalServer* _server;
+    QMutex* _outputMutex;
+    QStringList _pendingOutput; //< messages to send to the connected client, protected by _outputMutex
+    int _connectedClient; //< index of the connected client, 0 if none, protected by _outputMutex
+    int _jobClient; //< index of the client of the job being rendered, 0 if none, protected by _outputMutex
+    std::list<std::pair<QString,int> > _jobs; //< jobs waiting to be rendered and their client, only accessed in the main thread
+    bool _renderingJobs;
+    QMutex* _jobMutex;
+    bool _jobRunning; //< true while a job is rendered, protected by _jobMutex
+    bool _jobAborted; //< true if the job being rendered was aborted, protected by _jobMutex
+    AppInstance* _jobApp; //< the instance rendering the job once it can be aborted, protected by _jobMutex
+    std::list<LoadedProject> _loadedProjects; //< most recently used first, only accessed in the main thread
+    bool _mustQuit;
+    QMutex* _mustQuitMutex;
+};
+
+/**
+ * @brief Renders the frame range of writers with several render processes instead of the current process.
+ * Each process is a RenderDaemon started by this class, frames are handed out as render jobs (with the project
+ * snapshot passed to render()) to the processes that are not busy, either one frame at a time (interleaved) or
+ * in contiguous chunks. Frames rendered by the processes are reported to the output pipe of this process, so that
+ * a GUI which launched this process sees the progress as usual.
+ * If a process crashes or fails to render a job, the frames of the job it did not render are handed out again to
+ * the other processes. All processes share the disk cache.
+ **/
+class MultiProcessRenderer
+{
+public:
+
+    enum FrameSplittingEnum
+    {
+        eFrameSplittingInterleaved = 0,
+        eFrameSplittingChunked
+    };
+
+    MultiProcessRenderer(int nProcesses,FrameSplittingEnum splitting);
+
+    ~MultiProcessRenderer();
+
+    /**
+     * @brief Adds a writer to render. If canSplit is false (e.g: the writer encodes a movie file) the whole range is
+     * rendered by a single process.
+     **/
+    void addWriter(const QString & writerName,int firstFrame,int lastFrame,bool canSplit);
+
+    /**
+     * @brief Starts the processes and blocks until all frames are rendered by loading the project at the given path.
+     * Throws an exception if some frames could not be rendered.
+     **/
+    void render(const QString & projectFilePath);
+
+private:
+
+    struct RenderChunk
+    {
+        QString writerName;
+        std::set<int> frames; //< frames left to render
+        int attempts; //< the number of processes that failed to render the chunk
+    };
+
+    struct RenderProcess
+    {
+        QProcess* process;
+        QLocalSocket* socket;
+        QString serverName;
+        bool connected;
+        bool dead;
+        bool busy;
+        RenderChunk chunk; //< valid if busy
+    };
+
+    /**
+     * @brief Appends the frames to the queue as chunks of at most maxChunkSize contiguous frames, so that each chunk
+     * can be given as a frame range to a render process.
+     **/
+    static void queueContiguousChunks(const QString & writerName,
+                                      const std::set<int> & frames,
+                                      int attempts,
+                                      int maxChunkSize,
+                                      std::list<RenderChunk>* queue);
+
+    void startProcesses();
+
+    void sendNextChunk(RenderProcess* p,const QString & projectFilePath);
+
+    /**
+     * @brief Interprets a message received from a render process.
+     **/
+    void onProcessMessageReceived(RenderProcess* p,const QString & message);
+
+    /**
+     * @brief Puts the frames the process did not render back in the queue.
+     **/
+    void requeueChunk(RenderProcess* p,const std::string & reason);
+
+    void stopProcesses();
+
+    int _nProcesses;
+    FrameSplittingEnum _splitting;
+    std::list<RenderChunk> _queue;
+    std::vector<RenderProcess> _processes;
+    int _nFramesTotal;
+    int _nFramesRendered;
+    bool _renderingStartedReported;
+};
+
 #endif // PROCESSHANDLER_H
@@ -15,6 +15,7 @@
 #include "Project.h"
 
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <ios>
 #include <cstdlib> // strtoul
@@ -45,6 +46,7 @@
 #include "Engine/EffectInstance.h"
 #include "Engine/Hash64.h"
 #include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
 #include "Engine/ViewerInstance.h"
 #include "Engine/ProjectSerialization.h"
 #include "Engine/Settings.h"
@@ -104,8 +106,8 @@ Project::Project(AppInstance* appInstance)
 Project::~Project()
 {
     ///wait for all autosaves to finish
-    for (std::list<boost::shared_ptr<QFutureWatcher<void> > >::iterator it = _imp->autoSaveFutures.begin(); it != _imp->autoSaveFutures.end(); ++it) {
-        (*it)->waitForFinished();
+    for (AutoSaveFutures::iterator it = _imp->autoSaveFutures.begin(); it != _imp->autoSaveFutures.end(); ++it) {
+        it->first->waitForFinished();
     }
     
     ///Don't clear autosaves if the program is shutting down by user request.
@@ -218,6 +220,117 @@ Project::loadProject(const QString & path,
     return true;
 } // loadProject
 
+/**
+ * @brief Binary projects start with a magic string followed by the format version, so that a binary project
+ * saved by a more recent version is rejected with a meaningful error instead of failing in the middle of the archive.
+ **/
+static void
+writeBinaryProjectHeader(std::ostream& ofile)
+{
+    ofile.write(NATRON_PROJECT_BINARY_FILE_MAGIC, sizeof(NATRON_PROJECT_BINARY_FILE_MAGIC) - 1);
+    quint32 version = NATRON_PROJECT_BINARY_FILE_VERSION;
+    ofile.write(reinterpret_cast<const char*>(&version), sizeof(version));
+}
+
+static void
+readBinaryProjectHeader(std::istream& ifile)
+{
+    char magic[sizeof(NATRON_PROJECT_BINARY_FILE_MAGIC) - 1];
+    ifile.read(magic, sizeof(magic));
+    if (std::string(magic, sizeof(magic)) != NATRON_PROJECT_BINARY_FILE_MAGIC) {
+        throw std::runtime_error("This file is not a binary project");
+    }
+    quint32 version;
+    ifile.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (version > NATRON_PROJECT_BINARY_FILE_VERSION) {
+        throw std::runtime_error("This project was saved with a more recent version of " NATRON_APPLICATION_NAME
+                                 " and cannot be opened by this version");
+    }
+}
+
+static void
+writeBinaryProject(std::ostream& ofile,
+                   bool bgProject,
+                   const ProjectSerialization& projectSerializationObj,
+                   const std::string& guiLayout)
+{
+    writeBinaryProjectHeader(ofile);
+    boost::archive::binary_oarchive oArchive(ofile);
+    oArchive << bgProject;
+    oArchive << projectSerializationObj;
+    oArchive << guiLayout;
+}
+
+/**
+ * @brief Incremental auto-saves are appended after a binary project as a size followed by a binary archive
+ * of a ProjectJournalEntry. The size is written first so that an entry that was only partially written
+ * (e.g: because the application crashed during the auto-save) can be detected and ignored when loading.
+ **/
+static bool
+appendProjectJournalEntry(const QString& filePath,
+                          const ProjectJournalEntry& entry)
+{
+    std::string data;
+    try {
+        std::ostringstream entryStream;
+        {
+            boost::archive::binary_oarchive entryArchive(entryStream);
+            entryArchive << entry;
+        }
+        data = entryStream.str();
+    } catch (const std::exception& e) {
+        qDebug() << "Failed to write the auto-save journal entry:" << e.what();
+        return false;
+    }
+    
+    std::ofstream ofile(filePath.toStdString().c_str(),std::ofstream::out | std::ofstream::binary | std::ofstream::app);
+    if ( !ofile.good() ) {
+        return false;
+    }
+    quint64 size = data.size();
+    ofile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    ofile.write(data.data(), data.size());
+    ofile.close();
+    
+    return !ofile.fail();
+}
+
+/**
+ * @brief Reads the next incremental auto-save appended after a binary project. Returns false if there is none left.
+ **/
+static bool
+readProjectJournalEntry(std::istream& ifile,
+                        ProjectJournalEntry* entry)
+{
+    ///Read directly from the buffer: the stream throws exceptions when it reaches the end of the file
+    std::streambuf* buf = ifile.rdbuf();
+    quint64 size;
+    if (buf->sgetn(reinterpret_cast<char*>(&size), sizeof(size)) != (std::streamsize)sizeof(size) || size == 0) {
+        return false;
+    }
+    std::streampos pos = buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    std::streampos end = buf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    if ( pos == std::streampos(-1) || end == std::streampos(-1) || (quint64)(end - pos) < size ) {
+        qDebug() << "Ignoring an incomplete auto-save journal entry";
+        return false;
+    }
+    buf->pubseekpos(pos, std::ios_base::in);
+    
+    std::string data((std::size_t)size, '\0');
+    if ( buf->sgetn(&data[0], (std::streamsize)size) != (std::streamsize)size ) {
+        return false;
+    }
+    try {
+        std::istringstream entryStream(data);
+        boost::archive::binary_iarchive entryArchive(entryStream);
+        entryArchive >> *entry;
+    } catch (const std::exception& e) {
+        qDebug() << "Ignoring a corrupted auto-save journal entry:" << e.what();
+        return false;
+    }
+    return true;
+}
+
 bool
 Project::loadProjectInternal(const QString & path,
                              const QString & name,bool isAutoSave,bool isUntitledAutosave, bool* mustSave)
@@ -232,15 +345,16 @@ Project::loadProjectInternal(const QString & path,
     }
     
     bool ret = false;
+    bool binaryFormat = isBinaryProjectFile(filePath);
     std::ifstream ifile;
     try {
         ifile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        ifile.open(filePath.toStdString().c_str(),std::ifstream::in);
+        ifile.open(filePath.toStdString().c_str(),binaryFormat ? std::ifstream::in | std::ifstream::binary : std::ifstream::in);
     } catch (const std::ifstream::failure & e) {
         throw std::runtime_error( std::string("Exception occured when opening file ") + filePath.toStdString() + ": " + e.what() );
     }
     
-    if (NATRON_VERSION_MAJOR == 1 && NATRON_VERSION_MINOR == 0 && NATRON_VERSION_REVISION == 0) {
+    if (!binaryFormat && NATRON_VERSION_MAJOR == 1 && NATRON_VERSION_MINOR == 0 && NATRON_VERSION_REVISION == 0) {
         
         ///Try to determine if the project was made during Natron v1.0.0 - RC2 or RC3 to detect a bug we introduced at that time
         ///in the BezierCP class serialisation
@@ -267,19 +381,53 @@ Project::loadProjectInternal(const QString & path,
     
     try {
         bool bgProject;
-        boost::archive::xml_iarchive iArchive(ifile);
-        {
-            FlagSetter __raii_loadingProjectInternal__(true,&_imp->isLoadingProjectInternal,&_imp->isLoadingProjectMutex);
-            
-            iArchive >> boost::serialization::make_nvp("Background_project", bgProject);
+        if (binaryFormat) {
+            readBinaryProjectHeader(ifile);
+            boost::archive::binary_iarchive iArchive(ifile);
+            iArchive >> bgProject;
             ProjectSerialization projectSerializationObj( getApp() );
-            iArchive >> boost::serialization::make_nvp("Project", projectSerializationObj);
+            iArchive >> projectSerializationObj;
             
-            ret = load(projectSerializationObj,name,path, mustSave);
-        } // __raii_loadingProjectInternal__
-        
-        if (!bgProject) {
-            getApp()->loadProjectGui(iArchive);
+            ///The GUI layout is stored as an embedded XML document so that the Gui does not depend on the project format
+            std::string guiLayout;
+            iArchive >> guiLayout;
+            
+            ///Replay the incremental auto-saves appended after the project, the GUI layout of the last one is the most recent
+            for (;;) {
+                ProjectJournalEntry entry;
+                if ( !readProjectJournalEntry(ifile, &entry) ) {
+                    break;
+                }
+                projectSerializationObj.applyJournalEntry(entry);
+                guiLayout = entry.getGuiLayout();
+            }
+            
+            {
+                FlagSetter __raii_loadingProjectInternal__(true,&_imp->isLoadingProjectInternal,&_imp->isLoadingProjectMutex);
+                
+                ret = load(projectSerializationObj,name,path, mustSave);
+            } // __raii_loadingProjectInternal__
+            
+            if (!bgProject && !guiLayout.empty()) {
+                std::istringstream guiStream(guiLayout);
+                boost::archive::xml_iarchive guiArchive(guiStream);
+                getApp()->loadProjectGui(guiArchive);
+            }
+        } else {
+            boost::archive::xml_iarchive iArchive(ifile);
+            {
+                FlagSetter __raii_loadingProjectInternal__(true,&_imp->isLoadingProjectInternal,&_imp->isLoadingProjectMutex);
+                
+                iArchive >> boost::serialization::make_nvp("Background_project", bgProject);
+                ProjectSerialization projectSerializationObj( getApp() );
+                iArchive >> boost::serialization::make_nvp("Project", projectSerializationObj);
+                
+                ret = load(projectSerializationObj,name,path, mustSave);
+            } // __raii_loadingProjectInternal__
+            
+            if (!bgProject) {
+                getApp()->loadProjectGui(iArchive);
+            }
         }
     } catch (const boost::archive::archive_exception & e) {
         ifile.close();
@@ -361,6 +509,15 @@ QString
 Project::saveProject(const QString & path,
                      const QString & name,
                      bool autoS)
+{
+    return saveProjectImpl(path, name, autoS, 0);
+}
+
+QString
+Project::saveProjectImpl(const QString & path,
+                         const QString & name,
+                         bool autoS,
+                         const ProjectAutoSaveSnapshot* snapshot)
 {
     {
         QMutexLocker l(&_imp->isLoadingProjectMutex);
@@ -388,6 +545,7 @@ Project::saveProject(const QString & path,
             
             ///We just saved, remove the last auto-save which is now obsolete
             removeLastAutosave();
+            _imp->resetAutoSaveJournal();
 
             //}
         } else {
@@ -395,7 +553,7 @@ Project::saveProject(const QString & path,
             ///Replace the last auto-save with a more recent one
             removeLastAutosave();
             
-            ret = saveProjectInternal(path,name,true);
+            ret = saveProjectInternal(path,name,true,snapshot);
         }
     } catch (const std::exception & e) {
         if (!autoS) {
@@ -436,7 +594,8 @@ fileCopy(const QString & source,
 QString
 Project::saveProjectInternal(const QString & path,
                              const QString & name,
-                             bool autoSave)
+                             bool autoSave,
+                             const ProjectAutoSaveSnapshot* snapshot)
 {
     
     bool isRenderSave = name.contains("RENDER_SAVE");
@@ -487,10 +646,13 @@ Project::saveProjectInternal(const QString & path,
     tmpFilename.append( QDir::separator() );
     tmpFilename.append( QString::number( time.toMSecsSinceEpoch() ) );
 
+    ///Auto-saves are only ever read back by this application so they always use the faster binary format
+    bool binaryFormat = autoSave || appPTR->getCurrentSettings()->isBinaryProjectFormatEnabled();
+    
     std::ofstream ofile;
     try {
         ofile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        ofile.open(tmpFilename.toStdString().c_str(),std::ofstream::out);
+        ofile.open(tmpFilename.toStdString().c_str(),binaryFormat ? std::ofstream::out | std::ofstream::binary : std::ofstream::out);
     } catch (const std::ofstream::failure & e) {
         throw std::runtime_error( std::string("Exception occured when opening file ") + tmpFilename.toStdString() + ": " + e.what() );
     }
@@ -511,14 +673,10 @@ Project::saveProjectInternal(const QString & path,
     }
     
     try {
-        boost::archive::xml_oarchive oArchive(ofile);
-        bool bgProject = appPTR->isBackground();
-        oArchive << boost::serialization::make_nvp("Background_project",bgProject);
-        ProjectSerialization projectSerializationObj( getApp() );
-        save(&projectSerializationObj);
-        oArchive << boost::serialization::make_nvp("Project",projectSerializationObj);
-        if (!bgProject) {
-            getApp()->saveProjectGui(oArchive);
+        if (snapshot) {
+            writeBinaryProject(ofile, false, *snapshot->project, snapshot->guiLayout);
+        } else {
+            writeProjectToStream(ofile, binaryFormat);
         }
     } catch (...) {
         ofile.close();
@@ -569,6 +727,74 @@ Project::saveProjectInternal(const QString & path,
     return filePath;
 } // saveProjectInternal
 
+void
+Project::writeProjectToStream(std::ostream& ofile,
+                              bool binaryFormat)
+{
+    bool bgProject = appPTR->isBackground();
+    ProjectSerialization projectSerializationObj( getApp() );
+    save(&projectSerializationObj);
+    
+    if (binaryFormat) {
+        std::string guiLayout;
+        if (!bgProject) {
+            guiLayout = getProjectGuiLayout();
+        }
+        writeBinaryProject(ofile, bgProject, projectSerializationObj, guiLayout);
+    } else {
+        boost::archive::xml_oarchive oArchive(ofile);
+        oArchive << boost::serialization::make_nvp("Background_project",bgProject);
+        oArchive << boost::serialization::make_nvp("Project",projectSerializationObj);
+        if (!bgProject) {
+            getApp()->saveProjectGui(oArchive);
+        }
+    }
+}
+
+std::string
+Project::getProjectGuiLayout()
+{
+    std::ostringstream guiStream;
+    {
+        ///The archive must be destroyed to write the closing tags of the XML document
+        boost::archive::xml_oarchive guiArchive(guiStream);
+        getApp()->saveProjectGui(guiArchive);
+    }
+    return guiStream.str();
+}
+
+void
+Project::exportProject(const QString& filePath,
+                       bool binaryFormat)
+{
+    std::ofstream ofile;
+    try {
+        ofile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        ofile.open(filePath.toStdString().c_str(),binaryFormat ? std::ofstream::out | std::ofstream::binary : std::ofstream::out);
+    } catch (const std::ofstream::failure & e) {
+        throw std::runtime_error( std::string("Exception occured when opening file ") + filePath.toStdString() + ": " + e.what() );
+    }
+    
+    try {
+        writeProjectToStream(ofile, binaryFormat);
+    } catch (...) {
+        ofile.close();
+        throw;
+    }
+    ofile.close();
+}
+
+bool
+Project::isBinaryProjectFile(const QString& filePath)
+{
+    QFile f(filePath);
+    if ( !f.open(QIODevice::ReadOnly) ) {
+        return false;
+    }
+    QByteArray magic = f.read(sizeof(NATRON_PROJECT_BINARY_FILE_MAGIC) - 1);
+    return magic == QByteArray(NATRON_PROJECT_BINARY_FILE_MAGIC);
+}
+
 void
 Project::autoSave()
 {
@@ -577,9 +803,121 @@ Project::autoSave()
         return;
     }
     
-    QString path(_imp->getProjectPath().c_str());
-    QString name(_imp->getProjectFilename().c_str());
-    saveProject(path, name, true);
+    assert( QThread::currentThread() == qApp->thread() );
+    
+    ///Make sure an older auto-save is not written after this one, and commit it before taking the next snapshot
+    for (AutoSaveFutures::iterator it = _imp->autoSaveFutures.begin(); it != _imp->autoSaveFutures.end(); ++it) {
+        it->first->waitForFinished();
+        if (it->second) {
+            _imp->commitAutoSaveSnapshot(*it->second);
+            it->second.reset();
+        }
+    }
+    
+    boost::shared_ptr<ProjectAutoSaveSnapshot> snapshot = createAutoSaveSnapshot();
+    writeAutoSave(snapshot);
+    _imp->commitAutoSaveSnapshot(*snapshot);
+}
+
+boost::shared_ptr<ProjectAutoSaveSnapshot>
+Project::createAutoSaveSnapshot()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    
+    boost::shared_ptr<ProjectAutoSaveSnapshot> snapshot(new ProjectAutoSaveSnapshot);
+    snapshot->path = _imp->getProjectPath().c_str();
+    snapshot->name = _imp->getProjectFilename().c_str();
+    
+    ///Compact the journal by writing a full auto-save once it has grown too much
+    bool canAppend;
+    {
+        QMutexLocker l(&_imp->autoSaveJournalMutex);
+        snapshot->journalFilePath = _imp->autoSaveJournalFilePath;
+        canAppend = !snapshot->journalFilePath.isEmpty() && _imp->autoSaveJournalEntries < NATRON_AUTOSAVE_JOURNAL_MAX_ENTRIES;
+    }
+    if (canAppend) {
+        QFileInfo journalInfo(snapshot->journalFilePath);
+        canAppend = journalInfo.exists() && journalInfo.size() < NATRON_AUTOSAVE_JOURNAL_MAX_SIZE;
+    }
+    
+    NodeList nodes;
+    getActiveNodes(&nodes);
+    
+    std::map<std::string,AutoSaveNodeState> nodesState;
+    std::list< boost::shared_ptr<NodeSerialization> > serializedNodes;
+    std::list< boost::shared_ptr<NodeSerialization> > modifiedNodes;
+    for (NodeList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if ( (*it)->getParentMultiInstance() ) {
+            continue;
+        }
+        std::string scriptName = (*it)->getScriptName_mt_safe();
+        AutoSaveNodeState state;
+        state.hash = (*it)->getHashValue();
+        state.label = (*it)->getLabel_mt_safe();
+        state.knobsModificationCount = (*it)->getLiveInstance()->getKnobsModificationCount();
+        
+        ///The nodes inside a group and the children of a multi-instance (e.g: tracks) are serialized with their parent
+        ///but are not part of its hash nor of its knobs, so always serialize these parents again.
+        ///A full auto-save serializes everything again so that it never depends on the hash.
+        bool hasChildren = dynamic_cast<NodeGroup*>( (*it)->getLiveInstance() ) != 0 || (*it)->isMultiInstance();
+        std::map<std::string,AutoSaveNodeState>::iterator found = _imp->autoSaveNodes.find(scriptName);
+        if ( canAppend && !hasChildren && found != _imp->autoSaveNodes.end() &&
+             found->second.hash == state.hash && found->second.label == state.label &&
+             found->second.knobsModificationCount == state.knobsModificationCount ) {
+            state.serialization = found->second.serialization;
+        } else {
+            state.serialization.reset( new NodeSerialization(*it) );
+            modifiedNodes.push_back(state.serialization);
+        }
+        serializedNodes.push_back(state.serialization);
+        nodesState.insert( std::make_pair(scriptName, state) );
+    }
+    
+    std::list<std::string> removedNodes;
+    for (std::map<std::string,AutoSaveNodeState>::iterator it = _imp->autoSaveNodes.begin(); it != _imp->autoSaveNodes.end(); ++it) {
+        if ( nodesState.find(it->first) == nodesState.end() ) {
+            removedNodes.push_back(it->first);
+        }
+    }
+    ///Committed once written, see ProjectPrivate::commitAutoSaveSnapshot
+    snapshot->nodesState.swap(nodesState);
+    
+    snapshot->project.reset( new ProjectSerialization( getApp() ) );
+    snapshot->project->initialize(this, serializedNodes);
+    snapshot->guiLayout = getProjectGuiLayout();
+    
+    if (canAppend) {
+        snapshot->journalEntry.reset( new ProjectJournalEntry(*snapshot->project, modifiedNodes, removedNodes, snapshot->guiLayout) );
+    }
+    
+    return snapshot;
+}
+
+void
+Project::writeAutoSave(const boost::shared_ptr<ProjectAutoSaveSnapshot>& snapshot)
+{
+    if (snapshot->journalEntry) {
+        if ( appendProjectJournalEntry(snapshot->journalFilePath, *snapshot->journalEntry) ) {
+            {
+                QMutexLocker l(&_imp->autoSaveJournalMutex);
+                if (_imp->autoSaveJournalFilePath == snapshot->journalFilePath) {
+                    ++_imp->autoSaveJournalEntries;
+                }
+            }
+            QMutexLocker l(&_imp->projectLock);
+            _imp->lastAutoSave = QDateTime::currentDateTime();
+            snapshot->written = true;
+            return;
+        }
+        ///Appending failed, the snapshot also holds the whole project: write a full auto-save instead
+    }
+    
+    QString filePath = saveProjectImpl(snapshot->path, snapshot->name, true, snapshot.get());
+    snapshot->written = !filePath.isEmpty();
+    
+    QMutexLocker l(&_imp->autoSaveJournalMutex);
+    _imp->autoSaveJournalFilePath = filePath;
+    _imp->autoSaveJournalEntries = 0;
 }
 
 void
@@ -612,13 +950,16 @@ Project::onAutoSaveTimerTriggered()
     
     ///check that all schedulers are not working.
     ///If so launch an auto-save, otherwise, restart the timer.
-    bool canAutoSave = !hasNodeRendering() && !getApp()->isShowingDialog();
+    ///Also wait for the previous auto-save to be written since the next one may be appended to it.
+    bool canAutoSave = !hasNodeRendering() && !getApp()->isShowingDialog() && _imp->autoSaveFutures.empty();
 
     if (canAutoSave) {
+        ///The snapshot is taken here in the main-thread so that the auto-save thread does not race with edits.
+        boost::shared_ptr<ProjectAutoSaveSnapshot> snapshot = createAutoSaveSnapshot();
         boost::shared_ptr<QFutureWatcher<void> > watcher(new QFutureWatcher<void>);
         QObject::connect(watcher.get(), SIGNAL(finished()), this, SLOT(onAutoSaveFutureFinished()));
-        watcher->setFuture(QtConcurrent::run(this,&Project::autoSave));
-        _imp->autoSaveFutures.push_back(watcher);
+        watcher->setFuture(QtConcurrent::run(this,&Project::writeAutoSave,snapshot));
+        _imp->autoSaveFutures.push_back( std::make_pair(watcher, snapshot) );
     } else {
         ///If the auto-save failed because a render is in progress, try every 2 seconds to auto-save.
         ///We don't use the user-provided timeout interval here because it could be an inapropriate value.
@@ -630,8 +971,11 @@ void Project::onAutoSaveFutureFinished()
 {
     QFutureWatcherBase* future = qobject_cast<QFutureWatcherBase*>(sender());
     assert(future);
-    for (std::list<boost::shared_ptr<QFutureWatcher<void> > >::iterator it = _imp->autoSaveFutures.begin(); it != _imp->autoSaveFutures.end(); ++it) {
-        if (it->get() == future) {
+    for (AutoSaveFutures::iterator it = _imp->autoSaveFutures.begin(); it != _imp->autoSaveFutures.end(); ++it) {
+        if (it->first.get() == future) {
+            if (it->second) {
+                _imp->commitAutoSaveSnapshot(*it->second);
+            }
             _imp->autoSaveFutures.erase(it);
             break;
         }
@@ -1426,6 +1770,12 @@ Project::reset(bool aboutToQuit)
         _imp->autoSaveTimer->stop();
         _imp->additionalFormats.clear();
     }
+    _imp->autoSaveNodes.clear();
+    ///Auto-saves still being written belong to the closed project
+    for (AutoSaveFutures::iterator it = _imp->autoSaveFutures.begin(); it != _imp->autoSaveFutures.end(); ++it) {
+        it->second.reset();
+    }
+    _imp->resetAutoSaveJournal();
     _imp->timeline->removeAllKeyframesIndicators();
     
     Q_EMIT projectNameChanged(NATRON_PROJECT_UNTITLED);
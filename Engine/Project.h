@@ -17,6 +17,7 @@
 
 #include <map>
 #include <vector>
+#include <iosfwd>
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/noncopyable.hpp>
 #include <boost/enable_shared_from_this.hpp>
@@ -47,6 +48,7 @@ namespace Natron {
 class Node;
 class OutputEffectInstance;
 struct ProjectPrivate;
+struct ProjectAutoSaveSnapshot;
 
 class Project
     :  public KnobHolder, public NodeCollection,  public boost::noncopyable, public boost::enable_shared_from_this<Natron::Project>
@@ -70,15 +72,28 @@ public:
      * @returns The actual filepath of the file saved
      **/
     QString saveProject(const QString & path,const QString & name,bool autoSave);
+    
+    /**
+     * @brief Writes the project to the given file in the binary or XML format without changing the project name,
+     * path or auto-save state. This is used to convert a project file from one format to the other.
+     * Throws an exception upon failure.
+     **/
+    void exportProject(const QString& filePath,bool binaryFormat);
+    
+    /**
+     * @brief Returns true if the given file was saved in the binary project format.
+     **/
+    static bool isBinaryProjectFile(const QString& filePath);
 
     /**
      * @brief Same as saveProject except that it will save the project in a temporary file
-     * so it doesn't overwrite the project.
+     * so it doesn't overwrite the project. If possible, only the nodes that changed since the previous
+     * auto-save are written and appended to it.
      **/
     void autoSave();
 
     /**
-     * @brief Same as autoSave() but the auto-save is run in a separate thread instead.
+     * @brief Same as autoSave() but the auto-save is written in a separate thread instead.
      **/
     void triggerAutoSave();
 
@@ -320,7 +335,36 @@ private:
     bool loadProjectInternal(const QString & path,const QString & name,bool isAutoSave,
                              bool isUntitledAutosave, bool* mustSave);
 
-    QString saveProjectInternal(const QString & path,const QString & name,bool autosave = false);
+    QString saveProjectImpl(const QString & path,const QString & name,bool autoSave,const ProjectAutoSaveSnapshot* snapshot);
+    
+    /**
+     * @brief If snapshot is not NULL, it is written instead of the live project.
+     **/
+    QString saveProjectInternal(const QString & path,const QString & name,bool autosave = false,
+                                const ProjectAutoSaveSnapshot* snapshot = 0);
+    
+    /**
+     * @brief Captures what the next auto-save must write. Nodes that did not change since the previous written
+     * auto-save are not serialized again. Must be called in the main-thread.
+     **/
+    boost::shared_ptr<ProjectAutoSaveSnapshot> createAutoSaveSnapshot();
+    
+    /**
+     * @brief Appends the snapshot to the previous auto-save if it is incremental, otherwise writes a full auto-save.
+     * It never reads the live project, hence it can run in any thread. The snapshot is marked as written upon success.
+     **/
+    void writeAutoSave(const boost::shared_ptr<ProjectAutoSaveSnapshot>& snapshot);
+    
+    /**
+     * @brief Returns the GUI layout of the project as an XML document.
+     **/
+    std::string getProjectGuiLayout();
+    
+    /**
+     * @brief Serializes the project and its GUI layout to the given stream, which must have been opened
+     * in binary mode if binaryFormat is true.
+     **/
+    void writeProjectToStream(std::ostream& ofile,bool binaryFormat);
 
     
     
@@ -16,6 +16,8 @@
 
 #include <QDebug>
 #include <QTimer>
+#include <QThread>
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QFile>
 #include <QDir>
@@ -71,6 +73,11 @@ ProjectPrivate::ProjectPrivate(Natron::Project* project)
     , isSavingProjectMutex()
     , isSavingProject(false)
     , autoSaveTimer( new QTimer() )
+    , autoSaveFutures()
+    , autoSaveNodes()
+    , autoSaveJournalMutex()
+    , autoSaveJournalFilePath()
+    , autoSaveJournalEntries(0)
     , projectClosing(false)
     
 {
@@ -347,6 +354,25 @@ ProjectPrivate::runOnProjectSaveCallback(const std::string& filename, bool autoS
     return filename;
 }
     
+void
+ProjectPrivate::resetAutoSaveJournal()
+{
+    QMutexLocker l(&autoSaveJournalMutex);
+    autoSaveJournalFilePath.clear();
+    autoSaveJournalEntries = 0;
+}
+
+void
+ProjectPrivate::commitAutoSaveSnapshot(const ProjectAutoSaveSnapshot& snapshot)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    
+    ///If the auto-save failed the next one is compared against the last written one, so no edit is lost
+    if (snapshot.written) {
+        autoSaveNodes = snapshot.nodesState;
+    }
+}
+
 void
 ProjectPrivate::runOnProjectCloseCallback()
 {
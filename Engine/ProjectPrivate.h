@@ -38,6 +38,7 @@ class QTimer;
 class TimeLine;
 class NodeSerialization;
 class ProjectSerialization;
+class ProjectJournalEntry;
 class File_Knob;
 namespace Natron {
 class Node;
@@ -60,6 +61,55 @@ generateStringFromFormat(const Format & f)
     return formatStr;
 }
 
+///Number of incremental auto-saves appended to a full auto-save before a new full auto-save is written instead
+#define NATRON_AUTOSAVE_JOURNAL_MAX_ENTRIES 20
+
+///Size (in bytes) of an auto-save file above which a new full auto-save is written instead of appending to it
+#define NATRON_AUTOSAVE_JOURNAL_MAX_SIZE (64 * 1024 * 1024)
+
+/**
+ * @brief What the last auto-save wrote for a node. As long as the hash, the label and the knobs modification count
+ * (see KnobHolder::getKnobsModificationCount()) of the node are the same the node is considered unchanged and
+ * its serialization is reused as-is.
+ **/
+struct AutoSaveNodeState
+{
+    U64 hash;
+    std::string label;
+    U64 knobsModificationCount;
+    boost::shared_ptr<NodeSerialization> serialization;
+};
+
+/**
+ * @brief Everything an auto-save writes, captured in the main-thread so that the thread writing the
+ * auto-save never reads objects that are being edited.
+ **/
+struct ProjectAutoSaveSnapshot
+{
+    QString path,name; //< the project path and name when the snapshot was taken
+    boost::shared_ptr<ProjectSerialization> project; //< the whole project
+    std::string guiLayout;
+    boost::shared_ptr<ProjectJournalEntry> journalEntry; //< if set, only this entry is appended to journalFilePath
+    QString journalFilePath;
+    std::map<std::string,AutoSaveNodeState> nodesState; //< becomes ProjectPrivate::autoSaveNodes once written
+    bool written; //< set by the thread writing the auto-save upon success
+    
+    ProjectAutoSaveSnapshot()
+    : path()
+    , name()
+    , project()
+    , guiLayout()
+    , journalEntry()
+    , journalFilePath()
+    , nodesState()
+    , written(false)
+    {
+    }
+};
+
+///An auto-save being written and its snapshot, which is reset once it no longer has to be committed
+typedef std::list<std::pair<boost::shared_ptr<QFutureWatcher<void> >, boost::shared_ptr<ProjectAutoSaveSnapshot> > > AutoSaveFutures;
+
 struct ProjectPrivate
 {
     Natron::Project* _publicInterface;
@@ -111,7 +161,11 @@ struct ProjectPrivate
     mutable QMutex isSavingProjectMutex;
     bool isSavingProject; //< true when the project is saving
     boost::shared_ptr<QTimer> autoSaveTimer;
-    std::list<boost::shared_ptr<QFutureWatcher<void> > > autoSaveFutures;
+    AutoSaveFutures autoSaveFutures;
+    std::map<std::string,AutoSaveNodeState> autoSaveNodes; //< the nodes of the last written auto-save, by script name. Only accessed by the main-thread
+    mutable QMutex autoSaveJournalMutex; //< protects autoSaveJournalFilePath & autoSaveJournalEntries
+    QString autoSaveJournalFilePath; //< the full auto-save incremental auto-saves are appended to, empty if the next one must be full
+    int autoSaveJournalEntries; //< number of incremental auto-saves appended to autoSaveJournalFilePath
     bool projectClosing;
     
     ProjectPrivate(Natron::Project* project);
@@ -127,6 +181,14 @@ struct ProjectPrivate
     
     std::string runOnProjectSaveCallback(const std::string& filename,bool autoSave);
     
+    /**
+     * @brief The next auto-save will be a full one, rather than appended to the previous one.
+     **/
+    void resetAutoSaveJournal();
+    
+    ///Remembers the nodes of the snapshot for the next auto-save if it was written. Must be called in the main-thread.
+    void commitAutoSaveSnapshot(const ProjectAutoSaveSnapshot& snapshot);
+    
     void runOnProjectCloseCallback();
     
     void runOnProjectLoadCallback();
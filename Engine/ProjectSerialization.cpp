@@ -27,6 +27,23 @@ ProjectSerialization::initialize(const Natron::Project* project)
 
     _nodes.initialize(*project);
     
+    initializeProjectState(project);
+}
+
+void
+ProjectSerialization::initialize(const Natron::Project* project,
+                                 const std::list< boost::shared_ptr<NodeSerialization> >& nodes)
+{
+    for (std::list< boost::shared_ptr<NodeSerialization> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        _nodes.addNodeSerialization(*it);
+    }
+    
+    initializeProjectState(project);
+}
+
+void
+ProjectSerialization::initializeProjectState(const Natron::Project* project)
+{
     project->getAdditionalFormats(&_additionalFormats);
 
     std::vector< boost::shared_ptr<KnobI> > knobs = project->getKnobs_mt_safe();
@@ -45,3 +62,33 @@ ProjectSerialization::initialize(const Natron::Project* project)
     _creationDate = project->getProjectCreationTime();
 }
 
+void
+ProjectSerialization::applyJournalEntry(const ProjectJournalEntry& entry)
+{
+    const std::list<std::string>& removedNodes = entry.getRemovedNodes();
+    for (std::list<std::string>::const_iterator it = removedNodes.begin(); it != removedNodes.end(); ++it) {
+        _nodes.removeNodeSerialization(*it);
+    }
+    
+    const std::list< boost::shared_ptr<NodeSerialization> >& modifiedNodes = entry.getModifiedNodes();
+    for (std::list< boost::shared_ptr<NodeSerialization> >::const_iterator it = modifiedNodes.begin(); it != modifiedNodes.end(); ++it) {
+        _nodes.replaceNodeSerialization(*it);
+    }
+    
+    _projectKnobs = entry.getProjectKnobsValues();
+    _additionalFormats = entry.getAdditionalFormats();
+    _timelineCurrent = entry.getCurrentTime();
+}
+
+ProjectJournalEntry::ProjectJournalEntry(const ProjectSerialization& project,
+                                         const std::list< boost::shared_ptr<NodeSerialization> >& modifiedNodes,
+                                         const std::list<std::string>& removedNodes,
+                                         const std::string& guiLayout)
+    : _modifiedNodes(modifiedNodes)
+    , _removedNodes(removedNodes)
+    , _additionalFormats(project.getAdditionalFormats())
+    , _projectKnobs(project.getProjectKnobsValues())
+    , _timelineCurrent(project.getCurrentTime())
+    , _guiLayout(guiLayout)
+{
+}
@@ -23,6 +23,8 @@ GCC_DIAG_OFF(unused-parameter)
 #include <boost/archive/xml_iarchive.hpp>
 GCC_DIAG_ON(unused-parameter)
 #include <boost/archive/xml_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -48,7 +50,120 @@ GCC_DIAG_ON(unused-parameter)
 #define PROJECT_SERIALIZATION_INTRODUCES_GROUPS 5
 #define PROJECT_SERIALIZATION_VERSION PROJECT_SERIALIZATION_INTRODUCES_GROUPS
 
+#define PROJECT_JOURNAL_ENTRY_INITIAL_VERSION 1
+#define PROJECT_JOURNAL_ENTRY_VERSION PROJECT_JOURNAL_ENTRY_INITIAL_VERSION
+
 class AppInstance;
+class ProjectSerialization;
+
+/**
+ * @brief An incremental auto-save: it only holds the nodes that were created or modified since the previous auto-save,
+ * the script names of the nodes that were removed and the (small) project-wide state. Entries are appended after the last
+ * full auto-save and replayed on top of it when the auto-save is loaded.
+ **/
+class ProjectJournalEntry
+{
+    std::list< boost::shared_ptr<NodeSerialization> > _modifiedNodes;
+    std::list<std::string> _removedNodes;
+    std::list<Format> _additionalFormats;
+    std::list< boost::shared_ptr<KnobSerialization> > _projectKnobs;
+    SequenceTime _timelineCurrent;
+    std::string _guiLayout;
+
+public:
+
+    ProjectJournalEntry()
+        : _timelineCurrent(0)
+    {
+    }
+
+    ProjectJournalEntry(const ProjectSerialization& project,
+                        const std::list< boost::shared_ptr<NodeSerialization> >& modifiedNodes,
+                        const std::list<std::string>& removedNodes,
+                        const std::string& guiLayout);
+
+    const std::list< boost::shared_ptr<NodeSerialization> >& getModifiedNodes() const
+    {
+        return _modifiedNodes;
+    }
+
+    const std::list<std::string>& getRemovedNodes() const
+    {
+        return _removedNodes;
+    }
+
+    const std::list<Format> & getAdditionalFormats() const
+    {
+        return _additionalFormats;
+    }
+
+    const std::list< boost::shared_ptr<KnobSerialization> > & getProjectKnobsValues() const
+    {
+        return _projectKnobs;
+    }
+
+    SequenceTime getCurrentTime() const
+    {
+        return _timelineCurrent;
+    }
+
+    const std::string& getGuiLayout() const
+    {
+        return _guiLayout;
+    }
+
+private:
+
+    friend class boost::serialization::access;
+    template<class Archive>
+    void save(Archive & ar,
+              const unsigned int /*version*/) const
+    {
+        int nodesCount = (int)_modifiedNodes.size();
+        ar & boost::serialization::make_nvp("ModifiedNodesCount",nodesCount);
+        for (std::list< boost::shared_ptr<NodeSerialization> >::const_iterator it = _modifiedNodes.begin(); it != _modifiedNodes.end(); ++it) {
+            ar & boost::serialization::make_nvp("item",**it);
+        }
+        ar & boost::serialization::make_nvp("RemovedNodes",_removedNodes);
+        int knobsCount = (int)_projectKnobs.size();
+        ar & boost::serialization::make_nvp("ProjectKnobsCount",knobsCount);
+        for (std::list< boost::shared_ptr<KnobSerialization> >::const_iterator it = _projectKnobs.begin(); it != _projectKnobs.end(); ++it) {
+            ar & boost::serialization::make_nvp("item",**it);
+        }
+        ar & boost::serialization::make_nvp("AdditionalFormats",_additionalFormats);
+        ar & boost::serialization::make_nvp("Timeline_current_time",_timelineCurrent);
+        ar & boost::serialization::make_nvp("GuiLayout",_guiLayout);
+    }
+
+    template<class Archive>
+    void load(Archive & ar,
+              const unsigned int /*version*/)
+    {
+        int nodesCount;
+        ar & boost::serialization::make_nvp("ModifiedNodesCount",nodesCount);
+        for (int i = 0; i < nodesCount; ++i) {
+            boost::shared_ptr<NodeSerialization> ns(new NodeSerialization);
+            ar & boost::serialization::make_nvp("item",*ns);
+            _modifiedNodes.push_back(ns);
+        }
+        ar & boost::serialization::make_nvp("RemovedNodes",_removedNodes);
+        int knobsCount;
+        ar & boost::serialization::make_nvp("ProjectKnobsCount",knobsCount);
+        for (int i = 0; i < knobsCount; ++i) {
+            boost::shared_ptr<KnobSerialization> ks(new KnobSerialization);
+            ar & boost::serialization::make_nvp("item",*ks);
+            _projectKnobs.push_back(ks);
+        }
+        ar & boost::serialization::make_nvp("AdditionalFormats",_additionalFormats);
+        ar & boost::serialization::make_nvp("Timeline_current_time",_timelineCurrent);
+        ar & boost::serialization::make_nvp("GuiLayout",_guiLayout);
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+};
+
+BOOST_CLASS_VERSION(ProjectJournalEntry,PROJECT_JOURNAL_ENTRY_VERSION)
+
 class ProjectSerialization
 {
     NodeCollectionSerialization _nodes;
@@ -80,6 +195,17 @@ public:
     }
     
     void initialize(const Natron::Project* project);
+    
+    /**
+     * @brief Same as initialize(project) except that the nodes are not serialized again: the given
+     * (already serialized) nodes are used instead.
+     **/
+    void initialize(const Natron::Project* project,const std::list< boost::shared_ptr<NodeSerialization> >& nodes);
+    
+    /**
+     * @brief Replays an incremental auto-save on top of this serialization.
+     **/
+    void applyJournalEntry(const ProjectJournalEntry& entry);
 
     SequenceTime getCurrentTime() const
     {
@@ -106,6 +232,10 @@ public:
         return _creationDate;
     }
 
+private:
+    
+    void initializeProjectState(const Natron::Project* project);
+
 
     friend class boost::serialization::access;
     template<class Archive>
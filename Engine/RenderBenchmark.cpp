@@ -0,0 +1,335 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "RenderBenchmark.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+#include <QThread>
+#include <QCoreApplication>
+
+#include "Global/Macros.h"
+#include "Global/MemoryInfo.h"
+#include "Engine/AppInstance.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/Format.h"
+#include "Engine/Image.h"
+#include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
+#include "Engine/Plugin.h"
+#include "Engine/Project.h"
+#include "Engine/RotoContext.h"
+#include "Engine/TimeLine.h"
+#include "Engine/Timer.h"
+
+///Every n-th stage of the graph is wrapped in a Group
+#define RENDER_BENCHMARK_GROUP_PERIOD 4
+
+///Number of frames between 2 keyframes of an animated shape
+#define RENDER_BENCHMARK_KEYFRAME_INTERVAL 10
+
+using namespace Natron;
+
+namespace {
+
+/**
+ * @brief A linear congruential generator: std::rand() is not guaranteed to give the same sequence on every platform
+ **/
+class BenchmarkRandom
+{
+    unsigned int _state;
+
+public:
+
+    BenchmarkRandom(unsigned int seed)
+    : _state(seed)
+    {
+    }
+
+    ///Returns a number in [0,1)
+    double next()
+    {
+        _state = _state * 1664525u + 1013904223u;
+        return (_state >> 8) / (double)(1u << 24);
+    }
+};
+
+static boost::shared_ptr<Node>
+createBenchmarkNode(AppInstance* app,
+                    const QString& pluginID,
+                    const boost::shared_ptr<NodeCollection>& group)
+{
+    return app->createNode( CreateNodeArgs(pluginID,
+                                           "",
+                                           -1,-1,false,INT_MIN,INT_MIN,false,true,false,
+                                           QString(),CreateNodeArgs::DefaultValuesList(),
+                                           group) );
+}
+
+static bool
+isPluginAvailable(const QString& pluginID)
+{
+    try {
+        return appPTR->getPluginBinary(pluginID, -1, -1, false) != 0;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Adds args.fanIn squares to the roto node, animating a fraction args.animationDensity of them
+ * from firstFrame to lastFrame.
+ **/
+static void
+addBenchmarkShapes(const boost::shared_ptr<Node>& roto,
+                   const CLArgs::RenderBenchmarkArgs& args,
+                   int firstFrame,
+                   int lastFrame,
+                   BenchmarkRandom* random)
+{
+    boost::shared_ptr<RotoContext> context = roto->getRotoContext();
+    assert(context);
+    context->setAutoKeyingEnabled(true);
+
+    const double maxSize = std::max(args.width, args.height) / 4.;
+    for (int i = 0; i < args.fanIn; ++i) {
+        double size = maxSize * (0.25 + 0.75 * random->next());
+        double x = random->next() * (args.width - size);
+        double y = size + random->next() * (args.height - size);
+        boost::shared_ptr<Bezier> shape = context->makeSquare(x, y, size, firstFrame);
+
+        ///Spread the animated shapes evenly rather than animating the first ones
+        bool animated = (int)( (i + 1) * args.animationDensity ) > (int)(i * args.animationDensity);
+        if (!animated) {
+            continue;
+        }
+        int nPoints = shape->getControlPointsCount();
+        for (int time = firstFrame + RENDER_BENCHMARK_KEYFRAME_INTERVAL; time <= lastFrame; time += RENDER_BENCHMARK_KEYFRAME_INTERVAL) {
+            double dx = (random->next() - 0.5) * size;
+            double dy = (random->next() - 0.5) * size;
+            for (int p = 0; p < nPoints; ++p) {
+                shape->movePointByIndex(p, time, dx, dy);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Creates the roto node of a stage, inside a new Group if wrapInGroup is true, and connects the previous
+ * stage to its background input through a Dot. Returns the node to connect to the next stage.
+ **/
+static boost::shared_ptr<Node>
+createBenchmarkStage(AppInstance* app,
+                     const QString& pluginID,
+                     bool wrapInGroup,
+                     const boost::shared_ptr<Node>& previousStage,
+                     boost::shared_ptr<Node>* roto)
+{
+    boost::shared_ptr<NodeCollection> project = app->getProject();
+    boost::shared_ptr<Node> stage;
+    if (wrapInGroup) {
+        stage = createBenchmarkNode(app, PLUGINID_NATRON_GROUP, project);
+        if (!stage) {
+            return boost::shared_ptr<Node>();
+        }
+        boost::shared_ptr<NodeGroup> group = boost::dynamic_pointer_cast<NodeGroup>(stage->getLiveInstance()->shared_from_this());
+        assert(group);
+        std::vector<boost::shared_ptr<Node> > inputs;
+        group->getInputs(&inputs);
+        boost::shared_ptr<Node> output = group->getOutputNode();
+        *roto = createBenchmarkNode(app, pluginID, group);
+        if (!*roto || inputs.empty() || !output ||
+            !NodeCollection::connectNodes(0, inputs[0], roto->get(), true) ||
+            !NodeCollection::connectNodes(0, *roto, output.get(), true)) {
+            return boost::shared_ptr<Node>();
+        }
+    } else {
+        stage = createBenchmarkNode(app, pluginID, project);
+        *roto = stage;
+        if (!stage) {
+            return boost::shared_ptr<Node>();
+        }
+    }
+
+    if (previousStage) {
+        boost::shared_ptr<Node> dot = createBenchmarkNode(app, PLUGINID_NATRON_DOT, project);
+        if (!dot ||
+            !NodeCollection::connectNodes(0, previousStage, dot.get(), true) ||
+            !NodeCollection::connectNodes(0, dot, stage.get(), true)) {
+            return boost::shared_ptr<Node>();
+        }
+    }
+    return stage;
+}
+
+static bool
+renderBenchmarkFrame(AppInstance* app,
+                     EffectInstance* effect,
+                     const RectI& format,
+                     int time)
+{
+    ParallelRenderArgsSetter frameRenderArgs(app->getProject().get(),
+                                             time,
+                                             0, //< view
+                                             false, //<isRenderUserInteraction
+                                             true, //isSequential
+                                             false, //can abort
+                                             0, //render Age
+                                             0, // requester
+                                             0, //texture index
+                                             app->getTimeLine().get(),
+                                             NodePtr(),
+                                             false);
+    RenderScale scale;
+    scale.x = scale.y = 1.;
+    RectD rod;
+    bool isProjectFormat;
+    StatusEnum stat = effect->getRegionOfDefinition_public(effect->getHash(), time, scale, 0, &rod, &isProjectFormat);
+    if (stat == eStatusFailed) {
+        return false;
+    }
+    RectI rodPixel;
+    rod.toPixelEnclosing(0, effect->getPreferredAspectRatio(), &rodPixel);
+    RectI renderWindow;
+    if ( !rodPixel.intersect(format, &renderWindow) ) {
+        ///Nothing to render
+        return true;
+    }
+
+    std::list<ImageComponents> requestedComps;
+    requestedComps.push_back( ImageComponents::getRGBAComponents() );
+    ImageList planes;
+    EffectInstance::RenderRoIRetCode retCode =
+    effect->renderRoI(EffectInstance::RenderRoIArgs(time, scale, 0, 0, false, renderWindow, rod, requestedComps,
+                                                    eImageBitDepthFloat, effect), &planes);
+    return retCode == EffectInstance::eRenderRoIRetCodeOk;
+}
+
+} // anon namespace
+
+std::string
+Natron::escapeJSON(const std::string& str)
+{
+    std::string ret;
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        if (str[i] == '"' || str[i] == '\\') {
+            ret.push_back('\\');
+        }
+        ret.push_back(str[i]);
+    }
+    return ret;
+}
+
+bool
+Natron::runRenderBenchmark(AppInstance* app,
+                           const CLArgs::RenderBenchmarkArgs& args,
+                           int firstFrame,
+                           int lastFrame,
+                           std::ostream& os)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    ///The shapes of the roto nodes are rendered by the Roto and Merge plug-ins bundled with Natron
+    const char* requiredPlugins[2] = { PLUGINID_OFX_ROTO, PLUGINID_OFX_MERGE };
+    for (int i = 0; i < 2; ++i) {
+        if ( !isPluginAvailable(requiredPlugins[i]) ) {
+            std::fprintf(stderr, "%s\n", QObject::tr("The benchmark needs the plug-in %1 which is not installed")
+                         .arg(requiredPlugins[i]).toStdString().c_str());
+            return false;
+        }
+    }
+
+    boost::shared_ptr<Project> project = app->getProject();
+    Format format(0, 0, args.width, args.height, "Benchmark", 1.);
+    project->setOrAddProjectFormat(format);
+
+    ///Build the graph
+    BenchmarkRandom random(1);
+    boost::shared_ptr<Node> previousStage;
+    for (int i = 0; i < args.depth; ++i) {
+        boost::shared_ptr<Node> roto;
+        boost::shared_ptr<Node> stage = createBenchmarkStage(app,
+                                                             i % 2 ? PLUGINID_NATRON_ROTOPAINT : PLUGINID_NATRON_ROTO,
+                                                             i % RENDER_BENCHMARK_GROUP_PERIOD == RENDER_BENCHMARK_GROUP_PERIOD - 1,
+                                                             previousStage,
+                                                             &roto);
+        if (!stage) {
+            std::fprintf(stderr, "%s\n", QObject::tr("Could not build the benchmark graph").toStdString().c_str());
+            return false;
+        }
+        addBenchmarkShapes(roto, args, firstFrame, lastFrame, &random);
+        previousStage = stage;
+    }
+    boost::shared_ptr<Node> output = createBenchmarkNode(app, PLUGINID_NATRON_DISKCACHE, project);
+    if ( !output || !NodeCollection::connectNodes(0, previousStage, output.get(), true) ) {
+        std::fprintf(stderr, "%s\n", QObject::tr("Could not build the benchmark graph").toStdString().c_str());
+        return false;
+    }
+
+    NodeList nodes;
+    project->getNodes_recursive(nodes);
+    for (NodeList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        (*it)->getLiveInstance()->resetRenderStatistics();
+    }
+    appPTR->resetNodeCacheLookupStatistics();
+
+    ///Render
+    EffectInstance* effect = output->getLiveInstance();
+    TimeLapse timer;
+    for (int time = firstFrame; time <= lastFrame; ++time) {
+        if ( !renderBenchmarkFrame(app, effect, format, time) ) {
+            std::fprintf(stderr, "%s\n", QObject::tr("Failed to render frame %1").arg(time).toStdString().c_str());
+            return false;
+        }
+        std::fprintf(stderr, "%s\n", QObject::tr("Rendered frame %1").arg(time).toStdString().c_str());
+    }
+    double elapsed = timer.getTimeElapsedReset();
+    int nFrames = lastFrame - firstFrame + 1;
+
+    U64 nLookups, nHits;
+    appPTR->getNodeCacheLookupStatistics(&nLookups, &nHits);
+
+    ///Report
+    os.precision(9);
+    os << "{\n";
+    os << "  \"version\": \"" << NATRON_VERSION_STRING << "\",\n";
+    os << "  \"depth\": " << args.depth << ",\n";
+    os << "  \"fanIn\": " << args.fanIn << ",\n";
+    os << "  \"width\": " << args.width << ",\n";
+    os << "  \"height\": " << args.height << ",\n";
+    os << "  \"animationDensity\": " << args.animationDensity << ",\n";
+    os << "  \"firstFrame\": " << firstFrame << ",\n";
+    os << "  \"lastFrame\": " << lastFrame << ",\n";
+    os << "  \"seconds\": " << elapsed << ",\n";
+    os << "  \"framesPerSecond\": " << (elapsed > 0. ? nFrames / elapsed : 0.) << ",\n";
+    os << "  \"peakRSS\": " << (U64)getPeakRSS() << ",\n";
+    os << "  \"cacheLookups\": " << nLookups << ",\n";
+    os << "  \"cacheHits\": " << nHits << ",\n";
+    os << "  \"cacheHitRate\": " << (nLookups > 0 ? nHits / (double)nLookups : 0.) << ",\n";
+    os << "  \"nodes\": [";
+    for (NodeList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        EffectInstance::RenderStatistics stats = (*it)->getLiveInstance()->getRenderStatistics();
+        os << (it == nodes.begin() ? "\n" : ",\n");
+        os << "    { \"name\": \"" << escapeJSON( (*it)->getFullyQualifiedName() ) << "\", \"renders\": " << stats.nRenders
+           << ", \"renderTime\": " << stats.renderTime
+           << ", \"busyTime\": " << stats.busyTime
+           << ", \"lockWaitTime\": " << stats.lockWaitTime << " }";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+    os.flush();
+
+    return true;
+}
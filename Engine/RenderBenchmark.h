@@ -0,0 +1,47 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_ENGINE_RENDERBENCHMARK_H_
+#define NATRON_ENGINE_RENDERBENCHMARK_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <ostream>
+#include <string>
+
+#include "Engine/AppManager.h"
+
+class AppInstance;
+
+namespace Natron {
+
+/**
+ * @brief Builds a synthetic graph in the project of app and renders it over [firstFrame, lastFrame] at full scale,
+ * without any writer nor viewer so that it runs without a display.
+ * The graph chains args.depth stages through Dot nodes and ends with a DiskCache node. Each stage is a Roto (or RotoPaint
+ * for every other stage) node merging args.fanIn squares over the previous stage, every fourth stage being wrapped in a Group.
+ * A fraction args.animationDensity of the shapes has a keyframe every 10 frames.
+ * The shapes are placed with a fixed seed so that runs are comparable.
+ * The results (frames per second, peak resident memory, image cache hit rate and render time of each node) are written
+ * as JSON to os. Must be called on the main thread.
+ * Returns false if the graph could not be built or a frame failed to render, an error being printed on the standard error.
+ **/
+bool runRenderBenchmark(AppInstance* app,
+                        const CLArgs::RenderBenchmarkArgs& args,
+                        int firstFrame,
+                        int lastFrame,
+                        std::ostream& os);
+
+/**
+ * @brief Escapes the quotes and backslashes of str so that it can be written in a JSON string.
+ **/
+std::string escapeJSON(const std::string& str);
+
+}
+
+#endif // NATRON_ENGINE_RENDERBENCHMARK_H_
@@ -295,9 +295,8 @@ bezierPointBboxUpdate(const Point & p0,
 // x and 2 for y). the Bbox is the Bbox of these points and the
 // extremal points (P0,P3)
 static void
-bezierSegmentBboxUpdate(const BezierCP & first,
-                        const BezierCP & last,
-                        int time,
+bezierSegmentBboxUpdate(const BezierCPValue & first,
+                        const BezierCPValue & last,
                         unsigned int mipMapLevel,
                         const Transform::Matrix3x3& transform,
                         RectD* bbox) ///< input/output
@@ -306,14 +305,14 @@ bezierSegmentBboxUpdate(const BezierCP & first,
     Transform::Point3D p0M,p1M,p2M,p3M;
     assert(bbox);
     
-    try {
-        first.getPositionAtTime(time, &p0M.x, &p0M.y);
-        first.getRightBezierPointAtTime(time, &p1M.x, &p1M.y);
-        last.getPositionAtTime(time, &p3M.x, &p3M.y);
-        last.getLeftBezierPointAtTime(time, &p2M.x, &p2M.y);
-    } catch (const std::exception & e) {
-        assert(false);
-    }
+    p0M.x = first.p.x;
+    p0M.y = first.p.y;
+    p1M.x = first.right.x;
+    p1M.y = first.right.y;
+    p3M.x = last.p.x;
+    p3M.y = last.p.y;
+    p2M.x = last.left.x;
+    p2M.y = last.left.y;
     p0M.z = p1M.z = p2M.z = p3M.z = 1;
     
     p0M = Transform::matApply(transform, p0M);
@@ -348,14 +347,25 @@ bezierSegmentBboxUpdate(const BezierCP & first,
     bezierPointBboxUpdate(p0, p1, p2, p3, bbox);
 }
 
-void
-Bezier::bezierSegmentListBboxUpdate(const BezierCPs & points,
-                                    bool finished,
-                                    bool isOpenBezier,
-                                    int time,
-                                    unsigned int mipMapLevel,
-                                    const Transform::Matrix3x3& transform,
-                                    RectD* bbox) ///< input/output
+static void
+evaluateControlPoints(const BezierCPs & points,
+                      int time,
+                      std::vector<BezierCPValue>* values)
+{
+    values->resize(points.size());
+    std::vector<BezierCPValue>::iterator v = values->begin();
+    for (BezierCPs::const_iterator it = points.begin(); it != points.end(); ++it, ++v) {
+        (*it)->evaluateAtTime(time, &*v);
+    }
+}
+
+static void
+bezierSegmentListBboxUpdate(const std::vector<BezierCPValue> & points,
+                            bool finished,
+                            bool isOpenBezier,
+                            unsigned int mipMapLevel,
+                            const Transform::Matrix3x3& transform,
+                            RectD* bbox) ///< input/output
 {
     if ( points.empty() ) {
         return;
@@ -363,8 +373,8 @@ Bezier::bezierSegmentListBboxUpdate(const BezierCPs & points,
     if (points.size() == 1) {
         // only one point
         Transform::Point3D p0;
-        const boost::shared_ptr<BezierCP>& p = points.front();
-        p->getPositionAtTime(time, &p0.x, &p0.y);
+        p0.x = points.front().p.x;
+        p0.y = points.front().p.y;
         p0.z = 1;
         p0 = Transform::matApply(transform, p0);
         bbox->x1 = p0.x;
@@ -373,33 +383,39 @@ Bezier::bezierSegmentListBboxUpdate(const BezierCPs & points,
         bbox->y2 = p0.y;
         return;
     }
-    BezierCPs::const_iterator next = points.begin();
-    if (next != points.end()) {
-        ++next;
-    }
-    for (BezierCPs::const_iterator it = points.begin(); it != points.end(); ++it) {
-        if ( next == points.end() ) {
+    std::size_t nPoints = points.size();
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        std::size_t next = i + 1;
+        if (next == nPoints) {
             if (!finished && !isOpenBezier) {
                 break;
             }
-            next = points.begin();
-        }
-        bezierSegmentBboxUpdate(*(*it), *(*next), time, mipMapLevel, transform, bbox);
-        
-        // increment for next iteration
-        if (next != points.end()) {
-            ++next;
+            next = 0;
         }
+        bezierSegmentBboxUpdate(points[i], points[next], mipMapLevel, transform, bbox);
     } // for()
 }
 
+void
+Bezier::bezierSegmentListBboxUpdate(const BezierCPs & points,
+                                    bool finished,
+                                    bool isOpenBezier,
+                                    int time,
+                                    unsigned int mipMapLevel,
+                                    const Transform::Matrix3x3& transform,
+                                    RectD* bbox) ///< input/output
+{
+    std::vector<BezierCPValue> values;
+    evaluateControlPoints(points, time, &values);
+    ::bezierSegmentListBboxUpdate(values, finished, isOpenBezier, mipMapLevel, transform, bbox);
+}
+
 // compute nbPointsperSegment points and update the bbox bounding box for the Bezier
 // segment from 'first' to 'last' evaluated at 'time'
 // If nbPointsPerSegment is -1 then it will be automatically computed
 static void
-bezierSegmentEval(const BezierCP & first,
-                  const BezierCP & last,
-                  int time,
+bezierSegmentEval(const BezierCPValue & first,
+                  const BezierCPValue & last,
                   unsigned int mipMapLevel,
                   int nbPointsPerSegment,
                   const Transform::Matrix3x3& transform,
@@ -409,14 +425,14 @@ bezierSegmentEval(const BezierCP & first,
     Transform::Point3D p0M,p1M,p2M,p3M;
     Point p0,p1,p2,p3;
     
-    try {
-        first.getPositionAtTime(time, &p0M.x, &p0M.y);
-        first.getRightBezierPointAtTime(time, &p1M.x, &p1M.y);
-        last.getPositionAtTime(time, &p3M.x, &p3M.y);
-        last.getLeftBezierPointAtTime(time, &p2M.x, &p2M.y);
-    } catch (const std::exception & e) {
-        assert(false);
-    }
+    p0M.x = first.p.x;
+    p0M.y = first.p.y;
+    p1M.x = first.right.x;
+    p1M.y = first.right.y;
+    p3M.x = last.p.x;
+    p3M.y = last.p.y;
+    p2M.x = last.left.x;
+    p2M.y = last.left.y;
     
     p0M.z = p1M.z = p2M.z = p3M.z = 1;
     
@@ -481,20 +497,17 @@ bezierSegmentEval(const BezierCP & first,
  * yields the closest point to (x,y) on the curve.
  **/
 static bool
-bezierSegmentMeetsPoint(const BezierCP & first,
-                        const BezierCP & last,
-                        int time,
+bezierSegmentMeetsPoint(const BezierCPValue & first,
+                        const BezierCPValue & last,
                         double x,
                         double y,
                         double distance,
                         double *param) ///< output
 {
-    Point p0,p1,p2,p3;
-    
-    first.getPositionAtTime(time, &p0.x, &p0.y);
-    first.getRightBezierPointAtTime(time, &p1.x, &p1.y);
-    last.getPositionAtTime(time, &p3.x, &p3.y);
-    last.getLeftBezierPointAtTime(time, &p2.x, &p2.y);
+    const Point & p0 = first.p;
+    const Point & p1 = first.right;
+    const Point & p2 = last.left;
+    const Point & p3 = last.p;
     
     ///Use the control polygon to approximate segment length
     double length = ( std::sqrt( (p1.x - p0.x) * (p1.x - p0.x) + (p1.y - p0.y) * (p1.y - p0.y) ) +
@@ -528,15 +541,14 @@ bezierSegmentMeetsPoint(const BezierCP & first,
 }
 
 static bool
-isPointCloseTo(int time,
-               const BezierCP & p,
+isPointCloseTo(const BezierCPValue & p,
                double x,
                double y,
                double acceptance)
 {
-    double px,py;
+    double px = p.p.x;
+    double py = p.p.y;
     
-    p.getPositionAtTime(time, &px, &py);
     if ( ( px >= (x - acceptance) ) && ( px <= (x + acceptance) ) && ( py >= (y - acceptance) ) && ( py <= (y + acceptance) ) ) {
         return true;
     }
@@ -545,30 +557,16 @@ isPointCloseTo(int time,
 }
 
 static bool
-bezierSegmenEqual(int time,
-                  const BezierCP & p0,
-                  const BezierCP & p1,
-                  const BezierCP & s0,
-                  const BezierCP & s1)
-{
-    double prevX,prevY,prevXF,prevYF;
-    double nextX,nextY,nextXF,nextYF;
-    
-    p0.getPositionAtTime(time, &prevX, &prevY);
-    p1.getPositionAtTime(time, &nextX, &nextY);
-    s0.getPositionAtTime(time, &prevXF, &prevYF);
-    s1.getPositionAtTime(time, &nextXF, &nextYF);
-    if ( (prevX != prevXF) || (prevY != prevYF) || (nextX != nextXF) || (nextY != nextYF) ) {
+bezierSegmenEqual(const BezierCPValue & p0,
+                  const BezierCPValue & p1,
+                  const BezierCPValue & s0,
+                  const BezierCPValue & s1)
+{
+    if ( (p0.p.x != s0.p.x) || (p0.p.y != s0.p.y) || (p1.p.x != s1.p.x) || (p1.p.y != s1.p.y) ) {
         return true;
     } else {
         ///check derivatives
-        double prevRightX,prevRightY,nextLeftX,nextLeftY;
-        double prevRightXF,prevRightYF,nextLeftXF,nextLeftYF;
-        p0.getRightBezierPointAtTime(time, &prevRightX, &prevRightY);
-        p1.getLeftBezierPointAtTime(time, &nextLeftX, &nextLeftY);
-        s0.getRightBezierPointAtTime(time,&prevRightXF, &prevRightYF);
-        s1.getLeftBezierPointAtTime(time, &nextLeftXF, &nextLeftYF);
-        if ( (prevRightX != prevRightXF) || (prevRightY != prevRightYF) || (nextLeftX != nextLeftXF) || (nextLeftY != nextLeftYF) ) {
+        if ( (p0.right.x != s0.right.x) || (p0.right.y != s0.right.y) || (p1.left.x != s1.left.x) || (p1.left.y != s1.left.y) ) {
             return true;
         } else {
             return false;
@@ -663,33 +661,43 @@ BezierCP::setPositionAtTime(int time,
         k.setInterpolation(Natron::eKeyframeTypeLinear);
         _imp->curveY->addKeyFrame(k);
     }
+    invalidateHolderEvaluation();
 }
 
 void
 BezierCP::setStaticPosition(double x,
                             double y)
 {
-    QMutexLocker l(&_imp->staticPositionMutex);
-    _imp->x = x;
-    _imp->y = y;
+    {
+        QMutexLocker l(&_imp->staticPositionMutex);
+        _imp->x = x;
+        _imp->y = y;
+    }
+    invalidateHolderEvaluation();
 }
 
 void
 BezierCP::setLeftBezierStaticPosition(double x,
                                       double y)
 {
-    QMutexLocker l(&_imp->staticPositionMutex);
-    _imp->leftX = x;
-    _imp->leftY = y;
+    {
+        QMutexLocker l(&_imp->staticPositionMutex);
+        _imp->leftX = x;
+        _imp->leftY = y;
+    }
+    invalidateHolderEvaluation();
 }
 
 void
 BezierCP::setRightBezierStaticPosition(double x,
                                        double y)
 {
-    QMutexLocker l(&_imp->staticPositionMutex);
-    _imp->rightX = x;
-    _imp->rightY = y;
+    {
+        QMutexLocker l(&_imp->staticPositionMutex);
+        _imp->rightX = x;
+        _imp->rightY = y;
+    }
+    invalidateHolderEvaluation();
 }
 
 bool
@@ -808,6 +816,7 @@ BezierCP::setLeftBezierPointAtTime(int time,
         k.setInterpolation(Natron::eKeyframeTypeLinear);
         _imp->curveLeftBezierY->addKeyFrame(k);
     }
+    invalidateHolderEvaluation();
 }
 
 void
@@ -825,6 +834,7 @@ BezierCP::setRightBezierPointAtTime(int time,
         k.setInterpolation(Natron::eKeyframeTypeLinear);
         _imp->curveRightBezierY->addKeyFrame(k);
     }
+    invalidateHolderEvaluation();
 }
 
 
@@ -850,6 +860,7 @@ BezierCP::removeAnimation(int currentTime)
     _imp->curveRightBezierX->clearKeyFrames();
     _imp->curveLeftBezierY->clearKeyFrames();
     _imp->curveRightBezierY->clearKeyFrames();
+    invalidateHolderEvaluation();
 }
 
 void
@@ -878,6 +889,7 @@ BezierCP::removeKeyframe(int time)
         _imp->curveRightBezierY->removeKeyFrameWithTime(time);
     } catch (...) {
     }
+    invalidateHolderEvaluation();
 }
 
 
@@ -924,6 +936,7 @@ BezierCP::setKeyFrameInterpolation(Natron::KeyframeTypeEnum interp,int index)
     _imp->curveLeftBezierY->setKeyFrameInterpolation(interp, index);
     _imp->curveRightBezierX->setKeyFrameInterpolation(interp, index);
     _imp->curveRightBezierY->setKeyFrameInterpolation(interp, index);
+    invalidateHolderEvaluation();
 }
 
 int
@@ -1270,6 +1283,7 @@ BezierCP::clone(const BezierCP & other)
         _imp->masterTrack = other._imp->masterTrack;
         _imp->offsetTime = other._imp->offsetTime;
     }
+    invalidateHolderEvaluation();
 }
 
 bool
@@ -1308,9 +1322,12 @@ BezierCP::slaveTo(SequenceTime offsetTime,
 {
     assert( QThread::currentThread() == qApp->thread() );
     assert(!_imp->masterTrack);
-    QWriteLocker l(&_imp->masterMutex);
-    _imp->masterTrack = track;
-    _imp->offsetTime = offsetTime;
+    {
+        QWriteLocker l(&_imp->masterMutex);
+        _imp->masterTrack = track;
+        _imp->offsetTime = offsetTime;
+    }
+    invalidateHolderEvaluation();
 }
 
 void
@@ -1318,8 +1335,11 @@ BezierCP::unslave()
 {
     assert( QThread::currentThread() == qApp->thread() );
     assert(_imp->masterTrack);
-    QWriteLocker l(&_imp->masterMutex);
-    _imp->masterTrack.reset();
+    {
+        QWriteLocker l(&_imp->masterMutex);
+        _imp->masterTrack.reset();
+    }
+    invalidateHolderEvaluation();
 }
 
 boost::shared_ptr<Double_Knob>
@@ -1330,6 +1350,24 @@ BezierCP::isSlaved() const
     return _imp->masterTrack;
 }
 
+void
+BezierCP::evaluateAtTime(int time,
+                         BezierCPValue* value) const
+{
+    getPositionAtTime(time, &value->p.x, &value->p.y);
+    getLeftBezierPointAtTime(time, &value->left.x, &value->left.y);
+    getRightBezierPointAtTime(time, &value->right.x, &value->right.y);
+}
+
+void
+BezierCP::invalidateHolderEvaluation()
+{
+    boost::shared_ptr<Bezier> b = _imp->holder.lock();
+    if (b) {
+        b->invalidateEvaluation();
+    }
+}
+
 ////////////////////////////////////RotoItem////////////////////////////////////
 namespace {
 class RotoMetaTypesRegistration
@@ -3483,6 +3521,8 @@ Bezier::clearAllPoints()
     _imp->featherPoints.clear();
     _imp->isClockwiseOriented.clear();
     _imp->finished = false;
+    k.unlock();
+    invalidateEvaluation();
 }
 
 void
@@ -3520,6 +3560,7 @@ Bezier::clone(const RotoItem* other)
         _imp->isOpenBezier = otherBezier->_imp->isOpenBezier;
         _imp->finished = otherBezier->_imp->finished && _imp->isOpenBezier;
     }
+    invalidateEvaluation();
     incrementNodesAge();
     RotoDrawableItem::clone(other);
     Q_EMIT cloned();
@@ -3607,6 +3648,7 @@ Bezier::addControlPoint(double x,
         }
     }
     
+    invalidateEvaluation();
     incrementNodesAge();
     return p;
 }
@@ -3779,6 +3821,7 @@ Bezier::addControlPointAfterIndex(int index,
   
     }
     
+    invalidateEvaluation();
     incrementNodesAge();
     
     return p;
@@ -3804,21 +3847,26 @@ Bezier::isPointOnCurve(double x,
 
     int time = getContext()->getTimelineCurrentTime();
     QMutexLocker l(&itemMutex);
+    BezierEvaluationPtr evaluation = getEvaluationAtTime_internal(time);
+    const std::vector<BezierCPValue> & points = evaluation->points;
+    const std::vector<BezierCPValue> & featherPoints = evaluation->featherPoints;
+
+    bool useFeather = useFeatherPoints();
+    
+    assert( featherPoints.size() == points.size() || !useFeather);
 
     ///special case: if the curve has only 1 control point, just check if the point
     ///is nearby that sole control point
-    if (_imp->points.size() == 1) {
-        const boost::shared_ptr<BezierCP> & cp = _imp->points.front();
-        if ( isPointCloseTo(time, *cp, x, y, distance) ) {
+    if (points.size() == 1) {
+        if ( isPointCloseTo(points.front(), x, y, distance) ) {
             *feather = false;
             
             return 0;
         } else {
             
-            if (useFeatherPoints()) {
+            if (useFeather) {
                 ///do the same with the feather points
-                const boost::shared_ptr<BezierCP> & fp = _imp->featherPoints.front();
-                if ( isPointCloseTo(time, *fp, x, y, distance) ) {
+                if ( isPointCloseTo(featherPoints.front(), x, y, distance) ) {
                     *feather = true;
                     
                     return 0;
@@ -3830,52 +3878,29 @@ Bezier::isPointOnCurve(double x,
     }
 
     ///For each segment find out if the point lies on the bezier
-    int index = 0;
-
-    bool useFeather = useFeatherPoints();
-    
-    assert( _imp->featherPoints.size() == _imp->points.size() || !useFeather);
-
-    BezierCPs::const_iterator fp = _imp->featherPoints.begin();
-    for (BezierCPs::const_iterator it = _imp->points.begin(); it != _imp->points.end(); ++it, ++index) {
-        BezierCPs::const_iterator next = it;
-        BezierCPs::const_iterator nextFp = fp;
-        
-        if (useFeather && nextFp != _imp->featherPoints.end()) {
-            ++nextFp;
-        }
-        if (next != _imp->points.end()) {
-            ++next;
-        }
-        if ( next == _imp->points.end() ) {
+    int nPoints = (int)points.size();
+    for (int index = 0; index < nPoints; ++index) {
+        int next = index + 1;
+        if (next == nPoints) {
             if (!_imp->finished) {
                 return -1;
             } else {
-                next = _imp->points.begin();
-                if (useFeather) {
-                    nextFp = _imp->featherPoints.begin();
-                }
+                next = 0;
             }
         }
-        if ( bezierSegmentMeetsPoint(*(*it), *(*next), time, x, y, distance, t) ) {
+        if ( bezierSegmentMeetsPoint(points[index], points[next], x, y, distance, t) ) {
             *feather = false;
 
             return index;
         }
         
-        if (useFeather && bezierSegmentMeetsPoint(**fp, **nextFp, time, x, y, distance, t) ) {
+        if (useFeather && bezierSegmentMeetsPoint(featherPoints[index], featherPoints[next], x, y, distance, t) ) {
             *feather = true;
 
             return index;
         }
-        if (useFeather) {
-            ++fp;
-        }
     }
 
-    ///now check the feather points segments only if they are different from the base bezier
-
-
     return -1;
 } // isPointOnCurve
 
@@ -3971,6 +3996,7 @@ Bezier::removeControlPointByIndex(int index)
         }
     }
     
+    invalidateEvaluation();
     incrementNodesAge();
     refreshPolygonOrientation();
     Q_EMIT controlPointRemoved();
@@ -4708,38 +4734,104 @@ Bezier::getKeyframesCount() const
     }
 }
 
-void
-Bezier::deCastelJau(const std::list<boost::shared_ptr<BezierCP> >& cps,
-                    int time,
-                    unsigned int mipMapLevel,
-                    bool finished,
-                    int nBPointsPerSegment,
-                    const Transform::Matrix3x3& transform,
-                    std::list<Natron::Point>* points, RectD* bbox)
+BezierEvaluationPtr
+Bezier::getEvaluationAtTime(int time) const
 {
-    BezierCPs::const_iterator next = cps.begin();
+    QMutexLocker l(&itemMutex);
+    return getEvaluationAtTime_internal(time);
+}
+
+BezierEvaluationPtr
+Bezier::getEvaluationAtTime_internal(int time) const
+{
+    // PRIVATE - itemMutex must be locked by the caller
     
-    if (next != cps.end()) {
-        ++next;
+    bool useFeather = useFeatherPoints();
+    std::size_t nFeatherPoints = useFeather ? _imp->featherPoints.size() : 0;
+    U64 age;
+    {
+        QMutexLocker k(&_imp->evaluationCacheMutex);
+        std::map<int,BezierEvaluationPtr>::const_iterator found = _imp->evaluationCache.find(time);
+        ///Also check the sizes in case points were added but the invalidation did not happen yet
+        if ( found != _imp->evaluationCache.end() &&
+            found->second->points.size() == _imp->points.size() &&
+            found->second->featherPoints.size() == nFeatherPoints) {
+            return found->second;
+        }
+        age = _imp->evaluationCacheAge;
     }
     
+    boost::shared_ptr<BezierEvaluation> ret(new BezierEvaluation);
+    evaluateControlPoints(_imp->points, time, &ret->points);
+    if (useFeather) {
+        evaluateControlPoints(_imp->featherPoints, time, &ret->featherPoints);
+    }
     
-    for (BezierCPs::const_iterator it = cps.begin(); it != cps.end(); ++it) {
-        if ( next == cps.end() ) {
+    ///Points slaved to a track follow a knob that does not notify the Bezier, so do not cache them
+    bool hasSlavedPoint = false;
+    for (BezierCPs::const_iterator it = _imp->points.begin(); it != _imp->points.end() && !hasSlavedPoint; ++it) {
+        hasSlavedPoint = (bool)(*it)->isSlaved();
+    }
+    for (BezierCPs::const_iterator it = _imp->featherPoints.begin(); it != _imp->featherPoints.end() && !hasSlavedPoint; ++it) {
+        hasSlavedPoint = (bool)(*it)->isSlaved();
+    }
+    if (!hasSlavedPoint) {
+        QMutexLocker k(&_imp->evaluationCacheMutex);
+        ///If the age changed, a control point was modified while we were evaluating
+        if (age == _imp->evaluationCacheAge) {
+            if ((int)_imp->evaluationCache.size() >= ROTO_BEZIER_EVALUATION_CACHE_SIZE) {
+                _imp->evaluationCache.clear();
+            }
+            _imp->evaluationCache[time] = ret;
+        }
+    }
+    return ret;
+}
+
+void
+Bezier::invalidateEvaluation()
+{
+    QMutexLocker k(&_imp->evaluationCacheMutex);
+    _imp->evaluationCache.clear();
+    ++_imp->evaluationCacheAge;
+}
+
+static void
+deCastelJau(const std::vector<BezierCPValue>& cps,
+            unsigned int mipMapLevel,
+            bool finished,
+            int nBPointsPerSegment,
+            const Transform::Matrix3x3& transform,
+            std::list<Natron::Point>* points,
+            RectD* bbox)
+{
+    std::size_t nPoints = cps.size();
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        std::size_t next = i + 1;
+        if (next == nPoints) {
             if (!finished) {
                 break;
             }
-            next = cps.begin();
-        }
-        bezierSegmentEval(*(*it),*(*next), time,mipMapLevel, nBPointsPerSegment, transform, points,bbox);
-        
-        // increment for next iteration
-        if (next != cps.end()) {
-            ++next;
+            next = 0;
         }
+        bezierSegmentEval(cps[i], cps[next], mipMapLevel, nBPointsPerSegment, transform, points, bbox);
     } // for()
 }
 
+void
+Bezier::deCastelJau(const std::list<boost::shared_ptr<BezierCP> >& cps,
+                    int time,
+                    unsigned int mipMapLevel,
+                    bool finished,
+                    int nBPointsPerSegment,
+                    const Transform::Matrix3x3& transform,
+                    std::list<Natron::Point>* points, RectD* bbox)
+{
+    std::vector<BezierCPValue> values;
+    evaluateControlPoints(cps, time, &values);
+    ::deCastelJau(values, mipMapLevel, finished, nBPointsPerSegment, transform, points, bbox);
+}
+
 void
 Bezier::evaluateAtTime_DeCasteljau(int time,
                                    unsigned int mipMapLevel,
@@ -4750,7 +4842,8 @@ Bezier::evaluateAtTime_DeCasteljau(int time,
     Transform::Matrix3x3 transform;
     getTransformAtTime(time, &transform);
     QMutexLocker l(&itemMutex);
-    deCastelJau(_imp->points, time, mipMapLevel, _imp->finished, nbPointsPerSegment, transform, points, bbox);
+    BezierEvaluationPtr evaluation = getEvaluationAtTime_internal(time);
+    ::deCastelJau(evaluation->points, mipMapLevel, _imp->finished, nbPointsPerSegment, transform, points, bbox);
 }
 
 void
@@ -4771,52 +4864,35 @@ Bezier::evaluateFeatherPointsAtTime_DeCasteljau(int time,
                                                 RectD* bbox) const ///< output
 {
     assert(useFeatherPoints());
+    
+    Transform::Matrix3x3 transform;
+    getTransformAtTime(time, &transform);
+    
     QMutexLocker l(&itemMutex);
+    BezierEvaluationPtr evaluation = getEvaluationAtTime_internal(time);
+    const std::vector<BezierCPValue> & cps = evaluation->points;
+    const std::vector<BezierCPValue> & fps = evaluation->featherPoints;
 
-    if ( _imp->points.empty() ) {
+    if ( cps.empty() ) {
         return;
     }
-    BezierCPs::const_iterator itCp = _imp->points.begin();
-    BezierCPs::const_iterator next = _imp->featherPoints.begin();
-    if (next != _imp->featherPoints.end()) {
-        ++next;
-    }
-    BezierCPs::const_iterator nextCp = itCp;
-    if (nextCp != _imp->points.end()) {
-        ++nextCp;
-    }
+    assert(cps.size() == fps.size());
     
-    Transform::Matrix3x3 transform;
-    getTransformAtTime(time, &transform);
-    
-    for (BezierCPs::const_iterator it = _imp->featherPoints.begin(); it != _imp->featherPoints.end();
-         ++it) {
-        if ( next == _imp->featherPoints.end() ) {
-            next = _imp->featherPoints.begin();
-        }
-        if ( nextCp == _imp->points.end() ) {
+    std::size_t nPoints = fps.size();
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        std::size_t next = i + 1;
+        if (next == nPoints) {
             if (!_imp->finished) {
                 break;
             }
-            nextCp = _imp->points.begin();
+            next = 0;
         }
-        if ( !evaluateIfEqual && bezierSegmenEqual(time, **itCp, **nextCp, **it, **next) ) {
+        if ( !evaluateIfEqual && bezierSegmenEqual(cps[i], cps[next], fps[i], fps[next]) ) {
             continue;
         }
 
-        bezierSegmentEval(*(*it),*(*next), time, mipMapLevel, nbPointsPerSegment, transform, points, bbox);
-
-        // increment for next iteration
-        if (itCp != _imp->featherPoints.end()) {
-            ++itCp;
-        }
-        if (next != _imp->featherPoints.end()) {
-            ++next;
-        }
-        if (nextCp != _imp->featherPoints.end()) {
-            ++nextCp;
-        }
-    } // for(it)
+        bezierSegmentEval(fps[i], fps[next], mipMapLevel, nbPointsPerSegment, transform, points, bbox);
+    } // for(i)
 }
 
 RectD
@@ -4834,11 +4910,12 @@ Bezier::getBoundingBox(int time) const
     getTransformAtTime(time, &transform);
     
     QMutexLocker l(&itemMutex);
-    bezierSegmentListBboxUpdate(_imp->points, _imp->finished, _imp->isOpenBezier, time, 0, transform , &bbox);
+    BezierEvaluationPtr evaluation = getEvaluationAtTime_internal(time);
+    ::bezierSegmentListBboxUpdate(evaluation->points, _imp->finished, _imp->isOpenBezier, 0, transform , &bbox);
     
     
     if (useFeatherPoints() && !_imp->isOpenBezier) {
-        bezierSegmentListBboxUpdate(_imp->featherPoints, _imp->finished, _imp->isOpenBezier, time, 0, transform, &bbox);
+        ::bezierSegmentListBboxUpdate(evaluation->featherPoints, _imp->finished, _imp->isOpenBezier, 0, transform, &bbox);
         // EDIT: Partial fix, just pad the BBOX by the feather distance. This might not be accurate but gives at least something
         // enclosing the real bbox and close enough
         double featherDistance = getFeatherDistance(time);
@@ -5207,32 +5284,73 @@ Bezier::rightDerivativeAtPoint(int time,
 }
 
 void
-Bezier::save(RotoItemSerialization* obj) const
+Bezier::saveShape(BezierSerialization* s) const
 {
-    BezierSerialization* s = dynamic_cast<BezierSerialization*>(obj);
-    if (s) {
-        QMutexLocker l(&itemMutex);
+    QMutexLocker l(&itemMutex);
+
+    s->_closed = _imp->finished;
+    s->_isOpenBezier = _imp->isOpenBezier;
+    assert( _imp->featherPoints.size() == _imp->points.size() || !useFeatherPoints());
 
-        s->_closed = _imp->finished;
-        s->_isOpenBezier = _imp->isOpenBezier;
-        assert( _imp->featherPoints.size() == _imp->points.size() || !useFeatherPoints());
 
+    bool useFeather = useFeatherPoints();
+    BezierCPs::const_iterator fp = _imp->featherPoints.begin();
+    for (BezierCPs::const_iterator it = _imp->points.begin(); it != _imp->points.end(); ++it) {
+        BezierCP c;
+        c.clone(**it);
+        s->_controlPoints.push_back(c);
+        if (useFeather) {
+            BezierCP f;
+            f.clone(**fp);
+            s->_featherPoints.push_back(f);
+            ++fp;
+        }
+        
+    }
+}
 
+void
+Bezier::restoreShape(const BezierSerialization & s)
+{
+    boost::shared_ptr<Bezier> this_shared = boost::dynamic_pointer_cast<Bezier>(shared_from_this());
+    assert(this_shared);
+    
+    Q_EMIT aboutToClone();
+    {
+        QMutexLocker l(&itemMutex);
+        _imp->isOpenBezier = s._isOpenBezier;
+        _imp->finished = s._closed && _imp->isOpenBezier;
+        
+        _imp->featherPoints.clear();
+        _imp->points.clear();
         bool useFeather = useFeatherPoints();
-        BezierCPs::const_iterator fp = _imp->featherPoints.begin();
-        for (BezierCPs::const_iterator it = _imp->points.begin(); it != _imp->points.end(); ++it) {
-            BezierCP c;
-            c.clone(**it);
-            s->_controlPoints.push_back(c);
+        std::list<BezierCP>::const_iterator itF = s._featherPoints.begin();
+        for (std::list<BezierCP>::const_iterator it = s._controlPoints.begin(); it != s._controlPoints.end(); ++it) {
+            boost::shared_ptr<BezierCP> cp( new BezierCP(this_shared) );
+            cp->clone(*it);
+            _imp->points.push_back(cp);
+            
             if (useFeather) {
-                BezierCP f;
-                f.clone(**fp);
-                s->_featherPoints.push_back(f);
-                ++fp;
+                boost::shared_ptr<BezierCP> fp( new FeatherPoint(this_shared) );
+                fp->clone(*itF);
+                _imp->featherPoints.push_back(fp);
+                ++itF;
             }
-            
         }
     }
+    invalidateEvaluation();
+    incrementNodesAge();
+    refreshPolygonOrientation();
+    Q_EMIT cloned();
+}
+
+void
+Bezier::save(RotoItemSerialization* obj) const
+{
+    BezierSerialization* s = dynamic_cast<BezierSerialization*>(obj);
+    if (s) {
+        saveShape(s);
+    }
     
     RotoDrawableItem::save(obj);
 }
@@ -5264,6 +5382,7 @@ Bezier::load(const RotoItemSerialization & obj)
             }
         }
     }
+    invalidateEvaluation();
     refreshPolygonOrientation();
     RotoDrawableItem::load(obj);
 }
@@ -19,6 +19,7 @@
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
@@ -81,6 +82,26 @@ class Bezier;
 class RotoItemSerialization;
 class BezierSerialization;
 
+/**
+ * @brief The position and the left/right bezier points of a control point evaluated at a given time.
+ **/
+struct BezierCPValue
+{
+    Natron::Point p,left,right;
+};
+
+/**
+ * @brief An immutable snapshot of the control points and feather points of a Bezier evaluated at a given time.
+ * The feather points vector is empty if the Bezier does not use feather points.
+ **/
+struct BezierEvaluation
+{
+    std::vector<BezierCPValue> points;
+    std::vector<BezierCPValue> featherPoints;
+};
+
+typedef boost::shared_ptr<const BezierEvaluation> BezierEvaluationPtr;
+
 /**
  * @class A Bezier is an animated control point of a Bezier. It is the starting point
  * and/or the ending point of a bezier segment. (It would correspond to P0/P3).
@@ -162,6 +183,11 @@ public:
 
     bool getRightBezierPointAtTime(int time,double *x,double *y,bool skipMasterOrRelative = false) const;
 
+    /**
+     * @brief Evaluates the position and both bezier points at the given time
+     **/
+    void evaluateAtTime(int time,BezierCPValue* value) const;
+
     bool hasKeyFrameAtTime(int time) const;
 
     void getKeyframeTimes(std::set<int>* times) const;
@@ -204,6 +230,11 @@ public:
     SequenceTime getOffsetTime() const;
 
 private:
+    
+    /**
+     * @brief Must be called after any change to the curves so that the Bezier drops its cached evaluations
+     **/
+    void invalidateHolderEvaluation();
 
     template<class Archive>
     void save(Archive & ar, const unsigned int version) const;
@@ -646,6 +677,14 @@ public:
     
     virtual void clone(const RotoItem* other) OVERRIDE;
 
+    /**
+     * @brief Same as save() and load() but only for the shape of the curve: its control points, feather points
+     * and whether it is open and finished. Unlike load(), restoreShape() replaces the points of the curve.
+     * The parameters of the item are left untouched, which makes this much lighter than clone() for
+     * the undo/redo commands that only edit the shape.
+     **/
+    void saveShape(BezierSerialization* obj) const;
+    void restoreShape(const BezierSerialization & obj);
     
     void clearAllPoints();
     
@@ -843,6 +882,23 @@ public:
      * @brief Returns the number of keyframes for this spline.
      **/
     int getKeyframesCount() const;
+    
+    /**
+     * @brief Returns the control points and feather points evaluated at the given time. The snapshot is cached per time
+     * and shared by the render, the bounding box, the hit tests and the overlay until a control point or a keyframe changes.
+     **/
+    BezierEvaluationPtr getEvaluationAtTime(int time) const;
+    
+    /**
+     * @brief Drops all the cached evaluations. This is called by the control points whenever they are modified.
+     **/
+    void invalidateEvaluation();
+    
+private:
+    
+    BezierEvaluationPtr getEvaluationAtTime_internal(int time) const;
+    
+public:
 
     static void deCastelJau(const std::list<boost::shared_ptr<BezierCP> >& cps, int time, unsigned int mipMapLevel,
                             bool finished,
@@ -53,6 +53,9 @@
 #define ROTO_DEFAULT_COLOR_G 1.
 #define ROTO_DEFAULT_COLOR_B 1.
 
+///Maximum number of times for which the evaluated control points of a Bezier are kept
+#define ROTO_BEZIER_EVALUATION_CACHE_SIZE 32
+
 
 #define kRotoScriptNameHint "Script-name of the item for Python scripts. It cannot be edited."
 
@@ -342,6 +345,11 @@ struct BezierPrivate
 
     bool isOpenBezier;
     
+    //The control points evaluated per time, dropped whenever a control point changes
+    mutable QMutex evaluationCacheMutex;
+    mutable std::map<int,BezierEvaluationPtr> evaluationCache;
+    U64 evaluationCacheAge; //< incremented on each invalidation so that evaluations racing with an edit are not cached
+    
     BezierPrivate(bool isOpenBezier)
     : points()
     , featherPoints()
@@ -350,6 +358,9 @@ struct BezierPrivate
     , autoRecomputeOrientation(true)
     , finished(false)
     , isOpenBezier(isOpenBezier)
+    , evaluationCacheMutex()
+    , evaluationCache()
+    , evaluationCacheAge(0)
     {
     }
 
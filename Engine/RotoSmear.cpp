@@ -5,6 +5,17 @@
 
 #include "RotoSmear.h"
 
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NATRON_SMEAR_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+#include <QtConcurrentMap>
+
+#include <boost/bind.hpp>
+
 #include "Engine/Node.h"
 #include "Engine/Image.h"
 #include "Engine/KnobTypes.h"
@@ -142,66 +153,188 @@ static ImagePtr renderSmearMaskDot( boost::shared_ptr<RotoStrokeItem>& stroke, c
 }
 
 
-static void renderSmearDot(boost::shared_ptr<RotoStrokeItem>& stroke,
-                           const Point& prev,
-                           const Point& next,
-                           double /*prevPress*/,
-                           double nextPress,
-                           double brushSize,
-                           ImageBitDepthEnum depth,
-                           unsigned int mipmapLevel,
-                           int nComps,
-                           const ImagePtr& outputImage)
+void
+Natron::smearBlendRow(const float* src,
+                      const float* mask,
+                      int width,
+                      int nComps,
+                      float* dst)
 {
-    ImagePtr dotMask = renderSmearMaskDot( stroke, next, nextPress, brushSize, ImageComponents::getAlphaComponents(), depth, mipmapLevel);
-    assert(dotMask);
-    
-    RectI nextDotBounds = dotMask->getBounds();
+    int x = 0;
+#ifdef NATRON_SMEAR_USE_SSE
+    if (nComps == 4) {
+        for (; x < width; ++x, src += 4, dst += 4) {
+            __m128 m = _mm_set1_ps(mask[x]);
+            __m128 s = _mm_loadu_ps(src);
+            __m128 d = _mm_loadu_ps(dst);
+            //dst + (src - dst) * mask == src * mask + dst * (1 - mask)
+            _mm_storeu_ps(dst, _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(s, d), m)));
+        }
+        return;
+    } else if (nComps == 1) {
+        for (; x + 4 <= width; x += 4, src += 4, dst += 4) {
+            __m128 m = _mm_loadu_ps(mask + x);
+            __m128 s = _mm_loadu_ps(src);
+            __m128 d = _mm_loadu_ps(dst);
+            _mm_storeu_ps(dst, _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(s, d), m)));
+        }
+        //The remaining pixels are processed by the scalar loop below
+    }
+#endif
+    for (; x < width; ++x, src += nComps, dst += nComps) {
+        for (int k = 0; k < nComps; ++k) {
+            dst[k] = src[k] * mask[x] + dst[k] * (1. - mask[x]);
+        }
+    }
+}
+
+namespace {
     
+struct SmearDab
+{
+    //Center of the portion of the image copied and center of the dot we render
+    Point prev,next;
+    double pressure;
     
-    RectD prevDotRoD(prev.x - brushSize / 2., prev.y - brushSize / 2., prev.x + brushSize / 2., prev.y + brushSize / 2.);
-    RectI prevDotBounds;
-    prevDotRoD.toPixelEnclosing(mipmapLevel, outputImage->getPixelAspectRatio(), &prevDotBounds);
+    //Pixel bounds read from the output image (src) and written to (dst)
+    RectI srcBounds,dstBounds;
     
+    ImagePtr mask,src;
     
+    SmearDab()
+    : prev()
+    , next()
+    , pressure(0)
+    , srcBounds()
+    , dstBounds()
+    , mask()
+    , src()
+    {
+        
+    }
+};
     
-    ImagePtr tmpBuf(new Image(outputImage->getComponents(),prevDotRoD, prevDotBounds, mipmapLevel, outputImage->getPixelAspectRatio(), depth, false));
-    tmpBuf->pasteFrom(*outputImage, prevDotBounds, false);
+typedef std::vector<SmearDab> SmearDabBatch;
     
-    Image::ReadAccess tmpAcc(tmpBuf.get());
-    Image::WriteAccess wacc(outputImage.get());
-    Image::ReadAccess mracc = dotMask->getReadRights();
+}
 
+bool
+Natron::smearDabsConflict(const RectI& srcA,
+                          const RectI& dstA,
+                          const RectI& srcB,
+                          const RectI& dstB)
+{
+    return dstA.intersects(srcB) || dstA.intersects(dstB) || srcA.intersects(dstB);
+}
+
+/**
+ * @brief Renders the mask of the dab and computes the pixel bounds it reads and writes. The bounds written
+ * are those of the rendered mask, so this must be called before checking whether the dab can join a batch.
+ **/
+static void initSmearDab(boost::shared_ptr<RotoStrokeItem>& stroke,
+                         double brushSize,
+                         ImageBitDepthEnum depth,
+                         unsigned int mipmapLevel,
+                         double par,
+                         SmearDab* dab)
+{
+    RectD prevDotRoD(dab->prev.x - brushSize / 2., dab->prev.y - brushSize / 2., dab->prev.x + brushSize / 2., dab->prev.y + brushSize / 2.);
+    prevDotRoD.toPixelEnclosing(mipmapLevel, par, &dab->srcBounds);
+    dab->mask = renderSmearMaskDot( stroke, dab->next, dab->pressure, brushSize, ImageComponents::getAlphaComponents(), depth, mipmapLevel);
+    assert(dab->mask);
+    dab->dstBounds = dab->mask->getBounds();
+}
+
+/**
+ * @brief Returns true if the dab can be rendered concurrently with all dabs of the batch: this is the case
+ * if it does not read pixels written by the batch and does not write pixels read or written by the batch.
+ **/
+static bool canAddSmearDabToBatch(const SmearDabBatch& batch,const SmearDab& dab)
+{
+    for (SmearDabBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+        if ( Natron::smearDabsConflict(it->srcBounds, it->dstBounds, dab.srcBounds, dab.dstBounds) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+///Copies the pixels read by the dab, once all the previous batches were blended
+static void copySmearDabSource(double brushSize,
+                               ImageBitDepthEnum depth,
+                               unsigned int mipmapLevel,
+                               const ImagePtr& outputImage,
+                               SmearDab* dab)
+{
+    RectD prevDotRoD(dab->prev.x - brushSize / 2., dab->prev.y - brushSize / 2., dab->prev.x + brushSize / 2., dab->prev.y + brushSize / 2.);
+    dab->src.reset(new Image(outputImage->getComponents(),prevDotRoD, dab->srcBounds, mipmapLevel, outputImage->getPixelAspectRatio(), depth, false));
+    dab->src->pasteFrom(*outputImage, dab->srcBounds, false);
+}
+
+/**
+ * @brief Blends the copied source of the dab onto the output image. The caller holds the write access
+ * of the output image so that several dabs of the same batch can be blended concurrently.
+ **/
+static void blendSmearDab(int nComps,
+                          Image::WriteAccess* wacc,
+                          const RectI& outputBounds,
+                          const SmearDab& dab)
+{
+    RectI dstRect;
+    if (!dab.dstBounds.intersect(outputBounds, &dstRect)) {
+        return;
+    }
+    
+    Image::ReadAccess tmpAcc(dab.src.get());
+    Image::ReadAccess mracc = dab.mask->getReadRights();
     
-    int yPrev = prevDotBounds.y1;
-    for (int y = nextDotBounds.y1; y < nextDotBounds.y2; ++y,++yPrev) {
+    //Offset between the destination and the source pixels
+    int dx = dab.srcBounds.x1 - dab.dstBounds.x1;
+    int dy = dab.srcBounds.y1 - dab.dstBounds.y1;
+    
+    //Do not read past the end of the source rows
+    int width = std::min(dstRect.x2, dab.srcBounds.x2 - dx) - dstRect.x1;
+    if (width <= 0) {
+        return;
+    }
+    
+    for (int y = dstRect.y1; y < dstRect.y2; ++y) {
         
-        float* dstPixels = (float*)wacc.pixelAt(nextDotBounds.x1, y);
-        const float* maskPixels = (const float*)mracc.pixelAt(nextDotBounds.x1, y);
-        const float* srcPixels = (const float*)tmpAcc.pixelAt(prevDotBounds.x1, yPrev);
+        float* dstPixels = (float*)wacc->pixelAt(dstRect.x1, y);
+        const float* maskPixels = (const float*)mracc.pixelAt(dstRect.x1, y);
+        const float* srcPixels = (const float*)tmpAcc.pixelAt(dstRect.x1 + dx, y + dy);
         assert(dstPixels && maskPixels);
-        
-        int xPrev = prevDotBounds.x1;
-        for (int x = nextDotBounds.x1; x < nextDotBounds.x2;
-             ++x, ++xPrev,
-             dstPixels += nComps,
-             ++maskPixels) {
-            
-            
-            if (srcPixels) {
-                for (int k = 0; k < nComps; ++k) {
-                    dstPixels[k] = srcPixels[k] * *maskPixels + dstPixels[k] * (1. - *maskPixels);
-                }
-                
-                if (srcPixels) {
-                    srcPixels += nComps;
-                }
-            }
-            
+        if (!srcPixels) {
+            continue;
         }
+        Natron::smearBlendRow(srcPixels, maskPixels, width, nComps, dstPixels);
     }
-    
+}
 
+static void renderSmearDabBatch(double brushSize,
+                                ImageBitDepthEnum depth,
+                                unsigned int mipmapLevel,
+                                int nComps,
+                                const ImagePtr& outputImage,
+                                SmearDabBatch& batch)
+{
+    if (batch.empty()) {
+        return;
+    }
+    
+    //No dab of the batch reads pixels written by another
+    for (SmearDabBatch::iterator it = batch.begin(); it != batch.end(); ++it) {
+        copySmearDabSource(brushSize, depth, mipmapLevel, outputImage, &*it);
+    }
+    
+    RectI outputBounds = outputImage->getBounds();
+    Image::WriteAccess wacc(outputImage.get());
+    if (batch.size() == 1) {
+        blendSmearDab(nComps, &wacc, outputBounds, batch.front());
+    } else {
+        QtConcurrent::blockingMap(batch, boost::bind(&blendSmearDab, nComps, &wacc, outputBounds, _1));
+    }
+    batch.clear();
 }
 
 Natron::StatusEnum
@@ -317,12 +450,20 @@ RotoSmear::render(const RenderActionArgs& args)
         
         double distToNext = 0;
 
+        //Consecutive dabs that do not overlap are rendered concurrently
+        SmearDabBatch batch;
+        ImageBitDepthEnum depth = plane->second->getBitDepth();
         
         if (isFirstStrokeTick || !duringPainting) {
             //This is the very first dot we render
             prev = *it;
             ++it;
-            renderSmearDot(stroke,prev.first,it->first,prev.second,it->second,brushSize,plane->second->getBitDepth(),mipmapLevel, nComps, plane->second);
+            SmearDab dab;
+            dab.prev = prev.first;
+            dab.next = it->first;
+            dab.pressure = it->second;
+            initSmearDab(stroke, brushSize, depth, mipmapLevel, plane->second->getPixelAspectRatio(), &dab);
+            batch.push_back(dab);
             renderPoint = *it;
             prev = renderPoint;
             ++it;
@@ -343,6 +484,7 @@ RotoSmear::render(const RenderActionArgs& args)
         while (it!=visiblePortion.end()) {
             
             if (aborted()) {
+                batch.clear();
                 return eStatusOK;
             }
             
@@ -384,13 +526,23 @@ RotoSmear::render(const RenderActionArgs& args)
             
             prevPoint.x = prev.first.x + vx * v.x;
             prevPoint.y = prev.first.y + vy * v.y;
-            renderSmearDot(stroke,prevPoint,renderPoint.first,renderPoint.second,renderPoint.second,brushSize,plane->second->getBitDepth(),mipmapLevel, nComps,plane->second);
+            
+            SmearDab dab;
+            dab.prev = prevPoint;
+            dab.next = renderPoint.first;
+            dab.pressure = renderPoint.second;
+            initSmearDab(stroke, brushSize, depth, mipmapLevel, plane->second->getPixelAspectRatio(), &dab);
+            if (!canAddSmearDabToBatch(batch, dab)) {
+                renderSmearDabBatch(brushSize, depth, mipmapLevel, nComps, plane->second, batch);
+            }
+            batch.push_back(dab);
             
             prev = renderPoint;
             cur = renderPoint;
             distToNext = 0;
             
         }
+        renderSmearDabBatch(brushSize, depth, mipmapLevel, nComps, plane->second, batch);
         
         if (duringPainting) {
             QMutexLocker k(&_imp->smearDataMutex);
@@ -8,6 +8,23 @@
 
 #include "Engine/EffectInstance.h"
 
+namespace Natron {
+    
+/**
+ * @brief Blends one row of a smear dab: dst = src * mask + dst * (1 - mask).
+ * src and dst have nComps floats per pixel, mask has 1 float per pixel.
+ * RGBA and Alpha rows are processed with SSE when the compiler supports it.
+ **/
+void smearBlendRow(const float* src,const float* mask,int width,int nComps,float* dst);
+
+/**
+ * @brief Returns true if two smear dabs, given the pixel bounds they read (src) and write (dst), cannot be
+ * blended concurrently: one of them writes pixels read or written by the other.
+ **/
+bool smearDabsConflict(const RectI& srcA,const RectI& dstA,const RectI& srcB,const RectI& dstB);
+    
+}
+
 struct RotoSmearPrivate;
 class RotoSmear : public Natron::EffectInstance
 {
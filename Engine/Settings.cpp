@@ -111,6 +111,16 @@ Settings::initializeKnobs()
                                    " auto-saving. Note that if a render is in progress, " NATRON_APPLICATION_NAME " will "
                                    " wait until it is done to actually auto-save.");
     _generalTab->addKnob(_autoSaveDelay);
+    
+    _saveProjectsInBinaryFormat = Natron::createKnob<Bool_Knob>(this, "Save projects in binary format");
+    _saveProjectsInBinaryFormat->setName("binaryProjectFormat");
+    _saveProjectsInBinaryFormat->setAnimationEnabled(false);
+    _saveProjectsInBinaryFormat->setHintToolTip("When checked, projects are saved in a binary format which is much faster to load and save "
+                                                "than the default XML format, especially for projects with many nodes and animation. "
+                                                "Binary projects can only be opened by this version of " NATRON_APPLICATION_NAME " or a more recent one "
+                                                "running on the same kind of platform. Auto-saves always use the binary format. "
+                                                "Both formats can be opened regardless of this setting.");
+    _generalTab->addKnob(_saveProjectsInBinaryFormat);
 
 
     _linearPickers = Natron::createKnob<Bool_Knob>(this, "Linear color pickers");
@@ -258,6 +268,31 @@ Settings::initializeKnobs()
     _activateTransformConcatenationSupport->setName("transformCatSupport");
     _generalTab->addKnob(_activateTransformConcatenationSupport);
     
+    _hostTransformFilter = Natron::createKnob<Choice_Knob>(this, "Concatenated transforms filter");
+    _hostTransformFilter->setHintToolTip("The filter used to resample the image once when a chain of transform effects is concatenated. "
+                                         "When set to Plug-in, the last transform effect of the chain resamples the image with its own filter. "
+                                         "Otherwise " NATRON_APPLICATION_NAME " applies the concatenated transformation in a single pass "
+                                         "when it renders the same image as the last transform effect: its filter is the selected one, "
+                                         "clamping is off when the filter is Keys, black outside is on and motion blur is off. "
+                                         "The effect renders itself otherwise, so a chain ending with a transform effect that uses "
+                                         "another filter is rendered as with Plug-in.");
+    _hostTransformFilter->setAnimationEnabled(false);
+    _hostTransformFilter->setName("transformCatFilter");
+    {
+        std::vector<std::string> filters,helpFilters;
+        filters.push_back("Plug-in");
+        helpFilters.push_back("Let the last transform effect of the chain resample the image.");
+        filters.push_back("Bilinear");
+        helpFilters.push_back("Bilinear interpolation (2x2 pixels). Fast, but softens the image.");
+        filters.push_back("Cubic");
+        helpFilters.push_back("Cubic spline interpolation with zero derivatives at the samples (2x2 pixels). "
+                              "The default filter of the transform effects.");
+        filters.push_back("Keys");
+        helpFilters.push_back("Catmull-Rom cubic interpolation (4x4 pixels). Sharp, may overshoot on edges.");
+        _hostTransformFilter->populateChoices(filters,helpFilters);
+    }
+    _generalTab->addKnob(_hostTransformFilter);
+    
     
     _hostName = Natron::createKnob<String_Knob>(this, "Host name");
     _hostName->setName("hostName");
@@ -612,6 +647,18 @@ Settings::initializeKnobs()
                                           "Changing this value will clear the undo/redo stack.");
     _nodegraphTab->addKnob(_maxUndoRedoNodeGraph);
 
+    _maxUndoRedoMemoryMB = Natron::createKnob<Int_Knob>(this, "Maximum undo/redo memory (MiB)");
+    _maxUndoRedoMemoryMB->setName("maxUndoRedoMemory");
+    _maxUndoRedoMemoryMB->setAnimationEnabled(false);
+    _maxUndoRedoMemoryMB->disableSlider();
+    _maxUndoRedoMemoryMB->setMinimum(0);
+    _maxUndoRedoMemoryMB->setHintToolTip("The maximum amount of RAM (in MiB) used to remember the state of the items "
+                                         "edited by the undo/redo events, such as the shapes of the roto curves and the animation "
+                                         "curves replaced by a paste. Past this limit, the oldest states are compressed "
+                                         "and moved to a temporary file on disk and read back when undoing or redoing "
+                                         "their event.");
+    _nodegraphTab->addKnob(_maxUndoRedoMemoryMB);
+
 
     _disconnectedArrowLength = Natron::createKnob<Int_Knob>(this, "Disconnected arrow length");
     _disconnectedArrowLength->setName("disconnectedArrowLength");
@@ -1029,7 +1076,9 @@ Settings::setDefaultValues()
     _checkForUpdates->setDefaultValue(false);
     _notifyOnFileChange->setDefaultValue(true);
     _autoSaveDelay->setDefaultValue(5, 0);
+    _saveProjectsInBinaryFormat->setDefaultValue(false);
     _maxUndoRedoNodeGraph->setDefaultValue(20, 0);
+    _maxUndoRedoMemoryMB->setDefaultValue(512, 0);
     _linearPickers->setDefaultValue(true,0);
     _snapNodesToConnections->setDefaultValue(true);
     _useBWIcons->setDefaultValue(false);
@@ -1047,6 +1096,7 @@ Settings::setDefaultValues()
     _renderOnEditingFinished->setDefaultValue(false);
     _activateRGBSupport->setDefaultValue(true);
     _activateTransformConcatenationSupport->setDefaultValue(true);
+    _hostTransformFilter->setDefaultValue(0,0);
     _extraPluginPaths->setDefaultValue("",0);
     _preferBundledPlugins->setDefaultValue(true);
     _loadBundledPlugins->setDefaultValue(true);
@@ -1635,6 +1685,10 @@ Settings::onKnobValueChanged(KnobI* k,
         appPTR->onCheckerboardSettingsChanged();
     }  else if (k == _hideOptionalInputsAutomatically.get() && !_restoringSettings && reason == Natron::eValueChangedReasonUserEdited) {
         appPTR->toggleAutoHideGraphInputs();
+    } else if (k == _hostTransformFilter.get() && !_restoringSettings) {
+        ///Images rendered with the previous filter are no longer valid
+        appPTR->clearDiskCache();
+        appPTR->clearNodeCache();
     } else if (k == _autoProxyWhenScrubbingTimeline.get()) {
         _autoProxyLevel->setSecret(!_autoProxyWhenScrubbingTimeline->getValue());
     } else if (!_restoringSettings &&
@@ -2157,12 +2211,24 @@ Settings::getMaximumUndoRedoNodeGraph() const
     return _maxUndoRedoNodeGraph->getValue();
 }
 
+U64
+Settings::getMaximumUndoRedoMemory() const
+{
+    return (U64)( _maxUndoRedoMemoryMB->getValue() ) * std::pow(1024.,2.);
+}
+
 int
 Settings::getAutoSaveDelayMS() const
 {
     return _autoSaveDelay->getValue() * 1000;
 }
 
+bool
+Settings::isBinaryProjectFormatEnabled() const
+{
+    return _saveProjectsInBinaryFormat->getValue();
+}
+
 bool
 Settings::isSnapToNodeEnabled() const
 {
@@ -2470,6 +2536,17 @@ Settings::isTransformConcatenationEnabled() const
     return _activateTransformConcatenationSupport->getValue();
 }
 
+bool
+Settings::getHostTransformFilter(Natron::TransformFilterEnum* filter) const
+{
+    int index = _hostTransformFilter->getValue();
+    if (index <= 0) {
+        return false;
+    }
+    *filter = (Natron::TransformFilterEnum)(index - 1);
+    return true;
+}
+
 bool
 Settings::useGlobalThreadPool() const
 {
@@ -144,7 +144,12 @@ public:
 
     int getMaximumUndoRedoNodeGraph() const;
 
+    ///The memory (in bytes) that the states remembered by the undo/redo events may use before being moved to disk
+    U64 getMaximumUndoRedoMemory() const;
+
     int getAutoSaveDelayMS() const;
+    
+    bool isBinaryProjectFormatEnabled() const;
 
     bool isSnapToNodeEnabled() const;
 
@@ -206,6 +211,12 @@ public:
     
     bool isTransformConcatenationEnabled() const;
     
+    /**
+     * @brief Returns false if concatenated transforms are resampled by the plug-ins, otherwise the filter
+     * used by the host to resample them.
+     **/
+    bool getHostTransformFilter(Natron::TransformFilterEnum* filter) const;
+    
     bool isMergeAutoConnectingToAInput() const;
     
     /**
@@ -300,6 +311,7 @@ private:
     boost::shared_ptr<Bool_Knob> _checkForUpdates;
     boost::shared_ptr<Bool_Knob> _notifyOnFileChange;
     boost::shared_ptr<Int_Knob> _autoSaveDelay;
+    boost::shared_ptr<Bool_Knob> _saveProjectsInBinaryFormat;
     boost::shared_ptr<Bool_Knob> _linearPickers;
     boost::shared_ptr<Int_Knob> _numberOfThreads;
     boost::shared_ptr<Int_Knob> _numberOfParallelRenders;
@@ -315,6 +327,7 @@ private:
     boost::shared_ptr<Bool_Knob> _renderOnEditingFinished;
     boost::shared_ptr<Bool_Knob> _activateRGBSupport;
     boost::shared_ptr<Bool_Knob> _activateTransformConcatenationSupport;
+    boost::shared_ptr<Choice_Knob> _hostTransformFilter;
     boost::shared_ptr<String_Knob> _hostName;
     boost::shared_ptr<Choice_Knob> _ocioConfigKnob;
     boost::shared_ptr<Bool_Knob> _warnOcioConfigKnobChanged;
@@ -362,6 +375,7 @@ private:
     boost::shared_ptr<Bool_Knob> _snapNodesToConnections;
     boost::shared_ptr<Bool_Knob> _useBWIcons;
     boost::shared_ptr<Int_Knob> _maxUndoRedoNodeGraph;
+    boost::shared_ptr<Int_Knob> _maxUndoRedoMemoryMB;
     boost::shared_ptr<Int_Knob> _disconnectedArrowLength;
     boost::shared_ptr<Bool_Knob> _hideOptionalInputsAutomatically;
     boost::shared_ptr<Bool_Knob> _useInputAForMergeAutoConnect;
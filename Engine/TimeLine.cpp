@@ -127,7 +127,7 @@ TimeLine::addKeyframeIndicator(SequenceTime time)
     ///runs only in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    _keyframes.push_back(time);
+    _keyframes.insert(time);
     Q_EMIT keyframeIndicatorsChanged();
 }
 
@@ -138,7 +138,7 @@ TimeLine::addMultipleKeyframeIndicatorsAdded(const std::list<SequenceTime> & key
     ///runs only in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    _keyframes.insert( _keyframes.begin(),keys.begin(),keys.end() );
+    _keyframes.insert( keys.begin(),keys.end() );
     if (!keys.empty() && emitSignal) {
         Q_EMIT keyframeIndicatorsChanged();
     }
@@ -150,7 +150,8 @@ TimeLine::removeKeyFrameIndicator(SequenceTime time)
     ///runs only in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    std::list<SequenceTime>::iterator it = std::find(_keyframes.begin(), _keyframes.end(), time);
+    ///only remove one occurence, other keyframes may be at the same time
+    std::multiset<SequenceTime>::iterator it = _keyframes.find(time);
     if ( it != _keyframes.end() ) {
         _keyframes.erase(it);
         Q_EMIT keyframeIndicatorsChanged();
@@ -165,7 +166,7 @@ TimeLine::removeMultipleKeyframeIndicator(const std::list<SequenceTime> & keys,
     assert( QThread::currentThread() == qApp->thread() );
 
     for (std::list<SequenceTime>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
-        std::list<SequenceTime>::iterator it2 = std::find(_keyframes.begin(), _keyframes.end(), *it);
+        std::multiset<SequenceTime>::iterator it2 = _keyframes.find(*it);
         if ( it2 != _keyframes.end() ) {
             _keyframes.erase(it2);
         }
@@ -239,7 +240,18 @@ TimeLine::getKeyframes(std::list<SequenceTime>* keys) const
     ///runs only in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    *keys = _keyframes;
+    for (std::multiset<SequenceTime>::const_iterator it = _keyframes.begin(); it != _keyframes.end(); it = _keyframes.upper_bound(*it)) {
+        keys->push_back(*it);
+    }
+}
+
+bool
+TimeLine::isKeyframe(SequenceTime time) const
+{
+    ///runs only in the main thread
+    assert( QThread::currentThread() == qApp->thread() );
+
+    return _keyframes.find(time) != _keyframes.end();
 }
 
 void
@@ -248,8 +260,7 @@ TimeLine::goToPreviousKeyframe()
     ///runs only in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    _keyframes.sort();
-    std::list<SequenceTime>::iterator lowerBound = std::lower_bound(_keyframes.begin(), _keyframes.end(), _currentFrame);
+    std::multiset<SequenceTime>::iterator lowerBound = _keyframes.lower_bound(_currentFrame);
     if ( lowerBound != _keyframes.begin() ) {
         --lowerBound;
         seekFrame(*lowerBound, true, NULL, Natron::eTimelineChangeReasonPlaybackSeek);
@@ -262,8 +273,7 @@ TimeLine::goToNextKeyframe()
     ///runs only in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    _keyframes.sort();
-    std::list<SequenceTime>::iterator upperBound = std::upper_bound(_keyframes.begin(), _keyframes.end(), _currentFrame);
+    std::multiset<SequenceTime>::iterator upperBound = _keyframes.upper_bound(_currentFrame);
     if ( upperBound != _keyframes.end() ) {
         seekFrame(*upperBound, true, NULL, Natron::eTimelineChangeReasonPlaybackSeek);
     }
@@ -14,6 +14,7 @@
 #include <Python.h>
 
 #include <list>
+#include <set>
 #include "Global/Macros.h"
 CLANG_DIAG_OFF(deprecated)
 #include <QtCore/QMutex>
@@ -90,8 +91,16 @@ public:
      **/
     void removeNodeKeyframesFromTimeline(Natron::Node* node);
 
+    /**
+     * @brief Fills keys with the times where at least one keyframe is displayed, once each and in increasing order.
+     **/
     void getKeyframes(std::list<SequenceTime>* keys) const;
 
+    /**
+     * @brief Returns true if a keyframe is displayed at the given time. This is O(log n) in the number of keyframes.
+     **/
+    bool isKeyframe(SequenceTime time) const;
+
 public Q_SLOTS:
 
 
@@ -115,7 +124,8 @@ private:
     SequenceTime _currentFrame;
     
     // not MT-safe
-    std::list<SequenceTime> _keyframes;
+    ///The keyframes of all the nodes displayed on the timeline, a time appears once per keyframe at that time
+    std::multiset<SequenceTime> _keyframes;
     Natron::Project* _project;
 };
 
@@ -368,6 +368,15 @@ enum ViewerColorSpaceEnum
     eViewerColorSpaceRec709
 };
 
+///Filters of the host-side resampling of concatenated transforms, see Natron::transformImage
+enum TransformFilterEnum
+{
+    eTransformFilterBilinear = 0,
+    eTransformFilterCubic, //< cubic spline with zero derivatives at the samples, the "Cubic" filter of the transform plug-ins
+    eTransformFilterKeys, //< Catmull-Rom, the "Keys" filter of the transform plug-ins
+    eTransformFilterLanczos
+};
+
 enum ImageBitDepthEnum
 {
     eImageBitDepthNone = 0,
@@ -91,6 +91,13 @@ typedef OfxRangeD RangeD;
 
 #define kBgProcessServerCreatedShort "--bg_server_created"
 
+///these are used between a render daemon and its clients
+#define kRenderJobFailedStringLong "Render job failed: "
+#define kRenderJobFailedStringShort "-f"
+
+#define kQuitRenderDaemonStringLong "Quit render daemon"
+#define kQuitRenderDaemonStringShort "-q"
+
 
 #define kNodeGraphObjectName "nodeGraph"
 #define kCurveEditorObjectName "curveEditor"
@@ -16,6 +16,7 @@
 #include "CurveWidget.h"
 
 #include <cmath>
+#include <algorithm>
 CLANG_DIAG_OFF(unused-private-field)
 // /opt/local/include/QtGui/qmime.h:119:10: warning: private field 'type' is not used [-Wunused-private-field]
 #include <QMouseEvent>
@@ -78,6 +79,9 @@ using namespace Natron;
                                                // (in widget pixels)
 #define CURSOR_WIDTH 15
 #define CURSOR_HEIGHT 8
+#define CURVE_FLATNESS_TOLERANCE 0.5 //maximum distance between a sampled curve segment and its chord (in widget pixels)
+#define CURVE_MAX_SAMPLED_SEGMENT_WIDTH 32 //maximum width of a segment of a sampled curve (in widget pixels)
+#define CURVE_MAX_SUBDIVISION_DEPTH 8
 
 #define DERIVATIVE_ROUND_PRECISION 3.
 
@@ -262,6 +266,139 @@ std::pair<KeyFrame,bool> CurveGui::nextPointForSegment(double x1,
     return std::make_pair(KeyFrame(0.,0.),false);
 } // nextPointForSegment
 
+void
+CurveGui::computeCurveVertices(const KeyFrameSet & keyframes,
+                               bool adaptive,
+                               std::vector<float>* vertices)
+{
+    assert( !keyframes.empty() );
+    double w = _curveWidget->width();
+    double xminCurveWidgetCoord = _curveWidget->toWidgetCoordinates(keyframes.begin()->getTime(),0).x();
+    double xmaxCurveWidgetCoord = _curveWidget->toWidgetCoordinates(keyframes.rbegin()->getTime(),0).x();
+    double x1 = 0;
+    double x2;
+    std::pair<KeyFrame,bool> isX1AKey;
+    
+    while ( x1 < (w - 1) ) {
+        double x,y;
+        if (!isX1AKey.second) {
+            x = _curveWidget->toZoomCoordinates(x1,0).x();
+            y = evaluate(false,x);
+        } else {
+            x = isX1AKey.first.getTime();
+            y = isX1AKey.first.getValue();
+        }
+        vertices->push_back( (float)x );
+        vertices->push_back( (float)y );
+        
+        KeyFrameSet::const_iterator upper = keyframes.end();
+        if ( adaptive && (x1 >= xminCurveWidgetCoord) && (x1 < xmaxCurveWidgetCoord) ) {
+            upper = keyframes.upper_bound( KeyFrame(x,0.) );
+        }
+        if ( (upper == keyframes.end()) || (upper == keyframes.begin()) ) {
+            isX1AKey = nextPointForSegment(x1,&x2,keyframes);
+        } else {
+            ///we're between 2 keyframes: sample the visible part of the segment at once
+            KeyFrameSet::const_iterator lower = upper;
+            --lower;
+            double upperWidgetCoord = _curveWidget->toWidgetCoordinates(upper->getTime(),0).x();
+            if (upperWidgetCoord <= w - 1) {
+                sampleSegment(*lower, *upper, x, y, upper->getTime(), upper->getValue(), vertices);
+                x2 = upperWidgetCoord;
+                isX1AKey = std::make_pair(*upper,true);
+            } else {
+                x2 = w - 1;
+                double xEnd = _curveWidget->toZoomCoordinates(x2,0).x();
+                sampleSegment(*lower, *upper, x, y, xEnd, evaluate(false,xEnd), vertices);
+                isX1AKey = std::make_pair(KeyFrame(0.,0.),false);
+            }
+        }
+        x1 = x2;
+    }
+    //also add the last point
+    {
+        double x = _curveWidget->toZoomCoordinates(x1,0).x();
+        double y = evaluate(false,x);
+        vertices->push_back( (float)x );
+        vertices->push_back( (float)y );
+    }
+} // computeCurveVertices
+
+void
+CurveGui::sampleSegment(const KeyFrame & lower,
+                        const KeyFrame & upper,
+                        double x0,
+                        double y0,
+                        double x1,
+                        double y1,
+                        std::vector<float>* vertices) const
+{
+    if (lower.getInterpolation() == eKeyframeTypeConstant) {
+        ///the curve keeps the value of the lower keyframe up to the upper keyframe where it jumps
+        if ( x1 >= upper.getTime() ) {
+            vertices->push_back( (float)x1 );
+            vertices->push_back( (float)y0 );
+        }
+        return;
+    }
+    if ( (lower.getInterpolation() == eKeyframeTypeLinear) && (upper.getInterpolation() == eKeyframeTypeLinear) ) {
+        ///both derivatives are the slope of the segment: it is a straight line, unless it gets clamped
+        std::pair<double,double> curveYRange = getCurveYRange();
+        if ( (std::min( lower.getValue(), upper.getValue() ) >= curveYRange.first) &&
+             (std::max( lower.getValue(), upper.getValue() ) <= curveYRange.second) ) {
+            return;
+        }
+    }
+    
+    QPointF origin = _curveWidget->toWidgetCoordinates(0,0);
+    QPointF unit = _curveWidget->toWidgetCoordinates(1,1);
+    double xScale = std::abs( unit.x() - origin.x() );
+    double yScale = std::abs( unit.y() - origin.y() );
+    subdivideSegment(x0, y0, x1, y1, xScale, yScale, 0, vertices);
+}
+
+void
+CurveGui::subdivideSegment(double x0,
+                           double y0,
+                           double x1,
+                           double y1,
+                           double xScale,
+                           double yScale,
+                           int depth,
+                           std::vector<float>* vertices) const
+{
+    double widthPx = (x1 - x0) * xScale;
+    if (widthPx <= 1.) {
+        return;
+    }
+    
+    ///Compare the curve with the chord at 1/3 and 2/3 of the segment: a cubic is flat enough when both points
+    ///are within the tolerance, otherwise subdivide each third reusing the values already computed
+    double xa = x0 + (x1 - x0) / 3.;
+    double xb = x0 + 2. * (x1 - x0) / 3.;
+    double ya = evaluate(false,xa);
+    double yb = evaluate(false,xb);
+    double errA = std::abs( ya - ( y0 + (y1 - y0) / 3. ) ) * yScale;
+    double errB = std::abs( yb - ( y0 + 2. * (y1 - y0) / 3. ) ) * yScale;
+    
+    if ( (depth >= CURVE_MAX_SUBDIVISION_DEPTH) ||
+         ( (errA <= CURVE_FLATNESS_TOLERANCE) && (errB <= CURVE_FLATNESS_TOLERANCE) && (widthPx <= CURVE_MAX_SAMPLED_SEGMENT_WIDTH) ) ) {
+        vertices->push_back( (float)xa );
+        vertices->push_back( (float)ya );
+        vertices->push_back( (float)xb );
+        vertices->push_back( (float)yb );
+        return;
+    }
+    
+    subdivideSegment(x0, y0, xa, ya, xScale, yScale, depth + 1, vertices);
+    vertices->push_back( (float)xa );
+    vertices->push_back( (float)ya );
+    subdivideSegment(xa, ya, xb, yb, xScale, yScale, depth + 1, vertices);
+    vertices->push_back( (float)xb );
+    vertices->push_back( (float)yb );
+    subdivideSegment(xb, yb, x1, y1, xScale, yScale, depth + 1, vertices);
+}
+
 std::pair<double,double>
 CurveGui::getCurveYRange() const
 {
@@ -292,9 +429,7 @@ CurveGui::drawCurve(int curveIndex,
 
     assert( QGLContext::currentContext() == _curveWidget->context() );
 
-    std::vector<float> vertices,exprVertices;
-    double x1 = 0;
-    double x2;
+    std::vector<float> exprVertices;
     double w = _curveWidget->width();
     KeyFrameSet keyframes;
     BezierCPCurveGui* isBezier = dynamic_cast<BezierCPCurveGui*>(this);
@@ -308,7 +443,7 @@ CurveGui::drawCurve(int curveIndex,
         expr = knob->getExpression(isKnobCurve->getDimension());
         if (!expr.empty()) {
             //we have no choice but to evaluate the expression at each time
-            for (int i = x1; i < w; ++i) {
+            for (int i = 0; i < w; ++i) {
                 double x = _curveWidget->toZoomCoordinates(i,0).x();;
                 double y = knob->getValueAtWithExpression(x, isKnobCurve->getDimension());
                 exprVertices.push_back(x);
@@ -330,30 +465,44 @@ CurveGui::drawCurve(int curveIndex,
     }
     if (!keyframes.empty()) {
         
-        std::pair<KeyFrame,bool> isX1AKey;
-        while ( x1 < (w - 1) ) {
-            double x,y;
-            if (!isX1AKey.second) {
-                x = _curveWidget->toZoomCoordinates(x1,0).x();
-                y = evaluate(false,x);
-            } else {
-                x = isX1AKey.first.getTime();
-                y = isX1AKey.first.getValue();
-            }
-            vertices.push_back( (float)x );
-            vertices.push_back( (float)y );
-            isX1AKey = nextPointForSegment(x1,&x2,keyframes);
-            x1 = x2;
-        }
-        //also add the last point
-        {
-            double x = _curveWidget->toZoomCoordinates(x1,0).x();
-            double y = evaluate(false,x);
-            vertices.push_back( (float)x );
-            vertices.push_back( (float)y );
-        }
+        std::pair<double,double> yRange = getCurveYRange();
+        double zoomLeft,zoomBottom,zoomFactor,zoomAspectRatio;
+        _curveWidget->getProjection(&zoomLeft, &zoomBottom, &zoomFactor, &zoomAspectRatio);
+        int width = _curveWidget->width();
+        int height = _curveWidget->height();
         
+        if (!_verticesCache.valid ||
+            _verticesCache.zoomLeft != zoomLeft ||
+            _verticesCache.zoomBottom != zoomBottom ||
+            _verticesCache.zoomFactor != zoomFactor ||
+            _verticesCache.zoomAspectRatio != zoomAspectRatio ||
+            _verticesCache.width != width ||
+            _verticesCache.height != height ||
+            _verticesCache.yRange != yRange ||
+            _verticesCache.keyframes != keyframes) {
+            
+            ///Bezier curves and curves clamped to integers or booleans are made of steps that are not aligned
+            ///on the keyframes: keep sampling them at each pixel step
+            bool adaptive = !isBezier && !areKeyFramesValuesClampedToIntegers() && !areKeyFramesValuesClampedToBooleans();
+            
+            _verticesCache.vertices.clear();
+            computeCurveVertices(keyframes, adaptive, &_verticesCache.vertices);
+            _verticesCache.valid = true;
+            _verticesCache.keyframes = keyframes;
+            _verticesCache.yRange = yRange;
+            _verticesCache.zoomLeft = zoomLeft;
+            _verticesCache.zoomBottom = zoomBottom;
+            _verticesCache.zoomFactor = zoomFactor;
+            _verticesCache.zoomAspectRatio = zoomAspectRatio;
+            _verticesCache.width = width;
+            _verticesCache.height = height;
+        }
+    } else {
+        _verticesCache.valid = false;
+        _verticesCache.keyframes.clear();
+        _verticesCache.vertices.clear();
     }
+    const std::vector<float> & vertices = _verticesCache.vertices;
     
     QPointF btmLeft = _curveWidget->toZoomCoordinates(0,_curveWidget->height() - 1);
     QPointF topRight = _curveWidget->toZoomCoordinates(_curveWidget->width() - 1, 0);
@@ -17,6 +17,7 @@
 #include <Python.h>
 
 #include <set>
+#include <vector>
 
 #include "Global/GLIncludes.h" //!<must be included before QGlWidget because of gl.h and glew.h
 #include "Global/Macros.h"
@@ -154,6 +155,25 @@ private:
 
     std::pair<KeyFrame,bool> nextPointForSegment(double x1,double* x2,const KeyFrameSet & keyframes);
     
+    /**
+     * @brief Fills vertices with the polyline (x,y pairs in curve coordinates) approximating the curve on the visible part of the widget.
+     **/
+    void computeCurveVertices(const KeyFrameSet & keyframes,bool adaptive,std::vector<float>* vertices);
+    
+    /**
+     * @brief Appends to vertices the points strictly between (x0,y0) and (x1,y1) needed to draw the part of the segment
+     * going from the keyframe lower to the keyframe upper that lies in [x0,x1].
+     * Constant segments only need a step and straight linear segments need no point at all, the others are subdivided
+     * until they are flat enough.
+     **/
+    void sampleSegment(const KeyFrame & lower,const KeyFrame & upper,
+                       double x0,double y0,double x1,double y1,
+                       std::vector<float>* vertices) const;
+    
+    void subdivideSegment(double x0,double y0,double x1,double y1,
+                          double xScale,double yScale,int depth,
+                          std::vector<float>* vertices) const;
+    
 protected:
     
     boost::shared_ptr<Curve> _internalCurve; ///ptr to the internal curve
@@ -166,6 +186,34 @@ private:
     bool _visible; /// should we draw this curve ?
     bool _selected; /// is this curve selected
     const CurveWidget* _curveWidget;
+    
+    ///The polyline drawn by the last call to drawCurve along with everything it depends on, so that it is only
+    ///sampled again when the curve or the view changes
+    struct VerticesCache
+    {
+        bool valid;
+        KeyFrameSet keyframes;
+        std::pair<double,double> yRange;
+        double zoomLeft,zoomBottom,zoomFactor,zoomAspectRatio;
+        int width,height;
+        std::vector<float> vertices;
+        
+        VerticesCache()
+        : valid(false)
+        , keyframes()
+        , yRange()
+        , zoomLeft(0)
+        , zoomBottom(0)
+        , zoomFactor(0)
+        , zoomAspectRatio(0)
+        , width(0)
+        , height(0)
+        , vertices()
+        {
+        }
+    };
+    
+    VerticesCache _verticesCache;
    
 };
 
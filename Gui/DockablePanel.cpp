@@ -2232,6 +2232,13 @@ DockablePanel::focusInEvent(QFocusEvent* e)
     _imp->_undoStack->setActive();
 }
 
+void
+DockablePanel::showEvent(QShowEvent* e)
+{
+    QFrame::showEvent(e);
+    Q_EMIT shown();
+}
+
 void
 DockablePanel::onRightClickMenuRequested(const QPoint & pos)
 {
@@ -2522,6 +2529,8 @@ NodeSettingsPanel::NodeSettingsPanel(const boost::shared_ptr<MultiInstancePanel>
 
     
     QObject::connect( this,SIGNAL( closeChanged(bool) ),NodeUi.get(),SLOT( onSettingsPanelClosedChanged(bool) ) );
+    QObject::connect( this,SIGNAL( maximized() ),NodeUi.get(),SLOT( onSettingsPanelShown() ) );
+    QObject::connect( this,SIGNAL( shown() ),NodeUi.get(),SLOT( onSettingsPanelShown() ) );
     
     QPixmap pixSettings;
     appPTR->getIcon(NATRON_PIXMAP_SETTINGS,&pixSettings);
@@ -49,6 +49,7 @@ class QGridLayout;
 class RotoPanel;
 class MultiInstancePanel;
 class QTabWidget;
+class QShowEvent;
 class Group_Knob;
 
 /**
@@ -307,6 +308,9 @@ Q_SIGNALS:
     /*emitted when the panel is maximized*/
     void maximized();
 
+    /*emitted when the panel becomes visible on screen*/
+    void shown();
+
     void closeChanged(bool closed);
 
     void colorChanged(QColor);
@@ -341,6 +345,8 @@ private:
 
     virtual void focusInEvent(QFocusEvent* e) OVERRIDE FINAL;
 
+    virtual void showEvent(QShowEvent* e) OVERRIDE FINAL;
+
     QString helpString() const;
 
     boost::scoped_ptr<DockablePanelPrivate> _imp;
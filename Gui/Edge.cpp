@@ -18,6 +18,7 @@
 #include <cmath>
 #include <QPainter>
 #include <QGraphicsScene>
+#include <QStyleOptionGraphicsItem>
 
 #include "Gui/NodeGui.h"
 #include "Gui/NodeGraph.h"
@@ -616,6 +617,11 @@ Edge::paint(QPainter *painter,
     
   
     painter->drawLine(line());
+    
+    ///When zoomed out the arrow head and the bend point would be a few pixels wide: do not bother drawing them
+    if (QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() ) < NATRON_NODEGRAPH_LOW_DETAIL_ZOOM) {
+        return;
+    }
 
     myPen.setStyle(Qt::SolidLine);
     painter->setPen(myPen);
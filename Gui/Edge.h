@@ -132,6 +132,12 @@ public:
 
     void setBendPointVisible(bool visible);
 
+    ///A culled edge is fully transparent so that the scene skips it along with its label when painting
+    void setCulled(bool culled)
+    {
+        setOpacity(culled ? 0. : 1.);
+    }
+
     bool isBendPointVisible() const
     {
         return _paintBendPoint;
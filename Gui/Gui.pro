@@ -89,10 +89,13 @@ SOURCES += \
     NodeBackDropSerialization.cpp \
     NodeCreationDialog.cpp \
     NodeGraph.cpp \
+    NodeGraphBenchmark.cpp \
+    NodeGraphSpatialIndex.cpp \
     NodeGraphUndoRedo.cpp \
     NodeGui.cpp \
     NodeGuiSerialization.cpp \
     PreferencesPanel.cpp \
+    PreviewThread.cpp \
     ProjectGui.cpp \
     ProjectGuiSerialization.cpp \
     PythonPanels.cpp \
@@ -120,6 +123,7 @@ SOURCES += \
     ToolButton.cpp \
     TimeLineGui.cpp \
     TrackerGui.cpp \
+    UndoJournal.cpp \
     Utils.cpp \
     ViewerGL.cpp \
     ViewerTab.cpp \
@@ -171,10 +175,13 @@ HEADERS += \
     NodeBackDropSerialization.h \
     NodeCreationDialog.h \
     NodeGraph.h \
+    NodeGraphBenchmark.h \
+    NodeGraphSpatialIndex.h \
     NodeGraphUndoRedo.h \
     NodeGui.h \
     NodeGuiSerialization.h \
     PreferencesPanel.h \
+    PreviewThread.h \
     ProjectGui.h \
     ProjectGuiSerialization.h \
     Pyside_Gui_Python.h \
@@ -203,6 +210,7 @@ HEADERS += \
     TimeLineGui.h \
     ToolButton.h \
     TrackerGui.h \
+    UndoJournal.h \
     Utils.h \
     ViewerGL.h \
     ViewerTab.h \
@@ -14,11 +14,14 @@
 
 #include "GuiAppInstance.h"
 
+#include <iostream>
+
 
 #include <QDir>
 #include <QSettings>
 #include <QMutex>
 #include <QCoreApplication>
+#include <QtCore/QTimer>
 
 #include "Gui/GuiApplicationManager.h"
 #include "Gui/Gui.h"
@@ -28,6 +31,8 @@
 #include "Gui/ViewerTab.h"
 #include "Gui/SplashScreen.h"
 #include "Gui/ViewerGL.h"
+#include "Gui/NodeGraphBenchmark.h"
+#include "Gui/PreviewThread.h"
 
 #include "Engine/Project.h"
 #include "Engine/EffectInstance.h"
@@ -73,6 +78,10 @@ struct GuiAppInstancePrivate
     mutable QMutex userIsPaintingMutex;
     boost::shared_ptr<Natron::Node> userIsPainting;
     
+    PreviewThread previewThread;
+    
+    int nodeGraphBenchmarkNodesCount; //< see CLArgs::getNodeGraphBenchmarkNodesCount
+    
     GuiAppInstancePrivate()
     : _gui(NULL)
     , _activeBgProcesses()
@@ -88,6 +97,8 @@ struct GuiAppInstancePrivate
     , overlayRedrawRequests(0)
     , userIsPaintingMutex()
     , userIsPainting()
+    , previewThread()
+    , nodeGraphBenchmarkNodesCount(0)
     {
     }
     
@@ -148,6 +159,8 @@ GuiAppInstance::aboutToQuit()
 {
     
     deletePreviewProvider();
+    ///Node previews must not be computed while the nodes are destroyed
+    _imp->previewThread.quitThread();
     _imp->_isClosing = true;
     _imp->_gui->close();
     _imp->_gui->setParent(NULL);
@@ -158,6 +171,8 @@ GuiAppInstance::~GuiAppInstance()
     ///process events before closing gui
     QCoreApplication::processEvents();
 
+    _imp->previewThread.quitThread();
+    
     ///clear nodes prematurely so that any thread running is stopped
     getProject()->clearNodes(false);
 
@@ -214,6 +229,13 @@ GuiAppInstance::load(const CLArgs& cl)
     
     QObject::connect(getProject().get(), SIGNAL(formatChanged(Format)), this, SLOT(projectFormatChanged(Format)));
     
+    if (cl.getNodeGraphBenchmarkNodesCount() > 0) {
+        ///Skip the dialogs and the project loading: the benchmark runs once the interface is laid out, then the application quits
+        _imp->nodeGraphBenchmarkNodesCount = cl.getNodeGraphBenchmarkNodesCount();
+        QTimer::singleShot( 0, this, SLOT( runNodeGraphBenchmark() ) );
+        return;
+    }
+    
     {
         QSettings settings(NATRON_ORGANIZATION_NAME,NATRON_APPLICATION_NAME);
         if ( !settings.contains("checkForUpdates") ) {
@@ -299,6 +321,13 @@ GuiAppInstance::load(const CLArgs& cl)
 } // load
 
 
+void
+GuiAppInstance::runNodeGraphBenchmark()
+{
+    bool ok = Natron::runNodeGraphBenchmark(this, _imp->nodeGraphBenchmarkNodesCount, std::cout);
+    qApp->exit(ok ? 0 : 1);
+}
+
 bool
 GuiAppInstance::findAndTryLoadUntitledAutoSave()
 {
@@ -843,6 +872,14 @@ GuiAppInstance::getPreviewProvider() const
     return _imp->_previewProvider;
 }
 
+void
+GuiAppInstance::appendToPreviewQueue(const boost::shared_ptr<NodeGui>& node,
+                                     int time,
+                                     bool visible)
+{
+    _imp->previewThread.appendToQueue(node, time, visible);
+}
+
 void
 GuiAppInstance::projectFormatChanged(const Format& /*f*/)
 {
@@ -133,6 +133,11 @@ public:
 
 
     boost::shared_ptr<FileDialogPreviewProvider> getPreviewProvider() const;
+    
+    /**
+     * @brief Queues the computation of the preview of node in the preview thread of this application, see PreviewThread.
+     **/
+    void appendToPreviewQueue(const boost::shared_ptr<NodeGui>& node,int time,bool visible);
 
     virtual std::string openImageFileDialog() OVERRIDE FINAL;
     virtual std::string saveImageFileDialog() OVERRIDE FINAL;
@@ -176,6 +181,8 @@ public:
 
     void reloadStylesheet();
 
+    void runNodeGraphBenchmark();
+
     virtual void redrawAllViewers() OVERRIDE FINAL;
 
     void onProcessFinished();
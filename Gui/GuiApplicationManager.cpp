@@ -54,6 +54,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Gui/GuiAppInstance.h"
 #include "Gui/CurveWidget.h"
 #include "Gui/ActionShortcuts.h"
+#include "Gui/UndoJournal.h"
 CLANG_DIAG_OFF(mismatched-tags)
 GCC_DIAG_OFF(unused-parameter)
 #include "NatronGui/natrongui_python.h"
@@ -136,6 +137,8 @@ struct GuiApplicationManagerPrivate
     
     std::list<PythonUserCommand> pythonCommands;
     
+    boost::shared_ptr<UndoJournal> undoJournal;
+    
     GuiApplicationManagerPrivate(GuiApplicationManager* publicInterface)
         :   _publicInterface(publicInterface)
     , _topLevelToolButtons()
@@ -150,6 +153,7 @@ struct GuiApplicationManagerPrivate
     , _fontSize(0)
     , _nodeCB()
     , pythonCommands()
+    , undoJournal( new UndoJournal() )
     {
     }
 
@@ -2366,6 +2370,13 @@ GuiApplicationManager::getUserPythonCommands() const
 {
     return _imp->pythonCommands;
 }
+
+const boost::shared_ptr<UndoJournal>&
+GuiApplicationManager::getUndoJournal() const
+{
+    return _imp->undoJournal;
+}
+
 void
 GuiApplicationManager::reloadStylesheets()
 {
@@ -60,6 +60,7 @@ class KeyBoundAction;
 class QAction;
 class NodeSerialization;
 class NodeGuiSerialization;
+class UndoJournal;
 
 
 struct NodeClipBoard
@@ -199,6 +200,11 @@ public:
     
     const std::list<PythonUserCommand>& getUserPythonCommands() const;
     
+    /**
+     * @brief The journal holding the states remembered by the undo/redo commands of all applications.
+     **/
+    const boost::shared_ptr<UndoJournal>& getUndoJournal() const;
+    
 public Q_SLOTS:
 
 
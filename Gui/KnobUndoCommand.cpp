@@ -9,10 +9,48 @@
 
 #include "KnobUndoCommand.h"
 
+#include <sstream>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QDebug>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
 #include "Engine/Node.h"
+#include "Engine/CurveSerialization.h"
 #include "Gui/GuiApplicationManager.h"
+#include "Gui/UndoJournal.h"
+
+///Only the keyframes of the curve are remembered, see Curve::serialize
+static boost::shared_ptr<UndoRecord>
+saveCurve(const Curve & curve)
+{
+    std::ostringstream ss;
+    try {
+        boost::archive::binary_oarchive oArchive(ss);
+        oArchive << boost::serialization::make_nvp("Curve",curve);
+    } catch (const std::exception & e) {
+        qDebug() << "Failed to save an animation curve:" << e.what();
+    }
+
+    return appPTR->getUndoJournal()->createRecord( ss.str() );
+}
+
+static void
+loadCurve(const UndoRecord & record,
+          Curve* curve)
+{
+    std::istringstream ss( record.getData() );
+    try {
+        boost::archive::binary_iarchive iArchive(ss);
+        iArchive >> boost::serialization::make_nvp("Curve",*curve);
+    } catch (const std::exception & e) {
+        qDebug() << "Failed to restore an animation curve:" << e.what();
+    }
+}
 
 PasteUndoCommand::PasteUndoCommand(KnobGui* knob,
                                    bool copyAnimation,
@@ -24,16 +62,23 @@ PasteUndoCommand::PasteUndoCommand(KnobGui* knob,
       , _knob(knob)
       , newValues(values)
       , oldValues()
-      , newCurves(curves)
+      , newCurves()
       , oldCurves()
-      , newParametricCurves(parametricCurves)
+      , newParametricCurves()
       , oldParametricCurves()
       , newStringAnimation(stringAnimation)
       , oldStringAnimation()
       , _copyAnimation(copyAnimation)
 {
     assert( !appPTR->isClipBoardEmpty() );
-    assert( ( !copyAnimation && newCurves.empty() ) || copyAnimation );
+    assert( ( !copyAnimation && curves.empty() ) || copyAnimation );
+
+    for (std::list<boost::shared_ptr<Curve> >::const_iterator it = curves.begin(); it != curves.end(); ++it) {
+        newCurves.push_back( saveCurve(**it) );
+    }
+    for (std::list<boost::shared_ptr<Curve> >::const_iterator it = parametricCurves.begin(); it != parametricCurves.end(); ++it) {
+        newParametricCurves.push_back( saveCurve(**it) );
+    }
 
     boost::shared_ptr<KnobI> internalKnob = knob->getKnob();
     Knob<int>* isInt = dynamic_cast<Knob<int>*>( internalKnob.get() );
@@ -54,9 +99,10 @@ PasteUndoCommand::PasteUndoCommand(KnobGui* knob,
         } else if (isString) {
             oldValues.push_back( Variant( isString->getValue(i).c_str() ) );
         }
-        boost::shared_ptr<Curve> c(new Curve);
-        c->clone( *internalKnob->getCurve(i) );
-        oldCurves.push_back(c);
+        ///The animation is only restored by undo() if it was pasted
+        if (copyAnimation) {
+            oldCurves.push_back( saveCurve( *internalKnob->getCurve(i) ) );
+        }
     }
 
     if (isAnimatingString) {
@@ -67,9 +113,7 @@ PasteUndoCommand::PasteUndoCommand(KnobGui* knob,
         std::list< Curve > tmpCurves;
         isParametric->saveParametricCurves(&tmpCurves);
         for (std::list< Curve >::iterator it = tmpCurves.begin(); it != tmpCurves.end(); ++it) {
-            boost::shared_ptr<Curve> c(new Curve);
-            c->clone(*it);
-            oldParametricCurves.push_back(c);
+            oldParametricCurves.push_back( saveCurve(*it) );
         }
     }
 }
@@ -89,9 +133,11 @@ PasteUndoCommand::undo()
     if (_copyAnimation) {
         bool hasKeyframes = false;
         _knob->removeAllKeyframeMarkersOnTimeline(-1);
-        std::list<boost::shared_ptr<Curve> >::iterator it = oldCurves.begin();
+        std::list<boost::shared_ptr<UndoRecord> >::iterator it = oldCurves.begin();
         for (int i = 0; i < targetDimension; ++it, ++i) {
-            internalKnob->getCurve(i)->clone( *(*it) );
+            Curve c;
+            loadCurve(**it, &c);
+            internalKnob->getCurve(i)->clone(c);
             if (internalKnob->getKeyFramesCount(i) > 0) {
                 hasKeyframes = true;
             }
@@ -128,9 +174,9 @@ PasteUndoCommand::undo()
 
     if (isParametric) {
         std::list<Curve> tmpCurves;
-        for (std::list<boost::shared_ptr<Curve> >::iterator it = oldParametricCurves.begin(); it != oldParametricCurves.end(); ++it) {
+        for (std::list<boost::shared_ptr<UndoRecord> >::iterator it = oldParametricCurves.begin(); it != oldParametricCurves.end(); ++it) {
             Curve c;
-            c.clone( *(*it) );
+            loadCurve(**it, &c);
             tmpCurves.push_back(c);
         }
         isParametric->loadParametricCurves(tmpCurves);
@@ -162,13 +208,15 @@ PasteUndoCommand::redo()
     if ( !newCurves.empty() ) {
         _knob->removeAllKeyframeMarkersOnTimeline(-1);
         
-        std::list<boost::shared_ptr<Curve> >::iterator it = newCurves.begin();
+        std::list<boost::shared_ptr<UndoRecord> >::iterator it = newCurves.begin();
         for (U32 i = 0; i  < newCurves.size(); ++it, ++i) {
+            Curve newCurve;
+            loadCurve(**it, &newCurve);
             boost::shared_ptr<Curve> c = internalKnob->getCurve(i);
             if (c) {
-                c->clone( *(*it) );
+                c->clone(newCurve);
             }
-            if ( (*it)->getKeyFramesCount() > 0 ) {
+            if (newCurve.getKeyFramesCount() > 0) {
                 hasKeyframeData = true;
             }
         }
@@ -202,9 +250,9 @@ PasteUndoCommand::redo()
 
     if (isParametric) {
         std::list<Curve> tmpCurves;
-        for (std::list<boost::shared_ptr<Curve> >::iterator it = newParametricCurves.begin(); it != newParametricCurves.end(); ++it) {
+        for (std::list<boost::shared_ptr<UndoRecord> >::iterator it = newParametricCurves.begin(); it != newParametricCurves.end(); ++it) {
             Curve c;
-            c.clone( *(*it) );
+            loadCurve(**it, &c);
             tmpCurves.push_back(c);
         }
         isParametric->loadParametricCurves(tmpCurves);
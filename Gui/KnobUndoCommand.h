@@ -35,6 +35,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Gui/CurveWidget.h"
 #include "Gui/GuiAppInstance.h"
 
+class UndoRecord;
 
 //================================================================
 
@@ -273,8 +274,9 @@ class PasteUndoCommand
 {
     KnobGui* _knob;
     std::list<Variant> newValues,oldValues;
-    std::list<boost::shared_ptr<Curve> > newCurves,oldCurves;
-    std::list<boost::shared_ptr<Curve> > newParametricCurves,oldParametricCurves;
+    ///Curves are held by the undo/redo journal, old curves are only remembered when pasting the animation
+    std::list<boost::shared_ptr<UndoRecord> > newCurves,oldCurves;
+    std::list<boost::shared_ptr<UndoRecord> > newParametricCurves,oldParametricCurves;
     std::map<int,std::string> newStringAnimation,oldStringAnimation;
     bool _copyAnimation;
 
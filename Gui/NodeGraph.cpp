@@ -42,6 +42,8 @@ CLANG_DIAG_ON(unused-private-field)
 #include <QtCore/QRectF>
 #include <QRegExp>
 #include <QtCore/QTimer>
+#include <QtConcurrentRun>
+#include <QFutureWatcher>
 #include <QAction>
 #include <QPainter>
 CLANG_DIAG_OFF(deprecated)
@@ -54,6 +56,7 @@ CLANG_DIAG_ON(uninitialized)
 
 #include "Engine/AppManager.h"
 
+#include "Engine/Curve.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/ViewerInstance.h"
 #include "Engine/Hash64.h"
@@ -78,6 +81,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Gui/ViewerGL.h"
 #include "Gui/ViewerTab.h"
 #include "Gui/NodeGui.h"
+#include "Gui/NodeGraphSpatialIndex.h"
 #include "Gui/Gui.h"
 #include "Gui/TimeLineGui.h"
 #include "Gui/SequenceFileDialog.h"
@@ -98,6 +102,9 @@ CLANG_DIAG_ON(uninitialized)
 
 #define NATRON_CACHE_SIZE_TEXT_REFRESH_INTERVAL_MS 1000
 
+///During playback the knobs of the settings panels are refreshed at most at the refresh rate of the display
+#define NATRON_KNOBS_GUI_REFRESH_RATE 60
+
 
 
 #define NATRON_NODE_DUPLICATE_X_OFFSET 50
@@ -109,6 +116,13 @@ CLANG_DIAG_ON(uninitialized)
 #define NATRON_SCENE_MAX 1e6
 #define NATRON_SCENE_MIN 0
 
+///Below this zoom factor, nodes do not display their name, previews nor any indicator
+#define NATRON_NODEGRAPH_DETAILS_ZOOM 0.4
+
+///Nodes are culled against the visible portion of the graph enlarged by this fraction of its size
+///so that panning does not have to refresh the culling at each frame
+#define NATRON_NODEGRAPH_CULLING_MARGIN 0.25
+
 
 using namespace Natron;
 using std::cout; using std::endl;
@@ -130,6 +144,25 @@ enum EventStateEnum
     eEventStateSelectionRect,
 };
 
+///The value of a dimension of an animated knob at the time of a batch, see NodeGraph::onKnobsRefreshTimerTimeout
+struct KnobDimensionValue
+{
+    boost::weak_ptr<KnobI> knob; //< weak so that the worker thread never destroys a knob
+    int dimension;
+    double value;
+    bool onKeyframe;
+
+    KnobDimensionValue()
+    : knob()
+    , dimension(0)
+    , value(0.)
+    , onKeyframe(false)
+    {
+    }
+};
+
+typedef std::list<KnobDimensionValue> KnobDimensionValueList;
+
 class Navigator
     : public QGraphicsPixmapItem
 {
@@ -254,6 +287,14 @@ struct NodeGraphPrivate
     QGraphicsItem* _nodeRoot; ///< this is the parent of all nodes
     QGraphicsTextItem* _cacheSizeText;
     QTimer _refreshCacheTextTimer;
+    QTimer _knobsRefreshTimer; //< throttles the refresh of the knobs during playback
+    QFutureWatcher<KnobDimensionValueList> _knobsRefreshWatcher; //< watches the evaluation of the animated knobs of a batch
+    bool _knobsRefreshPending; //< true if the time changed during playback since the last batch
+    SequenceTime _knobsRefreshTime; //< the last time received during playback
+    SequenceTime _knobsRefreshBatchTime; //< the time of the batch being evaluated
+    std::list<boost::weak_ptr<NodeGui> > _knobsRefreshBatchNodes; //< the nodes refreshed once the batch is evaluated
+    std::set<NodeGui*> _knobsRefreshBatchPanels; //< the nodes whose panel was on screen when the batch was started
+    KnobDimensionValueList _knobsRefreshLastValues; //< the values displayed by the previous batch
     Navigator* _navigator;
     QUndoStack* _undoStack;
     QMenu* _menu;
@@ -278,6 +319,14 @@ struct NodeGraphPrivate
     bool _knobLinksVisible;
     double _accumDelta;
     bool _detailsVisible;
+    bool _lowDetail; //< true when zoomed out below NATRON_NODEGRAPH_LOW_DETAIL_ZOOM
+    
+    NodeGraphSpatialIndex _spatialIndex; //< bounding boxes of all visible nodes and their edges in the scene
+    QRectF _culledRect; //< the portion of the scene for which nodes were last culled
+    bool _cullingDirty; //< true when a node moved since the last culling
+    std::list<boost::weak_ptr<NodeGui> > _unculledNodes; //< all nodes that may not be culled, see updateCulledNodes
+    QImage _navigatorNodes; //< the nodes and edges drawn in the navigator, see renderNavigatorNodes
+    bool _navigatorNodesDirty; //< true when a node changed since _navigatorNodes was rendered
     QPointF _deltaSinceMousePress; //< mouse delta since last press
     bool _hasMovedOnce;
     
@@ -306,6 +355,14 @@ struct NodeGraphPrivate
     , _nodeRoot(NULL)
     , _cacheSizeText(NULL)
     , _refreshCacheTextTimer()
+    , _knobsRefreshTimer()
+    , _knobsRefreshWatcher()
+    , _knobsRefreshPending(false)
+    , _knobsRefreshTime(0)
+    , _knobsRefreshBatchTime(0)
+    , _knobsRefreshBatchNodes()
+    , _knobsRefreshBatchPanels()
+    , _knobsRefreshLastValues()
     , _navigator(NULL)
     , _undoStack(NULL)
     , _menu(NULL)
@@ -326,6 +383,13 @@ struct NodeGraphPrivate
     , _knobLinksVisible(true)
     , _accumDelta(0)
     , _detailsVisible(false)
+    , _lowDetail(false)
+    , _spatialIndex()
+    , _culledRect()
+    , _cullingDirty(true)
+    , _unculledNodes()
+    , _navigatorNodes()
+    , _navigatorNodesDirty(true)
     , _deltaSinceMousePress(0,0)
     , _hasMovedOnce(false)
     , lastSelectedViewer(0)
@@ -335,6 +399,28 @@ struct NodeGraphPrivate
     void resetAllClipboards();
 
     QRectF calcNodesBoundingRect();
+    
+    /**
+     * @brief Makes transparent all nodes and edges outside of a margin around visibleScene so that painting the graph
+     * does not depend on the total number of nodes. This is a no-op if no node moved and visibleScene is
+     * still within the portion that was culled last time. Only the nodes found in the spatial index and the ones
+     * that were not culled the last time are visited.
+     **/
+    void updateCulledNodes(const QRectF& visibleScene);
+    
+    /**
+     * @brief Refreshes the knobs of all nodes at the time of the batch that just finished. On the panels on screen,
+     * only the knobs whose values evaluated by the worker differ from the previous batch and the ones driven by an
+     * expression are refreshed.
+     **/
+    void applyKnobsRefreshBatch(const KnobDimensionValueList& values);
+    
+    /**
+     * @brief Draws the nodes and edges as flat shapes into _navigatorNodes which covers nodesRect and fits in
+     * a navigator of the given size. This does not go through the scene so that the culled items do not have to be
+     * made visible, and this is only done again once a node changed or the navigator was resized.
+     **/
+    void renderNavigatorNodes(const QRectF& nodesRect,int navWidth,int navHeight);
 
     void copyNodesInternal(const NodeGuiList& selection,NodeClipBoard & clipboard);
     void pasteNodesInternal(const NodeClipBoard & clipboard,const QPointF& scenPos,
@@ -456,6 +542,11 @@ NodeGraph::NodeGraph(Gui* gui,
     QObject::connect( &_imp->_refreshCacheTextTimer,SIGNAL( timeout() ),this,SLOT( updateCacheSizeText() ) );
     _imp->_refreshCacheTextTimer.start(NATRON_CACHE_SIZE_TEXT_REFRESH_INTERVAL_MS);
 
+    _imp->_knobsRefreshTimer.setSingleShot(true);
+    _imp->_knobsRefreshTimer.setInterval(1000 / NATRON_KNOBS_GUI_REFRESH_RATE);
+    QObject::connect( &_imp->_knobsRefreshTimer,SIGNAL( timeout() ),this,SLOT( onKnobsRefreshTimerTimeout() ) );
+    QObject::connect( &_imp->_knobsRefreshWatcher,SIGNAL( finished() ),this,SLOT( onKnobsRefreshBatchEvaluated() ) );
+
     _imp->_undoStack = new QUndoStack(this);
     _imp->_undoStack->setUndoLimit( appPTR->getCurrentSettings()->getMaximumUndoRedoNodeGraph() );
     _imp->_gui->registerNewUndoStack(_imp->_undoStack);
@@ -530,7 +621,11 @@ NodeGraph::~NodeGraph()
         delete _imp->_hintOutputEdge;
     }
 
+    _imp->_spatialIndex.clear();
     QObject::disconnect( &_imp->_refreshCacheTextTimer,SIGNAL( timeout() ),this,SLOT( updateCacheSizeText() ) );
+    _imp->_knobsRefreshTimer.stop();
+    QObject::disconnect( &_imp->_knobsRefreshWatcher,SIGNAL( finished() ),this,SLOT( onKnobsRefreshBatchEvaluated() ) );
+    _imp->_knobsRefreshWatcher.waitForFinished();
     _imp->_nodeCreationShortcutEnabled = false;
 
 }
@@ -590,6 +685,10 @@ NodeGraph::onNodesCleared()
     _imp->_magnifiedNode.reset();
     _imp->_nodes.clear();
     _imp->_nodesTrash.clear();
+    _imp->_spatialIndex.clear();
+    _imp->_cullingDirty = true;
+    _imp->_unculledNodes.clear();
+    _imp->_navigatorNodesDirty = true;
     _imp->_undoStack->clear();
 
 }
@@ -629,9 +728,83 @@ NodeGraph::paintEvent(QPaintEvent* e)
         updateNavigator();
         _imp->_refreshOverlays = false;
     }
+    _imp->updateCulledNodes( visibleSceneRect() );
     QGraphicsView::paintEvent(e);
 }
 
+void
+NodeGraphPrivate::updateCulledNodes(const QRectF& visibleScene)
+{
+    if ( !_cullingDirty && _culledRect.contains(visibleScene) ) {
+        return;
+    }
+    double margin = std::max( visibleScene.width(), visibleScene.height() ) * NATRON_NODEGRAPH_CULLING_MARGIN;
+    _culledRect = visibleScene.adjusted(-margin, -margin, margin, margin);
+    _cullingDirty = false;
+    
+    NodeGuiList inView;
+    _spatialIndex.getNodesOrEdgesIntersecting(_culledRect, &inView);
+    std::set<NodeGui*> inViewSet;
+    for (NodeGuiList::iterator it = inView.begin(); it != inView.end(); ++it) {
+        inViewSet.insert( it->get() );
+        (*it)->refreshCulling(_culledRect);
+    }
+    
+    ///Every node that is not culled is in _unculledNodes, hence the others do not have to be visited
+    for (std::list<boost::weak_ptr<NodeGui> >::iterator it = _unculledNodes.begin(); it != _unculledNodes.end(); ++it) {
+        NodeGuiPtr node = it->lock();
+        if ( node && ( inViewSet.find( node.get() ) == inViewSet.end() ) ) {
+            node->setCulled(true);
+        }
+    }
+    _unculledNodes.clear();
+    for (NodeGuiList::iterator it = inView.begin(); it != inView.end(); ++it) {
+        _unculledNodes.push_back(*it);
+    }
+}
+
+void
+NodeGraph::updateLevelOfDetail(double zoomFactor)
+{
+    setVisibleNodeDetails(zoomFactor >= NATRON_NODEGRAPH_DETAILS_ZOOM);
+    
+    bool lowDetail = zoomFactor < NATRON_NODEGRAPH_LOW_DETAIL_ZOOM;
+    if (lowDetail == _imp->_lowDetail) {
+        return;
+    }
+    _imp->_lowDetail = lowDetail;
+    QMutexLocker l(&_imp->_nodesMutex);
+    for (NodeGuiList::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+        (*it)->setLowDetail(lowDetail);
+    }
+}
+
+void
+NodeGraph::onNodeGeometryChanged(const boost::shared_ptr<NodeGui>& node)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    if ( node->isVisible() ) {
+        _imp->_spatialIndex.insertOrUpdate( node, node->mapRectToScene( node->boundingRect() ), node->boundingRectWithAllEdges() );
+    } else {
+        _imp->_spatialIndex.remove( node.get() );
+    }
+    _imp->_cullingDirty = true;
+    _imp->_navigatorNodesDirty = true;
+}
+
+void
+NodeGraph::getNodesIntersecting(const QRectF& sceneRect,
+                                std::list<boost::shared_ptr<NodeGui> >* nodes) const
+{
+    NodeGuiList candidates;
+    _imp->_spatialIndex.getNodesIntersecting(sceneRect, &candidates);
+    for (NodeGuiList::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        if ( (*it)->isVisible() ) {
+            nodes->push_back(*it);
+        }
+    }
+}
+
 QRectF
 NodeGraph::visibleSceneRect() const
 {
@@ -670,6 +843,12 @@ NodeGraph::createNodeGUI(const boost::shared_ptr<Natron::Node> & node,
     }
     assert(node_ui);
     node_ui->initialize(this, node);
+    onNodeGeometryChanged(node_ui);
+    ///The node is not culled yet
+    _imp->_unculledNodes.push_back(node_ui);
+    if (_imp->_lowDetail) {
+        node_ui->setLowDetail(true);
+    }
 
     if (isBd) {
         BackDropGui* bd = dynamic_cast<BackDropGui*>(node_ui.get());
@@ -2615,11 +2794,7 @@ NodeGraph::wheelEventInternal(bool ctrlDown,double delta)
     if ((newZoomfactor < 0.01 && scaleFactor < 1.) || (newZoomfactor > 50 && scaleFactor > 1.)) {
         return;
     }
-    if (newZoomfactor < 0.4) {
-        setVisibleNodeDetails(false);
-    } else if (newZoomfactor >= 0.4) {
-        setVisibleNodeDetails(true);
-    }
+    updateLevelOfDetail(newZoomfactor);
     
     if (ctrlDown && _imp->_magnifiedNode) {
         if (!_imp->_magnifOn) {
@@ -2886,30 +3061,22 @@ NodeGraph::updateNavigator()
 bool
 NodeGraph::areAllNodesVisible()
 {
-    QRectF rect = visibleSceneRect();
-    QMutexLocker l(&_imp->_nodesMutex);
+    QRectF nodesRect = _imp->calcNodesBoundingRect();
 
-    for (std::list<boost::shared_ptr<NodeGui> >::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
-        if ( (*it)->isVisible() ) {
-            if ( !rect.contains( (*it)->boundingRectWithEdges() ) ) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return nodesRect.isNull() || visibleSceneRect().contains(nodesRect);
 }
 
 QImage
 NodeGraph::getFullSceneScreenShot()
 {
     ///The bbox of all nodes in the nodegraph
-    QRectF sceneR = _imp->calcNodesBoundingRect();
+    QRectF nodesR = _imp->calcNodesBoundingRect();
 
     ///The visible portion of the nodegraph
     QRectF viewRect = visibleSceneRect();
 
     ///Make sure the visible rect is included in the scene rect
-    sceneR = sceneR.united(viewRect);
+    QRectF sceneR = nodesR.united(viewRect);
 
     int navWidth = std::ceil(width() * NATRON_NAVIGATOR_BASE_WIDTH);
     int navHeight = std::ceil(height() * NATRON_NAVIGATOR_BASE_HEIGHT);
@@ -2943,16 +3110,14 @@ NodeGraph::getFullSceneScreenShot()
     ///Paint the visible portion with a highlight
     QPainter painter(&renderImage);
 
-    ///Remove the overlays from the scene before rendering it
-    scene()->removeItem(_imp->_cacheSizeText);
-    scene()->removeItem(_imp->_navigator);
-
-    ///Render into the QImage with downscaling
-    scene()->render(&painter,renderImage.rect(),sceneR,Qt::KeepAspectRatio);
-
-    ///Add the overlays back
-    scene()->addItem(_imp->_navigator);
-    scene()->addItem(_imp->_cacheSizeText);
+    ///Draw the nodes, rendered again only if they changed, at their place in the scene rect
+    if ( !nodesR.isNull() ) {
+        _imp->renderNavigatorNodes(nodesR, navWidth, navHeight);
+        QRectF nodesR_navCoordinates( (nodesR.x() - sceneR.x()) * scaleFactor, (nodesR.y() - sceneR.y()) * scaleFactor,
+                                      nodesR.width() * scaleFactor, nodesR.height() * scaleFactor );
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(nodesR_navCoordinates, _imp->_navigatorNodes);
+    }
 
     ///Fill the highlight with a semi transparant whitish grey
     painter.fillRect( viewRect_navCoordinates, QColor(200,200,200,100) );
@@ -2994,6 +3159,65 @@ NodeGraph::getFullSceneScreenShot()
     return img;
 } // getFullSceneScreenShot
 
+void
+NodeGraphPrivate::renderNavigatorNodes(const QRectF& nodesRect,
+                                       int navWidth,
+                                       int navHeight)
+{
+    double scaleFactor = std::max( 0.001, std::min( navWidth / nodesRect.width(), navHeight / nodesRect.height() ) );
+    int w = std::max(1, (int)std::ceil(nodesRect.width() * scaleFactor));
+    int h = std::max(1, (int)std::ceil(nodesRect.height() * scaleFactor));
+    
+    if ( !_navigatorNodesDirty && (_navigatorNodes.width() == w) && (_navigatorNodes.height() == h) ) {
+        return;
+    }
+    _navigatorNodesDirty = false;
+    
+    _navigatorNodes = QImage(w, h, QImage::Format_ARGB32_Premultiplied);
+    _navigatorNodes.fill(0);
+    
+    QPainter painter(&_navigatorNodes);
+    painter.scale(scaleFactor, scaleFactor);
+    painter.translate( -nodesRect.topLeft() );
+    
+    NodeGuiList nodes;
+    {
+        QMutexLocker l(&_nodesMutex);
+        nodes = _nodes;
+    }
+    
+    ///Backdrops are below the edges and the other nodes
+    for (NodeGuiList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if ( (*it)->isVisible() && dynamic_cast<BackDropGui*>( it->get() ) ) {
+            QColor c = (*it)->getCurrentColor();
+            c.setAlpha(100);
+            painter.fillRect( (*it)->mapRectToScene( (*it)->boundingRect() ), c );
+        }
+    }
+    
+    QPen edgePen(Qt::black);
+    edgePen.setCosmetic(true);
+    painter.setPen(edgePen);
+    for (NodeGuiList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if ( !(*it)->isVisible() ) {
+            continue;
+        }
+        const std::vector<Edge*> & edges = (*it)->getInputsArrows();
+        for (std::vector<Edge*>::const_iterator it2 = edges.begin(); it2 != edges.end(); ++it2) {
+            if ( *it2 && (*it2)->isVisible() ) {
+                QLineF line = (*it2)->line();
+                painter.drawLine( (*it2)->mapToScene( line.p1() ), (*it2)->mapToScene( line.p2() ) );
+            }
+        }
+    }
+    
+    for (NodeGuiList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if ( (*it)->isVisible() && !dynamic_cast<BackDropGui*>( it->get() ) ) {
+            painter.fillRect( (*it)->mapRectToScene( (*it)->boundingRect() ), (*it)->getCurrentColor() );
+        }
+    }
+}
+
 const std::list<boost::shared_ptr<NodeGui> > &
 NodeGraph::getAllActiveNodes() const
 {
@@ -3040,21 +3264,12 @@ NodeGraph::restoreFromTrash(NodeGui* node)
         if ( (*it).get() == node ) {
             _imp->_nodes.push_back(*it);
             _imp->_nodesTrash.erase(it);
+            _imp->_cullingDirty = true;
             break;
         }
     }
 }
 
-void
-NodeGraph::refreshAllEdges()
-{
-    QMutexLocker l(&_imp->_nodesMutex);
-
-    for (std::list<boost::shared_ptr<NodeGui> >::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
-        (*it)->refreshEdges();
-    }
-}
-
 // grabbed from QDirModelPrivate::size() in qtbase/src/widgets/itemviews/qdirmodel.cpp
 static
 QString
@@ -3101,16 +3316,8 @@ NodeGraph::updateCacheSizeText()
 QRectF
 NodeGraphPrivate::calcNodesBoundingRect()
 {
-    QRectF ret;
-    QMutexLocker l(&_nodesMutex);
-
-    for (std::list<boost::shared_ptr<NodeGui> >::iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
-        if ( (*it)->isVisible() ) {
-            ret = ret.united( (*it)->boundingRectWithEdges() );
-        }
-    }
- 
-    return ret;
+    ///The spatial index only holds the visible nodes
+    return _spatialIndex.getBoundingRect();
 }
 
 void
@@ -3929,6 +4136,8 @@ NodeGraph::deleteNodepluginsly(boost::shared_ptr<NodeGui> n)
             _imp->_nodes.erase(it);
         }
     }
+    _imp->_spatialIndex.remove( n.get() );
+    _imp->_navigatorNodesDirty = true;
 
 
     n->deleteReferences();
@@ -4060,11 +4269,7 @@ NodeGraph::centerOnAllNodes()
     }
     
     currentZoomFactor = transform().mapRect( QRectF(0, 0, 1, 1) ).width();
-    if (currentZoomFactor < 0.4) {
-        setVisibleNodeDetails(false);
-    } else if (currentZoomFactor >= 0.4) {
-        setVisibleNodeDetails(true);
-    }
+    updateLevelOfDetail(currentZoomFactor);
 
     _imp->_refreshOverlays = true;
     update();
@@ -4138,6 +4343,8 @@ NodeGraph::refreshNodesKnobsAtTime(SequenceTime time)
     for (std::list<boost::shared_ptr<NodeGui> >::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
         (*it)->refreshKnobsAfterTimeChange(time);
     }
+    ///The next batch cannot rely on the values displayed by the previous one anymore
+    _imp->_knobsRefreshLastValues.clear();
 }
 
 
@@ -4152,13 +4359,24 @@ NodeGraph::onTimeChanged(SequenceTime time,
     }
     boost::shared_ptr<Natron::Project> project = _imp->_gui->getApp()->getProject();
 
-    ///Refresh all knobs at the current time
     for (std::list<boost::shared_ptr<NodeGui> >::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
         ViewerInstance* isViewer = dynamic_cast<ViewerInstance*>( (*it)->getNode()->getLiveInstance() );
         if (isViewer) {
             viewers.push_back(isViewer);
         }
-        (*it)->refreshKnobsAfterTimeChange(time);
+    }
+
+    if (reason == eTimelineChangeReasonPlaybackSeek) {
+        ///During playback, refresh the knobs in batches so that it does not compete with the viewer at each frame
+        _imp->_knobsRefreshTime = time;
+        _imp->_knobsRefreshPending = true;
+        if ( !_imp->_knobsRefreshTimer.isActive() && !_imp->_knobsRefreshWatcher.isRunning() ) {
+            _imp->_knobsRefreshTimer.start();
+        }
+    } else {
+        ///Refresh all knobs at the current time
+        _imp->_knobsRefreshPending = false;
+        refreshNodesKnobsAtTime(time);
     }
     
     ViewerInstance* leadViewer = getGui()->getApp()->getLastViewerUsingTimeline();
@@ -4171,6 +4389,139 @@ NodeGraph::onTimeChanged(SequenceTime time,
     }
 }
 
+///Evaluates the curves of the knobs at time on a worker thread. Knobs that were destroyed in the meantime are dropped.
+static KnobDimensionValueList
+evaluateKnobsAtTime(KnobDimensionValueList knobs,
+                    SequenceTime time)
+{
+    for (KnobDimensionValueList::iterator it = knobs.begin(); it != knobs.end();) {
+        boost::shared_ptr<KnobI> knob = it->knob.lock();
+        if (!knob) {
+            it = knobs.erase(it);
+            continue;
+        }
+        it->value = knob->getRawCurveValueAt(time, it->dimension);
+        KeyFrame k;
+        it->onKeyframe = knob->getCurve(it->dimension)->getKeyFrameWithTime(time, &k);
+        ++it;
+    }
+
+    return knobs;
+}
+
+void
+NodeGraph::onKnobsRefreshTimerTimeout()
+{
+    if ( !_imp->_knobsRefreshPending || _imp->_knobsRefreshWatcher.isRunning() ) {
+        return;
+    }
+    _imp->_knobsRefreshPending = false;
+    _imp->_knobsRefreshBatchTime = _imp->_knobsRefreshTime;
+    _imp->_knobsRefreshBatchNodes.clear();
+    _imp->_knobsRefreshBatchPanels.clear();
+
+    ///Only the panels on screen are evaluated, the others are refreshed when they are shown again.
+    ///Knobs driven by an expression are left to the main thread so that Python is not run from the worker.
+    KnobDimensionValueList knobs;
+    for (std::list<boost::shared_ptr<NodeGui> >::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+        _imp->_knobsRefreshBatchNodes.push_back(*it);
+        if ( !(*it)->isSettingsPanelShownOnScreen() ) {
+            continue;
+        }
+        _imp->_knobsRefreshBatchPanels.insert( it->get() );
+        const std::vector<boost::shared_ptr<KnobI> > & nodeKnobs = (*it)->getNode()->getKnobs();
+        for (std::vector<boost::shared_ptr<KnobI> >::const_iterator it2 = nodeKnobs.begin(); it2 != nodeKnobs.end(); ++it2) {
+            if ( (*it2)->getIsSecret() ) {
+                continue;
+            }
+            for (int i = 0; i < (*it2)->getDimension(); ++i) {
+                if ( (*it2)->isAnimated(i) && (*it2)->getExpression(i).empty() ) {
+                    KnobDimensionValue v;
+                    v.knob = *it2;
+                    v.dimension = i;
+                    knobs.push_back(v);
+                }
+            }
+        }
+    }
+
+    if ( knobs.empty() ) {
+        _imp->applyKnobsRefreshBatch( KnobDimensionValueList() );
+    } else {
+        _imp->_knobsRefreshWatcher.setFuture( QtConcurrent::run(evaluateKnobsAtTime, knobs, _imp->_knobsRefreshBatchTime) );
+    }
+}
+
+void
+NodeGraph::onKnobsRefreshBatchEvaluated()
+{
+    _imp->applyKnobsRefreshBatch( _imp->_knobsRefreshWatcher.result() );
+}
+
+void
+NodeGraphPrivate::applyKnobsRefreshBatch(const KnobDimensionValueList& values)
+{
+    SequenceTime time = _knobsRefreshBatchTime;
+
+    ///Only the knobs whose value or animation level changed since the previous batch need their widgets refreshed
+    std::map<std::pair<KnobI*,int>,double> lastValues;
+    for (KnobDimensionValueList::iterator it = _knobsRefreshLastValues.begin(); it != _knobsRefreshLastValues.end(); ++it) {
+        boost::shared_ptr<KnobI> knob = it->knob.lock();
+        if (knob) {
+            lastValues[std::make_pair(knob.get(), it->dimension)] = it->value;
+        }
+    }
+    std::set<KnobI*> changedKnobs;
+    for (KnobDimensionValueList::const_iterator it = values.begin(); it != values.end(); ++it) {
+        boost::shared_ptr<KnobI> knob = it->knob.lock();
+        if (!knob) {
+            continue;
+        }
+        std::map<std::pair<KnobI*,int>,double>::iterator found = lastValues.find( std::make_pair(knob.get(), it->dimension) );
+        Natron::AnimationLevelEnum level = it->onKeyframe ? Natron::eAnimationLevelOnKeyframe : Natron::eAnimationLevelInterpolatedValue;
+        if ( ( found == lastValues.end() ) || (found->second != it->value) || (knob->getAnimationLevel(it->dimension) != level) ) {
+            changedKnobs.insert( knob.get() );
+        }
+    }
+    _knobsRefreshLastValues = values;
+
+    ///Apply the values to the widgets of all panels in a single pass
+    std::list<boost::weak_ptr<NodeGui> > nodes;
+    nodes.swap(_knobsRefreshBatchNodes);
+    bool guiFrozen = _gui && _gui->getApp()->isGuiFrozen();
+    for (std::list<boost::weak_ptr<NodeGui> >::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        boost::shared_ptr<NodeGui> node = it->lock();
+        if (!node) {
+            continue;
+        }
+        if ( ( _knobsRefreshBatchPanels.find( node.get() ) == _knobsRefreshBatchPanels.end() ) ||
+             !node->isSettingsPanelShownOnScreen() ) {
+            node->refreshKnobsAfterTimeChange(time);
+            continue;
+        }
+        if (guiFrozen) {
+            continue;
+        }
+        const std::vector<boost::shared_ptr<KnobI> > & nodeKnobs = node->getNode()->getKnobs();
+        for (std::vector<boost::shared_ptr<KnobI> >::const_iterator it2 = nodeKnobs.begin(); it2 != nodeKnobs.end(); ++it2) {
+            if ( (*it2)->getIsSecret() ) {
+                continue;
+            }
+            bool refresh = changedKnobs.find( it2->get() ) != changedKnobs.end();
+            for (int i = 0; !refresh && i < (*it2)->getDimension(); ++i) {
+                refresh = !(*it2)->getExpression(i).empty();
+            }
+            if (refresh) {
+                (*it2)->onTimeChanged(time);
+            }
+        }
+    }
+    _knobsRefreshBatchPanels.clear();
+    if (_knobsRefreshPending) {
+        _knobsRefreshTimer.start();
+    }
+}
+
 void
 NodeGraph::onGuiFrozenChanged(bool frozen)
 {
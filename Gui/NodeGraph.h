@@ -34,6 +34,9 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/ScriptObject.h"
 #include "Global/GlobalDefines.h"
 
+///Below this zoom factor, nodes are drawn as flat shapes without texts nor previews and edges as plain lines
+#define NATRON_NODEGRAPH_LOW_DETAIL_ZOOM 0.2
+
 class QVBoxLayout;
 class QScrollArea;
 class QEvent;
@@ -107,7 +110,17 @@ public:
     void discardGuiPointer();
     void discardScenePointer();
 
-    void refreshAllEdges();
+    /**
+     * @brief Called by a node whenever its bounding box or one of its edges in the scene changed, or when it was shown
+     * or hidden, to keep the spatial index used to cull nodes and edges out of the visible portion of the graph up to date.
+     **/
+    void onNodeGeometryChanged(const boost::shared_ptr<NodeGui>& node);
+    
+    /**
+     * @brief Appends to nodes all visible nodes whose bounding box intersects sceneRect, without
+     * going through all nodes of the graph.
+     **/
+    void getNodesIntersecting(const QRectF& sceneRect,std::list<boost::shared_ptr<NodeGui> >* nodes) const;
 
     /**
      * @brief Removes the given node from the nodegraph, using the undo/redo stack.
@@ -215,6 +228,10 @@ public Q_SLOTS:
     
     ///Called whenever the time changes on the timeline
     void onTimeChanged(SequenceTime time,int reason);
+
+    void onKnobsRefreshTimerTimeout();
+
+    void onKnobsRefreshBatchEvaluated();
     
     void onGuiFrozenChanged(bool frozen);
 
@@ -243,6 +260,12 @@ private:
 
     void setVisibleNodeDetails(bool visible);
     
+    /**
+     * @brief Shows or hides the details of the nodes according to the zoom factor. This only goes through
+     * the nodes when a threshold is crossed.
+     **/
+    void updateLevelOfDetail(double zoomFactor);
+    
     virtual void enterEvent(QEvent* e) OVERRIDE FINAL;
     virtual void leaveEvent(QEvent* e) OVERRIDE FINAL;
     virtual void keyPressEvent(QKeyEvent* e) OVERRIDE FINAL;
@@ -0,0 +1,209 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "NodeGraphBenchmark.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <list>
+#include <vector>
+
+#include "Global/Macros.h"
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QThread>
+#include <QCoreApplication>
+#include <QImage>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Global/GlobalDefines.h"
+#include "Global/MemoryInfo.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
+#include "Engine/Project.h"
+#include "Engine/Timer.h"
+
+#include "Gui/Gui.h"
+#include "Gui/GuiAppInstance.h"
+#include "Gui/NodeGraph.h"
+#include "Gui/NodeGui.h"
+
+///Number of connected nodes in each column of the graph
+#define NODEGRAPH_BENCHMARK_CHAIN_LENGTH 50
+
+///Distance between 2 columns and between 2 nodes of a column, in scene coordinates
+#define NODEGRAPH_BENCHMARK_SPACING_X 200
+#define NODEGRAPH_BENCHMARK_SPACING_Y 100
+
+///Number of frames painted for each measure
+#define NODEGRAPH_BENCHMARK_FRAMES 50
+
+using namespace Natron;
+
+namespace {
+
+/**
+ * @brief Paints the visible portion of the graph NODEGRAPH_BENCHMARK_FRAMES times, calling step before each frame,
+ * and returns the number of frames per second.
+ **/
+template <typename STEP>
+static double
+measureFramesPerSecond(NodeGraph* graph,
+                       QImage* image,
+                       STEP step)
+{
+    TimeLapse timer;
+    for (int i = 0; i < NODEGRAPH_BENCHMARK_FRAMES; ++i) {
+        step(i);
+        ///Go through the paint event of the view so that the culling and the overlays are refreshed as on screen
+        graph->viewport()->render(image);
+    }
+    double elapsed = timer.getTimeElapsedReset();
+
+    return elapsed > 0. ? NODEGRAPH_BENCHMARK_FRAMES / elapsed : 0.;
+}
+
+struct NoStep
+{
+    void operator()(int /*frame*/) const
+    {
+    }
+};
+
+struct PanStep
+{
+    NodeGraph* graph;
+    QRectF bbox;
+
+    ///Sweeps the center of the view along the diagonal of the graph
+    void operator()(int frame) const
+    {
+        double t = frame / (double)(NODEGRAPH_BENCHMARK_FRAMES - 1);
+        graph->centerOn( bbox.left() + t * bbox.width(), bbox.top() + t * bbox.height() );
+    }
+};
+
+struct MoveStep
+{
+    const std::list<boost::shared_ptr<NodeGui> >* nodes;
+
+    ///Moves the nodes to the right as a drag in the node-graph would
+    void operator()(int /*frame*/) const
+    {
+        for (std::list<boost::shared_ptr<NodeGui> >::const_iterator it = nodes->begin(); it != nodes->end(); ++it) {
+            QPointF pos = (*it)->pos();
+            (*it)->refreshPosition(pos.x() + 5., pos.y(), true);
+        }
+    }
+};
+
+} // anon namespace
+
+bool
+Natron::runNodeGraphBenchmark(GuiAppInstance* app,
+                              int nodesCount,
+                              std::ostream& os)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    assert(nodesCount > 0);
+
+    NodeGraph* graph = app->getGui()->getNodeGraph();
+    assert(graph);
+    boost::shared_ptr<Project> project = app->getProject();
+
+    ///Build the graph
+    TimeLapse timer;
+    std::vector<boost::shared_ptr<NodeGui> > nodeGuis;
+    nodeGuis.reserve(nodesCount);
+    boost::shared_ptr<Node> previous;
+    for (int i = 0; i < nodesCount; ++i) {
+        int column = i / NODEGRAPH_BENCHMARK_CHAIN_LENGTH;
+        int row = i % NODEGRAPH_BENCHMARK_CHAIN_LENGTH;
+        boost::shared_ptr<Node> node = app->createNode( CreateNodeArgs(PLUGINID_NATRON_DISKCACHE,
+                                                                       "",
+                                                                       -1,-1,false,
+                                                                       column * NODEGRAPH_BENCHMARK_SPACING_X,
+                                                                       row * NODEGRAPH_BENCHMARK_SPACING_Y,
+                                                                       false,true,false,
+                                                                       QString(),CreateNodeArgs::DefaultValuesList(),
+                                                                       project) );
+        boost::shared_ptr<NodeGui> nodeGui;
+        if (node) {
+            nodeGui = boost::dynamic_pointer_cast<NodeGui>( node->getNodeGui() );
+        }
+        if (!nodeGui) {
+            std::fprintf(stderr, "%s\n", QObject::tr("Could not build the benchmark graph").toStdString().c_str());
+            return false;
+        }
+        if ( (row > 0) && previous ) {
+            NodeCollection::connectNodes(0, previous, node.get(), true);
+        }
+        nodeGuis.push_back(nodeGui);
+        previous = node;
+    }
+    QCoreApplication::processEvents();
+    double buildTime = timer.getTimeElapsedReset();
+
+    QSize viewSize = graph->viewport()->size();
+    if ( viewSize.isEmpty() ) {
+        std::fprintf(stderr, "%s\n", QObject::tr("The node-graph is not visible").toStdString().c_str());
+        return false;
+    }
+    QImage image(viewSize, QImage::Format_ARGB32_Premultiplied);
+
+    ///Zoomed out on the whole graph
+    graph->clearSelection();
+    graph->centerOnAllNodes();
+    double zoomedOutFps = measureFramesPerSecond( graph, &image, NoStep() );
+
+    ///At 100%: centering on a single node zooms to 1 at most
+    std::list<boost::shared_ptr<NodeGui> > selection;
+    selection.push_back( nodeGuis.front() );
+    graph->setSelection(selection);
+    graph->centerOnAllNodes();
+    graph->clearSelection();
+    PanStep pan;
+    pan.graph = graph;
+    pan.bbox = QRectF(0, 0,
+                      ( (nodesCount - 1) / NODEGRAPH_BENCHMARK_CHAIN_LENGTH ) * NODEGRAPH_BENCHMARK_SPACING_X,
+                      std::min(nodesCount - 1, NODEGRAPH_BENCHMARK_CHAIN_LENGTH - 1) * NODEGRAPH_BENCHMARK_SPACING_Y);
+    double panFps = measureFramesPerSecond(graph, &image, pan);
+
+    ///Drag the first column of nodes in view
+    std::list<boost::shared_ptr<NodeGui> > column;
+    for (int i = 0; i < std::min(nodesCount, NODEGRAPH_BENCHMARK_CHAIN_LENGTH); ++i) {
+        column.push_back(nodeGuis[i]);
+    }
+    graph->centerOn( nodeGuis.front().get() );
+    MoveStep move;
+    move.nodes = &column;
+    double moveFps = measureFramesPerSecond(graph, &image, move);
+
+    ///Report
+    os.precision(9);
+    os << "{\n";
+    os << "  \"version\": \"" << NATRON_VERSION_STRING << "\",\n";
+    os << "  \"nodes\": " << nodesCount << ",\n";
+    os << "  \"viewWidth\": " << viewSize.width() << ",\n";
+    os << "  \"viewHeight\": " << viewSize.height() << ",\n";
+    os << "  \"buildSeconds\": " << buildTime << ",\n";
+    os << "  \"zoomedOutFramesPerSecond\": " << zoomedOutFps << ",\n";
+    os << "  \"panFramesPerSecond\": " << panFps << ",\n";
+    os << "  \"moveFramesPerSecond\": " << moveFps << ",\n";
+    os << "  \"peakRSS\": " << (U64)getPeakRSS() << "\n";
+    os << "}\n";
+    os.flush();
+
+    return true;
+}
@@ -0,0 +1,34 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_GUI_NODEGRAPHBENCHMARK_H_
+#define NATRON_GUI_NODEGRAPHBENCHMARK_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <ostream>
+
+class GuiAppInstance;
+
+namespace Natron {
+
+/**
+ * @brief Builds a synthetic graph of nodesCount nodes in the project of app, laid out in columns of connected chains,
+ * and measures the node-graph of its interface: the time to build the graph, then the frames per second when repainting
+ * the whole graph zoomed out, when panning across it at 100% and when dragging a column of nodes.
+ * The frames are painted offscreen into an image with the size of the node-graph.
+ * The results are written as JSON to os. Must be called on the main thread once the interface is shown.
+ * Returns false if the graph could not be built, an error being printed on the standard error.
+ **/
+bool runNodeGraphBenchmark(GuiAppInstance* app,
+                           int nodesCount,
+                           std::ostream& os);
+
+}
+
+#endif // NATRON_GUI_NODEGRAPHBENCHMARK_H_
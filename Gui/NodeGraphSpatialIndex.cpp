@@ -0,0 +1,232 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "NodeGraphSpatialIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <set>
+
+///Size of a cell of the grid in scene coordinates: a few nodes wide so that a node overlaps 1 to 4 cells
+#define NATRON_NODEGRAPH_SPATIAL_INDEX_CELL_SIZE 512.
+
+///Cells coordinates are clamped so that huge rectangles do not overflow
+#define NATRON_NODEGRAPH_SPATIAL_INDEX_MAX_CELL (1 << 20)
+
+static int
+cellCoord(double x)
+{
+    double c = std::floor(x / NATRON_NODEGRAPH_SPATIAL_INDEX_CELL_SIZE);
+    c = std::max( (double)-NATRON_NODEGRAPH_SPATIAL_INDEX_MAX_CELL, std::min( (double)NATRON_NODEGRAPH_SPATIAL_INDEX_MAX_CELL, c ) );
+
+    return (int)c;
+}
+
+NodeGraphSpatialIndex::NodeGraphSpatialIndex()
+: _entries()
+, _cells()
+, _boundingRect()
+, _boundingRectDirty(false)
+{
+}
+
+NodeGraphSpatialIndex::~NodeGraphSpatialIndex()
+{
+}
+
+NodeGraphSpatialIndex::CellRange
+NodeGraphSpatialIndex::getCellRange(const QRectF& rect) const
+{
+    CellRange ret;
+    if ( !rect.isValid() ) {
+        return ret;
+    }
+    ret.x1 = cellCoord( rect.left() );
+    ret.x2 = cellCoord( rect.right() );
+    ret.y1 = cellCoord( rect.top() );
+    ret.y2 = cellCoord( rect.bottom() );
+
+    return ret;
+}
+
+void
+NodeGraphSpatialIndex::addToCells(const NodeGui* node,
+                                  const CellRange& range)
+{
+    for (int y = range.y1; y <= range.y2; ++y) {
+        for (int x = range.x1; x <= range.x2; ++x) {
+            _cells[std::make_pair(x,y)].push_back(node);
+        }
+    }
+}
+
+void
+NodeGraphSpatialIndex::removeFromCells(const NodeGui* node,
+                                       const CellRange& range)
+{
+    for (int y = range.y1; y <= range.y2; ++y) {
+        for (int x = range.x1; x <= range.x2; ++x) {
+            Cells::iterator found = _cells.find( std::make_pair(x,y) );
+            if ( found == _cells.end() ) {
+                continue;
+            }
+            std::vector<const NodeGui*>::iterator it = std::find(found->second.begin(), found->second.end(), node);
+            if ( it != found->second.end() ) {
+                ///the order within a cell does not matter
+                *it = found->second.back();
+                found->second.pop_back();
+            }
+            if ( found->second.empty() ) {
+                _cells.erase(found);
+            }
+        }
+    }
+}
+
+void
+NodeGraphSpatialIndex::onExtentRemoved(const QRectF& extent)
+{
+    if (_boundingRectDirty) {
+        return;
+    }
+    if ( (extent.left() <= _boundingRect.left()) || (extent.right() >= _boundingRect.right()) ||
+         (extent.top() <= _boundingRect.top()) || (extent.bottom() >= _boundingRect.bottom()) ) {
+        _boundingRectDirty = true;
+    }
+}
+
+void
+NodeGraphSpatialIndex::insertOrUpdate(const boost::shared_ptr<NodeGui>& node,
+                                      const QRectF& sceneRect,
+                                      const QRectF& sceneExtent)
+{
+    CellRange range = getCellRange(sceneExtent);
+    Entries::iterator found = _entries.find( node.get() );
+    if ( found != _entries.end() ) {
+        onExtentRemoved(found->second.extent);
+    }
+    if (!_boundingRectDirty) {
+        _boundingRect = _boundingRect.united(sceneExtent);
+    }
+    if ( found != _entries.end() ) {
+        found->second.rect = sceneRect;
+        found->second.extent = sceneExtent;
+        const CellRange& old = found->second.cells;
+        if ( (old.x1 == range.x1) && (old.x2 == range.x2) && (old.y1 == range.y1) && (old.y2 == range.y2) ) {
+            ///The node moved within the same cells, which is the common case while dragging
+            return;
+        }
+        removeFromCells(node.get(), old);
+        found->second.cells = range;
+    } else {
+        Entry e;
+        e.node = node;
+        e.rect = sceneRect;
+        e.extent = sceneExtent;
+        e.cells = range;
+        _entries.insert( std::make_pair(node.get(), e) );
+    }
+    addToCells(node.get(), range);
+}
+
+void
+NodeGraphSpatialIndex::remove(const NodeGui* node)
+{
+    Entries::iterator found = _entries.find(node);
+    if ( found == _entries.end() ) {
+        return;
+    }
+    removeFromCells(node, found->second.cells);
+    onExtentRemoved(found->second.extent);
+    _entries.erase(found);
+}
+
+void
+NodeGraphSpatialIndex::clear()
+{
+    _entries.clear();
+    _cells.clear();
+    _boundingRect = QRectF();
+    _boundingRectDirty = false;
+}
+
+QRectF
+NodeGraphSpatialIndex::getBoundingRect() const
+{
+    if (_boundingRectDirty) {
+        _boundingRect = QRectF();
+        for (Entries::const_iterator it = _entries.begin(); it != _entries.end(); ++it) {
+            _boundingRect = _boundingRect.united(it->second.extent);
+        }
+        _boundingRectDirty = false;
+    }
+
+    return _boundingRect;
+}
+
+void
+NodeGraphSpatialIndex::getNodesIntersecting(const QRectF& sceneRect,
+                                            std::list<boost::shared_ptr<NodeGui> >* nodes) const
+{
+    getNodesIntersectingInternal(sceneRect, false, nodes);
+}
+
+void
+NodeGraphSpatialIndex::getNodesOrEdgesIntersecting(const QRectF& sceneRect,
+                                                   std::list<boost::shared_ptr<NodeGui> >* nodes) const
+{
+    getNodesIntersectingInternal(sceneRect, true, nodes);
+}
+
+void
+NodeGraphSpatialIndex::getNodesIntersectingInternal(const QRectF& sceneRect,
+                                                    bool withEdges,
+                                                    std::list<boost::shared_ptr<NodeGui> >* nodes) const
+{
+    CellRange range = getCellRange(sceneRect);
+    if ( (range.x2 < range.x1) || (range.y2 < range.y1) ) {
+        return;
+    }
+
+    std::set<const NodeGui*> candidates;
+    double nCellsInRange = (double)(range.x2 - range.x1 + 1) * (double)(range.y2 - range.y1 + 1);
+    if ( nCellsInRange > (double)_cells.size() ) {
+        ///When zoomed out the rectangle covers more cells than there are non-empty ones
+        for (Cells::const_iterator it = _cells.begin(); it != _cells.end(); ++it) {
+            if ( (it->first.first >= range.x1) && (it->first.first <= range.x2) &&
+                 (it->first.second >= range.y1) && (it->first.second <= range.y2) ) {
+                candidates.insert( it->second.begin(), it->second.end() );
+            }
+        }
+    } else {
+        for (int y = range.y1; y <= range.y2; ++y) {
+            for (int x = range.x1; x <= range.x2; ++x) {
+                Cells::const_iterator found = _cells.find( std::make_pair(x,y) );
+                if ( found != _cells.end() ) {
+                    candidates.insert( found->second.begin(), found->second.end() );
+                }
+            }
+        }
+    }
+
+    for (std::set<const NodeGui*>::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        Entries::const_iterator found = _entries.find(*it);
+        assert( found != _entries.end() );
+        const QRectF& rect = withEdges ? found->second.extent : found->second.rect;
+        if ( !rect.intersects(sceneRect) ) {
+            continue;
+        }
+        boost::shared_ptr<NodeGui> node = found->second.node.lock();
+        if (node) {
+            nodes->push_back(node);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_GUI_NODEGRAPHSPATIALINDEX_H_
+#define NATRON_GUI_NODEGRAPHSPATIALINDEX_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "Global/Macros.h"
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QRectF>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#endif
+
+class NodeGui;
+
+/**
+ * @brief A uniform grid over the scene of a NodeGraph giving the nodes intersecting a rectangle without
+ * going through all the nodes of the graph. Each node is registered in every cell its extent overlaps, that is
+ * its bounding box united with the edges it owns (its input edges and its output edge) so that edges are
+ * found through the node they belong to.
+ * The index only holds weak references: a node that was destroyed without being removed is skipped by the queries.
+ * This is only used from the main thread.
+ **/
+class NodeGraphSpatialIndex
+{
+public:
+
+    NodeGraphSpatialIndex();
+
+    ~NodeGraphSpatialIndex();
+
+    /**
+     * @brief Registers node with the given bounding box and extent in scene coordinates, or moves it there if it was
+     * already in the index. The extent must contain the bounding box.
+     **/
+    void insertOrUpdate(const boost::shared_ptr<NodeGui>& node,const QRectF& sceneRect,const QRectF& sceneExtent);
+
+    void remove(const NodeGui* node);
+
+    void clear();
+
+    /**
+     * @brief Appends to nodes every node whose bounding box intersects sceneRect, once each and in no particular order.
+     **/
+    void getNodesIntersecting(const QRectF& sceneRect,std::list<boost::shared_ptr<NodeGui> >* nodes) const;
+
+    /**
+     * @brief Same as getNodesIntersecting but also appends the nodes out of sceneRect that own an edge intersecting it.
+     **/
+    void getNodesOrEdgesIntersecting(const QRectF& sceneRect,std::list<boost::shared_ptr<NodeGui> >* nodes) const;
+
+    /**
+     * @brief Returns the union of the extents of all nodes in the index. It is only recomputed from all the nodes when
+     * a node on the border of the previous union moved or was removed.
+     **/
+    QRectF getBoundingRect() const;
+
+    std::size_t size() const
+    {
+        return _entries.size();
+    }
+
+private:
+
+    struct CellRange
+    {
+        int x1,y1,x2,y2; //< inclusive
+
+        CellRange()
+        : x1(0), y1(0), x2(-1), y2(-1)
+        {
+        }
+    };
+
+    struct Entry
+    {
+        boost::weak_ptr<NodeGui> node;
+        QRectF rect;
+        QRectF extent;
+        CellRange cells; //< the cells overlapped by extent
+    };
+
+    typedef std::map<const NodeGui*,Entry> Entries;
+    typedef std::map<std::pair<int,int>,std::vector<const NodeGui*> > Cells;
+
+    CellRange getCellRange(const QRectF& rect) const;
+
+    void addToCells(const NodeGui* node,const CellRange& range);
+
+    void removeFromCells(const NodeGui* node,const CellRange& range);
+
+    void getNodesIntersectingInternal(const QRectF& sceneRect,bool withEdges,std::list<boost::shared_ptr<NodeGui> >* nodes) const;
+
+    /**
+     * @brief Marks the bounding rect as needing a full recompute if extent was not strictly inside of it.
+     **/
+    void onExtentRemoved(const QRectF& extent);
+
+    Entries _entries;
+    Cells _cells; //< only non-empty cells are stored
+    mutable QRectF _boundingRect; //< see getBoundingRect
+    mutable bool _boundingRectDirty;
+};
+
+#endif // NATRON_GUI_NODEGRAPHSPATIALINDEX_H_
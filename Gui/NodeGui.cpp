@@ -21,7 +21,6 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QLayout>
 #include <QAction>
-#include <QtConcurrentRun>
 #include <QFontMetrics>
 #include <QTextBlockFormat>
 #include <QTextCursor>
@@ -222,6 +221,9 @@ NodeGui::NodeGui(QGraphicsItem *parent)
 , _parentMultiInstance()
 , _renderingStartedCount(0)
 , _optionalInputsVisible(false)
+, _lowDetail(false)
+, _culled(false)
+, _knobsRefreshPending(false)
 , _mtSafeSizeMutex()
 , _mtSafeWidth(0)
 , _mtSafeHeight(0)
@@ -273,6 +275,7 @@ NodeGui::initialize(NodeGraph* dag,
     QObject::connect( internalNode.get(), SIGNAL( nodeExtraLabelChanged(QString) ),this,SLOT( onNodeExtraLabelChanged(QString) ) );
 
     setCacheMode(DeviceCoordinateCache);
+    setFlag(ItemSendsGeometryChanges);
     
     OutputEffectInstance* isOutput = dynamic_cast<OutputEffectInstance*>(internalNode->getLiveInstance());
     if (isOutput) {
@@ -672,7 +675,9 @@ NodeGui::ensurePreviewCreated()
         QPixmap prev_pixmap = QPixmap::fromImage(prev);
         _previewPixmap = new QGraphicsPixmapItem(prev_pixmap,this);
         _previewPixmap->setZValue(getBaseDepth() + 1);
-        
+        if (_lowDetail) {
+            _previewPixmap->setOpacity(0.);
+        }
     }
     QSize size = getSize();
     int w,h;
@@ -869,6 +874,11 @@ NodeGui::resize(int width,
     resizeExtraContent(width,height,forceSize);
     
     refreshPosition( pos().x(), pos().y(), true );
+    
+    if (_graph) {
+        ///The position may not have changed, e.g: when resizing a backdrop from its bottom right corner
+        _graph->onNodeGeometryChanged( shared_from_this() );
+    }
 }
 
 void
@@ -878,10 +888,13 @@ NodeGui::refreshPositionEnd(double x,
     setPos(x, y);
     if (_graph) {
         QRectF bbox = mapRectToScene(boundingRect());
-        const NodeGuiList & allNodes = _graph->getAllActiveNodes();
-
-        for (NodeGuiList::const_iterator it = allNodes.begin(); it != allNodes.end(); ++it) {
-            if ((*it)->isVisible() && (it->get() != this) && (*it)->intersects(bbox)) {
+        ///setPos does not notify the graph if the position did not change but the size may have
+        _graph->onNodeGeometryChanged( shared_from_this() );
+        
+        NodeGuiList nearbyNodes;
+        _graph->getNodesIntersecting(bbox, &nearbyNodes);
+        for (NodeGuiList::const_iterator it = nearbyNodes.begin(); it != nearbyNodes.end(); ++it) {
+            if ((it->get() != this) && (*it)->intersects(bbox)) {
                 setAboveItem( it->get() );
             }
         }
@@ -893,7 +906,13 @@ NodeGui::refreshPositionEnd(double x,
 
         for (std::list<Natron::Node* >::const_iterator it = outputs.begin(); it != outputs.end(); ++it) {
             assert(*it);
-            (*it)->doRefreshEdgesGUI();
+            boost::shared_ptr<NodeGui> outputGui = boost::dynamic_pointer_cast<NodeGui>( (*it)->getNodeGui() );
+            if (outputGui) {
+                ///Only the edges coming from this node have to follow it
+                outputGui->refreshEdgesFrom(this);
+            } else {
+                (*it)->doRefreshEdgesGUI();
+            }
         }
     }
     Q_EMIT positionChanged(x,y);
@@ -1115,6 +1134,24 @@ NodeGui::refreshEdges()
     if (_outputEdge) {
         _outputEdge->initLine();
     }
+    if (_graph) {
+        _graph->onNodeGeometryChanged( shared_from_this() );
+    }
+}
+
+void
+NodeGui::refreshEdgesFrom(const NodeGui* source)
+{
+    bool changed = false;
+    for (InputEdges::iterator it = _inputEdges.begin(); it != _inputEdges.end(); ++it) {
+        if ( (*it)->getSource().get() == source ) {
+            (*it)->initLine();
+            changed = true;
+        }
+    }
+    if (changed && _graph) {
+        _graph->onNodeGeometryChanged( shared_from_this() );
+    }
 }
 
 void
@@ -1151,7 +1188,7 @@ NodeGui::updatePreviewImage(int time)
         
         ensurePreviewCreated();
 
-        QtConcurrent::run(this,&NodeGui::computePreviewImage,time);
+        requestPreview(time);
     }
 }
 
@@ -1168,46 +1205,39 @@ NodeGui::forceComputePreview(int time)
         
         ensurePreviewCreated();
 
-        QtConcurrent::run(this,&NodeGui::computePreviewImage,time);
+        requestPreview(time);
     }
 }
 
 void
-NodeGui::computePreviewImage(int time)
+NodeGui::requestPreview(int time)
 {
-    NodePtr node = getNode();
-    if ( node->isRenderingPreview() ) {
+    if (!_graph || !_graph->getGui()) {
         return;
     }
-    
+    ///Nodes out of the view or in a hidden node-graph wait for the visible ones
+    bool visible = !_culled && _graph->isVisible();
+    _graph->getGui()->getApp()->appendToPreviewQueue(shared_from_this(), time, visible);
+}
 
-    int w = NATRON_PREVIEW_WIDTH;
-    int h = NATRON_PREVIEW_HEIGHT;
-    size_t dataSize = 4 * w * h;
-    {
-#ifndef __NATRON_WIN32__
-        unsigned int* buf = (unsigned int*)calloc(dataSize,1);
-#else
-        unsigned int* buf = (unsigned int*)malloc(dataSize);
-        for (int i = 0; i < w * h; ++i) {
-            buf[i] = qRgba(0,0,0,255);
-        }
-#endif
-        bool success = node->makePreviewImage(time, &w, &h, buf);
-        
-        if (success) {
-            QImage img(reinterpret_cast<const uchar*>(buf), w, h, QImage::Format_ARGB32_Premultiplied);
-            QPixmap prev_pixmap = QPixmap::fromImage(img);
-            _previewPixmap->setPixmap(prev_pixmap);
-            QPointF topLeft = mapFromParent( pos() );
-            QRectF bbox = boundingRect();
-            
-            int iconWidth = _pluginIcon ? NATRON_PLUGIN_ICON_SIZE + PLUGIN_ICON_OFFSET * 2 : 0;
-            _previewPixmap->setPos(topLeft.x() + iconWidth + NODE_WIDTH / 4. ,
-                                   topLeft.y() + bbox.height() / 2 - NATRON_PREVIEW_HEIGHT / 2 + 10);
-        }
-        free(buf);
+void
+NodeGui::setPreviewImage(const unsigned int* buf,
+                         int width,
+                         int height)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    if (!_previewPixmap) {
+        return;
     }
+    QImage img(reinterpret_cast<const uchar*>(buf), width, height, QImage::Format_ARGB32_Premultiplied);
+    QPixmap prev_pixmap = QPixmap::fromImage(img);
+    _previewPixmap->setPixmap(prev_pixmap);
+    QPointF topLeft = mapFromParent( pos() );
+    QRectF bbox = boundingRect();
+    
+    int iconWidth = _pluginIcon ? NATRON_PLUGIN_ICON_SIZE + PLUGIN_ICON_OFFSET * 2 : 0;
+    _previewPixmap->setPos(topLeft.x() + iconWidth + NODE_WIDTH / 4. ,
+                           topLeft.y() + bbox.height() / 2 - NATRON_PREVIEW_HEIGHT / 2 + 10);
 }
 
 bool
@@ -1460,6 +1490,23 @@ NodeGui::boundingRectWithEdges() const
     return ret;
 }
 
+QRectF
+NodeGui::boundingRectWithAllEdges() const
+{
+    QRectF ret = mapRectToScene( boundingRect() );
+
+    for (InputEdges::const_iterator it = _inputEdges.begin(); it != _inputEdges.end(); ++it) {
+        if (*it) {
+            ret = ret.united( (*it)->mapRectToScene( (*it)->boundingRect() ) );
+        }
+    }
+    if (_outputEdge) {
+        ret = ret.united( _outputEdge->mapRectToScene( _outputEdge->boundingRect() ) );
+    }
+
+    return ret;
+}
+
 bool
 NodeGui::isNearby(QPointF &point)
 {
@@ -2112,6 +2159,69 @@ NodeGui::setVisibleDetails(bool visible)
     }
 }
 
+void
+NodeGui::setLowDetail(bool lowDetail)
+{
+    if (lowDetail == _lowDetail) {
+        return;
+    }
+    _lowDetail = lowDetail;
+    QList<QGraphicsItem*> children = childItems();
+    for (QList<QGraphicsItem*>::iterator it = children.begin(); it != children.end(); ++it) {
+        int type = (*it)->type();
+        if ( (type == QGraphicsTextItem::Type) || (type == QGraphicsPixmapItem::Type) ) {
+            (*it)->setOpacity(lowDetail ? 0. : 1.);
+        }
+    }
+}
+
+void
+NodeGui::setCulled(bool culled)
+{
+    if (culled == _culled) {
+        return;
+    }
+    _culled = culled;
+    setOpacity(culled ? 0. : 1.);
+    for (InputEdges::iterator it = _inputEdges.begin(); it != _inputEdges.end(); ++it) {
+        if (*it) {
+            (*it)->setCulled(culled);
+        }
+    }
+    if (_outputEdge) {
+        _outputEdge->setCulled(culled);
+    }
+}
+
+void
+NodeGui::refreshCulling(const QRectF& sceneRect)
+{
+    bool culled = !mapRectToScene( boundingRect() ).intersects(sceneRect);
+    if (culled != _culled) {
+        _culled = culled;
+        setOpacity(culled ? 0. : 1.);
+    }
+    for (InputEdges::iterator it = _inputEdges.begin(); it != _inputEdges.end(); ++it) {
+        if (*it) {
+            (*it)->setCulled( !(*it)->mapRectToScene( (*it)->boundingRect() ).intersects(sceneRect) );
+        }
+    }
+    if (_outputEdge) {
+        _outputEdge->setCulled( !_outputEdge->mapRectToScene( _outputEdge->boundingRect() ).intersects(sceneRect) );
+    }
+}
+
+QVariant
+NodeGui::itemChange(GraphicsItemChange change,
+                    const QVariant & value)
+{
+    if ( _graph && ( (change == ItemPositionHasChanged) || (change == ItemScaleHasChanged) || (change == ItemVisibleHasChanged) ) ) {
+        _graph->onNodeGeometryChanged( shared_from_this() );
+    }
+
+    return QGraphicsItem::itemChange(change, value);
+}
+
 void
 NodeGui::onInputNRenderingStarted(int input)
 {
@@ -2822,12 +2932,34 @@ NodeGui::refreshKnobsAfterTimeChange(SequenceTime time)
 {
     NodePtr node = getNode();
     if ( ( _settingsPanel && !_settingsPanel->isClosed() ) ) {
-        node->getLiveInstance()->refreshAfterTimeChange(time);
+        if ( !isSettingsPanelShownOnScreen() ) {
+            _knobsRefreshPending = true;
+        } else {
+            _knobsRefreshPending = false;
+            node->getLiveInstance()->refreshAfterTimeChange(time);
+        }
     } else if ( !node->getParentMultiInstanceName().empty() ) {
         node->getLiveInstance()->refreshInstanceSpecificKnobsOnly(time);
     }
 }
 
+bool
+NodeGui::isSettingsPanelShownOnScreen() const
+{
+    return _settingsPanel && !_settingsPanel->isClosed() && !_settingsPanel->isMinimized() && _settingsPanel->isVisible();
+}
+
+void
+NodeGui::onSettingsPanelShown()
+{
+    if ( !_knobsRefreshPending || !isSettingsPanelShownOnScreen() ) {
+        return;
+    }
+    _knobsRefreshPending = false;
+    NodePtr node = getNode();
+    node->getLiveInstance()->refreshAfterTimeChange( node->getApp()->getTimeLine()->currentFrame() );
+}
+
 void
 NodeGui::onGuiFrozenChanged(bool frozen)
 {
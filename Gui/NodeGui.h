@@ -204,6 +204,10 @@ public:
 
     QRectF boundingRectWithEdges() const;
 
+    /*Returns the bounding box of the node in scene coordinates united with the ones of all the edges it owns,
+       that is its input edges and its output edge.*/
+    QRectF boundingRectWithAllEdges() const;
+
     /*this function does the painting, using QPainter, you can overload it to change the aspect of
        the node.*/
     virtual void paint(QPainter* painter,const QStyleOptionGraphicsItem* options,QWidget* parent) OVERRIDE;
@@ -219,6 +223,12 @@ public:
     Edge* getOutputArrow() const;
     Edge* getInputArrow(int inputNb) const;
 
+    /*Recomputes the lines of the input arrows connected to source only, e.g: when source moved.*/
+    void refreshEdgesFrom(const NodeGui* source);
+
+    /*Displays the given ARGB32 premultiplied image as preview, called on the main thread once the preview thread computed it.*/
+    void setPreviewImage(const unsigned int* buf,int width,int height);
+
     /*Returns true if the point is included in the rectangle +10px on all edges.*/
     bool isNearby(QPointF &point);
 
@@ -304,7 +314,17 @@ public:
     
     void setOverlayColor(const QColor& c);
 
+    /**
+     * @brief Refreshes the knobs of the settings panel at the given time. Panels that are minimized or not on screen
+     * are only refreshed once they are shown again.
+     **/
     void refreshKnobsAfterTimeChange(SequenceTime time);
+
+    /**
+     * @brief Returns true if the settings panel is opened, expanded and on screen, i.e: if its knobs are refreshed
+     * when the time changes.
+     **/
+    bool isSettingsPanelShownOnScreen() const;
     
     void onGuiFrozenChanged(bool frozen);
 
@@ -336,6 +356,30 @@ public:
      **/
     void setVisibleDetails(bool visible);
     
+    /**
+     * @brief Called when the node-graph is zoomed out below its low detail level: only the shapes of the node are drawn,
+     * its texts, icons and preview being made fully transparent so that they are not painted at all.
+     **/
+    void setLowDetail(bool lowDetail);
+    
+    /**
+     * @brief Called by the node-graph when the node and the edges it owns go out of (or back in) the visible portion
+     * of the graph. A culled node is fully transparent so that the scene skips it along with all its children when painting.
+     * Unlike a hidden node, it is still part of the graph for everything else.
+     **/
+    void setCulled(bool culled);
+
+    /**
+     * @brief Same as setCulled but the node and each of its edges are culled separately, depending on whether they
+     * intersect sceneRect.
+     **/
+    void refreshCulling(const QRectF& sceneRect);
+    
+    bool isCulled() const
+    {
+        return _culled;
+    }
+    
     virtual void refreshStateIndicator();
     
     virtual void exportGroupAsPythonScript() OVERRIDE FINAL;
@@ -402,6 +446,9 @@ protected:
     
     virtual void resizeExtraContent(int /*w*/,int /*h*/,bool /*forceResize*/) {}
     
+    /*Keeps the spatial index of the node-graph up to date when the node is moved, magnified, shown or hidden.*/
+    virtual QVariant itemChange(GraphicsItemChange change,const QVariant & value) OVERRIDE;
+    
 public Q_SLOTS:
 
 
@@ -490,6 +537,8 @@ public Q_SLOTS:
 
     void onSettingsPanelClosedChanged(bool closed);
 
+    void onSettingsPanelShown();
+
     void onParentMultiInstancePositionChanged(int x,int y);
     
     void setOptionalInputsVisible(bool visible);
@@ -524,7 +573,8 @@ private:
     
     void setAboveItem(QGraphicsItem* item);
 
-    void computePreviewImage(int time);
+    /*Queues the computation of the preview in the preview thread of the application.*/
+    void requestPreview(int time);
 
     void populateMenu();
 
@@ -620,6 +670,10 @@ private:
     
     bool _optionalInputsVisible;
     
+    bool _lowDetail; //< see setLowDetail
+    bool _culled; //< see setCulled
+    bool _knobsRefreshPending; //< true if a time change was skipped because the settings panel was not shown
+    
     ///For the serialization thread
     mutable QMutex _mtSafeSizeMutex;
     int _mtSafeWidth,_mtSafeHeight;
@@ -0,0 +1,311 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "PreviewThread.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <list>
+#include <vector>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QCoreApplication>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QColor>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/weak_ptr.hpp>
+#endif
+
+#include "Engine/AppInstance.h"
+#include "Engine/Node.h"
+#include "Engine/Project.h"
+#include "Engine/Timer.h"
+#include "Engine/ViewerInstance.h"
+
+#include "Gui/NodeGui.h"
+
+///A request is only served once no other request came for the same node during this delay
+#define NATRON_PREVIEW_REQUEST_DELAY_MS 150
+
+///Maximum number of pending requests
+#define NATRON_PREVIEW_QUEUE_MAX_SIZE 128
+
+///While a viewer renders, check every so often whether it is done
+#define NATRON_PREVIEW_VIEWER_POLL_MS 50
+
+struct PreviewRequest
+{
+    boost::weak_ptr<NodeGui> node;
+    boost::weak_ptr<Natron::Node> internalNode; //< the only one used on the preview thread
+    const NodeGui* key;
+    int time;
+    bool visible;
+    double requestTime; //< in seconds, see PreviewThreadPrivate::clock
+
+    PreviewRequest()
+    : node()
+    , internalNode()
+    , key(0)
+    , time(0)
+    , visible(false)
+    , requestTime(0)
+    {
+    }
+};
+
+struct ProducedPreview
+{
+    boost::weak_ptr<NodeGui> node;
+    std::vector<unsigned int> buf;
+    int width,height;
+};
+
+typedef std::list<PreviewRequest> PreviewRequests;
+
+struct PreviewThreadPrivate
+{
+    TimeLapse clock;
+    QMutex requestsMutex;
+    QWaitCondition requestsCond;
+    PreviewRequests requests;
+    bool mustQuit;
+    QMutex producedMutex;
+    std::list<ProducedPreview> produced;
+
+    PreviewThreadPrivate()
+    : clock()
+    , requestsMutex()
+    , requestsCond()
+    , requests()
+    , mustQuit(false)
+    , producedMutex()
+    , produced()
+    {
+    }
+
+    ///Returns true if there is a pending request for the given node. Must be called with requestsMutex locked.
+    bool hasRequestFor(const NodeGui* key) const
+    {
+        for (PreviewRequests::const_iterator it = requests.begin(); it != requests.end(); ++it) {
+            if (it->key == key) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Waits while a viewer of the project of node is rendering. Returns false if the thread must quit meanwhile.
+     **/
+    bool waitForViewersToFinish(const boost::shared_ptr<Natron::Node>& node);
+};
+
+///Visible nodes first, then the oldest request
+static bool
+isServedBefore(const PreviewRequest& a,
+               const PreviewRequest& b)
+{
+    if (a.visible != b.visible) {
+        return a.visible;
+    }
+
+    return a.requestTime < b.requestTime;
+}
+
+static bool
+isAnyViewerRendering(const boost::shared_ptr<Natron::Node>& node)
+{
+    std::list<ViewerInstance*> viewers;
+    node->getApp()->getProject()->getViewers(&viewers);
+    for (std::list<ViewerInstance*>::iterator it = viewers.begin(); it != viewers.end(); ++it) {
+        if ( (*it)->getNode()->isNodeRendering() ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+PreviewThreadPrivate::waitForViewersToFinish(const boost::shared_ptr<Natron::Node>& node)
+{
+    while ( isAnyViewerRendering(node) ) {
+        QMutexLocker l(&requestsMutex);
+        if (mustQuit) {
+            return false;
+        }
+        requestsCond.wait(&requestsMutex, NATRON_PREVIEW_VIEWER_POLL_MS);
+    }
+
+    return true;
+}
+
+PreviewThread::PreviewThread()
+    : QThread()
+    , _imp( new PreviewThreadPrivate() )
+{
+    QObject::connect( this, SIGNAL( previewsProduced() ), this, SLOT( onPreviewsProduced() ) );
+}
+
+PreviewThread::~PreviewThread()
+{
+    quitThread();
+}
+
+void
+PreviewThread::appendToQueue(const boost::shared_ptr<NodeGui>& node,
+                             int time,
+                             bool visible)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    PreviewRequest r;
+    r.node = node;
+    r.internalNode = node->getNode();
+    r.key = node.get();
+    r.time = time;
+    r.visible = visible;
+    r.requestTime = _imp->clock.getTimeSinceCreation();
+
+    QMutexLocker l(&_imp->requestsMutex);
+    if (_imp->mustQuit) {
+        return;
+    }
+
+    PreviewRequests::iterator found = _imp->requests.begin();
+    for (; found != _imp->requests.end(); ++found) {
+        if (found->key == r.key) {
+            break;
+        }
+    }
+    if ( found != _imp->requests.end() ) {
+        ///Replacing the pending request also postpones it: the node is being edited
+        *found = r;
+    } else if ( (int)_imp->requests.size() < NATRON_PREVIEW_QUEUE_MAX_SIZE ) {
+        _imp->requests.push_back(r);
+    } else {
+        PreviewRequests::iterator last = std::max_element(_imp->requests.begin(), _imp->requests.end(), isServedBefore);
+        if ( !isServedBefore(r, *last) ) {
+            return;
+        }
+        *last = r;
+    }
+
+    if ( !isRunning() ) {
+        start(LowestPriority);
+    } else {
+        _imp->requestsCond.wakeOne();
+    }
+}
+
+void
+PreviewThread::quitThread()
+{
+    {
+        QMutexLocker l(&_imp->requestsMutex);
+        _imp->mustQuit = true;
+        _imp->requests.clear();
+        _imp->requestsCond.wakeAll();
+    }
+    wait();
+    {
+        QMutexLocker l(&_imp->producedMutex);
+        _imp->produced.clear();
+    }
+}
+
+void
+PreviewThread::onPreviewsProduced()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    std::list<ProducedPreview> produced;
+    {
+        QMutexLocker l(&_imp->producedMutex);
+        produced.swap(_imp->produced);
+    }
+    for (std::list<ProducedPreview>::iterator it = produced.begin(); it != produced.end(); ++it) {
+        boost::shared_ptr<NodeGui> node = it->node.lock();
+        if (node) {
+            node->setPreviewImage(&it->buf[0], it->width, it->height);
+        }
+    }
+}
+
+void
+PreviewThread::run()
+{
+    for (;; ) {
+        PreviewRequest request;
+        {
+            QMutexLocker l(&_imp->requestsMutex);
+            for (;; ) {
+                if (_imp->mustQuit) {
+                    return;
+                }
+                if ( _imp->requests.empty() ) {
+                    _imp->requestsCond.wait(&_imp->requestsMutex);
+                    continue;
+                }
+                PreviewRequests::iterator next = std::min_element(_imp->requests.begin(), _imp->requests.end(), isServedBefore);
+                double remainingMS = NATRON_PREVIEW_REQUEST_DELAY_MS - (_imp->clock.getTimeSinceCreation() - next->requestTime) * 1000.;
+                if (remainingMS > 0) {
+                    _imp->requestsCond.wait( &_imp->requestsMutex, (unsigned long)std::ceil(remainingMS) );
+                    continue;
+                }
+                request = *next;
+                _imp->requests.erase(next);
+                break;
+            }
+        }
+
+        boost::shared_ptr<Natron::Node> node = request.internalNode.lock();
+        if ( !node || !node->isActivated() ) {
+            continue;
+        }
+
+        if ( !_imp->waitForViewersToFinish(node) ) {
+            return;
+        }
+        {
+            ///The node may have been edited again while waiting for the viewer: serve the newer request instead
+            QMutexLocker l(&_imp->requestsMutex);
+            if ( _imp->hasRequestFor(request.key) ) {
+                continue;
+            }
+        }
+
+        ProducedPreview ret;
+        ret.node = request.node;
+        ret.width = NATRON_PREVIEW_WIDTH;
+        ret.height = NATRON_PREVIEW_HEIGHT;
+#ifndef __NATRON_WIN32__
+        ret.buf.resize(ret.width * ret.height, 0);
+#else
+        ret.buf.resize( ret.width * ret.height, qRgba(0,0,0,255) );
+#endif
+        if ( !node->makePreviewImage(request.time, &ret.width, &ret.height, &ret.buf[0]) ) {
+            continue;
+        }
+
+        {
+            QMutexLocker l(&_imp->producedMutex);
+            _imp->produced.push_back(ret);
+        }
+        Q_EMIT previewsProduced();
+    }
+} // run
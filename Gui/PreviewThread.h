@@ -0,0 +1,73 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_GUI_PREVIEWTHREAD_H_
+#define NATRON_GUI_PREVIEWTHREAD_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "Global/Macros.h"
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QThread>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#endif
+
+class NodeGui;
+struct PreviewThreadPrivate;
+
+/**
+ * @brief Computes the previews of the nodes of the node-graphs of an application, one at a time and never on the main thread.
+ * Requests are served visible nodes first and are only computed once no other request came for the same node
+ * during a short delay, so that a burst of edits on a parameter yields a single preview. While a viewer is rendering,
+ * previews wait so that they do not compete with it for the CPU.
+ * The resulting images are handed to the nodes on the main thread.
+ **/
+class PreviewThread
+    : public QThread
+{
+    Q_OBJECT
+
+public:
+
+    PreviewThread();
+
+    virtual ~PreviewThread();
+
+    /**
+     * @brief Queues the computation of the preview of node at the given time, replacing any pending request for the same node.
+     * If the queue is full, the request with the lowest priority is dropped.
+     * @param visible True if the node is in the visible portion of its node-graph, in which case it is served first.
+     **/
+    void appendToQueue(const boost::shared_ptr<NodeGui>& node,int time,bool visible);
+
+    /**
+     * @brief Drops all pending requests and stops the thread, waiting for the preview being computed, if any.
+     **/
+    void quitThread();
+
+Q_SIGNALS:
+
+    void previewsProduced();
+
+public Q_SLOTS:
+
+    void onPreviewsProduced();
+
+private:
+
+    virtual void run() OVERRIDE FINAL;
+    boost::scoped_ptr<PreviewThreadPrivate> _imp;
+};
+
+#endif // NATRON_GUI_PREVIEWTHREAD_H_
@@ -15,6 +15,7 @@
 
 #include "QtDecoder.h"
 
+#include <climits>
 #include <stdexcept>
 
 CLANG_DIAG_OFF(deprecated)
@@ -51,6 +52,9 @@ QtReader::QtReader(boost::shared_ptr<Natron::Node> node)
       , _startingFrame()
       , _timeOffset()
       , _settingFrameRange(false)
+      , _sequenceFirstFrame(0)
+      , _sequenceFileNames()
+      , _sequenceFilesExist()
 {
 }
 
@@ -162,6 +166,7 @@ QtReader::knobChanged(KnobI* k,
                       bool /*originatedFromMainThread*/)
 {
     if ( k == _fileKnob.get() ) {
+        refreshSequenceFiles();
         SequenceTime first,last;
         getSequenceTimeDomain(first,last);
         timeDomainFromSequenceTimeDomain(first,last, true);
@@ -377,6 +382,26 @@ QtReader::getSequenceTime(SequenceTime t)
     return sequenceTime;
 } // getSequenceTime
 
+void
+QtReader::refreshSequenceFiles()
+{
+    SequenceTime first,last;
+    getSequenceTimeDomain(first,last);
+    
+    std::vector<std::string> fileNames;
+    std::vector<bool> exist;
+    ///A single file has no frame range
+    if ( (first != INT_MIN) && (last != INT_MAX) ) {
+        ///The directory of the sequence is listed once for all frames
+        _fileKnob->getFileNamesInRange(first, last, &fileNames, &exist);
+    }
+    
+    QMutexLocker l(&_lock);
+    _sequenceFirstFrame = first;
+    _sequenceFileNames.swap(fileNames);
+    _sequenceFilesExist.swap(exist);
+}
+
 void
 QtReader::getFilenameAtSequenceTime(SequenceTime time,
                                     std::string &filename)
@@ -384,27 +409,38 @@ QtReader::getFilenameAtSequenceTime(SequenceTime time,
     int missingChoice = _missingFrameChoice->getValue();
 
     filename = _fileKnob->getFileName(time);
+    
+    int index = time - _sequenceFirstFrame;
+    if ( (index < 0) || ( index >= (int)_sequenceFilesExist.size() ) || _sequenceFilesExist[index] ) {
+        return;
+    }
 
     switch (missingChoice) {
-    case 0:     // Load nearest
-                ///the nearest frame search went out of range and couldn't find a frame.
-        if ( filename.empty() ) {
-            filename = _fileKnob->getFileName(time);
-            if ( filename.empty() ) {
-                setPersistentMessage( Natron::eMessageTypeError, QObject::tr("Nearest frame search went out of range").toStdString() );
+    case 0: {   // Load nearest
+        filename.clear();
+        int count = (int)_sequenceFilesExist.size();
+        for (int offset = 1; offset < count; ++offset) {
+            if ( (index - offset >= 0) && _sequenceFilesExist[index - offset] ) {
+                filename = _sequenceFileNames[index - offset];
+                break;
+            }
+            if ( (index + offset < count) && _sequenceFilesExist[index + offset] ) {
+                filename = _sequenceFileNames[index + offset];
+                break;
             }
         }
-        break;
-    case 1:     // Error
-                /// For images sequences, if the offset is not 0, that means no frame were found at the  originally given
-                /// time, we can safely say this is  a missing frame.
+        ///the nearest frame search went out of range and couldn't find a frame.
         if ( filename.empty() ) {
-            setPersistentMessage( Natron::eMessageTypeError, QObject::tr("Missing frame").toStdString() );
+            setPersistentMessage( Natron::eMessageTypeError, QObject::tr("Nearest frame search went out of range").toStdString() );
         }
+        break;
+    }
+    case 1:     // Error
+        setPersistentMessage( Natron::eMessageTypeError, QObject::tr("Missing frame").toStdString() );
+        filename.clear();
+        break;
     case 2:     // Black image
-                /// For images sequences, if the offset is not 0, that means no frame were found at the  originally given
-                /// time, we can safely say this is  a missing frame.
-
+        filename.clear();
         break;
     }
 }
@@ -120,6 +120,9 @@ private:
 
     void getFilenameAtSequenceTime(SequenceTime time, std::string &filename);
 
+    /*Resolves the file names of the whole sequence and which of them exist on disk, called when the file changes.*/
+    void refreshSequenceFiles();
+
 
     const Natron::Color::Lut* _lut;
     std::string _filename;
@@ -135,6 +138,11 @@ private:
     boost::shared_ptr<Int_Knob> _startingFrame;
     boost::shared_ptr<Int_Knob> _timeOffset;
     bool _settingFrameRange;
+    
+    ///The file name of each frame of the sequence and whether it exists on disk, protected by _lock
+    SequenceTime _sequenceFirstFrame;
+    std::vector<std::string> _sequenceFileNames;
+    std::vector<bool> _sequenceFilesExist;
 };
 
 #endif /* defined(NATRON_READERS_READQT_H_) */
@@ -1551,6 +1551,10 @@ RotoGui::drawOverlays(double /*scaleX*/,
                         continue;
                     }
                     
+                    ///All the points are read from the same evaluated snapshot
+                    BezierEvaluationPtr evaluation = isBezier->getEvaluationAtTime(time);
+                    assert(evaluation->points.size() == cps.size() && evaluation->featherPoints.size() == featherPts.size());
+                    
                     double cpHalfWidth = kControlPointMidSize * pixelScale.first;
                     double cpHalfHeight = kControlPointMidSize * pixelScale.second;
                     
@@ -1576,13 +1580,18 @@ RotoGui::drawOverlays(double /*scaleX*/,
                         }
                         assert(itF != featherPts.end()); // because cps.size() == featherPts.size()
 
+                        const BezierCPValue & cpValue = evaluation->points[index];
+                        const BezierCPValue & fpValue = evaluation->featherPoints[index];
+                        
                         double x,y;
                         Transform::Point3D p,pF;
-                        (*it2)->getPositionAtTime(time, &p.x, &p.y);
+                        p.x = cpValue.p.x;
+                        p.y = cpValue.p.y;
                         p.z = 1.;
 
                         double xF,yF;
-                        (*itF)->getPositionAtTime(time, &pF.x, &pF.y);
+                        pF.x = fpValue.p.x;
+                        pF.y = fpValue.p.y;
                         pF.z = 1.;
                         
                         p = Transform::matApply(transform, p);
@@ -1596,7 +1605,9 @@ RotoGui::drawOverlays(double /*scaleX*/,
                         ///draw the feather point only if it is distinct from the associated point
                         bool drawFeather = isFeatherVisible();
                         if (drawFeather) {
-                            drawFeather = !(*it2)->equalsAtTime(time, **itF);
+                            drawFeather = cpValue.p.x != fpValue.p.x || cpValue.p.y != fpValue.p.y ||
+                            cpValue.left.x != fpValue.left.x || cpValue.left.y != fpValue.left.y ||
+                            cpValue.right.x != fpValue.right.x || cpValue.right.y != fpValue.right.y;
                         }
                         
                         
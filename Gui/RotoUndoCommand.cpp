@@ -22,8 +22,11 @@ CLANG_DIAG_OFF(uninitialized)
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include <sstream>
+
 #include "Global/GlobalDefines.h"
 #include "Engine/RotoContext.h"
+#include "Engine/RotoSerialization.h"
 #include "Engine/Transform.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/Project.h"
@@ -31,6 +34,8 @@ CLANG_DIAG_ON(uninitialized)
 #include "Gui/RotoGui.h"
 #include "Gui/GuiAppInstance.h"
 #include "Gui/RotoPanel.h"
+#include "Gui/GuiApplicationManager.h"
+#include "Gui/UndoJournal.h"
 
 
 using namespace Natron;
@@ -41,6 +46,43 @@ typedef std::list<SelectedCp> SelectedCpList;
 typedef boost::shared_ptr<Bezier> BezierPtr;
 typedef std::list<BezierPtr> BezierList;
 
+/**
+ * @brief Remembers the shape of the curve in the undo/redo journal. Only the points are saved, not the parameters
+ * of the item, which the commands editing the shape do not change.
+ **/
+static boost::shared_ptr<UndoRecord>
+saveBezierShape(const Bezier & curve)
+{
+    BezierSerialization s;
+    curve.saveShape(&s);
+    std::ostringstream ss;
+    try {
+        boost::archive::binary_oarchive oArchive(ss);
+        oArchive << boost::serialization::make_nvp("Shape",s);
+    } catch (const std::exception & e) {
+        qDebug() << "Failed to save the shape of" << curve.getScriptName().c_str() << ":" << e.what();
+    }
+
+    return appPTR->getUndoJournal()->createRecord( ss.str() );
+}
+
+static void
+restoreBezierShape(const UndoRecord & record,
+                   Bezier* curve)
+{
+    BezierSerialization s;
+    std::istringstream ss( record.getData() );
+    try {
+        boost::archive::binary_iarchive iArchive(ss);
+        iArchive >> boost::serialization::make_nvp("Shape",s);
+    } catch (const std::exception & e) {
+        qDebug() << "Failed to restore the shape of" << curve->getScriptName().c_str() << ":" << e.what();
+
+        return;
+    }
+    curve->restoreShape(s);
+}
+
 MoveControlPointsUndoCommand::MoveControlPointsUndoCommand(RotoGui* roto,
                                                            const std::list< std::pair<boost::shared_ptr<BezierCP>,boost::shared_ptr<BezierCP> > > & toDrag
                                                            ,
@@ -344,14 +386,12 @@ AddPointUndoCommand::AddPointUndoCommand(RotoGui* roto,
     : QUndoCommand()
       , _firstRedoCalled(false)
       , _roto(roto)
-      , _oldCurve()
+      , _oldShape()
       , _curve(curve)
       , _index(index)
       , _t(t)
 {
-    _oldCurve.reset( new Bezier(curve->getContext(),curve->getScriptName(),curve->getParentLayer(), false) );
-    _oldCurve->clone(curve.get());
-    
+    ///The shape is saved in redo()
 }
 
 AddPointUndoCommand::~AddPointUndoCommand()
@@ -361,7 +401,7 @@ AddPointUndoCommand::~AddPointUndoCommand()
 void
 AddPointUndoCommand::undo()
 {
-    _curve->clone(_oldCurve.get());
+    restoreBezierShape(*_oldShape, _curve.get());
     _roto->setSelection( _curve, std::make_pair( CpPtr(),CpPtr() ) );
     _roto->evaluate(true);
     setText( QObject::tr("Add point to %1 of %2").arg( _curve->getLabel().c_str() ).arg( _roto->getNodeName() ) );
@@ -370,7 +410,7 @@ AddPointUndoCommand::undo()
 void
 AddPointUndoCommand::redo()
 {
-    _oldCurve->clone(_curve.get());
+    _oldShape = saveBezierShape(*_curve);
     boost::shared_ptr<BezierCP> cp = _curve->addControlPointAfterIndex(_index,_t);
     boost::shared_ptr<BezierCP> newFp = _curve->getFeatherPointAtIndex(_index + 1);
 
@@ -403,8 +443,7 @@ RemovePointUndoCommand::RemovePointUndoCommand(RotoGui* roto,
     assert(desc.parentLayer);
     desc.curve = curve;
     desc.points.push_back(indexToRemove);
-    desc.oldCurve.reset( new Bezier(curve->getContext(),curve->getScriptName(),curve->getParentLayer(), false) );
-    desc.oldCurve->clone(curve.get());
+    ///The shape is saved in redo()
     _curves.push_back(desc);
 }
 
@@ -425,7 +464,6 @@ RemovePointUndoCommand::RemovePointUndoCommand(RotoGui* roto,
         assert(cp && cp->getBezier() && _roto && _roto->getContext() );
         BezierPtr curve = boost::dynamic_pointer_cast<Bezier>( _roto->getContext()->getItemByName( cp->getBezier()->getScriptName() ) );
         assert(curve);
-        RotoStrokeItem* isStroke = dynamic_cast<RotoStrokeItem*>(curve.get());
 
         std::list< CurveDesc >::iterator foundCurve = _curves.end();
         for (std::list< CurveDesc >::iterator it2 = _curves.begin(); it2 != _curves.end(); ++it2) {
@@ -445,12 +483,6 @@ RemovePointUndoCommand::RemovePointUndoCommand(RotoGui* roto,
             assert(curveDesc.parentLayer);
             curveDesc.points.push_back(indexToRemove);
             curveDesc.curve = curve;
-            if (!isStroke) {
-                curveDesc.oldCurve.reset( new Bezier(curve->getContext(),curve->getScriptName(),curve->getParentLayer(), false) );
-            } else {
-                curveDesc.oldCurve.reset( new RotoStrokeItem(isStroke->getBrushType(),curve->getContext(),curve->getScriptName(),curve->getParentLayer()) );
-            }
-            curveDesc.oldCurve->clone(curve.get());
             _curves.push_back(curveDesc);
         } else {
             foundCurve->points.push_back(indexToRemove);
@@ -472,8 +504,7 @@ RemovePointUndoCommand::undo()
     SelectedCpList cpSelection;
 
     for (std::list< CurveDesc >::iterator it = _curves.begin(); it != _curves.end(); ++it) {
-        ///clone the curve
-        it->curve->clone(it->oldCurve.get());
+        restoreBezierShape(*it->oldShape, it->curve.get());
         if (it->curveRemoved) {
             _roto->getContext()->addItem(it->parentLayer, it->indexInLayer, it->curve, RotoItem::eSelectionReasonOverlayInteract);
         }
@@ -489,18 +520,14 @@ RemovePointUndoCommand::undo()
 void
 RemovePointUndoCommand::redo()
 {
-    ///clone the curve
     for (std::list< CurveDesc >::iterator it = _curves.begin(); it != _curves.end(); ++it) {
-        it->oldCurve->clone(it->curve.get());
+        it->oldShape = saveBezierShape(*it->curve);
     }
 
     std::list<boost::shared_ptr<Bezier> > toRemove;
     for (std::list< CurveDesc >::iterator it = _curves.begin(); it != _curves.end(); ++it) {
         
-        boost::shared_ptr<Bezier> isBezier = boost::dynamic_pointer_cast<Bezier>(it->curve);
-        if (!isBezier) {
-            continue;
-        }
+        const boost::shared_ptr<Bezier>& isBezier = it->curve;
         ///Remove in decreasing order so indexes don't get messed up
         isBezier->setAutoOrientationComputation(false);
         for (std::list<int>::reverse_iterator it2 = it->points.rbegin(); it2 != it->points.rend(); ++it2) {
@@ -1197,7 +1224,7 @@ MakeBezierUndoCommand::MakeBezierUndoCommand(RotoGui* roto,
       , _roto(roto)
       , _parentLayer()
       , _indexInLayer(0)
-      , _oldCurve()
+      , _undoneShape()
       , _newCurve(curve)
       , _curveNonExistant(false)
       , _createdPoint(createPoint)
@@ -1211,9 +1238,6 @@ MakeBezierUndoCommand::MakeBezierUndoCommand(RotoGui* roto,
 {
     if (!_newCurve) {
         _curveNonExistant = true;
-    } else {
-        _oldCurve.reset( new Bezier(_newCurve->getContext(),_newCurve->getScriptName(),_newCurve->getParentLayer(), false) );
-        _oldCurve->clone(_newCurve.get());
     }
 }
 
@@ -1227,7 +1251,8 @@ MakeBezierUndoCommand::undo()
     assert(_createdPoint);
     _roto->setCurrentTool(RotoGui::eRotoToolDrawBezier,true);
     assert(_lastPointAdded != -1);
-    _oldCurve->clone(_newCurve.get());
+    ///Undoing only removes the last point: the shape is only needed to redo
+    _undoneShape = saveBezierShape(*_newCurve);
     if (_newCurve->getControlPointsCount() == 1) {
         _curveNonExistant = true;
         _roto->removeCurve(_newCurve);
@@ -1257,12 +1282,9 @@ MakeBezierUndoCommand::redo()
             if (!_newCurve) {
                 _newCurve = _roto->getContext()->makeBezier(_x, _y, _isOpenBezier ? kRotoOpenBezierBaseName : kRotoBezierBaseName,_time, _isOpenBezier);
                 assert(_newCurve);
-                _oldCurve.reset( new Bezier(_newCurve->getContext(), _newCurve->getScriptName(), _newCurve->getParentLayer(), false) );
-                _oldCurve->clone(_newCurve.get());
                 _lastPointAdded = 0;
                 _curveNonExistant = false;
             } else {
-                _oldCurve->clone(_newCurve.get());
                 _newCurve->addControlPoint(_x, _y,_time);
                 int lastIndex = _newCurve->getControlPointsCount() - 1;
                 assert(lastIndex > 0);
@@ -1270,7 +1292,6 @@ MakeBezierUndoCommand::redo()
             }
         } else {
             assert(_newCurve);
-            _oldCurve->clone(_newCurve.get());
             int lastIndex = _newCurve->getControlPointsCount() - 1;
             assert(lastIndex >= 0);
             _lastPointAdded = lastIndex;
@@ -1287,7 +1308,9 @@ MakeBezierUndoCommand::redo()
             _indexInLayer = _parentLayer->getChildIndex(_newCurve);
         }
     } else {
-        _newCurve->clone(_oldCurve.get());
+        assert(_undoneShape);
+        restoreBezierShape(*_undoneShape, _newCurve.get());
+        _undoneShape.reset();
         if (_curveNonExistant) {
             _roto->getContext()->addItem(_parentLayer, _indexInLayer, _newCurve, RotoItem::eSelectionReasonOverlayInteract);
         }
@@ -37,6 +37,7 @@ class RotoStrokeItem;
 class QTreeWidgetItem;
 class RotoItem;
 class Double_Knob;
+class UndoRecord;
 namespace Transform {
 struct Matrix3x3;
 }
@@ -142,7 +143,8 @@ private:
 
     bool _firstRedoCalled; //< false by default
     RotoGui* _roto;
-    boost::shared_ptr<Bezier> _oldCurve,_curve;
+    boost::shared_ptr<UndoRecord> _oldShape; //< the shape before the point was added, see Bezier::saveShape
+    boost::shared_ptr<Bezier> _curve;
     int _index;
     double _t;
 };
@@ -153,7 +155,8 @@ class RemovePointUndoCommand
 {
     struct CurveDesc
     {
-        boost::shared_ptr<RotoDrawableItem> oldCurve,curve;
+        boost::shared_ptr<UndoRecord> oldShape; //< the shape before the points were removed
+        boost::shared_ptr<Bezier> curve;
         std::list<int> points;
         boost::shared_ptr<RotoLayer> parentLayer;
         bool curveRemoved;
@@ -417,7 +420,8 @@ private:
     RotoGui* _roto;
     boost::shared_ptr<RotoLayer> _parentLayer;
     int _indexInLayer;
-    boost::shared_ptr<Bezier> _oldCurve,_newCurve;
+    boost::shared_ptr<UndoRecord> _undoneShape; //< the shape before the last undo, used by the next redo
+    boost::shared_ptr<Bezier> _newCurve;
     bool _curveNonExistant;
     bool _createdPoint;
     double _x,_y;
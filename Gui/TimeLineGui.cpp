@@ -437,9 +437,8 @@ TimeLineGui::paintGL()
             QPoint mouseNumberWidgetCoord(currentPosBtmWidgetCoordX - fontM.width(mouseNumber) / 2,
                                           currentPosBtmWidgetCoordY - CURSOR_HEIGHT - 2);
             QPointF mouseNumberPos = toTimeLineCoordinates( mouseNumberWidgetCoord.x(),mouseNumberWidgetCoord.y() );
-            std::list<SequenceTime>::iterator foundHoveredAsKeyframe = std::find(keyframes.begin(),keyframes.end(),hoveredTime);
             QColor currentColor;
-            if ( foundHoveredAsKeyframe != keyframes.end() ) {
+            if ( _imp->timeline->isKeyframe(hoveredTime) ) {
                 glColor4f(kfR, kfG, kfB, 0.4);
                 currentColor.setRgbF(Natron::clamp<qreal>(kfR, 0., 1.),
                                      Natron::clamp<qreal>(kfG, 0., 1.),
@@ -464,9 +463,8 @@ TimeLineGui::paintGL()
         }
 
         //draw the bounds and the current time cursor
-        std::list<SequenceTime>::iterator isCurrentTimeAKeyframe = std::find( keyframes.begin(),keyframes.end(),_imp->timeline->currentFrame() );
         QColor actualCursorColor;
-        if ( isCurrentTimeAKeyframe != keyframes.end() ) {
+        if ( _imp->timeline->isKeyframe( _imp->timeline->currentFrame() ) ) {
             glColor4f(kfR, kfG, kfB, 1.);
             actualCursorColor.setRgbF(Natron::clamp<qreal>(kfR, 0., 1.),
                                       Natron::clamp<qreal>(kfG, 0., 1.),
@@ -547,14 +545,10 @@ TimeLineGui::paintGL()
         
         ///now draw keyframes
         glColor4f(kfR,kfG,kfB,1.);
-        std::set<SequenceTime> alreadyDrawnKeyframes;
         glBegin(GL_LINES);
         for (std::list<SequenceTime>::const_iterator i = keyframes.begin(); i != keyframes.end(); ++i) {
-            std::pair<std::set<SequenceTime>::iterator,bool> success = alreadyDrawnKeyframes.insert(*i);
-            if (success.second) {
-                glVertex2f(*i - 0.5,lineYpos);
-                glVertex2f(*i + 0.5,lineYpos);
-            }
+            glVertex2f(*i - 0.5,lineYpos);
+            glVertex2f(*i + 0.5,lineYpos);
         }
         glEnd();
         glCheckErrorIgnoreOSXBug();
@@ -0,0 +1,183 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include "UndoJournal.h"
+
+#include <cassert>
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QCoreApplication>
+#include <QThread>
+#include <QTemporaryFile>
+#include <QDir>
+#include <QDebug>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Engine/Settings.h"
+
+#include "Gui/GuiApplicationManager.h"
+
+struct UndoJournalPrivate
+{
+    std::list<UndoRecord*> inMemory; //< oldest first
+    U64 memoryUsage;
+    boost::scoped_ptr<QTemporaryFile> file; //< created on the first record moved to disk
+    bool fileFailed; //< if the file could not be opened, records stay in memory
+    int nRecordsOnDisk;
+
+    UndoJournalPrivate()
+    : inMemory()
+    , memoryUsage(0)
+    , file()
+    , fileFailed(false)
+    , nRecordsOnDisk(0)
+    {
+    }
+
+    bool openFile()
+    {
+        if (file) {
+            return true;
+        }
+        if (fileFailed) {
+            return false;
+        }
+        file.reset( new QTemporaryFile( QDir::tempPath() + QDir::separator() + NATRON_APPLICATION_NAME "_UndoJournal" ) );
+        if ( !file->open() ) {
+            qDebug() << "Could not open the undo/redo journal file, undo/redo events will be kept in memory:" << file->errorString();
+            file.reset();
+            fileFailed = true;
+
+            return false;
+        }
+
+        return true;
+    }
+};
+
+UndoRecord::UndoRecord(const boost::shared_ptr<UndoJournal>& journal)
+: _journal(journal)
+, _compressed()
+, _onDisk(false)
+, _offset(0)
+, _size(0)
+, _memoryIt()
+{
+}
+
+UndoRecord::~UndoRecord()
+{
+    _journal->onRecordDestroyed(this);
+}
+
+std::string
+UndoRecord::getData() const
+{
+    QByteArray uncompressed = qUncompress( _onDisk ? _journal->readRecord(this) : _compressed );
+
+    return std::string( uncompressed.constData(), uncompressed.size() );
+}
+
+UndoJournal::UndoJournal()
+: _imp( new UndoJournalPrivate() )
+{
+}
+
+UndoJournal::~UndoJournal()
+{
+    ///Records hold a reference to the journal
+    assert( _imp->inMemory.empty() && _imp->nRecordsOnDisk == 0 );
+}
+
+boost::shared_ptr<UndoRecord>
+UndoJournal::createRecord(const std::string& data)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    boost::shared_ptr<UndoRecord> ret( new UndoRecord( shared_from_this() ) );
+    ret->_compressed = qCompress( (const uchar*)data.data(), (int)data.size() );
+    ret->_size = ret->_compressed.size();
+    ret->_memoryIt = _imp->inMemory.insert(_imp->inMemory.end(), ret.get());
+    _imp->memoryUsage += ret->_size;
+
+    moveToDisk( appPTR->getCurrentSettings()->getMaximumUndoRedoMemory() );
+
+    return ret;
+}
+
+U64
+UndoJournal::getMemoryUsage() const
+{
+    return _imp->memoryUsage;
+}
+
+void
+UndoJournal::onRecordDestroyed(UndoRecord* record)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    if (!record->_onDisk) {
+        _imp->memoryUsage -= record->_size;
+        _imp->inMemory.erase(record->_memoryIt);
+
+        return;
+    }
+
+    --_imp->nRecordsOnDisk;
+    assert(_imp->nRecordsOnDisk >= 0);
+    if ( (_imp->nRecordsOnDisk == 0) && _imp->file ) {
+        ///Only the end of the file is ever written: the space can only be reclaimed once no record lives there
+        _imp->file->resize(0);
+    }
+}
+
+QByteArray
+UndoJournal::readRecord(const UndoRecord* record) const
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    assert(record->_onDisk && _imp->file);
+
+    if ( !_imp->file->seek(record->_offset) ) {
+        return QByteArray();
+    }
+    QByteArray ret = _imp->file->read(record->_size);
+    if (ret.size() != record->_size) {
+        qDebug() << "Could not read an undo/redo event from the journal file:" << _imp->file->errorString();
+
+        return QByteArray();
+    }
+
+    return ret;
+}
+
+void
+UndoJournal::moveToDisk(U64 budget)
+{
+    while ( _imp->memoryUsage > budget && !_imp->inMemory.empty() ) {
+        if ( !_imp->openFile() ) {
+            return;
+        }
+        UndoRecord* record = _imp->inMemory.front();
+        qint64 offset = _imp->file->size();
+        if ( !_imp->file->seek(offset) || (_imp->file->write(record->_compressed) != record->_size) ) {
+            qDebug() << "Could not write an undo/redo event to the journal file:" << _imp->file->errorString();
+
+            return;
+        }
+        _imp->inMemory.pop_front();
+        _imp->memoryUsage -= record->_size;
+        record->_compressed = QByteArray();
+        record->_onDisk = true;
+        record->_offset = offset;
+        ++_imp->nRecordsOnDisk;
+    }
+}
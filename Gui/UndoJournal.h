@@ -0,0 +1,101 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef NATRON_GUI_UNDOJOURNAL_H_
+#define NATRON_GUI_UNDOJOURNAL_H_
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <list>
+#include <string>
+
+#include "Global/Macros.h"
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QByteArray>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+class UndoJournal;
+struct UndoJournalPrivate;
+
+/**
+ * @brief The state remembered by an undo/redo command, e.g: the shape of a roto curve before an edit.
+ * The data is kept compressed in memory until the journal that created it moves it to disk.
+ **/
+class UndoRecord
+    : public boost::noncopyable
+{
+    friend class UndoJournal;
+
+public:
+
+    ~UndoRecord();
+
+    /**
+     * @brief Returns the data the record was created with, reading it back from the journal file if needed.
+     * An empty string is returned if the journal file could not be read.
+     **/
+    std::string getData() const;
+
+private:
+
+    UndoRecord(const boost::shared_ptr<UndoJournal>& journal);
+
+    boost::shared_ptr<UndoJournal> _journal;
+    QByteArray _compressed; //< empty once the record is on disk
+    bool _onDisk;
+    qint64 _offset,_size; //< location of the compressed data in the journal file
+    std::list<UndoRecord*>::iterator _memoryIt; //< position in the journal's in-memory records, if not on disk
+};
+
+/**
+ * @brief Holds the records of the undo/redo commands of all the applications within a memory budget
+ * (see Settings::getMaximumUndoRedoMemory()). Past the budget, the oldest records are moved to a temporary file
+ * which is emptied when none of the records it holds are alive anymore.
+ * This is only used from the main thread.
+ **/
+class UndoJournal
+    : public boost::enable_shared_from_this<UndoJournal>
+    , public boost::noncopyable
+{
+    friend class UndoRecord;
+
+public:
+
+    UndoJournal();
+
+    ~UndoJournal();
+
+    boost::shared_ptr<UndoRecord> createRecord(const std::string& data);
+
+    ///Returns the size in bytes of the records currently held in memory
+    U64 getMemoryUsage() const;
+
+private:
+
+    void onRecordDestroyed(UndoRecord* record);
+
+    QByteArray readRecord(const UndoRecord* record) const;
+
+    ///Moves the oldest records to disk until the records in memory fit in budget bytes
+    void moveToDisk(U64 budget);
+
+    boost::scoped_ptr<UndoJournalPrivate> _imp;
+};
+
+#endif // NATRON_GUI_UNDOJOURNAL_H_
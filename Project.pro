@@ -14,6 +14,7 @@ SUBDIRS += \
     Gui \
     Renderer \
     Tests \
+    Benchmarks \
     App
 
 win32|mac|linux {SUBDIRS+=CrashReporter}
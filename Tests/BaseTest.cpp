@@ -17,6 +17,10 @@
 #include "BaseTest.h"
 
 #include <QFile>
+#include <QDir>
+#include <QTime>
+#include <QLocalSocket>
+#include <QCoreApplication>
 #include "Engine/Node.h"
 #include "Engine/Project.h"
 #include "Engine/AppManager.h"
@@ -25,6 +29,8 @@
 #include "Engine/EffectInstance.h"
 #include "Engine/Plugin.h"
 #include "Engine/Curve.h"
+#include "Engine/Image.h"
+#include "Engine/ProcessHandler.h"
 using namespace Natron;
 
 
@@ -236,6 +242,215 @@ TEST_F(BaseTest,GenerateDot)
     QFile::remove(filePath);
 }
 
+///Render 100 frames of a static generator: it must be rendered once for the whole sequence
+TEST_F(BaseTest,TimeInvariantSubtree)
+{
+    boost::shared_ptr<Node> generator = createNode(_dotGeneratorPluginID);
+    boost::shared_ptr<Node> writer = createNode(_writeOIIOPluginID);
+
+    const QString& binPath = appPTR->getApplicationBinaryPath();
+    QString filePattern = binPath + "/test_time_invariant_###.jpg";
+    writer->setOutputFilesForWriter(filePattern.toStdString());
+    connectNodes(generator, writer, 0, true);
+
+    Natron::EffectInstance* effect = generator->getLiveInstance();
+    EXPECT_FALSE(effect->isFrameVaryingOrAnimated_Recursive());
+
+    std::list<AppInstance::RenderWork> works;
+    AppInstance::RenderWork w;
+    w.writer = dynamic_cast<Natron::OutputEffectInstance*>(writer->getLiveInstance());
+    assert(w.writer);
+    w.firstFrame = 1;
+    w.lastFrame = 1;
+    works.push_back(w);
+    _app->startWritersRendering(works);
+    int nRendersForOneFrame = effect->getRenderStatistics().nRenders;
+    EXPECT_GT(nRendersForOneFrame, 0);
+    
+    ///The images of the generator rendered for frame 1
+    std::list<boost::shared_ptr<Natron::Image> > imagesOfFirstTime;
+    ASSERT_TRUE( appPTR->getImage(Natron::Image::makeKey(effect->getHash(), false, 1, 0), &imagesOfFirstTime) );
+    ASSERT_FALSE( imagesOfFirstTime.empty() );
+    for (std::list<boost::shared_ptr<Natron::Image> >::iterator it = imagesOfFirstTime.begin(); it != imagesOfFirstTime.end(); ++it) {
+        EXPECT_EQ(1, (*it)->getTime());
+    }
+
+    ///All frames of the sequence share the renders of frame 1
+    effect->resetRenderStatistics();
+    works.front().firstFrame = 2;
+    works.front().lastFrame = 100;
+    _app->startWritersRendering(works);
+    EXPECT_EQ(0, effect->getRenderStatistics().nRenders);
+    for (int i = 2; i <= 100; ++i) {
+        SequenceTime invariantTime;
+        EXPECT_TRUE(effect->getTimeInvariantRenderTime(effect->getHash(), i, &invariantTime));
+        EXPECT_EQ(1, invariantTime);
+    }
+    
+    ///The renders of the other frames were served from the images cached for frame 1: no image was made for them
+    std::list<boost::shared_ptr<Natron::Image> > imagesOfLastTime;
+    ASSERT_TRUE( appPTR->getImage(Natron::Image::makeKey(effect->getHash(), false, 100, 0), &imagesOfLastTime) );
+    EXPECT_TRUE(imagesOfLastTime == imagesOfFirstTime);
+    for (std::list<boost::shared_ptr<Natron::Image> >::iterator it = imagesOfLastTime.begin(); it != imagesOfLastTime.end(); ++it) {
+        EXPECT_EQ(1, (*it)->getTime());
+    }
+
+    ///Once animated, the generator must be rendered at each frame
+    boost::shared_ptr<KnobI> knob = generator->getKnobByName("radius");
+    Double_Knob* radius = dynamic_cast<Double_Knob*>(knob.get());
+    assert(radius);
+    radius->setValueAtTime(1, 10, 0);
+    radius->setValueAtTime(100, 50, 0);
+    EXPECT_TRUE(effect->isFrameVaryingOrAnimated_Recursive());
+    SequenceTime invariantTime;
+    EXPECT_FALSE(effect->getTimeInvariantRenderTime(effect->getHash(), 2, &invariantTime));
+    effect->resetRenderStatistics();
+    works.front().firstFrame = 1;
+    _app->startWritersRendering(works);
+    EXPECT_GE(effect->getRenderStatistics().nRenders, 100);
+
+    for (int i = 1; i <= 100; ++i) {
+        QFile::remove(binPath + QString("/test_time_invariant_%1.jpg").arg(i, 3, 10, QChar('0')));
+    }
+}
+
+/**
+ * @brief Reads the replies of a render daemon to a job until the line ending the job, while the main thread renders it.
+ * Returns the number of lines ending a job that were received.
+ **/
+static int
+readRenderDaemonReply(QLocalSocket* socket,
+                      QStringList* lines)
+{
+    int nTerminalLines = 0;
+    QTime timer;
+
+    timer.start();
+    while (nTerminalLines == 0 && timer.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+        socket->waitForReadyRead(100);
+        while ( socket->canReadLine() ) {
+            QString line = QString( socket->readLine() ).trimmed();
+            lines->push_back(line);
+            if ( (line == kRenderingFinishedStringShort) || line.startsWith(kRenderJobFailedStringShort) ) {
+                ++nTerminalLines;
+            }
+        }
+    }
+
+    return nTerminalLines;
+}
+
+///A render daemon ends each job with exactly one line reporting its actual result
+TEST_F(BaseTest,RenderDaemonJobs)
+{
+    boost::shared_ptr<Node> generator = createNode(_dotGeneratorPluginID);
+    boost::shared_ptr<Node> writer = createNode(_writeOIIOPluginID);
+
+    const QString& binPath = appPTR->getApplicationBinaryPath();
+    QString filePattern = binPath + "/test_render_daemon_###.jpg";
+    writer->setOutputFilesForWriter(filePattern.toStdString());
+    connectNodes(generator, writer, 0, true);
+    QString projectPath = QDir::tempPath() + "/test_render_daemon." NATRON_PROJECT_FILE_EXT;
+    _app->getProject()->exportProject(projectPath, false);
+
+    RenderDaemon daemon("NatronRenderDaemonTest");
+    ASSERT_TRUE( daemon.isListening() );
+
+    QLocalSocket socket;
+    socket.connectToServer( daemon.getFullServerName() );
+    ASSERT_TRUE( socket.waitForConnected(5000) );
+
+    ///An invalid job fails
+    QStringList lines;
+    socket.write("-w\n");
+    EXPECT_EQ( 1, readRenderDaemonReply(&socket, &lines) );
+    ASSERT_FALSE( lines.isEmpty() );
+    EXPECT_TRUE( lines.back().startsWith(kRenderJobFailedStringShort) );
+
+    ///A job rendering 2 frames succeeds and reports its frames before its end
+    lines.clear();
+    QString job = QString("-w %1 1-2 \"%2\"\n").arg( writer->getScriptName().c_str() ).arg(projectPath);
+    socket.write( job.toUtf8() );
+    EXPECT_EQ( 1, readRenderDaemonReply(&socket, &lines) );
+    ASSERT_FALSE( lines.isEmpty() );
+    EXPECT_EQ( QString(kRenderingFinishedStringShort), lines.back() );
+    EXPECT_EQ( 2, lines.filter(kFrameRenderedStringShort).size() );
+
+    ///The next reply starts with the next job: the render did not report its end twice
+    lines.clear();
+    socket.write("\"" + QString(binPath + "/does_not_exist." NATRON_PROJECT_FILE_EXT).toUtf8() + "\"\n");
+    EXPECT_EQ( 1, readRenderDaemonReply(&socket, &lines) );
+    ASSERT_EQ( 1, lines.size() );
+    EXPECT_TRUE( lines.front().startsWith(kRenderJobFailedStringShort) );
+
+    ///A job queued by a client that disconnected is not rendered and its result is not sent to the next client
+    socket.write( job.toUtf8() );
+    socket.flush();
+    socket.disconnectFromServer();
+    QLocalSocket socket2;
+    socket2.connectToServer( daemon.getFullServerName() );
+    ASSERT_TRUE( socket2.waitForConnected(5000) );
+    lines.clear();
+    socket2.write("-w\n");
+    EXPECT_EQ( 1, readRenderDaemonReply(&socket2, &lines) );
+    ASSERT_EQ( 1, lines.size() );
+    EXPECT_TRUE( lines.front().startsWith(kRenderJobFailedStringShort) );
+    socket2.disconnectFromServer();
+
+    QFile::remove(projectPath);
+    for (int i = 1; i <= 2; ++i) {
+        QFile::remove(binPath + QString("/test_render_daemon_%1.jpg").arg(i, 3, 10, QChar('0')));
+    }
+}
+
+///The keyframes index of a node follows the curves of its knobs
+TEST_F(BaseTest,KeyframesIndex)
+{
+    boost::shared_ptr<Node> generator = createNode(_dotGeneratorPluginID);
+    boost::shared_ptr<KnobI> knob = generator->getKnobByName("radius");
+    Double_Knob* radius = dynamic_cast<Double_Knob*>(knob.get());
+    assert(radius);
+
+    std::list<SequenceTime> keys;
+    generator->getAllKnobsKeyframes(&keys);
+    EXPECT_TRUE(keys.empty());
+
+    radius->setValueAtTime(10, 10, 0);
+    radius->setValueAtTime(1, 20, 0);
+    radius->setValueAtTime(5, 30, 0);
+    ///setting a keyframe at an existing time does not add one
+    radius->setValueAtTime(5, 40, 0);
+    generator->getAllKnobsKeyframes(&keys);
+    ASSERT_EQ(3, (int)keys.size());
+    std::list<SequenceTime>::iterator it = keys.begin();
+    EXPECT_EQ(1, *it++);
+    EXPECT_EQ(5, *it++);
+    EXPECT_EQ(10, *it++);
+
+    radius->deleteValueAtTime(5, 0, Natron::eValueChangedReasonPluginEdited);
+    keys.clear();
+    generator->getAllKnobsKeyframes(&keys);
+    ASSERT_EQ(2, (int)keys.size());
+    EXPECT_EQ(1, keys.front());
+    EXPECT_EQ(10, keys.back());
+
+    ///secret knobs are not indexed
+    radius->setSecret(true);
+    keys.clear();
+    generator->getAllKnobsKeyframes(&keys);
+    EXPECT_TRUE(keys.empty());
+    radius->setSecret(false);
+    keys.clear();
+    generator->getAllKnobsKeyframes(&keys);
+    EXPECT_EQ(2, (int)keys.size());
+
+    radius->removeAnimation(0, Natron::eValueChangedReasonPluginEdited);
+    keys.clear();
+    generator->getAllKnobsKeyframes(&keys);
+    EXPECT_TRUE(keys.empty());
+}
+
 TEST_F(BaseTest,SetValues)
 {
     boost::shared_ptr<Node> generator = createNode(_dotGeneratorPluginID);
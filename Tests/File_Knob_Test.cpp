@@ -14,6 +14,7 @@
 #include <QDir>
 
 #include "Engine/StandardPaths.h"
+#include "Engine/KnobFile.h"
 #include <SequenceParsing.h>
 
 using namespace SequenceParsing;
@@ -478,6 +479,85 @@ TEST(SequenceParsing,OutputSequence) {
     EXPECT_EQ(pattern,filename);
 }
 
+TEST(FileNamePattern,MatchesSequenceParsing) {
+    const char* patterns[] = {
+        "/Users/Test/mysequence.####.exr",
+        "/Users/Test/mysequence.#.exr",
+        "/Users/Test/####",
+        "/Users/Te#st/mysequence10.png",
+        "/Users/Test/mysequence10.png",
+        "weird.%v.test_%01d.unittest",
+        "###lalala%04d.jpg",
+        "##test_##.unittest",
+        ""
+    };
+    const int times[] = { 0, 1, 9, 10, 120, 12345, -5 };
+    for (std::size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i) {
+        FileNamePattern pattern(patterns[i]);
+        for (std::size_t t = 0; t < sizeof(times) / sizeof(times[0]); ++t) {
+            for (int view = 0; view < 3; ++view) {
+                EXPECT_EQ( generateFileNameFromPattern(patterns[i], times[t], view), pattern.generateFileName(times[t], view) );
+            }
+        }
+    }
+}
+
+TEST(File_Knob,FileNamesInRangeReportsMissingFrames) {
+    ///create a sequence with holes in a temporary directory
+    QString tempPath = Natron::StandardPaths::writableLocation(Natron::StandardPaths::eStandardLocationTemp);
+    QDir dir(tempPath);
+
+    dir.mkpath(".");
+    dir.mkdir("NatronUnitTest");
+    dir.cd("NatronUnitTest");
+    QStringList fileNames;
+    for (int i = 1; i <= 10; ++i) {
+        if ( (i == 3) || (i == 7) ) {
+            continue;
+        }
+        QString number = QString::number(i);
+        while (number.size() < 4) {
+            number.prepend('0');
+        }
+        QFile file( dir.absoluteFilePath("missing_" + number + ".unittest") );
+        fileNames << file.fileName();
+        file.open(QIODevice::WriteOnly | QIODevice::Text);
+    }
+
+    boost::shared_ptr<File_Knob> knob( new File_Knob(NULL, "File", 1, false) );
+    knob->populate();
+    knob->setAsInputImage();
+    knob->setValue(dir.absoluteFilePath("missing_####.unittest").toStdString(), 0);
+
+    ///the range goes past the end of the sequence
+    std::vector<std::string> files;
+    std::vector<bool> exist;
+    knob->getFileNamesInRange(1, 12, &files, &exist);
+    ASSERT_EQ( 12, (int)files.size() );
+    ASSERT_EQ( 12, (int)exist.size() );
+    std::vector<int> missing;
+    for (int i = 0; i < 12; ++i) {
+        EXPECT_EQ( knob->getFileName(i + 1), files[i] );
+        if (!exist[i]) {
+            missing.push_back(i + 1);
+        }
+    }
+    ASSERT_EQ( 4, (int)missing.size() );
+    EXPECT_EQ( 3, missing[0] );
+    EXPECT_EQ( 7, missing[1] );
+    EXPECT_EQ( 11, missing[2] );
+    EXPECT_EQ( 12, missing[3] );
+
+    ///an empty range
+    knob->getFileNamesInRange(5, 4, &files, &exist);
+    EXPECT_TRUE( files.empty() );
+    EXPECT_TRUE( exist.empty() );
+
+    ///delete files
+    for (int i = 0; i < fileNames.size(); ++i) {
+        QFile::remove(fileNames[i]);
+    }
+}
 
 TEST(FileNameContent,GeneralTest) {
     std::string file1("/Users/Test/mysequence001.jpg");
@@ -0,0 +1,136 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <cmath>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "Engine/Image.h"
+#include "Engine/ImageTransform.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using namespace Natron;
+
+static boost::shared_ptr<Image> createImage(const RectI& bounds,const ImageComponents& comps,ImageBitDepthEnum depth)
+{
+    RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    return boost::shared_ptr<Image>(new Image(comps, rod, bounds, 0, 1., depth, false));
+}
+
+///Fills a float RGBA image with a pattern depending on the pixel position
+static void fillPattern(Image* img)
+{
+    Image::WriteAccess acc = img->getWriteRights();
+    const RectI& bounds = img->getBounds();
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        float* pix = (float*)acc.pixelAt(bounds.x1, y);
+        for (int x = bounds.x1; x < bounds.x2; ++x, pix += 4) {
+            pix[0] = (float)x;
+            pix[1] = (float)y;
+            pix[2] = (float)((x * 7 + y * 3) % 11);
+            pix[3] = 1.f;
+        }
+    }
+}
+
+TEST(ImageTransformTest,IntegerTranslationIsExact) {
+    RectI bounds(0, 0, 32, 32);
+    boost::shared_ptr<Image> src = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+    boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+    fillPattern(src.get());
+
+    const TransformFilterEnum filters[] = { eTransformFilterBilinear, eTransformFilterCubic, eTransformFilterKeys, eTransformFilterLanczos };
+    Transform::Matrix3x3 translate(1., 0., 3., 0., 1., 2., 0., 0., 1.);
+    for (int f = 0; f < 4; ++f) {
+        ASSERT_TRUE(transformImage(*src, translate, filters[f], bounds, dst.get()));
+        Image::ReadAccess acc = dst->getReadRights();
+        ///Pixels far enough from the edges so that no tap falls outside of the source
+        for (int y = 6; y < 26; ++y) {
+            const float* pix = (const float*)acc.pixelAt(6, y);
+            for (int x = 6; x < 26; ++x, pix += 4) {
+                EXPECT_NEAR(x - 3, pix[0], 1e-4);
+                EXPECT_NEAR(y - 2, pix[1], 1e-4);
+                EXPECT_NEAR((((x - 3) * 7 + (y - 2) * 3) % 11), pix[2], 1e-4);
+                EXPECT_NEAR(1., pix[3], 1e-4);
+            }
+        }
+        ///The source does not cover the bottom left corner
+        const float* corner = (const float*)acc.pixelAt(0, 0);
+        EXPECT_EQ(0.f, corner[3]);
+    }
+}
+
+TEST(ImageTransformTest,ConstantImageIsPreserved) {
+    RectI bounds(0, 0, 64, 64);
+    boost::shared_ptr<Image> src = createImage(bounds, ImageComponents::getAlphaComponents(), eImageBitDepthByte);
+    boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getAlphaComponents(), eImageBitDepthByte);
+    {
+        Image::WriteAccess acc = src->getWriteRights();
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            unsigned char* pix = acc.pixelAt(bounds.x1, y);
+            for (int x = bounds.x1; x < bounds.x2; ++x) {
+                pix[x] = 200;
+            }
+        }
+    }
+
+    ///Rotate by 30 degrees around the center and scale by 1.3
+    double c = 1.3 * std::cos(M_PI / 6.);
+    double s = 1.3 * std::sin(M_PI / 6.);
+    Transform::Matrix3x3 mat(c, -s, 32. - c * 32. + s * 32., s, c, 32. - s * 32. - c * 32., 0., 0., 1.);
+
+    const TransformFilterEnum filters[] = { eTransformFilterBilinear, eTransformFilterCubic, eTransformFilterKeys, eTransformFilterLanczos };
+    for (int f = 0; f < 4; ++f) {
+        ASSERT_TRUE(transformImage(*src, mat, filters[f], bounds, dst.get()));
+        Image::ReadAccess acc = dst->getReadRights();
+        for (int y = 24; y < 40; ++y) {
+            const unsigned char* pix = acc.pixelAt(24, y);
+            for (int x = 24; x < 40; ++x, ++pix) {
+                EXPECT_EQ(200, *pix);
+            }
+        }
+    }
+}
+
+TEST(ImageTransformTest,CubicHasZeroDerivativesAtTheSamples) {
+    RectI bounds(0, 0, 16, 16);
+    boost::shared_ptr<Image> src = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+    boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+    fillPattern(src.get());
+
+    ///A quarter pixel translation samples the source 3/4 of the way between 2 pixels: the weight of the
+    ///nearest one is 1 - (3 * 0.25^2 - 2 * 0.25^3)
+    Transform::Matrix3x3 translate(1., 0., 0.25, 0., 1., 0., 0., 0., 1.);
+    ASSERT_TRUE(transformImage(*src, translate, eTransformFilterCubic, bounds, dst.get()));
+    Image::ReadAccess acc = dst->getReadRights();
+    Image::ReadAccess srcAcc = src->getReadRights();
+    for (int y = 2; y < 14; ++y) {
+        const float* pix = (const float*)acc.pixelAt(2, y);
+        for (int x = 2; x < 14; ++x, pix += 4) {
+            EXPECT_NEAR(x - 0.15625, pix[0], 1e-4);
+            EXPECT_NEAR(y, pix[1], 1e-4);
+            ///No overshoot: the result lies between the 2 source pixels
+            const float* left = (const float*)srcAcc.pixelAt(x - 1, y);
+            const float* right = (const float*)srcAcc.pixelAt(x, y);
+            EXPECT_LE(std::min(left[2], right[2]) - 1e-4, pix[2]);
+            EXPECT_GE(std::max(left[2], right[2]) + 1e-4, pix[2]);
+        }
+    }
+}
+
+TEST(ImageTransformTest,SingularMatrixFails) {
+    RectI bounds(0, 0, 8, 8);
+    boost::shared_ptr<Image> src = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+    boost::shared_ptr<Image> dst = createImage(bounds, ImageComponents::getRGBAComponents(), eImageBitDepthFloat);
+    Transform::Matrix3x3 singular(0., 0., 0., 0., 1., 0., 0., 0., 1.);
+    EXPECT_FALSE(transformImage(*src, singular, eTransformFilterCubic, bounds, dst.get()));
+}
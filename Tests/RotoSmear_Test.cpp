@@ -0,0 +1,85 @@
+//  Natron
+//
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Engine/RotoSmear.h"
+
+///The per-pixel blend that was used by RotoSmear before smearBlendRow
+static void referenceSmearBlendRow(const float* srcPixels,const float* maskPixels,int width,int nComps,float* dstPixels)
+{
+    for (int x = 0; x < width; ++x, dstPixels += nComps, srcPixels += nComps, ++maskPixels) {
+        for (int k = 0; k < nComps; ++k) {
+            dstPixels[k] = srcPixels[k] * *maskPixels + dstPixels[k] * (1. - *maskPixels);
+        }
+    }
+}
+
+static float randomFloat()
+{
+    // coverity[dont_call]
+    return (float)rand() / (float)RAND_MAX;
+}
+
+TEST(RotoSmearTest,BlendRowMatchesReference) {
+    srand(2000);
+    ///Test odd widths so that the remainder of the vectorized loops is exercised
+    const int widths[] = { 1, 3, 4, 7, 64, 129 };
+    for (int nComps = 1; nComps <= 4; ++nComps) {
+        for (unsigned int w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+            int width = widths[w];
+            std::vector<float> src(width * nComps),mask(width),dst(width * nComps);
+            for (std::size_t i = 0; i < src.size(); ++i) {
+                src[i] = randomFloat();
+                dst[i] = randomFloat();
+            }
+            for (int i = 0; i < width; ++i) {
+                mask[i] = randomFloat();
+            }
+            std::vector<float> expected = dst;
+            referenceSmearBlendRow(&src[0], &mask[0], width, nComps, &expected[0]);
+            Natron::smearBlendRow(&src[0], &mask[0], width, nComps, &dst[0]);
+            for (std::size_t i = 0; i < dst.size(); ++i) {
+                EXPECT_NEAR(expected[i], dst[i], 1e-6);
+            }
+        }
+    }
+}
+
+TEST(RotoSmearTest,BlendRowMaskBounds) {
+    const int width = 9;
+    std::vector<float> src(width * 4, 1.f),mask(width),dst(width * 4, 0.5f);
+    for (int i = 0; i < width; ++i) {
+        mask[i] = (i % 2) ? 1.f : 0.f;
+    }
+    Natron::smearBlendRow(&src[0], &mask[0], width, 4, &dst[0]);
+    ///A mask of 1 copies the source, a mask of 0 leaves the destination untouched
+    for (int i = 0; i < width; ++i) {
+        for (int k = 0; k < 4; ++k) {
+            EXPECT_EQ((i % 2) ? 1.f : 0.5f, dst[i * 4 + k]);
+        }
+    }
+}
+
+TEST(RotoSmearTest,DabsConflict) {
+    RectI srcA(0,0,10,10),dstA(5,0,15,10);
+    ///Far away dabs can be blended concurrently
+    EXPECT_FALSE(Natron::smearDabsConflict(srcA, dstA, RectI(100,0,110,10), RectI(105,0,115,10)));
+    ///Reading pixels written by the other dab, in both orders
+    EXPECT_TRUE(Natron::smearDabsConflict(srcA, dstA, RectI(14,0,24,10), RectI(30,0,40,10)));
+    EXPECT_TRUE(Natron::smearDabsConflict(RectI(14,0,24,10), RectI(30,0,40,10), srcA, dstA));
+    ///Writing pixels read by the other dab
+    EXPECT_TRUE(Natron::smearDabsConflict(srcA, dstA, RectI(30,0,40,10), RectI(9,0,19,10)));
+    ///Writing the same pixels
+    EXPECT_TRUE(Natron::smearDabsConflict(srcA, dstA, RectI(30,0,40,10), RectI(14,9,24,19)));
+    ///Touching bounds do not share pixels
+    EXPECT_FALSE(Natron::smearDabsConflict(srcA, dstA, RectI(15,0,25,10), RectI(25,0,35,10)));
+}
@@ -161,7 +161,9 @@ SOURCES += \
     Image_Test.cpp \
     Lut_Test.cpp \
     File_Knob_Test.cpp \
-    Curve_Test.cpp
+    Curve_Test.cpp \
+    RotoSmear_Test.cpp \
+    ImageTransform_Test.cpp
 
 HEADERS += \
     BaseTest.h